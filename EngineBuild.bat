@@ -13,7 +13,7 @@ set BuildDir=%MainDir%Build\
 set CompilerFlags=/c /Zi /Od /nologo /std:c++20
 
 set LibsPath=/LIBPATH:%MainDir%\Libs\
-set Libs=user32.lib vulkan-1.lib dxcompiler.lib
+set Libs=user32.lib advapi32.lib vulkan-1.lib dxcompiler.lib
 
 set BaseFileToCompile=%SrcDir%SM\%BaseFilename%.cpp
 set PlatformFileToCompile=%SrcDir%SM\%PlatformFilename%.cpp
@@ -35,6 +35,16 @@ set PlatformOutputFiles=/Fd%PlatformPdbOutput% /Fo%PlatformObjOutput%
 
 set Win32OutputFiles=/Fd%PdbOutput% /Fo%ObjOutput%
 
+set TestsDir=%SrcDir%Tests\
+set TestsObjOutput=%BuildDir%SM-Tests.obj
+set TestsPdbOutput=%BuildDir%SM-Tests.pdb
+set TestsExeOutput=%BuildDir%SM-Tests.exe
+
+REM Benchmarks compile their own optimized copy of the engine so they don't measure /Od code
+set BenchBuildDir=%BuildDir%Bench\
+set BenchCompilerFlags=/c /Zi /O2 /DNDEBUG /EHsc /nologo /std:c++20
+set BenchExeOutput=%BuildDir%SM-Bench.exe
+
 mkdir %BuildDir% >nul 2>&1
 
 REM Compile Engine.cpp
@@ -55,6 +65,47 @@ IF %ERRORLEVEL% NEQ 0 (
     EXIT /b %ERRORLEVEL%
 )
 
+REM Optional targets, "EngineBuild.bat tests" also builds SM-Tests.exe and "EngineBuild.bat bench" builds SM-Bench.exe
+IF /I "%~1"=="tests" GOTO BuildTests
+IF /I "%~1"=="bench" GOTO BuildBench
+GOTO Done
+
+:BuildTests
+cl %CompilerFlags% /EHsc %TestsDir%Tests.cpp %IncludeDirs% /Fd%TestsPdbOutput% /Fo%TestsObjOutput%
+IF %ERRORLEVEL% NEQ 0 (
+    EXIT /b %ERRORLEVEL%
+)
+
+link /nologo /DEBUG /out:%TestsExeOutput% %TestsObjOutput% %BaseLibOutput% %LibsPath% /IGNORE:4006
+IF %ERRORLEVEL% NEQ 0 (
+    EXIT /b %ERRORLEVEL%
+)
+GOTO Done
+
+:BuildBench
+mkdir %BenchBuildDir% >nul 2>&1
+
+cl %BenchCompilerFlags% %BaseFileToCompile% %IncludeDirs% /Fd%BenchBuildDir%%BaseOutputName%.pdb /Fo%BenchBuildDir%%BaseOutputName%.obj
+IF %ERRORLEVEL% NEQ 0 (
+    EXIT /b %ERRORLEVEL%
+)
+
+cl %BenchCompilerFlags% %PlatformFileToCompile% %IncludeDirs% /Fd%BenchBuildDir%%PlatformOutputName%.pdb /Fo%BenchBuildDir%%PlatformOutputName%.obj
+IF %ERRORLEVEL% NEQ 0 (
+    EXIT /b %ERRORLEVEL%
+)
+
+cl %BenchCompilerFlags% %TestsDir%Bench.cpp %IncludeDirs% /Fd%BenchBuildDir%Bench.pdb /Fo%BenchBuildDir%Bench.obj
+IF %ERRORLEVEL% NEQ 0 (
+    EXIT /b %ERRORLEVEL%
+)
+
+link /nologo /DEBUG /out:%BenchExeOutput% %BenchBuildDir%Bench.obj %BenchBuildDir%%BaseOutputName%.obj %BenchBuildDir%%PlatformOutputName%.obj %Libs% %LibsPath% /IGNORE:4006
+IF %ERRORLEVEL% NEQ 0 (
+    EXIT /b %ERRORLEVEL%
+)
+
+:Done
 ENDLOCAL
 
 EXIT /b %ERRORLEVEL%
@@ -2,6 +2,10 @@
 
 #include "SM/StandardTypes.h"
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 namespace SM
 {
     constexpr inline bool IsOnlyBitSet(U8 bits, U8 flag) { return (bits & ~flag) == 0; }
@@ -23,4 +27,67 @@ namespace SM
     constexpr inline bool IsBitSet(U64 bits, U64 flag) { return (bits & flag) == flag; }
     constexpr inline void SetBit(U64& bits, U64 flag) { bits |= flag; }
     constexpr inline void UnSetBit(U64& bits, U64 flag) { bits = bits & ~flag; }
+
+    // Bit scans return the index of the lowest / highest set bit, the result is undefined if no bits are set
+    inline U32 FindFirstSetBit(U32 bits)
+    {
+        #if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, bits);
+        return index;
+        #else
+        return __builtin_ctz(bits);
+        #endif
+    }
+
+    inline U32 FindFirstSetBit(U64 bits)
+    {
+        #if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, bits);
+        return index;
+        #else
+        return __builtin_ctzll(bits);
+        #endif
+    }
+
+    inline U32 FindLastSetBit(U32 bits)
+    {
+        #if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse(&index, bits);
+        return index;
+        #else
+        return 31 - __builtin_clz(bits);
+        #endif
+    }
+
+    inline U32 FindLastSetBit(U64 bits)
+    {
+        #if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, bits);
+        return index;
+        #else
+        return 63 - __builtin_clzll(bits);
+        #endif
+    }
+
+    inline U32 CountSetBits(U32 bits)
+    {
+        #if defined(_MSC_VER)
+        return __popcnt(bits);
+        #else
+        return __builtin_popcount(bits);
+        #endif
+    }
+
+    inline U32 CountSetBits(U64 bits)
+    {
+        #if defined(_MSC_VER)
+        return (U32)__popcnt64(bits);
+        #else
+        return __builtin_popcountll(bits);
+        #endif
+    }
 }
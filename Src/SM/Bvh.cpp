@@ -0,0 +1,530 @@
+#include "SM/Bvh.h"
+#include "SM/Assert.h"
+#include "SM/Util.h"
+
+#include <atomic>
+#include <cfloat>
+#include <thread>
+
+using namespace SM;
+
+static const U32 kBvhNumBins = 16;
+static const U32 kBvhMaxLeafPrims = 16;
+static const U32 kBvhParallelMinPrims = 16 * 1024;
+
+// Cost of visiting a node relative to testing one primitive
+static const F32 kBvhTraversalCost = 1.0f;
+
+static Vec3 MinVec3(const Vec3& a, const Vec3& b)
+{
+    return Vec3(Min(a.x, b.x), Min(a.y, b.y), Min(a.z, b.z));
+}
+
+static Vec3 MaxVec3(const Vec3& a, const Vec3& b)
+{
+    return Vec3(Max(a.x, b.x), Max(a.y, b.y), Max(a.z, b.z));
+}
+
+// Half the surface area, only ever compared against other areas
+static F32 CalcHalfArea(const Vec3& boundsMin, const Vec3& boundsMax)
+{
+    Vec3 size = boundsMax - boundsMin;
+    return (size.x * size.y) + (size.y * size.z) + (size.z * size.x);
+}
+
+// Primitives are partitioned as these rather than as indices so every pass over a node reads memory in order.
+// 16 byte aligned so the bounds load straight into simd registers, the w lanes then hold m_primIndex / padding.
+struct alignas(16) BvhPrimRef
+{
+    Vec3 m_boundsMin;
+    U32 m_primIndex = 0;
+    Vec3 m_boundsMax;
+    U32 m_pad = 0;
+};
+
+// Box grown one primitive at a time during the build. Left uninitialized by default so arrays of bins cost nothing
+// until Clear, every node only clears the bins it uses.
+struct BvhBounds
+{
+    #if SM_SIMD_ENABLED
+    F32x4 m_min;
+    F32x4 m_max;
+    #else
+    Vec3 m_min;
+    Vec3 m_max;
+    #endif
+
+    void Clear();
+    void Grow(const BvhBounds& other);
+    void GrowByPrim(const BvhPrimRef& ref);
+
+    // centroids are doubled, min + max, which bins the same as halving them
+    void GrowByCentroid(const BvhPrimRef& ref);
+
+    Vec3 GetMin() const;
+    Vec3 GetMax() const;
+
+    F32 CalcHalfArea() const;
+};
+
+inline void BvhBounds::Clear()
+{
+    #if SM_SIMD_ENABLED
+    m_min = SimdSplat(FLT_MAX);
+    m_max = SimdSplat(-FLT_MAX);
+    #else
+    m_min = Vec3(FLT_MAX, FLT_MAX, FLT_MAX);
+    m_max = Vec3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    #endif
+}
+
+inline void BvhBounds::Grow(const BvhBounds& other)
+{
+    #if SM_SIMD_ENABLED
+    m_min = SimdMin(m_min, other.m_min);
+    m_max = SimdMax(m_max, other.m_max);
+    #else
+    m_min = MinVec3(m_min, other.m_min);
+    m_max = MaxVec3(m_max, other.m_max);
+    #endif
+}
+
+inline void BvhBounds::GrowByPrim(const BvhPrimRef& ref)
+{
+    #if SM_SIMD_ENABLED
+    m_min = SimdMin(m_min, SimdLoad(&ref.m_boundsMin.x));
+    m_max = SimdMax(m_max, SimdLoad(&ref.m_boundsMax.x));
+    #else
+    m_min = MinVec3(m_min, ref.m_boundsMin);
+    m_max = MaxVec3(m_max, ref.m_boundsMax);
+    #endif
+}
+
+inline void BvhBounds::GrowByCentroid(const BvhPrimRef& ref)
+{
+    #if SM_SIMD_ENABLED
+    F32x4 centroid = SimdAdd(SimdLoad(&ref.m_boundsMin.x), SimdLoad(&ref.m_boundsMax.x));
+    m_min = SimdMin(m_min, centroid);
+    m_max = SimdMax(m_max, centroid);
+    #else
+    Vec3 centroid = ref.m_boundsMin + ref.m_boundsMax;
+    m_min = MinVec3(m_min, centroid);
+    m_max = MaxVec3(m_max, centroid);
+    #endif
+}
+
+inline Vec3 BvhBounds::GetMin() const
+{
+    #if SM_SIMD_ENABLED
+    alignas(16) F32 values[4];
+    SimdStore(values, m_min);
+    return Vec3(values[0], values[1], values[2]);
+    #else
+    return m_min;
+    #endif
+}
+
+inline Vec3 BvhBounds::GetMax() const
+{
+    #if SM_SIMD_ENABLED
+    alignas(16) F32 values[4];
+    SimdStore(values, m_max);
+    return Vec3(values[0], values[1], values[2]);
+    #else
+    return m_max;
+    #endif
+}
+
+inline F32 BvhBounds::CalcHalfArea() const
+{
+    #if SM_SIMD_ENABLED
+    // (x * y, y * z, z * x) summed, w is never read
+    F32x4 size = SimdSub(m_max, m_min);
+    F32x4 products = SimdMul(size, SimdSwizzle<1, 2, 0, 3>(size));
+    return SimdGetX(products) + SimdGetX(SimdSplatY(products)) + SimdGetX(SimdSplatZ(products));
+    #else
+    return ::CalcHalfArea(m_min, m_max);
+    #endif
+}
+
+static BvhBounds CreateEmptyBounds()
+{
+    BvhBounds bounds;
+    bounds.Clear();
+    return bounds;
+}
+
+struct BvhBin
+{
+    BvhBounds m_bounds;
+    U32 m_numPrims;
+
+    void Clear() { m_bounds.Clear(); m_numPrims = 0; }
+};
+
+struct BvhBuildContext
+{
+    BvhPrimRef* m_pPrimRefs = nullptr;
+    BvhNode* m_pNodes = nullptr;
+    std::atomic<U32> m_numNodes = 0;
+};
+
+static F32 GetAxis(const Vec3& v, U32 axis)
+{
+    return (&v.x)[axis];
+}
+
+static F32 CalcCentroidOnAxis(const BvhPrimRef& ref, U32 axis)
+{
+    return GetAxis(ref.m_boundsMin, axis) + GetAxis(ref.m_boundsMax, axis);
+}
+
+static U32 CalcBin(F32 centroid, F32 centroidMin, F32 binScale, U32 numBins)
+{
+    U32 bin = (U32)((centroid - centroidMin) * binScale);
+    return bin < numBins ? bin : numBins - 1;
+}
+
+static void SetNodeBounds(BvhNode& node, const BvhBounds& bounds)
+{
+    node.m_boundsMin = bounds.GetMin();
+    node.m_boundsMax = bounds.GetMax();
+}
+
+static void CalcRangeBounds(const BvhPrimRef* pPrimRefs, U32 numPrims, BvhNode& outNode, BvhBounds& outCentroidBounds)
+{
+    BvhBounds bounds = CreateEmptyBounds();
+    outCentroidBounds = CreateEmptyBounds();
+    for(U32 i = 0; i < numPrims; i++)
+    {
+        bounds.GrowByPrim(pPrimRefs[i]);
+        outCentroidBounds.GrowByCentroid(pPrimRefs[i]);
+    }
+    SetNodeBounds(outNode, bounds);
+}
+
+// The node's bounds and the bounds of its centroids come from the parent, which gets them for free while binning
+// and partitioning, so each level of the tree reads its primitives twice instead of three times
+static void BvhBuildNode(BvhBuildContext& context, U32 nodeIndex, const BvhBounds& centroidBounds, U32 first, U32 numPrims, U32 depth, U32 numThreads)
+{
+    BvhNode& node = context.m_pNodes[nodeIndex];
+    BvhPrimRef* pPrimRefs = context.m_pPrimRefs;
+    const Vec3 centroidMin = centroidBounds.GetMin();
+    const Vec3 centroidMax = centroidBounds.GetMax();
+
+    node.m_firstChildOrPrim = first;
+    node.m_numPrims = numPrims;
+    if(numPrims == 1 || depth + 1 >= kBvhMaxDepth)
+        return;
+
+    // bin centroids along every axis in one pass over the primitives, small nodes are most of the tree and get fewer
+    // bins so clearing and sweeping them doesn't dominate the build
+    const U32 numBins = numPrims < kBvhNumBins ? numPrims : kBvhNumBins;
+    BvhBin bins[3][kBvhNumBins];
+    F32 binScales[3];
+    for(U32 axis = 0; axis < 3; axis++)
+    {
+        for(U32 b = 0; b < numBins; b++)
+        {
+            bins[axis][b].Clear();
+        }
+
+        F32 extent = GetAxis(centroidMax, axis) - GetAxis(centroidMin, axis);
+        binScales[axis] = extent > 0.0f ? (F32)numBins * 0.9999f / extent : 0.0f;
+    }
+
+    for(U32 i = first; i < first + numPrims; i++)
+    {
+        const BvhPrimRef& ref = pPrimRefs[i];
+        for(U32 axis = 0; axis < 3; axis++)
+        {
+            BvhBin& bin = bins[axis][CalcBin(CalcCentroidOnAxis(ref, axis), GetAxis(centroidMin, axis), binScales[axis], numBins)];
+            bin.m_bounds.GrowByPrim(ref);
+            bin.m_numPrims++;
+        }
+    }
+
+    // sweep each axis from both ends, splitting before bin s puts bins [0, s) on the left
+    F32 bestCost = FLT_MAX;
+    U32 bestAxis = 0;
+    U32 bestSplit = 0;
+    for(U32 axis = 0; axis < 3; axis++)
+    {
+        if(binScales[axis] == 0.0f)
+            continue;
+
+        F32 rightAreas[kBvhNumBins];
+        U32 rightCounts[kBvhNumBins];
+        BvhBin right;
+        right.Clear();
+        for(U32 s = numBins - 1; s > 0; s--)
+        {
+            right.m_bounds.Grow(bins[axis][s].m_bounds);
+            right.m_numPrims += bins[axis][s].m_numPrims;
+            rightAreas[s] = right.m_numPrims > 0 ? right.m_bounds.CalcHalfArea() : 0.0f;
+            rightCounts[s] = right.m_numPrims;
+        }
+
+        BvhBin left;
+        left.Clear();
+        for(U32 s = 1; s < numBins; s++)
+        {
+            left.m_bounds.Grow(bins[axis][s - 1].m_bounds);
+            left.m_numPrims += bins[axis][s - 1].m_numPrims;
+            if(left.m_numPrims == 0 || rightCounts[s] == 0)
+                continue;
+
+            F32 cost = (left.m_bounds.CalcHalfArea() * (F32)left.m_numPrims) + (rightAreas[s] * (F32)rightCounts[s]);
+            if(cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = s;
+            }
+        }
+    }
+
+    if(bestSplit == 0)
+    {
+        // every centroid is in the same spot, only an arbitrary split can keep leaves small
+        if(numPrims <= kBvhMaxLeafPrims)
+            return;
+    }
+    else
+    {
+        // both sides are relative to this node's area, same as the sweep costs
+        F32 leafCost = (F32)numPrims;
+        F32 splitCost = kBvhTraversalCost + (bestCost / CalcHalfArea(node.m_boundsMin, node.m_boundsMax));
+        if(numPrims <= kBvhMaxLeafPrims && leafCost <= splitCost)
+            return;
+    }
+
+    U32 leftIndex = context.m_numNodes.fetch_add(2);
+    BvhNode& leftNode = context.m_pNodes[leftIndex];
+    BvhNode& rightNode = context.m_pNodes[leftIndex + 1];
+    BvhBounds leftCentroidBounds = CreateEmptyBounds();
+    BvhBounds rightCentroidBounds = CreateEmptyBounds();
+    U32 numLeftPrims = numPrims / 2;
+    if(bestSplit > 0)
+    {
+        BvhBounds leftBounds = CreateEmptyBounds();
+        BvhBounds rightBounds = CreateEmptyBounds();
+        for(U32 b = 0; b < numBins; b++)
+        {
+            (b < bestSplit ? leftBounds : rightBounds).Grow(bins[bestAxis][b].m_bounds);
+        }
+        SetNodeBounds(leftNode, leftBounds);
+        SetNodeBounds(rightNode, rightBounds);
+
+        BvhPrimRef* pBegin = pPrimRefs + first;
+        BvhPrimRef* pEnd = pBegin + numPrims;
+        F32 centroidMinOnAxis = GetAxis(centroidMin, bestAxis);
+        while(pBegin < pEnd)
+        {
+            if(CalcBin(CalcCentroidOnAxis(*pBegin, bestAxis), centroidMinOnAxis, binScales[bestAxis], numBins) < bestSplit)
+            {
+                leftCentroidBounds.GrowByCentroid(*pBegin);
+                pBegin++;
+            }
+            else
+            {
+                rightCentroidBounds.GrowByCentroid(*pBegin);
+                Swap(*pBegin, *--pEnd);
+            }
+        }
+        numLeftPrims = (U32)(pBegin - (pPrimRefs + first));
+    }
+    else
+    {
+        CalcRangeBounds(pPrimRefs + first, numLeftPrims, leftNode, leftCentroidBounds);
+        CalcRangeBounds(pPrimRefs + first + numLeftPrims, numPrims - numLeftPrims, rightNode, rightCentroidBounds);
+    }
+
+    node.m_firstChildOrPrim = leftIndex;
+    node.m_numPrims = 0;
+
+    U32 numRightPrims = numPrims - numLeftPrims;
+    if(numThreads > 1 && numPrims >= kBvhParallelMinPrims)
+    {
+        U32 numRightThreads = numThreads / 2;
+        std::thread worker(BvhBuildNode, std::ref(context), leftIndex + 1, std::cref(rightCentroidBounds), first + numLeftPrims, numRightPrims, depth + 1, numRightThreads);
+        BvhBuildNode(context, leftIndex, leftCentroidBounds, first, numLeftPrims, depth + 1, numThreads - numRightThreads);
+        worker.join();
+    }
+    else
+    {
+        BvhBuildNode(context, leftIndex, leftCentroidBounds, first, numLeftPrims, depth + 1, 1);
+        BvhBuildNode(context, leftIndex + 1, rightCentroidBounds, first + numLeftPrims, numRightPrims, depth + 1, 1);
+    }
+}
+
+void Bvh::Build(const Vec3* pPrimMins, const Vec3* pPrimMaxs, U32 numPrims, LinearAllocator* scratchAllocator, U32 numThreads)
+{
+    SM_ASSERT(numThreads >= 1);
+
+    m_nodes.Clear();
+    m_primIndices.Resize(numPrims);
+    if(numPrims == 0)
+        return;
+
+    size_t restoreAllocatedBytes = scratchAllocator->m_allocatedBytes;
+
+    BvhPrimRef* pPrimRefs = scratchAllocator->Alloc<BvhPrimRef>(numPrims);
+    for(U32 i = 0; i < numPrims; i++)
+    {
+        pPrimRefs[i].m_boundsMin = pPrimMins[i];
+        pPrimRefs[i].m_primIndex = i;
+        pPrimRefs[i].m_boundsMax = pPrimMaxs[i];
+        pPrimRefs[i].m_pad = 0;
+    }
+
+    // a binary tree with at least one primitive per leaf never needs more than 2n - 1 nodes
+    m_nodes.Resize(2 * (size_t)numPrims - 1);
+
+    BvhBuildContext context;
+    context.m_pPrimRefs = pPrimRefs;
+    context.m_pNodes = m_nodes.m_pData;
+    context.m_numNodes = 1;
+    BvhBounds centroidBounds;
+    CalcRangeBounds(pPrimRefs, numPrims, m_nodes[0], centroidBounds);
+    BvhBuildNode(context, 0, centroidBounds, 0, numPrims, 0, numThreads);
+    m_nodes.Resize(context.m_numNodes);
+    for(U32 i = 0; i < numPrims; i++)
+    {
+        m_primIndices.m_pData[i] = pPrimRefs[i].m_primIndex;
+    }
+
+    scratchAllocator->m_allocatedBytes = restoreAllocatedBytes;
+}
+
+void Bvh::BuildFromTriangles(const Vec3* pPositions, const U32* pIndices, U32 numTriangles, LinearAllocator* scratchAllocator, U32 numThreads)
+{
+    size_t restoreAllocatedBytes = scratchAllocator->m_allocatedBytes;
+
+    Vec3* pMins = scratchAllocator->Alloc<Vec3>(numTriangles);
+    Vec3* pMaxs = scratchAllocator->Alloc<Vec3>(numTriangles);
+    for(U32 i = 0; i < numTriangles; i++)
+    {
+        const Vec3& v0 = pPositions[pIndices[i * 3 + 0]];
+        const Vec3& v1 = pPositions[pIndices[i * 3 + 1]];
+        const Vec3& v2 = pPositions[pIndices[i * 3 + 2]];
+        pMins[i] = MinVec3(MinVec3(v0, v1), v2);
+        pMaxs[i] = MaxVec3(MaxVec3(v0, v1), v2);
+    }
+    Build(pMins, pMaxs, numTriangles, scratchAllocator, numThreads);
+
+    scratchAllocator->m_allocatedBytes = restoreAllocatedBytes;
+}
+
+U32 Bvh::RayCastTriangles(const Vec3* pPositions, const U32* pIndices, const Vec3& origin, const Vec3& dir, F32& inOutMaxT) const
+{
+    return RayCast(origin, dir, inOutMaxT, [&](U32 triangle, F32& inOutTriangleMaxT) {
+        return IntersectRayTriangle(origin, dir, pPositions[pIndices[triangle * 3 + 0]], pPositions[pIndices[triangle * 3 + 1]], pPositions[pIndices[triangle * 3 + 2]], inOutTriangleMaxT);
+    });
+}
+
+//-------------------------------------------------------------------------
+// Bvh4
+//-------------------------------------------------------------------------
+// Pulls grandchildren up into the slots of inner children until there are four slots or only leaves left,
+// opening the child with the biggest surface area first since rays are most likely to enter it
+static U32 CollectBvh4Children(const Bvh& bvh, U32 binaryIndex, U32* pOutChildren)
+{
+    const BvhNode* pNodes = bvh.m_nodes.m_pData;
+    U32 numChildren = 2;
+    pOutChildren[0] = pNodes[binaryIndex].m_firstChildOrPrim;
+    pOutChildren[1] = pNodes[binaryIndex].m_firstChildOrPrim + 1;
+
+    while(numChildren < 4)
+    {
+        U32 bestSlot = kBvhInvalidIndex;
+        F32 bestArea = -1.0f;
+        for(U32 i = 0; i < numChildren; i++)
+        {
+            const BvhNode& child = pNodes[pOutChildren[i]];
+            F32 area = CalcHalfArea(child.m_boundsMin, child.m_boundsMax);
+            if(!child.IsLeaf() && area > bestArea)
+            {
+                bestArea = area;
+                bestSlot = i;
+            }
+        }
+        if(bestSlot == kBvhInvalidIndex)
+            break;
+
+        U32 opened = pOutChildren[bestSlot];
+        pOutChildren[bestSlot] = pNodes[opened].m_firstChildOrPrim;
+        pOutChildren[numChildren++] = pNodes[opened].m_firstChildOrPrim + 1;
+    }
+    return numChildren;
+}
+
+static void BuildBvh4Node(const Bvh& bvh, U32 binaryIndex, Array<Bvh4Node>& nodes, U32 nodeIndex)
+{
+    U32 children[4];
+    U32 numChildren = CollectBvh4Children(bvh, binaryIndex, children);
+
+    // the array may grow while children are built, so fill this node in before recursing
+    for(U32 i = 0; i < 4; i++)
+    {
+        Bvh4Node& node = nodes[nodeIndex];
+        if(i >= numChildren)
+        {
+            node.m_boundsMinX[i] = node.m_boundsMinY[i] = node.m_boundsMinZ[i] = FLT_MAX;
+            node.m_boundsMaxX[i] = node.m_boundsMaxY[i] = node.m_boundsMaxZ[i] = -FLT_MAX;
+            node.m_children[i] = kBvhInvalidIndex;
+            node.m_numPrims[i] = 0;
+            continue;
+        }
+
+        const BvhNode& child = bvh.m_nodes[children[i]];
+        node.m_boundsMinX[i] = child.m_boundsMin.x;
+        node.m_boundsMinY[i] = child.m_boundsMin.y;
+        node.m_boundsMinZ[i] = child.m_boundsMin.z;
+        node.m_boundsMaxX[i] = child.m_boundsMax.x;
+        node.m_boundsMaxY[i] = child.m_boundsMax.y;
+        node.m_boundsMaxZ[i] = child.m_boundsMax.z;
+        node.m_numPrims[i] = child.m_numPrims;
+        node.m_children[i] = child.IsLeaf() ? child.m_firstChildOrPrim : (U32)nodes.m_numItems;
+        if(!child.IsLeaf())
+        {
+            nodes.PushUninitialized();
+        }
+    }
+
+    for(U32 i = 0; i < numChildren; i++)
+    {
+        if(nodes[nodeIndex].m_numPrims[i] == 0)
+        {
+            BuildBvh4Node(bvh, children[i], nodes, nodes[nodeIndex].m_children[i]);
+        }
+    }
+}
+
+void Bvh4::Build(const Bvh& bvh)
+{
+    m_nodes.Clear();
+    m_rootNumPrims = 0;
+    m_primIndices.Resize(bvh.m_primIndices.m_numItems);
+    ::memcpy(m_primIndices.m_pData, bvh.m_primIndices.m_pData, sizeof(U32) * bvh.m_primIndices.m_numItems);
+    if(bvh.IsEmpty())
+        return;
+
+    if(bvh.m_nodes[0].IsLeaf())
+    {
+        m_rootNumPrims = bvh.m_nodes[0].m_numPrims;
+        return;
+    }
+
+    // each node takes at least two binary nodes' worth of children
+    m_nodes.Reserve(bvh.m_nodes.m_numItems / 2 + 1);
+    m_nodes.PushUninitialized();
+    BuildBvh4Node(bvh, 0, m_nodes, 0);
+}
+
+U32 Bvh4::RayCastTriangles(const Vec3* pPositions, const U32* pIndices, const Vec3& origin, const Vec3& dir, F32& inOutMaxT) const
+{
+    return RayCast(origin, dir, inOutMaxT, [&](U32 triangle, F32& inOutTriangleMaxT) {
+        return IntersectRayTriangle(origin, dir, pPositions[pIndices[triangle * 3 + 0]], pPositions[pIndices[triangle * 3 + 1]], pPositions[pIndices[triangle * 3 + 2]], inOutTriangleMaxT);
+    });
+}
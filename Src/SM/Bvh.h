@@ -0,0 +1,443 @@
+#pragma once
+
+#include "SM/Containers.h"
+#include "SM/Geometry.h"
+#include "SM/Math.h"
+#include "SM/Memory.h"
+#include "SM/Simd.h"
+#include "SM/StandardTypes.h"
+
+namespace SM
+{
+    static const U32 kBvhInvalidIndex = 0xffffffff;
+
+    // The builder never goes deeper than this, which bounds the traversal stacks below
+    static const U32 kBvhMaxDepth = 64;
+
+    // 32 bytes so two share a cache line. Children of an inner node are adjacent, m_firstChildOrPrim is the left child
+    // and the right child follows it. For a leaf it is the first of m_numPrims entries in Bvh::m_primIndices.
+    struct BvhNode
+    {
+        Vec3 m_boundsMin;
+        U32 m_firstChildOrPrim = 0;
+        Vec3 m_boundsMax;
+        U32 m_numPrims = 0;
+
+        bool IsLeaf() const { return m_numPrims > 0; }
+    };
+    static_assert(sizeof(BvhNode) == 32, "BvhNode should stay 32 bytes");
+
+    // Binary bounding volume hierarchy over one box per primitive, built with a binned surface area heuristic.
+    // Primitives themselves are never stored, queries hand primitive indices back to a callback that knows what they are.
+    class Bvh
+    {
+        public:
+        Bvh() = default;
+        Bvh(LinearAllocator* allocator) :m_nodes(allocator), m_primIndices(allocator) {}
+        Bvh(HeapAllocator* allocator) :m_nodes(allocator), m_primIndices(allocator) {}
+
+        // Replaces the tree with one over the boxes pPrimMins[i], pPrimMaxs[i]. Scratch space comes from scratchAllocator
+        // and is given back before returning. numThreads > 1 builds large subtrees in parallel, node order then depends
+        // on thread timing but the tree itself does not.
+        void Build(const Vec3* pPrimMins, const Vec3* pPrimMaxs, U32 numPrims, LinearAllocator* scratchAllocator = GetThreadScratchAllocator(), U32 numThreads = 1);
+
+        // Indexed triangle list, primitive i is the triangle made of pIndices[3i], pIndices[3i + 1] and pIndices[3i + 2]
+        void BuildFromTriangles(const Vec3* pPositions, const U32* pIndices, U32 numTriangles, LinearAllocator* scratchAllocator = GetThreadScratchAllocator(), U32 numThreads = 1);
+
+        // Closest hit along origin + t * dir for 0 <= t <= inOutMaxT, nearest children are visited first.
+        // intersectPrim(primIndex, inOutMaxT) tests one primitive, on a hit closer than inOutMaxT it lowers inOutMaxT and
+        // returns true. Returns the closest primitive hit or kBvhInvalidIndex.
+        template<typename Func>
+        U32 RayCast(const Vec3& origin, const Vec3& dir, F32& inOutMaxT, Func&& intersectPrim) const;
+
+        // Stops at the first primitive hit at all, for line of sight and occlusion
+        template<typename Func>
+        bool RayCastAny(const Vec3& origin, const Vec3& dir, F32 maxT, Func&& intersectPrim) const;
+
+        // Calls func(primIndex) once for each primitive in every leaf whose box touches the sphere / box. Leaves hold a few
+        // primitives, so this is a superset of the overlapping ones and func does any exact test.
+        template<typename Func>
+        void QuerySphere(const Vec3& center, F32 radius, Func&& func) const;
+        template<typename Func>
+        void QueryAabb(const Vec3& boundsMin, const Vec3& boundsMax, Func&& func) const;
+
+        // RayCast against a tree made by BuildFromTriangles with the same triangles
+        U32 RayCastTriangles(const Vec3* pPositions, const U32* pIndices, const Vec3& origin, const Vec3& dir, F32& inOutMaxT) const;
+
+        bool IsEmpty() const { return m_nodes.m_numItems == 0; }
+
+        Array<BvhNode> m_nodes;
+        Array<U32> m_primIndices;
+
+        private:
+        template<bool bAnyHit, typename Func>
+        U32 RayCastImpl(const Vec3& origin, const Vec3& dir, F32& inOutMaxT, Func&& intersectPrim) const;
+    };
+
+    // Four children per node with their boxes stored as structure of arrays, one node visit tests all four at once.
+    // Collapsed from a binary Bvh so it keeps that tree's m_primIndices ordering. Empty child slots have no primitives
+    // and an inverted box that rays never hit.
+    struct alignas(16) Bvh4Node
+    {
+        F32 m_boundsMinX[4];
+        F32 m_boundsMinY[4];
+        F32 m_boundsMinZ[4];
+        F32 m_boundsMaxX[4];
+        F32 m_boundsMaxY[4];
+        F32 m_boundsMaxZ[4];
+        U32 m_children[4];  // node index, or first primitive for leaves
+        U32 m_numPrims[4];  // 0 for inner children
+    };
+    static_assert(sizeof(Bvh4Node) == 128, "Bvh4Node should stay two cache lines");
+
+    class Bvh4
+    {
+        public:
+        Bvh4() = default;
+        Bvh4(LinearAllocator* allocator) :m_nodes(allocator), m_primIndices(allocator) {}
+        Bvh4(HeapAllocator* allocator) :m_nodes(allocator), m_primIndices(allocator) {}
+
+        void Build(const Bvh& bvh);
+
+        // Same contract as Bvh::RayCast / RayCastAny
+        template<typename Func>
+        U32 RayCast(const Vec3& origin, const Vec3& dir, F32& inOutMaxT, Func&& intersectPrim) const;
+        template<typename Func>
+        bool RayCastAny(const Vec3& origin, const Vec3& dir, F32 maxT, Func&& intersectPrim) const;
+
+        U32 RayCastTriangles(const Vec3* pPositions, const U32* pIndices, const Vec3& origin, const Vec3& dir, F32& inOutMaxT) const;
+
+        bool IsEmpty() const { return m_nodes.m_numItems == 0; }
+
+        Array<Bvh4Node> m_nodes;
+        Array<U32> m_primIndices;
+
+        // A lone leaf has no Bvh4Node to live in, the whole tree is then just this range of m_primIndices
+        U32 m_rootNumPrims = 0;
+
+        private:
+        template<bool bAnyHit, typename Func>
+        U32 RayCastImpl(const Vec3& origin, const Vec3& dir, F32& inOutMaxT, Func&& intersectPrim) const;
+    };
+
+    //-------------------------------------------------------------------------
+    // Bvh
+    //-------------------------------------------------------------------------
+    // Slab test against a box, invDir from CalcRayInvDir
+    inline bool IntersectRayBounds(const Vec3& boundsMin, const Vec3& boundsMax, const Vec3& origin, const Vec3& invDir, F32 maxT, F32& outEntryT)
+    {
+        F32 tx0 = (boundsMin.x - origin.x) * invDir.x;
+        F32 tx1 = (boundsMax.x - origin.x) * invDir.x;
+        F32 ty0 = (boundsMin.y - origin.y) * invDir.y;
+        F32 ty1 = (boundsMax.y - origin.y) * invDir.y;
+        F32 tz0 = (boundsMin.z - origin.z) * invDir.z;
+        F32 tz1 = (boundsMax.z - origin.z) * invDir.z;
+
+        F32 entryT = Max(Max(Min(tx0, tx1), Min(ty0, ty1)), Max(Min(tz0, tz1), 0.0f));
+        F32 exitT = Min(Min(Max(tx0, tx1), Max(ty0, ty1)), Min(Max(tz0, tz1), maxT));
+        outEntryT = entryT;
+        return entryT <= exitT;
+    }
+
+    template<bool bAnyHit, typename Func>
+    inline U32 Bvh::RayCastImpl(const Vec3& origin, const Vec3& dir, F32& inOutMaxT, Func&& intersectPrim) const
+    {
+        if(IsEmpty())
+            return kBvhInvalidIndex;
+
+        struct StackEntry
+        {
+            U32 m_nodeIndex;
+            F32 m_entryT;
+        };
+        StackEntry stack[kBvhMaxDepth];
+        U32 stackSize = 0;
+
+        const BvhNode* pNodes = m_nodes.m_pData;
+        Vec3 invDir = CalcRayInvDir(dir);
+        U32 hitPrim = kBvhInvalidIndex;
+
+        F32 entryT;
+        if(!IntersectRayBounds(pNodes[0].m_boundsMin, pNodes[0].m_boundsMax, origin, invDir, inOutMaxT, entryT))
+            return kBvhInvalidIndex;
+
+        U32 nodeIndex = 0;
+        while(true)
+        {
+            const BvhNode& node = pNodes[nodeIndex];
+            if(node.IsLeaf())
+            {
+                for(U32 i = 0; i < node.m_numPrims; i++)
+                {
+                    U32 primIndex = m_primIndices.m_pData[node.m_firstChildOrPrim + i];
+                    if(intersectPrim(primIndex, inOutMaxT))
+                    {
+                        hitPrim = primIndex;
+                        if constexpr (bAnyHit)
+                        {
+                            return hitPrim;
+                        }
+                    }
+                }
+            }
+            else
+            {
+                // go to the nearer child and come back for the other if it is still in front of the closest hit
+                U32 leftIndex = node.m_firstChildOrPrim;
+                F32 leftT, rightT;
+                bool bHitLeft = IntersectRayBounds(pNodes[leftIndex].m_boundsMin, pNodes[leftIndex].m_boundsMax, origin, invDir, inOutMaxT, leftT);
+                bool bHitRight = IntersectRayBounds(pNodes[leftIndex + 1].m_boundsMin, pNodes[leftIndex + 1].m_boundsMax, origin, invDir, inOutMaxT, rightT);
+                if(bHitLeft && bHitRight)
+                {
+                    bool bLeftFirst = leftT <= rightT;
+                    stack[stackSize++] = bLeftFirst ? StackEntry{ leftIndex + 1, rightT } : StackEntry{ leftIndex, leftT };
+                    nodeIndex = bLeftFirst ? leftIndex : leftIndex + 1;
+                    continue;
+                }
+                if(bHitLeft || bHitRight)
+                {
+                    nodeIndex = bHitLeft ? leftIndex : leftIndex + 1;
+                    continue;
+                }
+            }
+
+            // pop the next subtree that can still hold a closer hit
+            while(stackSize > 0 && stack[stackSize - 1].m_entryT > inOutMaxT)
+            {
+                stackSize--;
+            }
+            if(stackSize == 0)
+                break;
+            nodeIndex = stack[--stackSize].m_nodeIndex;
+        }
+        return hitPrim;
+    }
+
+    template<typename Func>
+    inline U32 Bvh::RayCast(const Vec3& origin, const Vec3& dir, F32& inOutMaxT, Func&& intersectPrim) const
+    {
+        return RayCastImpl<false>(origin, dir, inOutMaxT, intersectPrim);
+    }
+
+    template<typename Func>
+    inline bool Bvh::RayCastAny(const Vec3& origin, const Vec3& dir, F32 maxT, Func&& intersectPrim) const
+    {
+        return RayCastImpl<true>(origin, dir, maxT, intersectPrim) != kBvhInvalidIndex;
+    }
+
+    template<typename Func>
+    inline void Bvh::QuerySphere(const Vec3& center, F32 radius, Func&& func) const
+    {
+        if(IsEmpty())
+            return;
+
+        U32 stack[kBvhMaxDepth];
+        U32 stackSize = 0;
+        stack[stackSize++] = 0;
+        const F32 radiusSq = radius * radius;
+
+        while(stackSize > 0)
+        {
+            const BvhNode& node = m_nodes.m_pData[stack[--stackSize]];
+
+            // squared distance from the center to the closest point in the box
+            F32 dx = Max(Max(node.m_boundsMin.x - center.x, center.x - node.m_boundsMax.x), 0.0f);
+            F32 dy = Max(Max(node.m_boundsMin.y - center.y, center.y - node.m_boundsMax.y), 0.0f);
+            F32 dz = Max(Max(node.m_boundsMin.z - center.z, center.z - node.m_boundsMax.z), 0.0f);
+            if((dx * dx) + (dy * dy) + (dz * dz) > radiusSq)
+                continue;
+
+            if(node.IsLeaf())
+            {
+                for(U32 i = 0; i < node.m_numPrims; i++)
+                {
+                    func(m_primIndices.m_pData[node.m_firstChildOrPrim + i]);
+                }
+            }
+            else
+            {
+                stack[stackSize++] = node.m_firstChildOrPrim + 1;
+                stack[stackSize++] = node.m_firstChildOrPrim;
+            }
+        }
+    }
+
+    template<typename Func>
+    inline void Bvh::QueryAabb(const Vec3& boundsMin, const Vec3& boundsMax, Func&& func) const
+    {
+        if(IsEmpty())
+            return;
+
+        U32 stack[kBvhMaxDepth];
+        U32 stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while(stackSize > 0)
+        {
+            const BvhNode& node = m_nodes.m_pData[stack[--stackSize]];
+            if(node.m_boundsMin.x > boundsMax.x || node.m_boundsMax.x < boundsMin.x ||
+               node.m_boundsMin.y > boundsMax.y || node.m_boundsMax.y < boundsMin.y ||
+               node.m_boundsMin.z > boundsMax.z || node.m_boundsMax.z < boundsMin.z)
+                continue;
+
+            if(node.IsLeaf())
+            {
+                for(U32 i = 0; i < node.m_numPrims; i++)
+                {
+                    func(m_primIndices.m_pData[node.m_firstChildOrPrim + i]);
+                }
+            }
+            else
+            {
+                stack[stackSize++] = node.m_firstChildOrPrim + 1;
+                stack[stackSize++] = node.m_firstChildOrPrim;
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // Bvh4
+    //-------------------------------------------------------------------------
+    // Bit n of the result is set when the ray enters child box n before maxT, outEntryT[n] is where it does.
+    // Slabs are picked by the sign of the direction instead of sorted with min / max, so the inverted boxes of empty
+    // child slots always miss.
+    inline U32 IntersectRayBounds4(const Bvh4Node& node, const Vec3& origin, const Vec3& invDir, F32 maxT, F32* outEntryT)
+    {
+        const F32* pNearX = invDir.x < 0.0f ? node.m_boundsMaxX : node.m_boundsMinX;
+        const F32* pFarX = invDir.x < 0.0f ? node.m_boundsMinX : node.m_boundsMaxX;
+        const F32* pNearY = invDir.y < 0.0f ? node.m_boundsMaxY : node.m_boundsMinY;
+        const F32* pFarY = invDir.y < 0.0f ? node.m_boundsMinY : node.m_boundsMaxY;
+        const F32* pNearZ = invDir.z < 0.0f ? node.m_boundsMaxZ : node.m_boundsMinZ;
+        const F32* pFarZ = invDir.z < 0.0f ? node.m_boundsMinZ : node.m_boundsMaxZ;
+
+        #if SM_SIMD_ENABLED
+        F32x4 originX = SimdSplat(origin.x);
+        F32x4 originY = SimdSplat(origin.y);
+        F32x4 originZ = SimdSplat(origin.z);
+        F32x4 invDirX = SimdSplat(invDir.x);
+        F32x4 invDirY = SimdSplat(invDir.y);
+        F32x4 invDirZ = SimdSplat(invDir.z);
+
+        F32x4 nearX = SimdMul(SimdSub(SimdLoad(pNearX), originX), invDirX);
+        F32x4 farX = SimdMul(SimdSub(SimdLoad(pFarX), originX), invDirX);
+        F32x4 nearY = SimdMul(SimdSub(SimdLoad(pNearY), originY), invDirY);
+        F32x4 farY = SimdMul(SimdSub(SimdLoad(pFarY), originY), invDirY);
+        F32x4 nearZ = SimdMul(SimdSub(SimdLoad(pNearZ), originZ), invDirZ);
+        F32x4 farZ = SimdMul(SimdSub(SimdLoad(pFarZ), originZ), invDirZ);
+
+        F32x4 entryT = SimdMax(SimdMax(nearX, nearY), SimdMax(nearZ, SimdZero()));
+        F32x4 exitT = SimdMin(SimdMin(farX, farY), SimdMin(farZ, SimdSplat(maxT)));
+        SimdStore(outEntryT, entryT);
+        return ~SimdLessThanMask(exitT, entryT) & 0xf;
+        #else
+        U32 hitMask = 0;
+        for(U32 i = 0; i < 4; i++)
+        {
+            F32 entryT = Max(Max((pNearX[i] - origin.x) * invDir.x, (pNearY[i] - origin.y) * invDir.y), Max((pNearZ[i] - origin.z) * invDir.z, 0.0f));
+            F32 exitT = Min(Min((pFarX[i] - origin.x) * invDir.x, (pFarY[i] - origin.y) * invDir.y), Min((pFarZ[i] - origin.z) * invDir.z, maxT));
+            outEntryT[i] = entryT;
+            if(!(exitT < entryT))
+            {
+                hitMask |= 1 << i;
+            }
+        }
+        return hitMask;
+        #endif
+    }
+
+    template<bool bAnyHit, typename Func>
+    inline U32 Bvh4::RayCastImpl(const Vec3& origin, const Vec3& dir, F32& inOutMaxT, Func&& intersectPrim) const
+    {
+        U32 hitPrim = kBvhInvalidIndex;
+        if(m_rootNumPrims > 0)
+        {
+            for(U32 i = 0; i < m_rootNumPrims; i++)
+            {
+                if(intersectPrim(m_primIndices.m_pData[i], inOutMaxT))
+                {
+                    hitPrim = m_primIndices.m_pData[i];
+                    if constexpr (bAnyHit)
+                    {
+                        return hitPrim;
+                    }
+                }
+            }
+            return hitPrim;
+        }
+        if(IsEmpty())
+            return kBvhInvalidIndex;
+
+        struct StackEntry
+        {
+            U32 m_child;
+            U32 m_numPrims;
+            F32 m_entryT;
+        };
+
+        // every node pushes at most three children besides the one it visits next
+        StackEntry stack[kBvhMaxDepth * 3 + 1];
+        U32 stackSize = 0;
+        stack[stackSize++] = StackEntry{ 0, 0, 0.0f };
+
+        const Bvh4Node* pNodes = m_nodes.m_pData;
+        Vec3 invDir = CalcRayInvDir(dir);
+
+        while(stackSize > 0)
+        {
+            StackEntry entry = stack[--stackSize];
+            if(entry.m_entryT > inOutMaxT)
+                continue;
+
+            if(entry.m_numPrims > 0)
+            {
+                for(U32 i = 0; i < entry.m_numPrims; i++)
+                {
+                    U32 primIndex = m_primIndices.m_pData[entry.m_child + i];
+                    if(intersectPrim(primIndex, inOutMaxT))
+                    {
+                        hitPrim = primIndex;
+                        if constexpr (bAnyHit)
+                        {
+                            return hitPrim;
+                        }
+                    }
+                }
+                continue;
+            }
+
+            const Bvh4Node& node = pNodes[entry.m_child];
+            alignas(16) F32 entryT[4];
+            U32 hitMask = IntersectRayBounds4(node, origin, invDir, inOutMaxT, entryT);
+
+            // push farthest first so the nearest child is popped next, insertion sort of at most four entries
+            U32 firstPushed = stackSize;
+            while(hitMask != 0)
+            {
+                U32 i = FindFirstSetBit(hitMask);
+                hitMask &= hitMask - 1;
+
+                StackEntry child{ node.m_children[i], node.m_numPrims[i], entryT[i] };
+                U32 insert = stackSize++;
+                while(insert > firstPushed && stack[insert - 1].m_entryT < child.m_entryT)
+                {
+                    stack[insert] = stack[insert - 1];
+                    insert--;
+                }
+                stack[insert] = child;
+            }
+        }
+        return hitPrim;
+    }
+
+    template<typename Func>
+    inline U32 Bvh4::RayCast(const Vec3& origin, const Vec3& dir, F32& inOutMaxT, Func&& intersectPrim) const
+    {
+        return RayCastImpl<false>(origin, dir, inOutMaxT, intersectPrim);
+    }
+
+    template<typename Func>
+    inline bool Bvh4::RayCastAny(const Vec3& origin, const Vec3& dir, F32 maxT, Func&& intersectPrim) const
+    {
+        return RayCastImpl<true>(origin, dir, maxT, intersectPrim) != kBvhInvalidIndex;
+    }
+}
@@ -1,7 +1,17 @@
 #pragma once
 
+#include "SM/Assert.h"
+#include "SM/Bits.h"
+#include "SM/Memory.h"
+#include "SM/Simd.h"
 #include "SM/StandardTypes.h"
 
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
 namespace SM
 {
     template<typename T, size_t MAX_SIZE>
@@ -11,6 +21,7 @@ namespace SM
         void Push(const T& t);
         bool Pop();
         bool Top(T* t);
+        T* PeekTop();
 
         U32 m_numItems = 0;
         T m_data[MAX_SIZE];
@@ -43,4 +54,2180 @@ namespace SM
         *t = m_data[m_numItems - 1];
         return true;
     }
+
+    template<typename T, size_t MAX_SIZE>
+    T* Stack<T, MAX_SIZE>::PeekTop()
+    {
+        if(m_numItems == 0)
+            return nullptr;
+
+        return &m_data[m_numItems - 1];
+    }
+
+    //-------------------------------------------------------------------------
+    // Array
+    //-------------------------------------------------------------------------
+    struct ArrayGrowDouble
+    {
+        static size_t CalcCapacity(size_t curCapacity, size_t minCapacity)
+        {
+            size_t newCapacity = curCapacity > 0 ? curCapacity * 2 : 8;
+            return newCapacity > minCapacity ? newCapacity : minCapacity;
+        }
+    };
+
+    struct ArrayGrowOneAndHalf
+    {
+        static size_t CalcCapacity(size_t curCapacity, size_t minCapacity)
+        {
+            size_t newCapacity = curCapacity > 0 ? curCapacity + (curCapacity / 2) : 8;
+            return newCapacity > minCapacity ? newCapacity : minCapacity;
+        }
+    };
+
+    // Growable array that gets its storage from either a LinearAllocator or a HeapAllocator.
+    // When backed by a LinearAllocator growth first tries to extend the allocation in place, otherwise the old storage
+    // is abandoned to the arena. Trivially copyable types are relocated with memcpy.
+    template<typename T, typename GrowthPolicy = ArrayGrowDouble>
+    class Array
+    {
+    public:
+        Array() = default;
+        Array(LinearAllocator* allocator, size_t initialCapacity = 0);
+        Array(HeapAllocator* allocator, size_t initialCapacity = 0);
+        Array(Array&& other);
+        Array& operator=(Array&& other);
+        Array(const Array&) = delete;
+        Array& operator=(const Array&) = delete;
+        ~Array();
+
+        T& operator[](size_t index);
+        const T& operator[](size_t index) const;
+
+        T* Push(const T& t);
+        T* Push(T&& t);
+        T* PushUninitialized(size_t numItems = 1);
+        void Pop();
+        void RemoveSwapBack(size_t index);
+        void Clear();
+        void Reserve(size_t capacity);
+        void Resize(size_t numItems);
+
+        bool IsEmpty() const { return m_numItems == 0; }
+        T* GetData() { return m_pData; }
+        const T* GetData() const { return m_pData; }
+        T& Back() { SM_ASSERT(m_numItems > 0); return m_pData[m_numItems - 1]; }
+
+        T* begin() { return m_pData; }
+        T* end() { return m_pData + m_numItems; }
+        const T* begin() const { return m_pData; }
+        const T* end() const { return m_pData + m_numItems; }
+
+        T* m_pData = nullptr;
+        size_t m_numItems = 0;
+        size_t m_capacity = 0;
+        LinearAllocator* m_pLinearAllocator = nullptr;
+        HeapAllocator* m_pHeapAllocator = nullptr;
+
+    private:
+        void Grow(size_t minCapacity);
+        void FreeStorage();
+    };
+
+    template<typename T, typename GrowthPolicy>
+    Array<T, GrowthPolicy>::Array(LinearAllocator* allocator, size_t initialCapacity)
+        :m_pLinearAllocator(allocator)
+    {
+        if(initialCapacity > 0)
+        {
+            Reserve(initialCapacity);
+        }
+    }
+
+    template<typename T, typename GrowthPolicy>
+    Array<T, GrowthPolicy>::Array(HeapAllocator* allocator, size_t initialCapacity)
+        :m_pHeapAllocator(allocator)
+    {
+        if(initialCapacity > 0)
+        {
+            Reserve(initialCapacity);
+        }
+    }
+
+    template<typename T, typename GrowthPolicy>
+    Array<T, GrowthPolicy>::Array(Array&& other)
+        :m_pData(other.m_pData)
+        ,m_numItems(other.m_numItems)
+        ,m_capacity(other.m_capacity)
+        ,m_pLinearAllocator(other.m_pLinearAllocator)
+        ,m_pHeapAllocator(other.m_pHeapAllocator)
+    {
+        other.m_pData = nullptr;
+        other.m_numItems = 0;
+        other.m_capacity = 0;
+    }
+
+    template<typename T, typename GrowthPolicy>
+    Array<T, GrowthPolicy>& Array<T, GrowthPolicy>::operator=(Array&& other)
+    {
+        if(this != &other)
+        {
+            Clear();
+            FreeStorage();
+
+            m_pData = other.m_pData;
+            m_numItems = other.m_numItems;
+            m_capacity = other.m_capacity;
+            m_pLinearAllocator = other.m_pLinearAllocator;
+            m_pHeapAllocator = other.m_pHeapAllocator;
+
+            other.m_pData = nullptr;
+            other.m_numItems = 0;
+            other.m_capacity = 0;
+        }
+        return *this;
+    }
+
+    template<typename T, typename GrowthPolicy>
+    Array<T, GrowthPolicy>::~Array()
+    {
+        Clear();
+        FreeStorage();
+    }
+
+    template<typename T, typename GrowthPolicy>
+    T& Array<T, GrowthPolicy>::operator[](size_t index)
+    {
+        SM_ASSERT(index < m_numItems);
+        return m_pData[index];
+    }
+
+    template<typename T, typename GrowthPolicy>
+    const T& Array<T, GrowthPolicy>::operator[](size_t index) const
+    {
+        SM_ASSERT(index < m_numItems);
+        return m_pData[index];
+    }
+
+    template<typename T, typename GrowthPolicy>
+    T* Array<T, GrowthPolicy>::Push(const T& t)
+    {
+        if(m_numItems == m_capacity)
+        {
+            // t might live inside our own storage so copy it before growing
+            T copy(t);
+            Grow(m_numItems + 1);
+            return new(&m_pData[m_numItems++]) T(std::move(copy));
+        }
+
+        return new(&m_pData[m_numItems++]) T(t);
+    }
+
+    template<typename T, typename GrowthPolicy>
+    T* Array<T, GrowthPolicy>::Push(T&& t)
+    {
+        if(m_numItems == m_capacity)
+        {
+            T moved(std::move(t));
+            Grow(m_numItems + 1);
+            return new(&m_pData[m_numItems++]) T(std::move(moved));
+        }
+
+        return new(&m_pData[m_numItems++]) T(std::move(t));
+    }
+
+    template<typename T, typename GrowthPolicy>
+    T* Array<T, GrowthPolicy>::PushUninitialized(size_t numItems)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "PushUninitialized is only valid for trivially copyable types");
+
+        if(m_numItems + numItems > m_capacity)
+        {
+            Grow(m_numItems + numItems);
+        }
+
+        T* pItems = &m_pData[m_numItems];
+        m_numItems += numItems;
+        return pItems;
+    }
+
+    template<typename T, typename GrowthPolicy>
+    void Array<T, GrowthPolicy>::Pop()
+    {
+        SM_ASSERT(m_numItems > 0);
+        m_numItems--;
+        m_pData[m_numItems].~T();
+    }
+
+    template<typename T, typename GrowthPolicy>
+    void Array<T, GrowthPolicy>::RemoveSwapBack(size_t index)
+    {
+        SM_ASSERT(index < m_numItems);
+        if(index != m_numItems - 1)
+        {
+            m_pData[index] = std::move(m_pData[m_numItems - 1]);
+        }
+        Pop();
+    }
+
+    template<typename T, typename GrowthPolicy>
+    void Array<T, GrowthPolicy>::Clear()
+    {
+        if constexpr (!std::is_trivially_destructible_v<T>)
+        {
+            for(size_t i = 0; i < m_numItems; i++)
+            {
+                m_pData[i].~T();
+            }
+        }
+        m_numItems = 0;
+    }
+
+    template<typename T, typename GrowthPolicy>
+    void Array<T, GrowthPolicy>::Reserve(size_t capacity)
+    {
+        if(capacity <= m_capacity)
+            return;
+
+        size_t oldCapacity = m_capacity;
+        T* pOldData = m_pData;
+
+        // if we are the last thing allocated in a linear arena just extend the allocation in place
+        if(m_pLinearAllocator != nullptr && pOldData != nullptr &&
+           m_pLinearAllocator->TryExtend(pOldData, sizeof(T) * oldCapacity, sizeof(T) * capacity))
+        {
+            m_capacity = capacity;
+            return;
+        }
+
+        T* pNewData = nullptr;
+        if(m_pLinearAllocator != nullptr)
+        {
+            pNewData = m_pLinearAllocator->Alloc<T>(capacity);
+        }
+        else
+        {
+            SM_ASSERT(m_pHeapAllocator != nullptr);
+            pNewData = m_pHeapAllocator->Alloc<T>(capacity);
+        }
+
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            if(m_numItems > 0)
+            {
+                ::memcpy(pNewData, pOldData, sizeof(T) * m_numItems);
+            }
+        }
+        else
+        {
+            for(size_t i = 0; i < m_numItems; i++)
+            {
+                new(&pNewData[i]) T(std::move(pOldData[i]));
+                pOldData[i].~T();
+            }
+        }
+
+        FreeStorage();
+        m_pData = pNewData;
+        m_capacity = capacity;
+    }
+
+    template<typename T, typename GrowthPolicy>
+    void Array<T, GrowthPolicy>::Resize(size_t numItems)
+    {
+        if(numItems > m_capacity)
+        {
+            Reserve(numItems);
+        }
+
+        // trivial types are left uninitialized, they are usually about to be filled in by the caller
+        if constexpr (std::is_trivially_destructible_v<T> && std::is_trivially_default_constructible_v<T>)
+        {
+            m_numItems = numItems;
+        }
+        else
+        {
+            while(m_numItems > numItems)
+            {
+                Pop();
+            }
+            while(m_numItems < numItems)
+            {
+                new(&m_pData[m_numItems++]) T();
+            }
+        }
+    }
+
+    template<typename T, typename GrowthPolicy>
+    void Array<T, GrowthPolicy>::Grow(size_t minCapacity)
+    {
+        Reserve(GrowthPolicy::CalcCapacity(m_capacity, minCapacity));
+    }
+
+    template<typename T, typename GrowthPolicy>
+    void Array<T, GrowthPolicy>::FreeStorage()
+    {
+        // linear allocator storage is reclaimed when the arena is reset
+        if(m_pHeapAllocator != nullptr && m_pData != nullptr)
+        {
+            m_pHeapAllocator->Free(m_pData);
+        }
+        m_pData = nullptr;
+        m_capacity = 0;
+    }
+
+    //-------------------------------------------------------------------------
+    // HashMap
+    //-------------------------------------------------------------------------
+    inline U64 HashU64(U64 x)
+    {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdull;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ull;
+        x ^= x >> 33;
+        return x;
+    }
+
+    inline U64 HashBytes(const void* pData, size_t sizeBytes)
+    {
+        // FNV-1a, finalized so the low bits used for the control byte are well mixed
+        const U8* pBytes = (const U8*)pData;
+        U64 hash = 0xcbf29ce484222325ull;
+        for(size_t i = 0; i < sizeBytes; i++)
+        {
+            hash ^= pBytes[i];
+            hash *= 0x100000001b3ull;
+        }
+        return HashU64(hash);
+    }
+
+    template<typename K>
+    struct DefaultHash
+    {
+        U64 operator()(const K& key) const
+        {
+            static_assert(std::is_integral_v<K> || std::is_enum_v<K> || std::is_pointer_v<K>, "No default hash for this key type, provide a Hasher");
+            if constexpr (std::is_pointer_v<K>)
+            {
+                return HashU64((U64)(uintptr_t)key);
+            }
+            else
+            {
+                return HashU64((U64)key);
+            }
+        }
+    };
+
+    template<>
+    struct DefaultHash<const char*>
+    {
+        U64 operator()(const char* key) const { return HashBytes(key, ::strlen(key)); }
+    };
+
+    template<typename K>
+    struct DefaultKeyEqual
+    {
+        bool operator()(const K& a, const K& b) const { return a == b; }
+    };
+
+    template<>
+    struct DefaultKeyEqual<const char*>
+    {
+        bool operator()(const char* a, const char* b) const { return ::strcmp(a, b) == 0; }
+    };
+
+    static const size_t kHashMapGroupWidth = 16;
+    static const U8 kHashMapEmpty = 0x80;
+
+    // Returns a bit per control byte in the 16 byte group starting at pGroup that equals h2
+    inline U32 HashMapMatchGroup(const U8* pGroup, U8 h2)
+    {
+    #if SM_SIMD_SSE2
+        __m128i group = _mm_loadu_si128((const __m128i*)pGroup);
+        return (U32)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)h2)));
+    #elif SM_SIMD_NEON
+        static const U8 kLaneBits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+        uint8x16_t bits = vandq_u8(vceqq_u8(vld1q_u8(pGroup), vdupq_n_u8(h2)), vld1q_u8(kLaneBits));
+        return (U32)vaddv_u8(vget_low_u8(bits)) | ((U32)vaddv_u8(vget_high_u8(bits)) << 8);
+    #else
+        U32 mask = 0;
+        for(U32 i = 0; i < kHashMapGroupWidth; i++)
+        {
+            mask |= (U32)(pGroup[i] == h2) << i;
+        }
+        return mask;
+    #endif
+    }
+
+    // Returns a bit per empty control byte in the 16 byte group starting at pGroup, empty is the only value with the high bit set
+    inline U32 HashMapMatchEmpty(const U8* pGroup)
+    {
+    #if SM_SIMD_SSE2
+        return (U32)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)pGroup));
+    #elif SM_SIMD_NEON
+        static const U8 kLaneBits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+        uint8x16_t bits = vandq_u8(vtstq_u8(vld1q_u8(pGroup), vdupq_n_u8(kHashMapEmpty)), vld1q_u8(kLaneBits));
+        return (U32)vaddv_u8(vget_low_u8(bits)) | ((U32)vaddv_u8(vget_high_u8(bits)) << 8);
+    #else
+        U32 mask = 0;
+        for(U32 i = 0; i < kHashMapGroupWidth; i++)
+        {
+            mask |= (U32)(pGroup[i] >> 7) << i;
+        }
+        return mask;
+    #endif
+    }
+
+    // Open addressing hash map in the style of a Swiss table. Each slot has a control byte holding 7 bits of the hash
+    // (or empty), and lookups compare a whole 16 byte group of control bytes at once. Probing is linear from the home
+    // slot so removal shifts later entries back into the hole instead of leaving tombstones, which keeps probe lengths
+    // short no matter how many erases happen. Storage comes from a LinearAllocator or a HeapAllocator like Array.
+    // Pointers returned by Find/Insert are invalidated by any insert that grows the map or by any Remove.
+    template<typename K, typename V, typename Hasher = DefaultHash<K>, typename KeyEqual = DefaultKeyEqual<K>>
+    class HashMap
+    {
+    public:
+        struct Slot
+        {
+            K m_key;
+            V m_value;
+        };
+
+        class Iterator
+        {
+        public:
+            Iterator(HashMap* pMap, size_t index) :m_pMap(pMap), m_index(index) { SkipEmpty(); }
+            Slot& operator*() const { return m_pMap->m_pSlots[m_index]; }
+            Slot* operator->() const { return &m_pMap->m_pSlots[m_index]; }
+            Iterator& operator++() { m_index++; SkipEmpty(); return *this; }
+            bool operator!=(const Iterator& other) const { return m_index != other.m_index; }
+
+        private:
+            void SkipEmpty();
+
+            HashMap* m_pMap;
+            size_t m_index;
+        };
+
+        HashMap() = default;
+        HashMap(LinearAllocator* allocator, size_t initialNumItems = 0);
+        HashMap(HeapAllocator* allocator, size_t initialNumItems = 0);
+        HashMap(HashMap&& other);
+        HashMap& operator=(HashMap&& other);
+        HashMap(const HashMap&) = delete;
+        HashMap& operator=(const HashMap&) = delete;
+        ~HashMap();
+
+        V* Find(const K& key);
+        const V* Find(const K& key) const;
+        bool Contains(const K& key) const { return FindIndex(key, m_hasher(key)) != kInvalidIndex; }
+        V* Insert(const K& key, const V& value);
+        V* Insert(const K& key, V&& value);
+        V& operator[](const K& key);
+        bool Remove(const K& key);
+        void Clear();
+        void Reserve(size_t numItems);
+
+        bool IsEmpty() const { return m_numItems == 0; }
+        Iterator begin() { return Iterator(this, 0); }
+        Iterator end() { return Iterator(this, m_capacity); }
+
+        Slot* m_pSlots = nullptr;
+        U8* m_pControl = nullptr;
+        size_t m_numItems = 0;
+        size_t m_capacity = 0;
+        LinearAllocator* m_pLinearAllocator = nullptr;
+        HeapAllocator* m_pHeapAllocator = nullptr;
+
+    private:
+        static const size_t kInvalidIndex = SIZE_MAX;
+        static const size_t kMinCapacity = kHashMapGroupWidth;
+
+        static size_t CalcHomeIndex(U64 hash, size_t capacity) { return (size_t)(hash >> 7) & (capacity - 1); }
+        static U8 CalcControlByte(U64 hash) { return (U8)(hash & 0x7f); }
+        size_t CalcMaxLoad() const { return m_capacity - (m_capacity / 8); }
+
+        size_t FindIndex(const K& key, U64 hash) const;
+        size_t FindEmptyIndex(U64 hash) const;
+        void SetControl(size_t index, U8 control);
+        template<typename VArg>
+        V* InsertNew(const K& key, U64 hash, VArg&& value);
+        void Rehash(size_t newCapacity);
+        void FreeStorage();
+
+        Hasher m_hasher;
+        KeyEqual m_keyEqual;
+    };
+
+    template<typename K, typename V, typename Hasher, typename KeyEqual>
+    void HashMap<K, V, Hasher, KeyEqual>::Iterator::SkipEmpty()
+    {
+        const size_t capacity = m_pMap->m_capacity;
+        while(m_index < capacity)
+        {
+            // bits past the end of the table land in the cloned tail, those are treated as the end
+            U32 full = ~HashMapMatchEmpty(m_pMap->m_pControl + m_index) & 0xffff;
+            if(full != 0)
+            {
+                m_index += FindFirstSetBit(full);
+                break;
+            }
+            m_index += kHashMapGroupWidth;
+        }
+
+        if(m_index > capacity)
+        {
+            m_index = capacity;
+        }
+    }
+
+    template<typename K, typename V, typename Hasher, typename KeyEqual>
+    HashMap<K, V, Hasher, KeyEqual>::HashMap(LinearAllocator* allocator, size_t initialNumItems)
+        :m_pLinearAllocator(allocator)
+    {
+        if(initialNumItems > 0)
+        {
+            Reserve(initialNumItems);
+        }
+    }
+
+    template<typename K, typename V, typename Hasher, typename KeyEqual>
+    HashMap<K, V, Hasher, KeyEqual>::HashMap(HeapAllocator* allocator, size_t initialNumItems)
+        :m_pHeapAllocator(allocator)
+    {
+        if(initialNumItems > 0)
+        {
+            Reserve(initialNumItems);
+        }
+    }
+
+    template<typename K, typename V, typename Hasher, typename KeyEqual>
+    HashMap<K, V, Hasher, KeyEqual>::HashMap(HashMap&& other)
+        :m_pSlots(other.m_pSlots)
+        ,m_pControl(other.m_pControl)
+        ,m_numItems(other.m_numItems)
+        ,m_capacity(other.m_capacity)
+        ,m_pLinearAllocator(other.m_pLinearAllocator)
+        ,m_pHeapAllocator(other.m_pHeapAllocator)
+        ,m_hasher(std::move(other.m_hasher))
+        ,m_keyEqual(std::move(other.m_keyEqual))
+    {
+        other.m_pSlots = nullptr;
+        other.m_pControl = nullptr;
+        other.m_numItems = 0;
+        other.m_capacity = 0;
+    }
+
+    template<typename K, typename V, typename Hasher, typename KeyEqual>
+    HashMap<K, V, Hasher, KeyEqual>& HashMap<K, V, Hasher, KeyEqual>::operator=(HashMap&& other)
+    {
+        if(this != &other)
+        {
+            Clear();
+            FreeStorage();
+
+            m_pSlots = other.m_pSlots;
+            m_pControl = other.m_pControl;
+            m_numItems = other.m_numItems;
+            m_capacity = other.m_capacity;
+            m_pLinearAllocator = other.m_pLinearAllocator;
+            m_pHeapAllocator = other.m_pHeapAllocator;
+            m_hasher = std::move(other.m_hasher);
+            m_keyEqual = std::move(other.m_keyEqual);
+
+            other.m_pSlots = nullptr;
+            other.m_pControl = nullptr;
+            other.m_numItems = 0;
+            other.m_capacity = 0;
+        }
+        return *this;
+    }
+
+    template<typename K, typename V, typename Hasher, typename KeyEqual>
+    HashMap<K, V, Hasher, KeyEqual>::~HashMap()
+    {
+        Clear();
+        FreeStorage();
+    }
+
+    template<typename K, typename V, typename Hasher, typename KeyEqual>
+    V* HashMap<K, V, Hasher, KeyEqual>::Find(const K& key)
+    {
+        size_t index = FindIndex(key, m_hasher(key));
+        return index != kInvalidIndex ? &m_pSlots[index].m_value : nullptr;
+    }
+
+    template<typename K, typename V, typename Hasher, typename KeyEqual>
+    const V* HashMap<K, V, Hasher, KeyEqual>::Find(const K& key) const
+    {
+        size_t index = FindIndex(key, m_hasher(key));
+        return index != kInvalidIndex ? &m_pSlots[index].m_value : nullptr;
+    }
+
+    template<typename K, typename V, typename Hasher, typename KeyEqual>
+    V* HashMap<K, V, Hasher, KeyEqual>::Insert(const K& key, const V& value)
+    {
+        U64 hash = m_hasher(key);
+        size_t index = FindIndex(key, hash);
+        if(index != kInvalidIndex)
+        {
+            m_pSlots[index].m_value = value;
+            return &m_pSlots[index].m_value;
+        }
+
+        return InsertNew(key, hash, value);
+    }
+
+    template<typename K, typename V, typename Hasher, typename KeyEqual>
+    V* HashMap<K, V, Hasher, KeyEqual>::Insert(const K& key, V&& value)
+    {
+        U64 hash = m_hasher(key);
+        size_t index = FindIndex(key, hash);
+        if(index != kInvalidIndex)
+        {
+            m_pSlots[index].m_value = std::move(value);
+            return &m_pSlots[index].m_value;
+        }
+
+        return InsertNew(key, hash, std::move(value));
+    }
+
+    template<typename K, typename V, typename Hasher, typename KeyEqual>
+    V& HashMap<K, V, Hasher, KeyEqual>::operator[](const K& key)
+    {
+        U64 hash = m_hasher(key);
+        size_t index = FindIndex(key, hash);
+        if(index != kInvalidIndex)
+        {
+            return m_pSlots[index].m_value;
+        }
+
+        return *InsertNew(key, hash, V());
+    }
+
+    template<typename K, typename V, typename Hasher, typename KeyEqual>
+    bool HashMap<K, V, Hasher, KeyEqual>::Remove(const K& key)
+    {
+        size_t hole = FindIndex(key, m_hasher(key));
+        if(hole == kInvalidIndex)
+            return false;
+
+        m_pSlots[hole].~Slot();
+        m_numItems--;
+
+        // backward shift, any entry after the hole whose home slot is not between the hole and itself moves into the
+        // hole so every entry stays reachable by a linear probe from its home without needing tombstones
+        const size_t mask = m_capacity - 1;
+        size_t next = (hole + 1) & mask;
+        while(m_pControl[next] != kHashMapEmpty)
+        {
+            size_t home = CalcHomeIndex(m_hasher(m_pSlots[next].m_key), m_capacity);
+            bool bHomeInRange = hole <= next ? (home > hole && home <= next) : (home > hole || home <= next);
+            if(!bHomeInRange)
+            {
+                new(&m_pSlots[hole]) Slot(std::move(m_pSlots[next]));
+                m_pSlots[next].~Slot();
+                SetControl(hole, m_pControl[next]);
+                hole = next;
+            }
+            next = (next + 1) & mask;
+        }
+
+        SetControl(hole, kHashMapEmpty);
+        return true;
+    }
+
+    template<typename K, typename V, typename Hasher, typename KeyEqual>
+    void HashMap<K, V, Hasher, KeyEqual>::Clear()
+    {
+        if(m_capacity == 0)
+            return;
+
+        if constexpr (!std::is_trivially_destructible_v<Slot>)
+        {
+            for(Slot& slot : *this)
+            {
+                slot.~Slot();
+            }
+        }
+
+        ::memset(m_pControl, kHashMapEmpty, m_capacity + kHashMapGroupWidth);
+        m_numItems = 0;
+    }
+
+    template<typename K, typename V, typename Hasher, typename KeyEqual>
+    void HashMap<K, V, Hasher, KeyEqual>::Reserve(size_t numItems)
+    {
+        size_t capacity = kMinCapacity;
+        while(capacity - (capacity / 8) < numItems)
+        {
+            capacity *= 2;
+        }
+
+        if(capacity > m_capacity)
+        {
+            Rehash(capacity);
+        }
+    }
+
+    template<typename K, typename V, typename Hasher, typename KeyEqual>
+    size_t HashMap<K, V, Hasher, KeyEqual>::FindIndex(const K& key, U64 hash) const
+    {
+        if(m_capacity == 0)
+            return kInvalidIndex;
+
+        const size_t mask = m_capacity - 1;
+        const U8 control = CalcControlByte(hash);
+        size_t pos = CalcHomeIndex(hash, m_capacity);
+        for(size_t numProbed = 0; numProbed < m_capacity; numProbed += kHashMapGroupWidth)
+        {
+            const U8* pGroup = m_pControl + pos;
+            U32 matches = HashMapMatchGroup(pGroup, control);
+            while(matches != 0)
+            {
+                size_t index = (pos + FindFirstSetBit(matches)) & mask;
+                if(m_keyEqual(m_pSlots[index].m_key, key))
+                    return index;
+                matches &= matches - 1;
+            }
+
+            // the probe run from the home slot always ends at the first empty slot
+            if(HashMapMatchEmpty(pGroup) != 0)
+                return kInvalidIndex;
+
+            pos = (pos + kHashMapGroupWidth) & mask;
+        }
+
+        return kInvalidIndex;
+    }
+
+    template<typename K, typename V, typename Hasher, typename KeyEqual>
+    size_t HashMap<K, V, Hasher, KeyEqual>::FindEmptyIndex(U64 hash) const
+    {
+        // load factor is capped below 1 so there is always an empty slot
+        const size_t mask = m_capacity - 1;
+        size_t pos = CalcHomeIndex(hash, m_capacity);
+        while(true)
+        {
+            U32 empties = HashMapMatchEmpty(m_pControl + pos);
+            if(empties != 0)
+                return (pos + FindFirstSetBit(empties)) & mask;
+
+            pos = (pos + kHashMapGroupWidth) & mask;
+        }
+    }
+
+    template<typename K, typename V, typename Hasher, typename KeyEqual>
+    void HashMap<K, V, Hasher, KeyEqual>::SetControl(size_t index, U8 control)
+    {
+        // the first group is cloned past the end so a group load starting anywhere in the table never needs to wrap
+        m_pControl[index] = control;
+        if(index < kHashMapGroupWidth)
+        {
+            m_pControl[m_capacity + index] = control;
+        }
+    }
+
+    template<typename K, typename V, typename Hasher, typename KeyEqual>
+    template<typename VArg>
+    V* HashMap<K, V, Hasher, KeyEqual>::InsertNew(const K& key, U64 hash, VArg&& value)
+    {
+        if(m_numItems + 1 > CalcMaxLoad())
+        {
+            Rehash(m_capacity > 0 ? m_capacity * 2 : kMinCapacity);
+        }
+
+        size_t index = FindEmptyIndex(hash);
+        Slot* pSlot = new(&m_pSlots[index]) Slot{ key, std::forward<VArg>(value) };
+        SetControl(index, CalcControlByte(hash));
+        m_numItems++;
+        return &pSlot->m_value;
+    }
+
+    template<typename K, typename V, typename Hasher, typename KeyEqual>
+    void HashMap<K, V, Hasher, KeyEqual>::Rehash(size_t newCapacity)
+    {
+        SM_ASSERT((newCapacity & (newCapacity - 1)) == 0 && newCapacity >= kMinCapacity);
+
+        // slots and control bytes share one allocation, control bytes go last since group loads are unaligned
+        size_t slotBytes = sizeof(Slot) * newCapacity;
+        size_t totalBytes = slotBytes + newCapacity + kHashMapGroupWidth;
+        U32 alignment = alignof(Slot) > kAlign16 ? (U32)alignof(Slot) : (U32)kAlign16;
+
+        void* pStorage = nullptr;
+        if(m_pLinearAllocator != nullptr)
+        {
+            pStorage = m_pLinearAllocator->Alloc(totalBytes, alignment);
+        }
+        else
+        {
+            SM_ASSERT(m_pHeapAllocator != nullptr);
+            pStorage = m_pHeapAllocator->Alloc(totalBytes, alignment);
+        }
+
+        Slot* pOldSlots = m_pSlots;
+        U8* pOldControl = m_pControl;
+        size_t oldCapacity = m_capacity;
+
+        m_pSlots = (Slot*)pStorage;
+        m_pControl = (U8*)pStorage + slotBytes;
+        m_capacity = newCapacity;
+        ::memset(m_pControl, kHashMapEmpty, newCapacity + kHashMapGroupWidth);
+
+        for(size_t i = 0; i < oldCapacity; i++)
+        {
+            if(pOldControl[i] == kHashMapEmpty)
+                continue;
+
+            U64 hash = m_hasher(pOldSlots[i].m_key);
+            size_t index = FindEmptyIndex(hash);
+            if constexpr (std::is_trivially_copyable_v<Slot>)
+            {
+                ::memcpy((void*)&m_pSlots[index], (const void*)&pOldSlots[i], sizeof(Slot));
+            }
+            else
+            {
+                new(&m_pSlots[index]) Slot(std::move(pOldSlots[i]));
+                pOldSlots[i].~Slot();
+            }
+            SetControl(index, pOldControl[i]);
+        }
+
+        // linear allocator storage is reclaimed when the arena is reset
+        if(m_pHeapAllocator != nullptr && pOldSlots != nullptr)
+        {
+            m_pHeapAllocator->Free(pOldSlots);
+        }
+    }
+
+    template<typename K, typename V, typename Hasher, typename KeyEqual>
+    void HashMap<K, V, Hasher, KeyEqual>::FreeStorage()
+    {
+        if(m_pHeapAllocator != nullptr && m_pSlots != nullptr)
+        {
+            m_pHeapAllocator->Free(m_pSlots);
+        }
+        m_pSlots = nullptr;
+        m_pControl = nullptr;
+        m_capacity = 0;
+    }
+
+    //-------------------------------------------------------------------------
+    // Queues
+    //-------------------------------------------------------------------------
+    static const size_t kCacheLineSize = 64;
+
+    // Bounded lock-free ring for exactly one producer thread and one consumer thread.
+    // Each side keeps a cached copy of the other side's index so it only touches the shared cache line when the cached
+    // value says the queue looks full/empty. Items are copied in and out so T must be trivially copyable.
+    template<typename T>
+    class SpscQueue
+    {
+    public:
+        static_assert(std::is_trivially_copyable_v<T>, "Queue items are copied with memcpy and must be trivially copyable");
+
+        SpscQueue() = default;
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+        ~SpscQueue();
+
+        void Init(LinearAllocator* allocator, U32 capacity);
+        void Init(HeapAllocator* allocator, U32 capacity);
+
+        bool Push(const T& item) { return PushBatch(&item, 1) == 1; }
+        bool Pop(T* pItem) { return PopBatch(pItem, 1) == 1; }
+
+        // Returns the number of items actually pushed/popped, a batch is published with a single atomic store
+        U32 PushBatch(const T* pItems, U32 numItems);
+        U32 PopBatch(T* pItems, U32 maxItems);
+
+        U32 GetCapacity() const { return m_mask + 1; }
+
+    private:
+        void InitStorage(void* pStorage, U32 capacity);
+
+        alignas(kCacheLineSize) std::atomic<U32> m_head = 0;
+        U32 m_cachedTail = 0;
+
+        alignas(kCacheLineSize) std::atomic<U32> m_tail = 0;
+        U32 m_cachedHead = 0;
+
+        alignas(kCacheLineSize) T* m_pItems = nullptr;
+        U32 m_mask = 0;
+        HeapAllocator* m_pHeapAllocator = nullptr;
+    };
+
+    template<typename T>
+    SpscQueue<T>::~SpscQueue()
+    {
+        if(m_pHeapAllocator != nullptr && m_pItems != nullptr)
+        {
+            m_pHeapAllocator->Free(m_pItems);
+        }
+    }
+
+    template<typename T>
+    void SpscQueue<T>::Init(LinearAllocator* allocator, U32 capacity)
+    {
+        InitStorage(allocator->Alloc<T>(capacity), capacity);
+    }
+
+    template<typename T>
+    void SpscQueue<T>::Init(HeapAllocator* allocator, U32 capacity)
+    {
+        m_pHeapAllocator = allocator;
+        InitStorage(allocator->Alloc<T>(capacity), capacity);
+    }
+
+    template<typename T>
+    void SpscQueue<T>::InitStorage(void* pStorage, U32 capacity)
+    {
+        SM_ASSERT(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+        m_pItems = (T*)pStorage;
+        m_mask = capacity - 1;
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+        m_cachedHead = 0;
+        m_cachedTail = 0;
+    }
+
+    template<typename T>
+    U32 SpscQueue<T>::PushBatch(const T* pItems, U32 numItems)
+    {
+        const U32 capacity = m_mask + 1;
+        const U32 tail = m_tail.load(std::memory_order_relaxed);
+
+        U32 numFree = capacity - (tail - m_cachedHead);
+        if(numFree < numItems)
+        {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            numFree = capacity - (tail - m_cachedHead);
+        }
+
+        U32 numToPush = numItems < numFree ? numItems : numFree;
+        if(numToPush == 0)
+            return 0;
+
+        // copy in at most two runs, the second one wraps around to the start of the ring
+        U32 start = tail & m_mask;
+        U32 firstRun = capacity - start < numToPush ? capacity - start : numToPush;
+        ::memcpy((void*)(m_pItems + start), pItems, sizeof(T) * firstRun);
+        if(firstRun < numToPush)
+        {
+            ::memcpy((void*)m_pItems, pItems + firstRun, sizeof(T) * (numToPush - firstRun));
+        }
+
+        m_tail.store(tail + numToPush, std::memory_order_release);
+        return numToPush;
+    }
+
+    template<typename T>
+    U32 SpscQueue<T>::PopBatch(T* pItems, U32 maxItems)
+    {
+        const U32 capacity = m_mask + 1;
+        const U32 head = m_head.load(std::memory_order_relaxed);
+
+        U32 numAvailable = m_cachedTail - head;
+        if(numAvailable < maxItems)
+        {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            numAvailable = m_cachedTail - head;
+        }
+
+        U32 numToPop = maxItems < numAvailable ? maxItems : numAvailable;
+        if(numToPop == 0)
+            return 0;
+
+        U32 start = head & m_mask;
+        U32 firstRun = capacity - start < numToPop ? capacity - start : numToPop;
+        ::memcpy((void*)pItems, m_pItems + start, sizeof(T) * firstRun);
+        if(firstRun < numToPop)
+        {
+            ::memcpy((void*)(pItems + firstRun), m_pItems, sizeof(T) * (numToPop - firstRun));
+        }
+
+        m_head.store(head + numToPop, std::memory_order_release);
+        return numToPop;
+    }
+
+    // Bounded lock-free ring for any number of producer and consumer threads.
+    // Every cell carries a sequence number that says which lap of the ring it is ready for, so producers and consumers
+    // only contend on their own position counter. Batches claim a run of ready cells with a single CAS and then
+    // publish each cell individually.
+    template<typename T>
+    class MpmcQueue
+    {
+    public:
+        static_assert(std::is_trivially_copyable_v<T>, "Queue items are copied with memcpy and must be trivially copyable");
+
+        MpmcQueue() = default;
+        MpmcQueue(const MpmcQueue&) = delete;
+        MpmcQueue& operator=(const MpmcQueue&) = delete;
+        ~MpmcQueue();
+
+        void Init(LinearAllocator* allocator, U32 capacity);
+        void Init(HeapAllocator* allocator, U32 capacity);
+
+        bool Push(const T& item) { return PushBatch(&item, 1) == 1; }
+        bool Pop(T* pItem) { return PopBatch(pItem, 1) == 1; }
+
+        // Returns the number of items actually pushed/popped, which may be fewer than asked for under contention
+        U32 PushBatch(const T* pItems, U32 numItems);
+        U32 PopBatch(T* pItems, U32 maxItems);
+
+        U32 GetCapacity() const { return (U32)m_mask + 1; }
+
+    private:
+        struct Cell
+        {
+            std::atomic<U64> m_sequence;
+            T m_item;
+        };
+
+        void InitStorage(void* pStorage, U32 capacity);
+
+        alignas(kCacheLineSize) std::atomic<U64> m_enqueuePos = 0;
+        alignas(kCacheLineSize) std::atomic<U64> m_dequeuePos = 0;
+        alignas(kCacheLineSize) Cell* m_pCells = nullptr;
+        U64 m_mask = 0;
+        HeapAllocator* m_pHeapAllocator = nullptr;
+    };
+
+    template<typename T>
+    MpmcQueue<T>::~MpmcQueue()
+    {
+        if(m_pHeapAllocator != nullptr && m_pCells != nullptr)
+        {
+            m_pHeapAllocator->Free(m_pCells);
+        }
+    }
+
+    template<typename T>
+    void MpmcQueue<T>::Init(LinearAllocator* allocator, U32 capacity)
+    {
+        InitStorage(allocator->Alloc(sizeof(Cell) * capacity, kAlign64), capacity);
+    }
+
+    template<typename T>
+    void MpmcQueue<T>::Init(HeapAllocator* allocator, U32 capacity)
+    {
+        m_pHeapAllocator = allocator;
+        InitStorage(allocator->Alloc(sizeof(Cell) * capacity, kAlign64), capacity);
+    }
+
+    template<typename T>
+    void MpmcQueue<T>::InitStorage(void* pStorage, U32 capacity)
+    {
+        SM_ASSERT(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+        m_pCells = (Cell*)pStorage;
+        m_mask = capacity - 1;
+        for(U32 i = 0; i < capacity; i++)
+        {
+            new(&m_pCells[i].m_sequence) std::atomic<U64>(i);
+        }
+        m_enqueuePos.store(0, std::memory_order_relaxed);
+        m_dequeuePos.store(0, std::memory_order_relaxed);
+    }
+
+    template<typename T>
+    U32 MpmcQueue<T>::PushBatch(const T* pItems, U32 numItems)
+    {
+        U64 pos = m_enqueuePos.load(std::memory_order_relaxed);
+        while(true)
+        {
+            // a cell is free for position pos when its sequence equals pos
+            U32 numReady = 0;
+            I64 diff = 0;
+            while(numReady < numItems)
+            {
+                U64 seq = m_pCells[(pos + numReady) & m_mask].m_sequence.load(std::memory_order_acquire);
+                diff = (I64)(seq - (pos + numReady));
+                if(diff != 0)
+                    break;
+                numReady++;
+            }
+
+            if(numReady == 0)
+            {
+                // behind means the consumer has not freed the cell yet so the queue is full, ahead means another
+                // producer already claimed pos
+                if(diff < 0)
+                    return 0;
+
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if(m_enqueuePos.compare_exchange_weak(pos, pos + numReady, std::memory_order_relaxed))
+            {
+                for(U32 i = 0; i < numReady; i++)
+                {
+                    Cell& cell = m_pCells[(pos + i) & m_mask];
+                    cell.m_item = pItems[i];
+                    cell.m_sequence.store(pos + i + 1, std::memory_order_release);
+                }
+                return numReady;
+            }
+        }
+    }
+
+    template<typename T>
+    U32 MpmcQueue<T>::PopBatch(T* pItems, U32 maxItems)
+    {
+        U64 pos = m_dequeuePos.load(std::memory_order_relaxed);
+        while(true)
+        {
+            // a cell holds the item for position pos once its sequence is pos + 1
+            U32 numReady = 0;
+            I64 diff = 0;
+            while(numReady < maxItems)
+            {
+                U64 seq = m_pCells[(pos + numReady) & m_mask].m_sequence.load(std::memory_order_acquire);
+                diff = (I64)(seq - (pos + numReady + 1));
+                if(diff != 0)
+                    break;
+                numReady++;
+            }
+
+            if(numReady == 0)
+            {
+                if(diff < 0)
+                    return 0;
+
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if(m_dequeuePos.compare_exchange_weak(pos, pos + numReady, std::memory_order_relaxed))
+            {
+                for(U32 i = 0; i < numReady; i++)
+                {
+                    Cell& cell = m_pCells[(pos + i) & m_mask];
+                    pItems[i] = cell.m_item;
+                    cell.m_sequence.store(pos + i + m_mask + 1, std::memory_order_release);
+                }
+                return numReady;
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // SlotMap
+    //-------------------------------------------------------------------------
+    // 64 bit handle, 32 bits of index and 32 bits of generation
+    struct SlotHandle64
+    {
+        static const U32 kMaxIndex = 0xffffffff;
+        static const U32 kMaxGeneration = 0xffffffff;
+
+        static SlotHandle64 Make(U32 index, U32 generation) { return SlotHandle64{ index, generation }; }
+        U32 GetIndex() const { return m_index; }
+        U32 GetGeneration() const { return m_generation; }
+        bool IsNull() const { return m_generation == 0; }
+        bool operator==(const SlotHandle64& other) const { return m_index == other.m_index && m_generation == other.m_generation; }
+        bool operator!=(const SlotHandle64& other) const { return !(*this == other); }
+
+        U32 m_index = 0;
+        U32 m_generation = 0;
+    };
+
+    // 32 bit handle, 20 bits of index and 12 bits of generation
+    struct SlotHandle32
+    {
+        static const U32 kIndexBits = 20;
+        static const U32 kMaxIndex = (1u << kIndexBits) - 1;
+        static const U32 kMaxGeneration = (1u << (32 - kIndexBits)) - 1;
+
+        static SlotHandle32 Make(U32 index, U32 generation) { return SlotHandle32{ index | (generation << kIndexBits) }; }
+        U32 GetIndex() const { return m_bits & kMaxIndex; }
+        U32 GetGeneration() const { return m_bits >> kIndexBits; }
+        bool IsNull() const { return GetGeneration() == 0; }
+        bool operator==(const SlotHandle32& other) const { return m_bits == other.m_bits; }
+        bool operator!=(const SlotHandle32& other) const { return m_bits != other.m_bits; }
+
+        U32 m_bits = 0;
+    };
+
+    // Stores T densely and hands out generational handles instead of pointers.
+    // Handles index an indirection slot that records where the item currently lives in the dense array and which
+    // generation it is on. Erase swaps the last item into the hole and bumps the slot's generation so any handle still
+    // referring to the old item is detected as stale. A default constructed handle is always invalid.
+    template<typename T, typename Handle = SlotHandle64>
+    class SlotMap
+    {
+    public:
+        SlotMap() = default;
+        SlotMap(LinearAllocator* allocator, size_t initialCapacity = 0);
+        SlotMap(HeapAllocator* allocator, size_t initialCapacity = 0);
+
+        Handle Insert(const T& item);
+        Handle Insert(T&& item);
+        bool Erase(Handle handle);
+        void Clear();
+        void Reserve(size_t capacity);
+
+        T* Get(Handle handle);
+        const T* Get(Handle handle) const;
+        bool IsValid(Handle handle) const { return FindDenseIndex(handle) != kInvalidIndex; }
+
+        size_t GetCount() const { return m_items.m_numItems; }
+        bool IsEmpty() const { return m_items.IsEmpty(); }
+
+        // Dense iteration, the handle for the item at a dense index is available through GetHandle
+        Handle GetHandle(size_t denseIndex) const;
+        T* begin() { return m_items.begin(); }
+        T* end() { return m_items.end(); }
+        const T* begin() const { return m_items.begin(); }
+        const T* end() const { return m_items.end(); }
+
+    private:
+        static const U32 kInvalidIndex = 0xffffffff;
+
+        struct Slot
+        {
+            U32 m_denseIndexOrNextFree;
+            U32 m_generation;
+        };
+
+        U32 FindDenseIndex(Handle handle) const;
+        Handle AllocSlot();
+
+        Array<T> m_items;
+        Array<U32> m_denseToSlot;
+        Array<Slot> m_slots;
+        U32 m_firstFreeSlot = kInvalidIndex;
+    };
+
+    template<typename T, typename Handle>
+    SlotMap<T, Handle>::SlotMap(LinearAllocator* allocator, size_t initialCapacity)
+        :m_items(allocator, initialCapacity)
+        ,m_denseToSlot(allocator, initialCapacity)
+        ,m_slots(allocator, initialCapacity)
+    {
+    }
+
+    template<typename T, typename Handle>
+    SlotMap<T, Handle>::SlotMap(HeapAllocator* allocator, size_t initialCapacity)
+        :m_items(allocator, initialCapacity)
+        ,m_denseToSlot(allocator, initialCapacity)
+        ,m_slots(allocator, initialCapacity)
+    {
+    }
+
+    template<typename T, typename Handle>
+    Handle SlotMap<T, Handle>::Insert(const T& item)
+    {
+        Handle handle = AllocSlot();
+        m_items.Push(item);
+        return handle;
+    }
+
+    template<typename T, typename Handle>
+    Handle SlotMap<T, Handle>::Insert(T&& item)
+    {
+        Handle handle = AllocSlot();
+        m_items.Push(std::move(item));
+        return handle;
+    }
+
+    template<typename T, typename Handle>
+    bool SlotMap<T, Handle>::Erase(Handle handle)
+    {
+        U32 denseIndex = FindDenseIndex(handle);
+        if(denseIndex == kInvalidIndex)
+            return false;
+
+        // move the last item into the hole and repoint its slot
+        U32 lastDenseIndex = (U32)m_items.m_numItems - 1;
+        if(denseIndex != lastDenseIndex)
+        {
+            U32 movedSlot = m_denseToSlot[lastDenseIndex];
+            m_slots[movedSlot].m_denseIndexOrNextFree = denseIndex;
+            m_denseToSlot[denseIndex] = movedSlot;
+        }
+        m_items.RemoveSwapBack(denseIndex);
+        m_denseToSlot.Pop();
+
+        // a slot whose generation would wrap is retired instead of reused so an old handle can never match again
+        U32 slotIndex = handle.GetIndex();
+        Slot& slot = m_slots[slotIndex];
+        slot.m_generation++;
+        if(slot.m_generation < Handle::kMaxGeneration)
+        {
+            slot.m_denseIndexOrNextFree = m_firstFreeSlot;
+            m_firstFreeSlot = slotIndex;
+        }
+        else
+        {
+            slot.m_denseIndexOrNextFree = kInvalidIndex;
+        }
+
+        return true;
+    }
+
+    template<typename T, typename Handle>
+    void SlotMap<T, Handle>::Clear()
+    {
+        // erasing from the back never moves anything and bumps every generation so outstanding handles go stale
+        while(!m_items.IsEmpty())
+        {
+            Erase(GetHandle(m_items.m_numItems - 1));
+        }
+    }
+
+    template<typename T, typename Handle>
+    void SlotMap<T, Handle>::Reserve(size_t capacity)
+    {
+        m_items.Reserve(capacity);
+        m_denseToSlot.Reserve(capacity);
+        m_slots.Reserve(capacity);
+    }
+
+    template<typename T, typename Handle>
+    T* SlotMap<T, Handle>::Get(Handle handle)
+    {
+        U32 denseIndex = FindDenseIndex(handle);
+        return denseIndex != kInvalidIndex ? &m_items[denseIndex] : nullptr;
+    }
+
+    template<typename T, typename Handle>
+    const T* SlotMap<T, Handle>::Get(Handle handle) const
+    {
+        U32 denseIndex = FindDenseIndex(handle);
+        return denseIndex != kInvalidIndex ? &m_items[denseIndex] : nullptr;
+    }
+
+    template<typename T, typename Handle>
+    Handle SlotMap<T, Handle>::GetHandle(size_t denseIndex) const
+    {
+        U32 slotIndex = m_denseToSlot[denseIndex];
+        return Handle::Make(slotIndex, m_slots[slotIndex].m_generation);
+    }
+
+    template<typename T, typename Handle>
+    U32 SlotMap<T, Handle>::FindDenseIndex(Handle handle) const
+    {
+        U32 slotIndex = handle.GetIndex();
+        if(handle.IsNull() || slotIndex >= m_slots.m_numItems)
+            return kInvalidIndex;
+
+        const Slot& slot = m_slots[slotIndex];
+        return slot.m_generation == handle.GetGeneration() ? slot.m_denseIndexOrNextFree : kInvalidIndex;
+    }
+
+    template<typename T, typename Handle>
+    Handle SlotMap<T, Handle>::AllocSlot()
+    {
+        U32 denseIndex = (U32)m_items.m_numItems;
+        U32 slotIndex = m_firstFreeSlot;
+        if(slotIndex != kInvalidIndex)
+        {
+            m_firstFreeSlot = m_slots[slotIndex].m_denseIndexOrNextFree;
+        }
+        else
+        {
+            SM_ASSERT(m_slots.m_numItems <= Handle::kMaxIndex);
+            slotIndex = (U32)m_slots.m_numItems;
+            m_slots.Push(Slot{ 0, 1 });
+        }
+
+        m_slots[slotIndex].m_denseIndexOrNextFree = denseIndex;
+        m_denseToSlot.Push(slotIndex);
+        return Handle::Make(slotIndex, m_slots[slotIndex].m_generation);
+    }
+
+    //-------------------------------------------------------------------------
+    // BitSet
+    //-------------------------------------------------------------------------
+    static const U32 kBitSetWordBits = 64;
+    static const U32 kBitSetInvalidIndex = 0xffffffff;
+
+    constexpr inline U32 CalcBitSetNumWords(U32 numBits) { return (numBits + kBitSetWordBits - 1) / kBitSetWordBits; }
+    constexpr inline U64 CalcBitSetWordMask(U32 index) { return 1ull << (index % kBitSetWordBits); }
+
+    // Word level helpers shared by every bit set type, bits past the end of the set are always kept clear
+    inline void BitWordsAnd(U64* pDst, const U64* pSrc, U32 numWords) { for(U32 i = 0; i < numWords; i++) pDst[i] &= pSrc[i]; }
+    inline void BitWordsOr(U64* pDst, const U64* pSrc, U32 numWords) { for(U32 i = 0; i < numWords; i++) pDst[i] |= pSrc[i]; }
+    inline void BitWordsAndNot(U64* pDst, const U64* pSrc, U32 numWords) { for(U32 i = 0; i < numWords; i++) pDst[i] &= ~pSrc[i]; }
+
+    inline U32 BitWordsCountSetBits(const U64* pWords, U32 numWords)
+    {
+        U32 count = 0;
+        for(U32 i = 0; i < numWords; i++)
+        {
+            count += CountSetBits(pWords[i]);
+        }
+        return count;
+    }
+
+    inline void BitWordsSetAll(U64* pWords, U32 numBits)
+    {
+        U32 numWords = CalcBitSetNumWords(numBits);
+        ::memset(pWords, 0xff, sizeof(U64) * numWords);
+        if(numBits % kBitSetWordBits != 0)
+        {
+            pWords[numWords - 1] = CalcBitSetWordMask(numBits) - 1;
+        }
+    }
+
+    // Returns the index of the first set bit at or after startIndex, or kBitSetInvalidIndex
+    inline U32 BitWordsFindNextSet(const U64* pWords, U32 numWords, U32 startIndex)
+    {
+        U32 wordIndex = startIndex / kBitSetWordBits;
+        if(wordIndex >= numWords)
+            return kBitSetInvalidIndex;
+
+        U64 word = pWords[wordIndex] & (~0ull << (startIndex % kBitSetWordBits));
+        while(word == 0)
+        {
+            if(++wordIndex >= numWords)
+                return kBitSetInvalidIndex;
+            word = pWords[wordIndex];
+        }
+        return wordIndex * kBitSetWordBits + FindFirstSetBit(word);
+    }
+
+    template<typename Func>
+    inline void BitWordsForEachSetBit(const U64* pWords, U32 numWords, Func&& func)
+    {
+        for(U32 wordIndex = 0; wordIndex < numWords; wordIndex++)
+        {
+            U64 word = pWords[wordIndex];
+            while(word != 0)
+            {
+                func(wordIndex * kBitSetWordBits + FindFirstSetBit(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+    // Bit set with a compile time size stored inline
+    template<U32 NUM_BITS>
+    class FixedBitSet
+    {
+    public:
+        static const U32 kNumWords = CalcBitSetNumWords(NUM_BITS);
+
+        void Set(U32 index) { SM_ASSERT(index < NUM_BITS); m_words[index / kBitSetWordBits] |= CalcBitSetWordMask(index); }
+        void UnSet(U32 index) { SM_ASSERT(index < NUM_BITS); m_words[index / kBitSetWordBits] &= ~CalcBitSetWordMask(index); }
+        bool IsSet(U32 index) const { SM_ASSERT(index < NUM_BITS); return (m_words[index / kBitSetWordBits] & CalcBitSetWordMask(index)) != 0; }
+        void SetAll() { BitWordsSetAll(m_words, NUM_BITS); }
+        void ClearAll() { ::memset(m_words, 0, sizeof(m_words)); }
+
+        void And(const FixedBitSet& other) { BitWordsAnd(m_words, other.m_words, kNumWords); }
+        void Or(const FixedBitSet& other) { BitWordsOr(m_words, other.m_words, kNumWords); }
+        void AndNot(const FixedBitSet& other) { BitWordsAndNot(m_words, other.m_words, kNumWords); }
+
+        U32 CountSetBits() const { return BitWordsCountSetBits(m_words, kNumWords); }
+        U32 FindFirstSet() const { return BitWordsFindNextSet(m_words, kNumWords, 0); }
+        U32 FindNextSet(U32 startIndex) const { return BitWordsFindNextSet(m_words, kNumWords, startIndex); }
+
+        template<typename Func>
+        void ForEachSetBit(Func&& func) const { BitWordsForEachSetBit(m_words, kNumWords, func); }
+
+        U32 GetNumBits() const { return NUM_BITS; }
+
+        U64 m_words[kNumWords] = {};
+    };
+
+    // Bit set sized at runtime with storage from a LinearAllocator or HeapAllocator, new bits start cleared
+    class BitSet
+    {
+    public:
+        BitSet() = default;
+        BitSet(LinearAllocator* allocator, U32 numBits = 0) :m_words(allocator) { Resize(numBits); }
+        BitSet(HeapAllocator* allocator, U32 numBits = 0) :m_words(allocator) { Resize(numBits); }
+
+        void Resize(U32 numBits);
+
+        void Set(U32 index) { SM_ASSERT(index < m_numBits); m_words.m_pData[index / kBitSetWordBits] |= CalcBitSetWordMask(index); }
+        void UnSet(U32 index) { SM_ASSERT(index < m_numBits); m_words.m_pData[index / kBitSetWordBits] &= ~CalcBitSetWordMask(index); }
+        bool IsSet(U32 index) const { SM_ASSERT(index < m_numBits); return (m_words.m_pData[index / kBitSetWordBits] & CalcBitSetWordMask(index)) != 0; }
+        void SetAll() { BitWordsSetAll(m_words.m_pData, m_numBits); }
+        void ClearAll() { ::memset(m_words.m_pData, 0, sizeof(U64) * m_words.m_numItems); }
+
+        // Combining sets of different sizes only touches the bits they have in common
+        void And(const BitSet& other);
+        void Or(const BitSet& other);
+        void AndNot(const BitSet& other) { BitWordsAndNot(m_words.m_pData, other.m_words.m_pData, CalcNumCommonWords(other)); }
+
+        U32 CountSetBits() const { return BitWordsCountSetBits(m_words.m_pData, GetNumWords()); }
+        U32 FindFirstSet() const { return BitWordsFindNextSet(m_words.m_pData, GetNumWords(), 0); }
+        U32 FindNextSet(U32 startIndex) const { return BitWordsFindNextSet(m_words.m_pData, GetNumWords(), startIndex); }
+
+        template<typename Func>
+        void ForEachSetBit(Func&& func) const { BitWordsForEachSetBit(m_words.m_pData, GetNumWords(), func); }
+
+        U32 GetNumBits() const { return m_numBits; }
+        U32 GetNumWords() const { return (U32)m_words.m_numItems; }
+
+        Array<U64> m_words;
+        U32 m_numBits = 0;
+
+    private:
+        U32 CalcNumCommonWords(const BitSet& other) const { return GetNumWords() < other.GetNumWords() ? GetNumWords() : other.GetNumWords(); }
+    };
+
+    inline void BitSet::Resize(U32 numBits)
+    {
+        U32 oldNumWords = GetNumWords();
+        U32 newNumWords = CalcBitSetNumWords(numBits);
+        m_words.Resize(newNumWords);
+        if(newNumWords > oldNumWords)
+        {
+            ::memset(m_words.m_pData + oldNumWords, 0, sizeof(U64) * (newNumWords - oldNumWords));
+        }
+
+        // keep the bits past the end clear when shrinking inside the last word
+        if(numBits < m_numBits && numBits % kBitSetWordBits != 0)
+        {
+            m_words.m_pData[newNumWords - 1] &= CalcBitSetWordMask(numBits) - 1;
+        }
+        m_numBits = numBits;
+    }
+
+    inline void BitSet::And(const BitSet& other)
+    {
+        U32 numCommonWords = CalcNumCommonWords(other);
+        BitWordsAnd(m_words.m_pData, other.m_words.m_pData, numCommonWords);
+        if(GetNumWords() > numCommonWords)
+        {
+            ::memset(m_words.m_pData + numCommonWords, 0, sizeof(U64) * (GetNumWords() - numCommonWords));
+        }
+    }
+
+    inline void BitSet::Or(const BitSet& other)
+    {
+        U32 numCommonWords = CalcNumCommonWords(other);
+        BitWordsOr(m_words.m_pData, other.m_words.m_pData, numCommonWords);
+
+        // a longer set can carry bits past our end in the shared last word
+        if(m_numBits % kBitSetWordBits != 0 && numCommonWords == GetNumWords() && numCommonWords > 0)
+        {
+            m_words.m_pData[numCommonWords - 1] &= CalcBitSetWordMask(m_numBits) - 1;
+        }
+    }
+
+    // Two level bit set, every bit in the summary level says whether the matching 64 bit word has anything set.
+    // Searches and set operations skip empty words 64 at a time, which makes sparse sets over large ranges cheap to
+    // iterate and combine.
+    class HierarchicalBitSet
+    {
+    public:
+        HierarchicalBitSet() = default;
+        HierarchicalBitSet(LinearAllocator* allocator, U32 numBits = 0) :m_bits(allocator), m_summary(allocator) { Resize(numBits); }
+        HierarchicalBitSet(HeapAllocator* allocator, U32 numBits = 0) :m_bits(allocator), m_summary(allocator) { Resize(numBits); }
+
+        void Resize(U32 numBits);
+
+        void Set(U32 index);
+        void UnSet(U32 index);
+        bool IsSet(U32 index) const { return m_bits.IsSet(index); }
+        void SetAll();
+        void ClearAll();
+
+        void And(const HierarchicalBitSet& other);
+        void Or(const HierarchicalBitSet& other);
+        void AndNot(const HierarchicalBitSet& other);
+
+        U32 CountSetBits() const;
+        U32 FindFirstSet() const { return FindNextSet(0); }
+        U32 FindNextSet(U32 startIndex) const;
+
+        template<typename Func>
+        void ForEachSetBit(Func&& func) const;
+
+        U32 GetNumBits() const { return m_bits.GetNumBits(); }
+
+        BitSet m_bits;
+        BitSet m_summary;
+
+    private:
+        void UpdateSummary(U32 wordIndex);
+    };
+
+    inline void HierarchicalBitSet::Resize(U32 numBits)
+    {
+        m_bits.Resize(numBits);
+        m_summary.Resize(m_bits.GetNumWords());
+        for(U32 i = 0; i < m_bits.GetNumWords(); i++)
+        {
+            UpdateSummary(i);
+        }
+    }
+
+    inline void HierarchicalBitSet::Set(U32 index)
+    {
+        m_bits.Set(index);
+        m_summary.Set(index / kBitSetWordBits);
+    }
+
+    inline void HierarchicalBitSet::UnSet(U32 index)
+    {
+        m_bits.UnSet(index);
+        UpdateSummary(index / kBitSetWordBits);
+    }
+
+    inline void HierarchicalBitSet::SetAll()
+    {
+        m_bits.SetAll();
+        m_summary.SetAll();
+    }
+
+    inline void HierarchicalBitSet::ClearAll()
+    {
+        // only the words the summary says are non zero need clearing
+        U64* pWords = m_bits.m_words.m_pData;
+        m_summary.ForEachSetBit([pWords](U32 wordIndex) { pWords[wordIndex] = 0; });
+        m_summary.ClearAll();
+    }
+
+    inline void HierarchicalBitSet::And(const HierarchicalBitSet& other)
+    {
+        U64* pWords = m_bits.m_words.m_pData;
+        const U64* pOtherWords = other.m_bits.m_words.m_pData;
+        U32 numOtherWords = other.m_bits.GetNumWords();
+        m_summary.ForEachSetBit([&](U32 wordIndex) {
+            if(wordIndex < numOtherWords && other.m_summary.IsSet(wordIndex))
+            {
+                pWords[wordIndex] &= pOtherWords[wordIndex];
+            }
+            else
+            {
+                pWords[wordIndex] = 0;
+            }
+            UpdateSummary(wordIndex);
+        });
+    }
+
+    inline void HierarchicalBitSet::Or(const HierarchicalBitSet& other)
+    {
+        U64* pWords = m_bits.m_words.m_pData;
+        const U64* pOtherWords = other.m_bits.m_words.m_pData;
+        U32 numWords = m_bits.GetNumWords();
+        other.m_summary.ForEachSetBit([&](U32 wordIndex) {
+            if(wordIndex < numWords)
+            {
+                pWords[wordIndex] |= pOtherWords[wordIndex];
+                m_summary.Set(wordIndex);
+            }
+        });
+
+        // the other set may be longer and carry bits past our end in the shared last word
+        if(GetNumBits() % kBitSetWordBits != 0 && numWords > 0)
+        {
+            pWords[numWords - 1] &= CalcBitSetWordMask(GetNumBits()) - 1;
+            UpdateSummary(numWords - 1);
+        }
+    }
+
+    inline void HierarchicalBitSet::AndNot(const HierarchicalBitSet& other)
+    {
+        U64* pWords = m_bits.m_words.m_pData;
+        const U64* pOtherWords = other.m_bits.m_words.m_pData;
+        U32 numOtherWords = other.m_bits.GetNumWords();
+        m_summary.ForEachSetBit([&](U32 wordIndex) {
+            if(wordIndex < numOtherWords)
+            {
+                pWords[wordIndex] &= ~pOtherWords[wordIndex];
+                UpdateSummary(wordIndex);
+            }
+        });
+    }
+
+    inline U32 HierarchicalBitSet::CountSetBits() const
+    {
+        U32 count = 0;
+        const U64* pWords = m_bits.m_words.m_pData;
+        m_summary.ForEachSetBit([&](U32 wordIndex) { count += SM::CountSetBits(pWords[wordIndex]); });
+        return count;
+    }
+
+    inline U32 HierarchicalBitSet::FindNextSet(U32 startIndex) const
+    {
+        U32 wordIndex = startIndex / kBitSetWordBits;
+        if(wordIndex >= m_bits.GetNumWords())
+            return kBitSetInvalidIndex;
+
+        U64 word = m_bits.m_words.m_pData[wordIndex] & (~0ull << (startIndex % kBitSetWordBits));
+        if(word != 0)
+            return wordIndex * kBitSetWordBits + FindFirstSetBit(word);
+
+        wordIndex = m_summary.FindNextSet(wordIndex + 1);
+        if(wordIndex == kBitSetInvalidIndex)
+            return kBitSetInvalidIndex;
+
+        return wordIndex * kBitSetWordBits + FindFirstSetBit(m_bits.m_words.m_pData[wordIndex]);
+    }
+
+    template<typename Func>
+    void HierarchicalBitSet::ForEachSetBit(Func&& func) const
+    {
+        const U64* pWords = m_bits.m_words.m_pData;
+        m_summary.ForEachSetBit([&](U32 wordIndex) {
+            U64 word = pWords[wordIndex];
+            while(word != 0)
+            {
+                func(wordIndex * kBitSetWordBits + FindFirstSetBit(word));
+                word &= word - 1;
+            }
+        });
+    }
+
+    inline void HierarchicalBitSet::UpdateSummary(U32 wordIndex)
+    {
+        if(m_bits.m_words.m_pData[wordIndex] != 0)
+        {
+            m_summary.Set(wordIndex);
+        }
+        else
+        {
+            m_summary.UnSet(wordIndex);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // BucketArray
+    //-------------------------------------------------------------------------
+    // Array built from fixed size chunks that never move, so pointers to items stay valid until the item is removed.
+    // Each chunk tracks its occupied slots in a bitmask and chunks with free slots are kept on a list, which makes
+    // adding O(1) and reuses holes left by removals. Items are addressed by pointer or by a flat index of
+    // chunk * CHUNK_SIZE + slot. Iteration walks chunk by chunk and only visits occupied slots.
+    template<typename T, U32 CHUNK_SIZE = 64>
+    class BucketArray
+    {
+    public:
+        struct Chunk
+        {
+            T* GetItems() { return (T*)m_items; }
+
+            alignas(T) Byte m_items[sizeof(T) * CHUNK_SIZE];
+            FixedBitSet<CHUNK_SIZE> m_occupied;
+            U32 m_numOccupied = 0;
+            U32 m_chunkIndex = 0;
+            Chunk* m_pNextWithFree = nullptr;
+        };
+
+        BucketArray() = default;
+        BucketArray(LinearAllocator* allocator) :m_chunks(allocator), m_pLinearAllocator(allocator) {}
+        BucketArray(HeapAllocator* allocator) :m_chunks(allocator), m_pHeapAllocator(allocator) {}
+        BucketArray(const BucketArray&) = delete;
+        BucketArray& operator=(const BucketArray&) = delete;
+        ~BucketArray();
+
+        T* Add(const T& item, U32* pOutIndex = nullptr) { return new(AllocSlot(pOutIndex)) T(item); }
+        T* Add(T&& item, U32* pOutIndex = nullptr) { return new(AllocSlot(pOutIndex)) T(std::move(item)); }
+        void Remove(U32 index);
+        void Remove(T* pItem) { Remove(FindIndex(pItem)); }
+        void Clear();
+
+        T& operator[](U32 index);
+        bool IsValidIndex(U32 index) const;
+
+        // Finding the index of a pointer walks the chunk table, keep the index around when removal is frequent
+        U32 FindIndex(const T* pItem) const;
+
+        template<typename Func>
+        void ForEach(Func&& func);
+
+        size_t GetCount() const { return m_numItems; }
+        bool IsEmpty() const { return m_numItems == 0; }
+
+        Array<Chunk*> m_chunks;
+        Chunk* m_pFirstWithFree = nullptr;
+        size_t m_numItems = 0;
+        LinearAllocator* m_pLinearAllocator = nullptr;
+        HeapAllocator* m_pHeapAllocator = nullptr;
+
+    private:
+        void* AllocSlot(U32* pOutIndex);
+        Chunk* AllocChunk();
+    };
+
+    template<typename T, U32 CHUNK_SIZE>
+    BucketArray<T, CHUNK_SIZE>::~BucketArray()
+    {
+        Clear();
+        if(m_pHeapAllocator != nullptr)
+        {
+            for(Chunk* pChunk : m_chunks)
+            {
+                pChunk->~Chunk();
+                m_pHeapAllocator->Free(pChunk);
+            }
+        }
+    }
+
+    template<typename T, U32 CHUNK_SIZE>
+    void BucketArray<T, CHUNK_SIZE>::Remove(U32 index)
+    {
+        SM_ASSERT(IsValidIndex(index));
+        Chunk* pChunk = m_chunks[index / CHUNK_SIZE];
+        U32 slot = index % CHUNK_SIZE;
+
+        pChunk->GetItems()[slot].~T();
+        pChunk->m_occupied.UnSet(slot);
+        m_numItems--;
+
+        // a chunk that was full is not on the free list yet
+        if(pChunk->m_numOccupied-- == CHUNK_SIZE)
+        {
+            pChunk->m_pNextWithFree = m_pFirstWithFree;
+            m_pFirstWithFree = pChunk;
+        }
+    }
+
+    template<typename T, U32 CHUNK_SIZE>
+    void BucketArray<T, CHUNK_SIZE>::Clear()
+    {
+        m_pFirstWithFree = nullptr;
+        for(size_t i = m_chunks.m_numItems; i > 0; i--)
+        {
+            Chunk* pChunk = m_chunks[i - 1];
+            if constexpr (!std::is_trivially_destructible_v<T>)
+            {
+                T* pItems = pChunk->GetItems();
+                pChunk->m_occupied.ForEachSetBit([pItems](U32 slot) { pItems[slot].~T(); });
+            }
+            pChunk->m_occupied.ClearAll();
+            pChunk->m_numOccupied = 0;
+
+            // rebuilt back to front so adds fill the lowest chunks first again
+            pChunk->m_pNextWithFree = m_pFirstWithFree;
+            m_pFirstWithFree = pChunk;
+        }
+        m_numItems = 0;
+    }
+
+    template<typename T, U32 CHUNK_SIZE>
+    T& BucketArray<T, CHUNK_SIZE>::operator[](U32 index)
+    {
+        SM_ASSERT(IsValidIndex(index));
+        return m_chunks[index / CHUNK_SIZE]->GetItems()[index % CHUNK_SIZE];
+    }
+
+    template<typename T, U32 CHUNK_SIZE>
+    bool BucketArray<T, CHUNK_SIZE>::IsValidIndex(U32 index) const
+    {
+        U32 chunkIndex = index / CHUNK_SIZE;
+        return chunkIndex < m_chunks.m_numItems && m_chunks[chunkIndex]->m_occupied.IsSet(index % CHUNK_SIZE);
+    }
+
+    template<typename T, U32 CHUNK_SIZE>
+    U32 BucketArray<T, CHUNK_SIZE>::FindIndex(const T* pItem) const
+    {
+        for(const Chunk* pChunk : m_chunks)
+        {
+            const T* pItems = (const T*)pChunk->m_items;
+            if(pItem >= pItems && pItem < pItems + CHUNK_SIZE)
+                return pChunk->m_chunkIndex * CHUNK_SIZE + (U32)(pItem - pItems);
+        }
+
+        SM_ERROR_MSG("Item does not belong to this bucket array");
+        return 0;
+    }
+
+    template<typename T, U32 CHUNK_SIZE>
+    template<typename Func>
+    void BucketArray<T, CHUNK_SIZE>::ForEach(Func&& func)
+    {
+        for(Chunk* pChunk : m_chunks)
+        {
+            if(pChunk->m_numOccupied == 0)
+                continue;
+
+            T* pItems = pChunk->GetItems();
+            pChunk->m_occupied.ForEachSetBit([&](U32 slot) { func(pItems[slot]); });
+        }
+    }
+
+    template<typename T, U32 CHUNK_SIZE>
+    void* BucketArray<T, CHUNK_SIZE>::AllocSlot(U32* pOutIndex)
+    {
+        Chunk* pChunk = m_pFirstWithFree != nullptr ? m_pFirstWithFree : AllocChunk();
+
+        U32 slot = kBitSetInvalidIndex;
+        for(U32 i = 0; i < FixedBitSet<CHUNK_SIZE>::kNumWords; i++)
+        {
+            U64 freeBits = ~pChunk->m_occupied.m_words[i];
+            if(freeBits != 0)
+            {
+                slot = i * kBitSetWordBits + FindFirstSetBit(freeBits);
+                break;
+            }
+        }
+        SM_ASSERT(slot < CHUNK_SIZE);
+
+        pChunk->m_occupied.Set(slot);
+        m_numItems++;
+
+        // the chunk we fill is always the list head so a full chunk comes off in O(1)
+        if(++pChunk->m_numOccupied == CHUNK_SIZE)
+        {
+            m_pFirstWithFree = pChunk->m_pNextWithFree;
+            pChunk->m_pNextWithFree = nullptr;
+        }
+
+        if(pOutIndex != nullptr)
+        {
+            *pOutIndex = pChunk->m_chunkIndex * CHUNK_SIZE + slot;
+        }
+        return &pChunk->GetItems()[slot];
+    }
+
+    template<typename T, U32 CHUNK_SIZE>
+    typename BucketArray<T, CHUNK_SIZE>::Chunk* BucketArray<T, CHUNK_SIZE>::AllocChunk()
+    {
+        void* pMemory = nullptr;
+        if(m_pLinearAllocator != nullptr)
+        {
+            pMemory = m_pLinearAllocator->Alloc(sizeof(Chunk), alignof(Chunk));
+        }
+        else
+        {
+            SM_ASSERT(m_pHeapAllocator != nullptr);
+            pMemory = m_pHeapAllocator->Alloc(sizeof(Chunk), alignof(Chunk) > kAlign16 ? (U32)alignof(Chunk) : (U32)kAlign16);
+        }
+
+        Chunk* pChunk = new(pMemory) Chunk;
+        pChunk->m_chunkIndex = (U32)m_chunks.m_numItems;
+        m_chunks.Push(pChunk);
+
+        pChunk->m_pNextWithFree = m_pFirstWithFree;
+        m_pFirstWithFree = pChunk;
+        return pChunk;
+    }
+
+    //-------------------------------------------------------------------------
+    // PriorityQueue
+    //-------------------------------------------------------------------------
+    template<typename T>
+    struct DefaultLess
+    {
+        bool operator()(const T& a, const T& b) const { return a < b; }
+    };
+
+    // Binary min heap, Top is the item that compares smallest. Push hands back a handle that stays attached to the item
+    // while it moves around the heap so its priority can be changed or it can be removed in O(log n).
+    template<typename T, typename Less = DefaultLess<T>>
+    class PriorityQueue
+    {
+    public:
+        static constexpr U32 kInvalidHandle = 0xffffffff;
+
+        PriorityQueue() = default;
+        PriorityQueue(LinearAllocator* allocator, size_t initialCapacity = 0);
+        PriorityQueue(HeapAllocator* allocator, size_t initialCapacity = 0);
+
+        U32 Push(const T& item);
+        const T& Top() const { SM_ASSERT(!IsEmpty()); return m_heap[0].m_item; }
+        U32 TopHandle() const { SM_ASSERT(!IsEmpty()); return m_heap[0].m_handle; }
+        void Pop();
+        bool Pop(T* pOutItem);
+
+        // DecreaseKey only sifts up, Update handles a priority moving in either direction
+        void DecreaseKey(U32 handle, const T& item);
+        void Update(U32 handle, const T& item);
+        void Remove(U32 handle);
+        bool Contains(U32 handle) const { return handle < m_handleToHeapIndex.m_numItems && m_handleToHeapIndex[handle] != kInvalidHandle; }
+        const T& Get(U32 handle) const { SM_ASSERT(Contains(handle)); return m_heap[m_handleToHeapIndex[handle]].m_item; }
+        void Clear();
+
+        size_t GetCount() const { return m_heap.m_numItems; }
+        bool IsEmpty() const { return m_heap.IsEmpty(); }
+
+    private:
+        struct Entry
+        {
+            T m_item;
+            U32 m_handle;
+        };
+
+        void SiftUp(U32 heapIndex);
+        void SiftDown(U32 heapIndex);
+        void Place(U32 heapIndex, Entry&& entry);
+        void RemoveAt(U32 heapIndex);
+
+        Array<Entry> m_heap;
+        Array<U32> m_handleToHeapIndex;
+        Array<U32> m_freeHandles;
+        Less m_less;
+    };
+
+    template<typename T, typename Less>
+    PriorityQueue<T, Less>::PriorityQueue(LinearAllocator* allocator, size_t initialCapacity)
+        :m_heap(allocator, initialCapacity)
+        ,m_handleToHeapIndex(allocator, initialCapacity)
+        ,m_freeHandles(allocator)
+    {
+    }
+
+    template<typename T, typename Less>
+    PriorityQueue<T, Less>::PriorityQueue(HeapAllocator* allocator, size_t initialCapacity)
+        :m_heap(allocator, initialCapacity)
+        ,m_handleToHeapIndex(allocator, initialCapacity)
+        ,m_freeHandles(allocator)
+    {
+    }
+
+    template<typename T, typename Less>
+    U32 PriorityQueue<T, Less>::Push(const T& item)
+    {
+        U32 handle = 0;
+        if(!m_freeHandles.IsEmpty())
+        {
+            handle = m_freeHandles.Back();
+            m_freeHandles.Pop();
+        }
+        else
+        {
+            handle = (U32)m_handleToHeapIndex.m_numItems;
+            m_handleToHeapIndex.Push(kInvalidHandle);
+        }
+
+        U32 heapIndex = (U32)m_heap.m_numItems;
+        m_heap.Push(Entry{ item, handle });
+        m_handleToHeapIndex[handle] = heapIndex;
+        SiftUp(heapIndex);
+        return handle;
+    }
+
+    template<typename T, typename Less>
+    void PriorityQueue<T, Less>::Pop()
+    {
+        SM_ASSERT(!IsEmpty());
+        RemoveAt(0);
+    }
+
+    template<typename T, typename Less>
+    bool PriorityQueue<T, Less>::Pop(T* pOutItem)
+    {
+        if(IsEmpty())
+            return false;
+
+        *pOutItem = std::move(m_heap[0].m_item);
+        RemoveAt(0);
+        return true;
+    }
+
+    template<typename T, typename Less>
+    void PriorityQueue<T, Less>::DecreaseKey(U32 handle, const T& item)
+    {
+        SM_ASSERT(Contains(handle));
+        U32 heapIndex = m_handleToHeapIndex[handle];
+        SM_ASSERT(!m_less(m_heap[heapIndex].m_item, item));
+        m_heap[heapIndex].m_item = item;
+        SiftUp(heapIndex);
+    }
+
+    template<typename T, typename Less>
+    void PriorityQueue<T, Less>::Update(U32 handle, const T& item)
+    {
+        SM_ASSERT(Contains(handle));
+        U32 heapIndex = m_handleToHeapIndex[handle];
+        bool bDecreased = m_less(item, m_heap[heapIndex].m_item);
+        m_heap[heapIndex].m_item = item;
+        if(bDecreased)
+        {
+            SiftUp(heapIndex);
+        }
+        else
+        {
+            SiftDown(heapIndex);
+        }
+    }
+
+    template<typename T, typename Less>
+    void PriorityQueue<T, Less>::Remove(U32 handle)
+    {
+        SM_ASSERT(Contains(handle));
+        RemoveAt(m_handleToHeapIndex[handle]);
+    }
+
+    template<typename T, typename Less>
+    void PriorityQueue<T, Less>::Clear()
+    {
+        m_heap.Clear();
+        m_handleToHeapIndex.Clear();
+        m_freeHandles.Clear();
+    }
+
+    template<typename T, typename Less>
+    void PriorityQueue<T, Less>::SiftUp(U32 heapIndex)
+    {
+        // hold the moving entry aside and shift parents down into the hole, placing it once at the end
+        Entry entry = std::move(m_heap[heapIndex]);
+        while(heapIndex > 0)
+        {
+            U32 parent = (heapIndex - 1) / 2;
+            if(!m_less(entry.m_item, m_heap[parent].m_item))
+                break;
+
+            Place(heapIndex, std::move(m_heap[parent]));
+            heapIndex = parent;
+        }
+        Place(heapIndex, std::move(entry));
+    }
+
+    template<typename T, typename Less>
+    void PriorityQueue<T, Less>::SiftDown(U32 heapIndex)
+    {
+        const U32 count = (U32)m_heap.m_numItems;
+        Entry entry = std::move(m_heap[heapIndex]);
+        while(true)
+        {
+            U32 child = heapIndex * 2 + 1;
+            if(child >= count)
+                break;
+
+            if(child + 1 < count && m_less(m_heap[child + 1].m_item, m_heap[child].m_item))
+            {
+                child++;
+            }
+
+            if(!m_less(m_heap[child].m_item, entry.m_item))
+                break;
+
+            Place(heapIndex, std::move(m_heap[child]));
+            heapIndex = child;
+        }
+        Place(heapIndex, std::move(entry));
+    }
+
+    template<typename T, typename Less>
+    void PriorityQueue<T, Less>::Place(U32 heapIndex, Entry&& entry)
+    {
+        m_heap[heapIndex] = std::move(entry);
+        m_handleToHeapIndex[m_heap[heapIndex].m_handle] = heapIndex;
+    }
+
+    template<typename T, typename Less>
+    void PriorityQueue<T, Less>::RemoveAt(U32 heapIndex)
+    {
+        U32 handle = m_heap[heapIndex].m_handle;
+        m_handleToHeapIndex[handle] = kInvalidHandle;
+        m_freeHandles.Push(handle);
+
+        U32 lastIndex = (U32)m_heap.m_numItems - 1;
+        if(heapIndex != lastIndex)
+        {
+            Place(heapIndex, std::move(m_heap[lastIndex]));
+            m_heap.Pop();
+
+            // the item pulled from the back can belong above or below the hole
+            if(heapIndex > 0 && m_less(m_heap[heapIndex].m_item, m_heap[(heapIndex - 1) / 2].m_item))
+            {
+                SiftUp(heapIndex);
+            }
+            else
+            {
+                SiftDown(heapIndex);
+            }
+        }
+        else
+        {
+            m_heap.Pop();
+        }
+    }
 }
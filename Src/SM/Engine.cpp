@@ -3,7 +3,14 @@
 
 #include "SM/Util.cpp"
 #include "SM/Math.cpp"
+#include "SM/MathBatch.cpp"
+#include "SM/Bvh.cpp"
+#include "SM/Geometry.cpp"
 #include "SM/Memory.cpp"
+#include "SM/Random.cpp"
+#include "SM/Simd.cpp"
+#include "SM/Sort.cpp"
+#include "SM/Timer.cpp"
 #include "SM/Renderer/VulkanRenderer.cpp"
 
 #include "ThirdParty/imgui/imgui.cpp"
@@ -22,7 +29,7 @@ void SM::Init(const EngineConfig& config)
     SM::Platform::Init();
     s_engineConfig = config;
     SeedRng();
-    InitBuiltInAllocators();
+    InitBuiltInAllocators(config.m_bUseLargePages);
 }
 
 void SM::Exit()
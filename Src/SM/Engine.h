@@ -7,6 +7,9 @@ namespace SM
     struct EngineConfig
     {
         const char* m_rawAssetsDir = nullptr;
+
+        // back built in arenas and the built in heap with large pages when the OS allows it, they become fixed size and fully committed at init
+        bool m_bUseLargePages = false;
     };
 
     void Init(const EngineConfig& config);
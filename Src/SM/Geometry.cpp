@@ -0,0 +1,331 @@
+#include "SM/Geometry.h"
+
+using namespace SM;
+
+// Squared lengths below this make a segment a point
+static const F32 kSegmentDegenerateLengthSq = 1e-12f;
+
+static void GetObbAxes(const Obb& obb, Vec3* pOutAxes)
+{
+    pOutAxes[0] = obb.m_axes.GetIBasis();
+    pOutAxes[1] = obb.m_axes.GetJBasis();
+    pOutAxes[2] = obb.m_axes.GetKBasis();
+}
+
+// point relative to the obb center in the obb's local axes
+static Vec3 ToObbLocal(const Obb& obb, const Vec3& point)
+{
+    Vec3 delta = point - obb.m_center;
+    return Vec3(Dot(delta, obb.m_axes.GetIBasis()), Dot(delta, obb.m_axes.GetJBasis()), Dot(delta, obb.m_axes.GetKBasis()));
+}
+
+// With the tiny component from CalcRayInvDir a ray lying exactly on a slab's far plane would leave the slab at t = 0.
+// A slab the ray is parallel to is all of t when the origin is between its planes and none of it otherwise.
+static void CalcSlabTs(F32 toMin, F32 toMax, F32 invDir, F32& outT0, F32& outT1)
+{
+    if(::fabsf(invDir) >= kRayParallelInvDir)
+    {
+        bool bOutside = toMin > 0.0f || toMax < 0.0f;
+        outT0 = bOutside ? INFINITY : -INFINITY;
+        outT1 = INFINITY;
+        return;
+    }
+
+    outT0 = toMin * invDir;
+    outT1 = toMax * invDir;
+}
+
+// Slab test with the box given by the vectors from the ray origin to its min and max corners
+static bool IntersectRaySlabs(const Vec3& toMin, const Vec3& toMax, const Vec3& invDir, F32& inOutMaxT)
+{
+    F32 tx0, tx1, ty0, ty1, tz0, tz1;
+    CalcSlabTs(toMin.x, toMax.x, invDir.x, tx0, tx1);
+    CalcSlabTs(toMin.y, toMax.y, invDir.y, ty0, ty1);
+    CalcSlabTs(toMin.z, toMax.z, invDir.z, tz0, tz1);
+
+    F32 entryT = Max(Max(Min(tx0, tx1), Min(ty0, ty1)), Max(Min(tz0, tz1), 0.0f));
+    F32 exitT = Min(Min(Max(tx0, tx1), Max(ty0, ty1)), Min(Max(tz0, tz1), inOutMaxT));
+    if(exitT < entryT)
+        return false;
+
+    inOutMaxT = entryT;
+    return true;
+}
+
+//-------------------------------------------------------------------------
+// Primitives
+//-------------------------------------------------------------------------
+Obb Obb::CreateFromAabb(const Aabb& aabb, const Mat44& transform)
+{
+    Vec3 i = transform.GetIBasis();
+    Vec3 j = transform.GetJBasis();
+    Vec3 k = transform.GetKBasis();
+    F32 scaleI = i.CalcLength();
+    F32 scaleJ = j.CalcLength();
+    F32 scaleK = k.CalcLength();
+
+    Obb obb;
+    obb.m_center = transform.TransformPoint(aabb.m_center);
+    obb.m_extents = Vec3(aabb.m_extents.x * scaleI, aabb.m_extents.y * scaleJ, aabb.m_extents.z * scaleK);
+    obb.m_axes = Mat33(i / scaleI, j / scaleJ, k / scaleK);
+    return obb;
+}
+
+//-------------------------------------------------------------------------
+// Closest points
+//-------------------------------------------------------------------------
+Vec3 SM::CalcClosestPoint(const Obb& obb, const Vec3& point)
+{
+    Vec3 local = ToObbLocal(obb, point);
+    Vec3 axes[3];
+    GetObbAxes(obb, axes);
+    return obb.m_center + (axes[0] * Clamp(local.x, -obb.m_extents.x, obb.m_extents.x))
+                        + (axes[1] * Clamp(local.y, -obb.m_extents.y, obb.m_extents.y))
+                        + (axes[2] * Clamp(local.z, -obb.m_extents.z, obb.m_extents.z));
+}
+
+F32 SM::CalcClosestPointsOnSegments(const Vec3& p0, const Vec3& p1, const Vec3& q0, const Vec3& q1, Vec3& outOnP, Vec3& outOnQ)
+{
+    // Ericson, Real-Time Collision Detection 5.1.9. s and t are the closest points' fractions along each segment.
+    Vec3 dirP = p1 - p0;
+    Vec3 dirQ = q1 - q0;
+    Vec3 r = p0 - q0;
+    F32 lengthSqP = Dot(dirP, dirP);
+    F32 lengthSqQ = Dot(dirQ, dirQ);
+    F32 f = Dot(dirQ, r);
+
+    F32 s = 0.0f;
+    F32 t = 0.0f;
+    if(lengthSqP <= kSegmentDegenerateLengthSq)
+    {
+        if(lengthSqQ > kSegmentDegenerateLengthSq)
+        {
+            t = Clamp(f / lengthSqQ, 0.0f, 1.0f);
+        }
+    }
+    else
+    {
+        F32 c = Dot(dirP, r);
+        if(lengthSqQ <= kSegmentDegenerateLengthSq)
+        {
+            s = Clamp(-c / lengthSqP, 0.0f, 1.0f);
+        }
+        else
+        {
+            // closest points of the infinite lines, parallel lines pick s = 0
+            F32 b = Dot(dirP, dirQ);
+            F32 denom = (lengthSqP * lengthSqQ) - (b * b);
+            s = denom != 0.0f ? Clamp(((b * f) - (c * lengthSqQ)) / denom, 0.0f, 1.0f) : 0.0f;
+            t = ((b * s) + f) / lengthSqQ;
+
+            // t off the end of q, clamp it and find s again for the clamped end
+            if(t < 0.0f)
+            {
+                t = 0.0f;
+                s = Clamp(-c / lengthSqP, 0.0f, 1.0f);
+            }
+            else if(t > 1.0f)
+            {
+                t = 1.0f;
+                s = Clamp((b - c) / lengthSqP, 0.0f, 1.0f);
+            }
+        }
+    }
+
+    outOnP = p0 + (dirP * s);
+    outOnQ = q0 + (dirQ * t);
+    Vec3 delta = outOnP - outOnQ;
+    return Dot(delta, delta);
+}
+
+//-------------------------------------------------------------------------
+// Ray tests
+//-------------------------------------------------------------------------
+bool SM::IntersectRayAabb(const Ray& ray, const Aabb& aabb, F32& inOutMaxT)
+{
+    Vec3 toMin = (aabb.m_center - aabb.m_extents) - ray.m_origin;
+    Vec3 toMax = (aabb.m_center + aabb.m_extents) - ray.m_origin;
+    return IntersectRaySlabs(toMin, toMax, CalcRayInvDir(ray.m_dir), inOutMaxT);
+}
+
+bool SM::IntersectRayObb(const Ray& ray, const Obb& obb, F32& inOutMaxT)
+{
+    // the box is an aabb centered on the origin in its own axes, t is unchanged since they are orthonormal
+    Vec3 localOrigin = ToObbLocal(obb, ray.m_origin);
+    Vec3 localDir(Dot(ray.m_dir, obb.m_axes.GetIBasis()), Dot(ray.m_dir, obb.m_axes.GetJBasis()), Dot(ray.m_dir, obb.m_axes.GetKBasis()));
+    return IntersectRaySlabs(-obb.m_extents - localOrigin, obb.m_extents - localOrigin, CalcRayInvDir(localDir), inOutMaxT);
+}
+
+bool SM::IntersectRaySphere(const Ray& ray, const Sphere& sphere, F32& inOutMaxT)
+{
+    // Roots of a t^2 + 2b t + c = 0
+    Vec3 toOrigin = ray.m_origin - sphere.m_center;
+    F32 radiusSq = sphere.m_radius * sphere.m_radius;
+    F32 a = Dot(ray.m_dir, ray.m_dir);
+    F32 b = Dot(toOrigin, ray.m_dir);
+    F32 c = Dot(toOrigin, toOrigin) - radiusSq;
+
+    // outside and pointing away
+    if(c > 0.0f && b > 0.0f)
+        return false;
+
+    // b^2 - ac rewritten with the distance from the center to the line, which doesn't cancel catastrophically for small
+    // spheres far from the ray origin
+    Vec3 toLine = toOrigin - (ray.m_dir * (b / a));
+    F32 discriminant = a * (radiusSq - Dot(toLine, toLine));
+    if(discriminant < 0.0f)
+        return false;
+
+    // the near root as c / (sqrt(disc) - b) instead of (-b - sqrt(disc)) / a, both terms are positive when outside
+    F32 t = c > 0.0f ? c / (::sqrtf(discriminant) - b) : 0.0f;
+    if(t >= inOutMaxT)
+        return false;
+
+    inOutMaxT = t;
+    return true;
+}
+
+bool SM::IntersectRayPlane(const Ray& ray, const Plane& plane, F32& inOutMaxT)
+{
+    F32 denom = Dot(plane.m_normal, ray.m_dir);
+    if(denom == 0.0f)
+        return false;
+
+    F32 t = -CalcSignedDistance(plane, ray.m_origin) / denom;
+    if(t < 0.0f || t >= inOutMaxT)
+        return false;
+
+    inOutMaxT = t;
+    return true;
+}
+
+bool SM::IntersectRayTriangle(const Vec3& origin, const Vec3& dir, const Vec3& v0, const Vec3& v1, const Vec3& v2, F32& inOutMaxT)
+{
+    Vec3 edge1 = v1 - v0;
+    Vec3 edge2 = v2 - v0;
+    Vec3 p = Cross(dir, edge2);
+    F32 det = Dot(edge1, p);
+
+    // squared to skip the square roots, the batch kernel in MathBatch.cpp multiplies in the same order
+    F32 minDetSq = (kRayTriangleParallelEpsilon * kRayTriangleParallelEpsilon * Dot(dir, dir)) * (Dot(edge1, edge1) * Dot(edge2, edge2));
+    if(det * det <= minDetSq)
+        return false;
+
+    F32 invDet = 1.0f / det;
+    Vec3 toOrigin = origin - v0;
+    F32 u = Dot(toOrigin, p) * invDet;
+    if(u < 0.0f || u > 1.0f)
+        return false;
+
+    Vec3 q = Cross(toOrigin, edge1);
+    F32 v = Dot(dir, q) * invDet;
+    if(v < 0.0f || u + v > 1.0f)
+        return false;
+
+    F32 t = Dot(edge2, q) * invDet;
+    if(t < 0.0f || t >= inOutMaxT)
+        return false;
+
+    inOutMaxT = t;
+    return true;
+}
+
+//-------------------------------------------------------------------------
+// Overlap tests
+//-------------------------------------------------------------------------
+bool SM::OverlapSphereAabb(const Sphere& sphere, const Aabb& aabb)
+{
+    // per axis how far the center is outside the box
+    F32 dx = Max(::fabsf(sphere.m_center.x - aabb.m_center.x) - aabb.m_extents.x, 0.0f);
+    F32 dy = Max(::fabsf(sphere.m_center.y - aabb.m_center.y) - aabb.m_extents.y, 0.0f);
+    F32 dz = Max(::fabsf(sphere.m_center.z - aabb.m_center.z) - aabb.m_extents.z, 0.0f);
+    return (dx * dx) + (dy * dy) + (dz * dz) <= sphere.m_radius * sphere.m_radius;
+}
+
+bool SM::OverlapSphereObb(const Sphere& sphere, const Obb& obb)
+{
+    Vec3 local = ToObbLocal(obb, sphere.m_center);
+    F32 dx = Max(::fabsf(local.x) - obb.m_extents.x, 0.0f);
+    F32 dy = Max(::fabsf(local.y) - obb.m_extents.y, 0.0f);
+    F32 dz = Max(::fabsf(local.z) - obb.m_extents.z, 0.0f);
+    return (dx * dx) + (dy * dy) + (dz * dz) <= sphere.m_radius * sphere.m_radius;
+}
+
+bool SM::OverlapObbPlane(const Obb& obb, const Plane& plane)
+{
+    F32 reach = (obb.m_extents.x * ::fabsf(Dot(plane.m_normal, obb.m_axes.GetIBasis()))) +
+                (obb.m_extents.y * ::fabsf(Dot(plane.m_normal, obb.m_axes.GetJBasis()))) +
+                (obb.m_extents.z * ::fabsf(Dot(plane.m_normal, obb.m_axes.GetKBasis())));
+    return ::fabsf(CalcSignedDistance(plane, obb.m_center)) <= reach;
+}
+
+bool SM::OverlapObbObb(const Obb& a, const Obb& b)
+{
+    // Ericson, Real-Time Collision Detection 4.4.1, everything in a's frame. The batch kernel in MathBatch.cpp runs the
+    // same axes in the same order.
+    Vec3 axesA[3];
+    Vec3 axesB[3];
+    GetObbAxes(a, axesA);
+    GetObbAxes(b, axesB);
+    const F32 extentsA[3] = { a.m_extents.x, a.m_extents.y, a.m_extents.z };
+    const F32 extentsB[3] = { b.m_extents.x, b.m_extents.y, b.m_extents.z };
+
+    F32 rotation[3][3];
+    F32 absRotation[3][3];
+    for(U32 i = 0; i < 3; i++)
+    {
+        for(U32 j = 0; j < 3; j++)
+        {
+            rotation[i][j] = Dot(axesA[i], axesB[j]);
+            absRotation[i][j] = ::fabsf(rotation[i][j]) + kObbParallelEpsilon;
+        }
+    }
+
+    Vec3 delta = b.m_center - a.m_center;
+    const F32 translation[3] = { Dot(delta, axesA[0]), Dot(delta, axesA[1]), Dot(delta, axesA[2]) };
+
+    // a's face normals
+    for(U32 i = 0; i < 3; i++)
+    {
+        F32 reachB = (extentsB[0] * absRotation[i][0]) + (extentsB[1] * absRotation[i][1]) + (extentsB[2] * absRotation[i][2]);
+        if(extentsA[i] + reachB < ::fabsf(translation[i]))
+            return false;
+    }
+
+    // b's face normals
+    for(U32 j = 0; j < 3; j++)
+    {
+        F32 reachA = (extentsA[0] * absRotation[0][j]) + (extentsA[1] * absRotation[1][j]) + (extentsA[2] * absRotation[2][j]);
+        F32 distance = (translation[0] * rotation[0][j]) + (translation[1] * rotation[1][j]) + (translation[2] * rotation[2][j]);
+        if(reachA + extentsB[j] < ::fabsf(distance))
+            return false;
+    }
+
+    // a's axis i crossed with b's axis j
+    for(U32 i = 0; i < 3; i++)
+    {
+        const U32 i1 = (i + 1) % 3;
+        const U32 i2 = (i + 2) % 3;
+        for(U32 j = 0; j < 3; j++)
+        {
+            const U32 j1 = (j + 1) % 3;
+            const U32 j2 = (j + 2) % 3;
+            F32 reachA = (extentsA[i1] * absRotation[i2][j]) + (extentsA[i2] * absRotation[i1][j]);
+            F32 reachB = (extentsB[j1] * absRotation[i][j2]) + (extentsB[j2] * absRotation[i][j1]);
+            F32 distance = (translation[i2] * rotation[i1][j]) - (translation[i1] * rotation[i2][j]);
+            if(reachA + reachB < ::fabsf(distance))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+// Containment tests
+//-------------------------------------------------------------------------
+bool SM::Contains(const Obb& obb, const Vec3& point)
+{
+    Vec3 local = ToObbLocal(obb, point);
+    return ::fabsf(local.x) <= obb.m_extents.x && ::fabsf(local.y) <= obb.m_extents.y && ::fabsf(local.z) <= obb.m_extents.z;
+}
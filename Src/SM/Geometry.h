@@ -0,0 +1,286 @@
+#pragma once
+
+#include "SM/Math.h"
+#include "SM/StandardTypes.h"
+
+namespace SM
+{
+    // Shapes for culling, picking and collision. Boxes are center and half size like the frustum tests and AabbSoA.
+    // Batch versions of the tests over structure of arrays data live in MathBatch.h.
+
+    //-------------------------------------------------------------------------
+    // Primitives
+    //-------------------------------------------------------------------------
+    // m_dir does not need to be unit length, hit distances are in multiples of it
+    struct Ray
+    {
+        Vec3 m_origin;
+        Vec3 m_dir;
+
+        Vec3 GetPoint(F32 t) const { return m_origin + (m_dir * t); }
+    };
+
+    // Points p with Dot(m_normal, p) + m_d == 0, laid out like the Vec4 frustum planes. m_normal is unit length.
+    struct Plane
+    {
+        Vec3 m_normal;
+        F32 m_d = 0.0f;
+
+        static Plane CreateFromPointNormal(const Vec3& point, const Vec3& normal);
+        static Plane CreateFromTriangle(const Vec3& v0, const Vec3& v1, const Vec3& v2);
+    };
+
+    struct Sphere
+    {
+        Vec3 m_center;
+        F32 m_radius = 0.0f;
+    };
+
+    struct Aabb
+    {
+        Vec3 m_center;
+        Vec3 m_extents;
+
+        static Aabb CreateFromMinMax(const Vec3& min, const Vec3& max);
+        Vec3 GetMin() const { return m_center - m_extents; }
+        Vec3 GetMax() const { return m_center + m_extents; }
+    };
+
+    // Rows of m_axes are the box's local x, y and z axes in world space and must be orthonormal
+    struct Obb
+    {
+        Vec3 m_center;
+        Vec3 m_extents;
+        Mat33 m_axes;
+
+        // The box around aabb after transform, which may rotate and scale but not shear
+        static Obb CreateFromAabb(const Aabb& aabb, const Mat44& transform);
+    };
+
+    // Every point within m_radius of the segment m_p0 to m_p1
+    struct Capsule
+    {
+        Vec3 m_p0;
+        Vec3 m_p1;
+        F32 m_radius = 0.0f;
+    };
+
+    struct Triangle
+    {
+        Vec3 m_v0;
+        Vec3 m_v1;
+        Vec3 m_v2;
+    };
+
+    //-------------------------------------------------------------------------
+    // Closest points
+    //-------------------------------------------------------------------------
+    // Positive in front of the plane, i.e. on the side m_normal points to
+    F32 CalcSignedDistance(const Plane& plane, const Vec3& point);
+
+    Vec3 CalcClosestPoint(const Aabb& aabb, const Vec3& point);
+    Vec3 CalcClosestPoint(const Obb& obb, const Vec3& point);
+    Vec3 CalcClosestPointOnSegment(const Vec3& a, const Vec3& b, const Vec3& point);
+
+    // Closest points between segments p0 p1 and q0 q1, returns the squared distance between them
+    F32 CalcClosestPointsOnSegments(const Vec3& p0, const Vec3& p1, const Vec3& q0, const Vec3& q1, Vec3& outOnP, Vec3& outOnQ);
+
+    //-------------------------------------------------------------------------
+    // Ray tests
+    //-------------------------------------------------------------------------
+    // On a hit closer than inOutMaxT these lower inOutMaxT to the hit distance and return true. A ray starting inside a
+    // solid shape hits it at 0. Distances are never negative, nothing behind the origin is hit.
+
+    // Zero components become tiny ones instead of infinities, otherwise a ray lying exactly on a slab boundary computes
+    // 0 * inf = nan and misses boxes it touches. Components of exactly kRayParallelInvDir mark axes the ray is parallel to.
+    static const F32 kRayMinDirComponent = 1e-20f;
+    static const F32 kRayParallelInvDir = 1.0f / kRayMinDirComponent;
+    Vec3 CalcRayInvDir(const Vec3& dir);
+
+    // Slab test, rays grazing an edge or face count as hits
+    bool IntersectRayAabb(const Ray& ray, const Aabb& aabb, F32& inOutMaxT);
+    bool IntersectRayObb(const Ray& ray, const Obb& obb, F32& inOutMaxT);
+    bool IntersectRaySphere(const Ray& ray, const Sphere& sphere, F32& inOutMaxT);
+
+    // Both sides of the plane count, rays parallel to it miss
+    bool IntersectRayPlane(const Ray& ray, const Plane& plane, F32& inOutMaxT);
+
+    // Moller-Trumbore, both windings count as hits. Rays closer to parallel with the triangle than
+    // kRayTriangleParallelEpsilon miss, the determinant is compared relative to |dir| |edge1| |edge2| so the cutoff is
+    // the same for tiny and huge triangles. Degenerate triangles always miss.
+    static const F32 kRayTriangleParallelEpsilon = FLT_EPSILON;
+    bool IntersectRayTriangle(const Vec3& origin, const Vec3& dir, const Vec3& v0, const Vec3& v1, const Vec3& v2, F32& inOutMaxT);
+    bool IntersectRayTriangle(const Ray& ray, const Triangle& triangle, F32& inOutMaxT);
+
+    //-------------------------------------------------------------------------
+    // Overlap tests
+    //-------------------------------------------------------------------------
+    // Touching shapes overlap
+    bool OverlapSphereSphere(const Sphere& a, const Sphere& b);
+    bool OverlapSphereAabb(const Sphere& sphere, const Aabb& aabb);
+    bool OverlapSphereObb(const Sphere& sphere, const Obb& obb);
+    bool OverlapSpherePlane(const Sphere& sphere, const Plane& plane);
+    bool OverlapAabbAabb(const Aabb& a, const Aabb& b);
+    bool OverlapAabbPlane(const Aabb& aabb, const Plane& plane);
+    bool OverlapObbPlane(const Obb& obb, const Plane& plane);
+
+    // Separating axis test over the 3 + 3 face normals and 9 edge cross products. Near parallel edges give near zero
+    // cross products, kObbParallelEpsilon is added to the rotation terms so rounding error can't separate along them.
+    static const F32 kObbParallelEpsilon = 1e-6f;
+    bool OverlapObbObb(const Obb& a, const Obb& b);
+
+    bool OverlapCapsuleSphere(const Capsule& capsule, const Sphere& sphere);
+    bool OverlapCapsuleCapsule(const Capsule& a, const Capsule& b);
+
+    //-------------------------------------------------------------------------
+    // Containment tests
+    //-------------------------------------------------------------------------
+    // Points on the boundary are inside, an inner shape touching the boundary from inside is contained
+    bool Contains(const Aabb& aabb, const Vec3& point);
+    bool Contains(const Aabb& outer, const Aabb& inner);
+    bool Contains(const Aabb& aabb, const Sphere& sphere);
+    bool Contains(const Obb& obb, const Vec3& point);
+    bool Contains(const Sphere& sphere, const Vec3& point);
+    bool Contains(const Sphere& outer, const Sphere& inner);
+    bool Contains(const Capsule& capsule, const Vec3& point);
+
+    //-------------------------------------------------------------------------
+    // Inline
+    //-------------------------------------------------------------------------
+    inline Plane Plane::CreateFromPointNormal(const Vec3& point, const Vec3& normal)
+    {
+        Plane plane;
+        plane.m_normal = normal;
+        plane.m_d = -Dot(normal, point);
+        return plane;
+    }
+
+    inline Plane Plane::CreateFromTriangle(const Vec3& v0, const Vec3& v1, const Vec3& v2)
+    {
+        return CreateFromPointNormal(v0, Cross(v1 - v0, v2 - v0).GetNormalized());
+    }
+
+    inline Aabb Aabb::CreateFromMinMax(const Vec3& min, const Vec3& max)
+    {
+        Aabb aabb;
+        aabb.m_center = (min + max) * 0.5f;
+        aabb.m_extents = (max - min) * 0.5f;
+        return aabb;
+    }
+
+    inline F32 CalcSignedDistance(const Plane& plane, const Vec3& point)
+    {
+        return (plane.m_normal.x * point.x) + (plane.m_normal.y * point.y) + (plane.m_normal.z * point.z) + plane.m_d;
+    }
+
+    inline Vec3 CalcClosestPoint(const Aabb& aabb, const Vec3& point)
+    {
+        Vec3 min = aabb.GetMin();
+        Vec3 max = aabb.GetMax();
+        return Vec3(Clamp(point.x, min.x, max.x), Clamp(point.y, min.y, max.y), Clamp(point.z, min.z, max.z));
+    }
+
+    inline Vec3 CalcClosestPointOnSegment(const Vec3& a, const Vec3& b, const Vec3& point)
+    {
+        Vec3 ab = b - a;
+        F32 lengthSq = Dot(ab, ab);
+        F32 t = lengthSq > 0.0f ? Clamp(Dot(point - a, ab) / lengthSq, 0.0f, 1.0f) : 0.0f;
+        return a + (ab * t);
+    }
+
+    inline Vec3 CalcRayInvDir(const Vec3& dir)
+    {
+        return Vec3(1.0f / (::fabsf(dir.x) < kRayMinDirComponent ? ::copysignf(kRayMinDirComponent, dir.x) : dir.x),
+                    1.0f / (::fabsf(dir.y) < kRayMinDirComponent ? ::copysignf(kRayMinDirComponent, dir.y) : dir.y),
+                    1.0f / (::fabsf(dir.z) < kRayMinDirComponent ? ::copysignf(kRayMinDirComponent, dir.z) : dir.z));
+    }
+
+    inline bool IntersectRayTriangle(const Ray& ray, const Triangle& triangle, F32& inOutMaxT)
+    {
+        return IntersectRayTriangle(ray.m_origin, ray.m_dir, triangle.m_v0, triangle.m_v1, triangle.m_v2, inOutMaxT);
+    }
+
+    inline bool OverlapSphereSphere(const Sphere& a, const Sphere& b)
+    {
+        Vec3 delta = b.m_center - a.m_center;
+        F32 radiusSum = a.m_radius + b.m_radius;
+        return Dot(delta, delta) <= radiusSum * radiusSum;
+    }
+
+    inline bool OverlapSpherePlane(const Sphere& sphere, const Plane& plane)
+    {
+        return ::fabsf(CalcSignedDistance(plane, sphere.m_center)) <= sphere.m_radius;
+    }
+
+    inline bool OverlapAabbAabb(const Aabb& a, const Aabb& b)
+    {
+        return ::fabsf(a.m_center.x - b.m_center.x) <= a.m_extents.x + b.m_extents.x &&
+               ::fabsf(a.m_center.y - b.m_center.y) <= a.m_extents.y + b.m_extents.y &&
+               ::fabsf(a.m_center.z - b.m_center.z) <= a.m_extents.z + b.m_extents.z;
+    }
+
+    inline bool OverlapAabbPlane(const Aabb& aabb, const Plane& plane)
+    {
+        // the box reaches as far towards the plane as its extents projected onto the normal
+        F32 reach = (::fabsf(plane.m_normal.x) * aabb.m_extents.x) + (::fabsf(plane.m_normal.y) * aabb.m_extents.y) + (::fabsf(plane.m_normal.z) * aabb.m_extents.z);
+        return ::fabsf(CalcSignedDistance(plane, aabb.m_center)) <= reach;
+    }
+
+    inline bool OverlapCapsuleSphere(const Capsule& capsule, const Sphere& sphere)
+    {
+        Vec3 delta = sphere.m_center - CalcClosestPointOnSegment(capsule.m_p0, capsule.m_p1, sphere.m_center);
+        F32 radiusSum = capsule.m_radius + sphere.m_radius;
+        return Dot(delta, delta) <= radiusSum * radiusSum;
+    }
+
+    inline bool OverlapCapsuleCapsule(const Capsule& a, const Capsule& b)
+    {
+        Vec3 onA;
+        Vec3 onB;
+        F32 radiusSum = a.m_radius + b.m_radius;
+        return CalcClosestPointsOnSegments(a.m_p0, a.m_p1, b.m_p0, b.m_p1, onA, onB) <= radiusSum * radiusSum;
+    }
+
+    inline bool Contains(const Aabb& aabb, const Vec3& point)
+    {
+        return ::fabsf(point.x - aabb.m_center.x) <= aabb.m_extents.x &&
+               ::fabsf(point.y - aabb.m_center.y) <= aabb.m_extents.y &&
+               ::fabsf(point.z - aabb.m_center.z) <= aabb.m_extents.z;
+    }
+
+    inline bool Contains(const Aabb& outer, const Aabb& inner)
+    {
+        return ::fabsf(inner.m_center.x - outer.m_center.x) + inner.m_extents.x <= outer.m_extents.x &&
+               ::fabsf(inner.m_center.y - outer.m_center.y) + inner.m_extents.y <= outer.m_extents.y &&
+               ::fabsf(inner.m_center.z - outer.m_center.z) + inner.m_extents.z <= outer.m_extents.z;
+    }
+
+    inline bool Contains(const Aabb& aabb, const Sphere& sphere)
+    {
+        return ::fabsf(sphere.m_center.x - aabb.m_center.x) + sphere.m_radius <= aabb.m_extents.x &&
+               ::fabsf(sphere.m_center.y - aabb.m_center.y) + sphere.m_radius <= aabb.m_extents.y &&
+               ::fabsf(sphere.m_center.z - aabb.m_center.z) + sphere.m_radius <= aabb.m_extents.z;
+    }
+
+    inline bool Contains(const Sphere& sphere, const Vec3& point)
+    {
+        Vec3 delta = point - sphere.m_center;
+        return Dot(delta, delta) <= sphere.m_radius * sphere.m_radius;
+    }
+
+    inline bool Contains(const Sphere& outer, const Sphere& inner)
+    {
+        if(inner.m_radius > outer.m_radius)
+            return false;
+
+        Vec3 delta = inner.m_center - outer.m_center;
+        F32 room = outer.m_radius - inner.m_radius;
+        return Dot(delta, delta) <= room * room;
+    }
+
+    inline bool Contains(const Capsule& capsule, const Vec3& point)
+    {
+        Vec3 delta = point - CalcClosestPointOnSegment(capsule.m_p0, capsule.m_p1, point);
+        return Dot(delta, delta) <= capsule.m_radius * capsule.m_radius;
+    }
+}
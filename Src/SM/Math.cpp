@@ -18,6 +18,8 @@ const IVec2 IVec2::kZero(0, 0);
 const IVec3 IVec3::kZero(0, 0, 0);
 const Mat33 Mat33::kIdentity;
 const Mat44 Mat44::kIdentity;
+const Quat Quat::kIdentity;
+const DualQuat DualQuat::kIdentity;
 
 // Based on https://randomascii.wordpress.com/2012/02/25/comparing-floating-point-numbers-2012-edition/ 
 // #TODO(smerendino): Implement ULP into this as well based on the source text
@@ -38,67 +40,180 @@ bool SM::IsCloseEnough(F32 a, F32 b, F32 acceptableError)
 	return false;
 };
 
-static F32 CalcCofactor(const Mat44& m, U32 row, U32 column)
+F32 Mat44::Determinant() const
 {
-    Mat33 submatrix;
-
-    // Build Mat33 submatrix by removing the row and column we are getting cofactor for
-    U32 curRow = 0;
-    for (U32 srcRow = 0; srcRow < 4; ++srcRow)
-    {
-        if (srcRow == row)
-            continue;
-
-        U32 curCol = 0;
-        for (U32 srcCol = 0; srcCol < 4; ++srcCol)
-        {
-            if (srcCol == column)
-                continue;
-
-            submatrix[curRow][curCol] = m[curRow][srcCol];
-            curCol++;
-        }
-
-        curRow++;
-    }
-
-    // Calculate determinant of submatrix
-    F32 subDeterminant = submatrix.Determinant();
-
-    // Use correct sign based on row and column
-    if ((row + column) % 2 != 0)
-    {
-        subDeterminant = -subDeterminant;
-    }
-
-    return subDeterminant;
+    // expand along the first two rows using 2x2 determinants of the top and bottom halves
+    F32 s0 = ix * jy - jx * iy;
+    F32 s1 = ix * jz - jx * iz;
+    F32 s2 = ix * jw - jx * iw;
+    F32 s3 = iy * jz - jy * iz;
+    F32 s4 = iy * jw - jy * iw;
+    F32 s5 = iz * jw - jz * iw;
+
+    F32 c0 = kx * ty - tx * ky;
+    F32 c1 = kx * tz - tx * kz;
+    F32 c2 = kx * tw - tx * kw;
+    F32 c3 = ky * tz - ty * kz;
+    F32 c4 = ky * tw - ty * kw;
+    F32 c5 = kz * tw - tz * kw;
+
+    return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
 }
 
-F32 Mat44::Determinant() const
+#if SM_SIMD_ENABLED
+// 2x2 matrices packed row major into one register as (m00, m01, m10, m11), # is the adjugate
+
+// a * b
+static F32x4 Mat22Mul(F32x4 a, F32x4 b)
+{
+    return SimdAdd(SimdMul(a, SimdSwizzle<0, 3, 0, 3>(b)), SimdMul(SimdSwizzle<1, 0, 3, 2>(a), SimdSwizzle<2, 1, 2, 1>(b)));
+}
+
+// a# * b
+static F32x4 Mat22AdjMul(F32x4 a, F32x4 b)
 {
-    return ix * CalcCofactor(*this, 0, 0) +
-           iy * CalcCofactor(*this, 0, 1) +
-           iz * CalcCofactor(*this, 0, 2) +
-           iw * CalcCofactor(*this, 0, 3);
+    return SimdSub(SimdMul(SimdSwizzle<3, 3, 0, 0>(a), b), SimdMul(SimdSwizzle<1, 1, 2, 2>(a), SimdSwizzle<2, 3, 0, 1>(b)));
 }
 
+// a * b#
+static F32x4 Mat22MulAdj(F32x4 a, F32x4 b)
+{
+    return SimdSub(SimdMul(a, SimdSwizzle<3, 0, 3, 0>(b)), SimdMul(SimdSwizzle<1, 0, 3, 2>(a), SimdSwizzle<2, 1, 2, 1>(b)));
+}
+#endif
+
 void Mat44::Inverse()
 {
-    // Cramer's method of inverse determinant multiplied by adjoint matrix
-    F32 invDet = 1.0f / Determinant();
-
-    // Build matrix of cofactors
-    Mat44 cofactorMat;
-    for (U32 row = 0; row < 4; ++row)
-    {
-        for (U32 col = 0; col < 4; ++col)
-        {
-            cofactorMat[row][col] = CalcCofactor(*this, row, col);
-        }
-    }
-
-    // Turn cofactor matrix into adjoint matrix by transposing
-    cofactorMat.Transpose();
-
-    *this = cofactorMat * invDet;
+    #if SM_SIMD_ENABLED
+    // Block inverse, split into 2x2 matrices | A B |
+    //                                        | C D |
+    F32x4 i = SimdLoad(&ix);
+    F32x4 j = SimdLoad(&jx);
+    F32x4 k = SimdLoad(&kx);
+    F32x4 t = SimdLoad(&tx);
+    F32x4 a = SimdShuffle<0, 1, 0, 1>(i, j);
+    F32x4 b = SimdShuffle<2, 3, 2, 3>(i, j);
+    F32x4 c = SimdShuffle<0, 1, 0, 1>(k, t);
+    F32x4 d = SimdShuffle<2, 3, 2, 3>(k, t);
+
+    // (|A|, |B|, |C|, |D|)
+    F32x4 subDets = SimdSub(SimdMul(SimdShuffle<0, 2, 0, 2>(i, k), SimdShuffle<1, 3, 1, 3>(j, t)),
+                            SimdMul(SimdShuffle<1, 3, 1, 3>(i, k), SimdShuffle<0, 2, 0, 2>(j, t)));
+    F32x4 detA = SimdSplatX(subDets);
+    F32x4 detB = SimdSplatY(subDets);
+    F32x4 detC = SimdSplatZ(subDets);
+    F32x4 detD = SimdSplatW(subDets);
+
+    // inverse = 1 / |M| * | X Y |, solved for the adjugates of X, Y, Z and W
+    //                     | Z W |
+    F32x4 adjDC = Mat22AdjMul(d, c);
+    F32x4 adjAB = Mat22AdjMul(a, b);
+    F32x4 adjX = SimdSub(SimdMul(detD, a), Mat22Mul(b, adjDC));
+    F32x4 adjW = SimdSub(SimdMul(detA, d), Mat22Mul(c, adjAB));
+    F32x4 adjY = SimdSub(SimdMul(detB, c), Mat22MulAdj(d, adjAB));
+    F32x4 adjZ = SimdSub(SimdMul(detC, b), Mat22MulAdj(a, adjDC));
+
+    // |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+    F32x4 trace = SimdHorizontalSum(SimdMul(adjAB, SimdSwizzle<0, 2, 1, 3>(adjDC)));
+    F32x4 det = SimdSub(SimdAdd(SimdMul(detA, detD), SimdMul(detB, detC)), trace);
+    F32x4 invDet = SimdDiv(SimdSet(1.0f, -1.0f, -1.0f, 1.0f), det);
+    adjX = SimdMul(adjX, invDet);
+    adjY = SimdMul(adjY, invDet);
+    adjZ = SimdMul(adjZ, invDet);
+    adjW = SimdMul(adjW, invDet);
+
+    // undo the adjugates while writing the blocks back out as rows
+    SimdStore(&ix, SimdShuffle<3, 1, 3, 1>(adjX, adjY));
+    SimdStore(&jx, SimdShuffle<2, 0, 2, 0>(adjX, adjY));
+    SimdStore(&kx, SimdShuffle<3, 1, 3, 1>(adjZ, adjW));
+    SimdStore(&tx, SimdShuffle<2, 0, 2, 0>(adjZ, adjW));
+    #else
+    // Adjugate over determinant, every 3x3 cofactor is built from 2x2 determinants of the top and bottom two rows
+    F32 s0 = ix * jy - jx * iy;
+    F32 s1 = ix * jz - jx * iz;
+    F32 s2 = ix * jw - jx * iw;
+    F32 s3 = iy * jz - jy * iz;
+    F32 s4 = iy * jw - jy * iw;
+    F32 s5 = iz * jw - jz * iw;
+
+    F32 c0 = kx * ty - tx * ky;
+    F32 c1 = kx * tz - tx * kz;
+    F32 c2 = kx * tw - tx * kw;
+    F32 c3 = ky * tz - ty * kz;
+    F32 c4 = ky * tw - ty * kw;
+    F32 c5 = kz * tw - tz * kw;
+
+    F32 invDet = 1.0f / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+    Mat44 src = *this;
+    ix = ( src.jy * c5 - src.jz * c4 + src.jw * c3) * invDet;
+    iy = (-src.iy * c5 + src.iz * c4 - src.iw * c3) * invDet;
+    iz = ( src.ty * s5 - src.tz * s4 + src.tw * s3) * invDet;
+    iw = (-src.ky * s5 + src.kz * s4 - src.kw * s3) * invDet;
+
+    jx = (-src.jx * c5 + src.jz * c2 - src.jw * c1) * invDet;
+    jy = ( src.ix * c5 - src.iz * c2 + src.iw * c1) * invDet;
+    jz = (-src.tx * s5 + src.tz * s2 - src.tw * s1) * invDet;
+    jw = ( src.kx * s5 - src.kz * s2 + src.kw * s1) * invDet;
+
+    kx = ( src.jx * c4 - src.jy * c2 + src.jw * c0) * invDet;
+    ky = (-src.ix * c4 + src.iy * c2 - src.iw * c0) * invDet;
+    kz = ( src.tx * s4 - src.ty * s2 + src.tw * s0) * invDet;
+    kw = (-src.kx * s4 + src.ky * s2 - src.kw * s0) * invDet;
+
+    tx = (-src.jx * c3 + src.jy * c1 - src.jz * c0) * invDet;
+    ty = ( src.ix * c3 - src.iy * c1 + src.iz * c0) * invDet;
+    tz = (-src.tx * s3 + src.ty * s1 - src.tz * s0) * invDet;
+    tw = ( src.kx * s3 - src.ky * s1 + src.kz * s0) * invDet;
+    #endif
+}
+
+void Mat44::AffineInverse()
+{
+    // | R 0 |^-1 = | R^-1      0 |
+    // | t 1 |      | -t * R^-1 1 |
+    // R^-1 has the cross products j x k, k x i and i x j of R's rows as its columns, divided by |R|
+    #if SM_SIMD_ENABLED
+    F32x4 i = SimdLoad(&ix);
+    F32x4 j = SimdLoad(&jx);
+    F32x4 k = SimdLoad(&kx);
+    F32x4 t = SimdLoad(&tx);
+
+    // a x b = a.yzx * b.zxy - a.zxy * b.yzx, the w lanes stay 0 since R's are
+    F32x4 jk = SimdSub(SimdMul(SimdSwizzle<1, 2, 0, 3>(j), SimdSwizzle<2, 0, 1, 3>(k)), SimdMul(SimdSwizzle<2, 0, 1, 3>(j), SimdSwizzle<1, 2, 0, 3>(k)));
+    F32x4 ki = SimdSub(SimdMul(SimdSwizzle<1, 2, 0, 3>(k), SimdSwizzle<2, 0, 1, 3>(i)), SimdMul(SimdSwizzle<2, 0, 1, 3>(k), SimdSwizzle<1, 2, 0, 3>(i)));
+    F32x4 ij = SimdSub(SimdMul(SimdSwizzle<1, 2, 0, 3>(i), SimdSwizzle<2, 0, 1, 3>(j)), SimdMul(SimdSwizzle<2, 0, 1, 3>(i), SimdSwizzle<1, 2, 0, 3>(j)));
+    F32x4 invDet = SimdDiv(SimdSplat(1.0f), SimdDot4(i, jk));
+    jk = SimdMul(jk, invDet);
+    ki = SimdMul(ki, invDet);
+    ij = SimdMul(ij, invDet);
+    F32x4 zero = SimdZero();
+    SimdTranspose(jk, ki, ij, zero);
+
+    F32x4 rotatedT = SimdMulAdd(SimdSplatZ(t), ij, SimdMulAdd(SimdSplatY(t), ki, SimdMul(SimdSplatX(t), jk)));
+    SimdStore(&ix, jk);
+    SimdStore(&jx, ki);
+    SimdStore(&kx, ij);
+    SimdStore(&tx, SimdSub(SimdSet(0.0f, 0.0f, 0.0f, 1.0f), rotatedT));
+    #else
+    F32 jkx = jy * kz - jz * ky;
+    F32 jky = jz * kx - jx * kz;
+    F32 jkz = jx * ky - jy * kx;
+    F32 kix = ky * iz - kz * iy;
+    F32 kiy = kz * ix - kx * iz;
+    F32 kiz = kx * iy - ky * ix;
+    F32 ijx = iy * jz - iz * jy;
+    F32 ijy = iz * jx - ix * jz;
+    F32 ijz = ix * jy - iy * jx;
+    F32 invDet = 1.0f / (ix * jkx + iy * jky + iz * jkz);
+
+    Mat44 src = *this;
+    ix = jkx * invDet; iy = kix * invDet; iz = ijx * invDet; iw = 0.0f;
+    jx = jky * invDet; jy = kiy * invDet; jz = ijy * invDet; jw = 0.0f;
+    kx = jkz * invDet; ky = kiz * invDet; kz = ijz * invDet; kw = 0.0f;
+    tx = -(src.tx * ix + src.ty * jx + src.tz * kx);
+    ty = -(src.tx * iy + src.ty * jy + src.tz * ky);
+    tz = -(src.tx * iz + src.ty * jz + src.tz * kz);
+    tw = 1.0f;
+    #endif
 }
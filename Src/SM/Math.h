@@ -2,11 +2,12 @@
 
 #include "SM/Util.h"
 #include "SM/Assert.h"
+#include "SM/Random.h"
+#include "SM/Simd.h"
 #include "SM/StandardTypes.h"
 #include <cfloat>
 #include <cmath>
 #include <cstring>
-#include <ctime>
 
 namespace SM
 {
@@ -93,7 +94,8 @@ namespace SM
     //-------------------------------------------------------------------------
     // Vec4
     //-------------------------------------------------------------------------
-    class Vec4
+    // Vec4 and Mat44 rows are 16 byte aligned so SIMD builds can load them straight into registers
+    class alignas(16) Vec4
     {
         public:
         F32 x = 0.0f;
@@ -105,6 +107,10 @@ namespace SM
         Vec4(F32 _x, F32 _y, F32 _z, F32 _w);
         Vec4(const Vec2& _xy, F32 _z = 0.0f, F32 _w = 0.0f);
         Vec4(const Vec3& _xyz, F32 _w = 0.0f);
+        #if SM_SIMD_ENABLED
+        explicit Vec4(F32x4 v);
+        F32x4 ToSimd() const;
+        #endif
 
         Vec4 operator*(F32 s) const;
         Vec4 operator/(F32 s) const;
@@ -231,7 +237,7 @@ namespace SM
     //-------------------------------------------------------------------------
     // Mat44
     //-------------------------------------------------------------------------
-    class Mat44
+    class alignas(16) Mat44
     {
         public:
         F32 ix = 1.0f; F32 iy = 0.0f; F32 iz = 0.0f; F32 iw = 0.0f;
@@ -273,6 +279,11 @@ namespace SM
         void Inverse();
         Mat44 GetInversed() const;
 
+        // Only for rotation, scale and translation (last column 0, 0, 0, 1), cheaper than the general inverse
+        void AffineInverse();
+        Mat44 GetAffineInversed() const;
+
+        // Only for rotation and translation
         void FastOrthoInverse();
         Mat44 GetFastOrthoInversed() const;
 
@@ -348,6 +359,137 @@ namespace SM
     };
     Vec4 operator*(const Vec4& v, const Mat44& mat);
 
+    //-------------------------------------------------------------------------
+    // Quat
+    //-------------------------------------------------------------------------
+    // Unit quaternion rotation, (x, y, z) is the axis scaled by sin(angle / 2) and w is cos(angle / 2).
+    // Products follow the Mat44 order, a * b rotates by a and then by b, so (a * b).ToMat44() == a.ToMat44() * b.ToMat44().
+    class alignas(16) Quat
+    {
+        public:
+        F32 x = 0.0f;
+        F32 y = 0.0f;
+        F32 z = 0.0f;
+        F32 w = 1.0f;
+
+        Quat() = default;
+        Quat(F32 _x, F32 _y, F32 _z, F32 _w);
+
+        Quat operator*(const Quat& other) const;
+        Quat& operator*=(const Quat& other);
+        Quat operator*(F32 s) const;
+        Quat operator+(const Quat& other) const;
+        Quat operator-() const;
+        bool operator==(const Quat& other) const;
+
+        F32 CalcLength() const;
+        F32 CalcLengthSq() const;
+        void Normalize();
+        Quat GetNormalized() const;
+
+        // The inverse of a unit quaternion
+        void Conjugate();
+        Quat GetConjugated() const;
+
+        Vec3 Rotate(const Vec3& v) const;
+
+        Mat33 ToMat33() const;
+        Mat44 ToMat44() const;
+
+        static Quat CreateRotationXRads(F32 xRads);
+        static Quat CreateRotationYRads(F32 yRads);
+        static Quat CreateRotationZRads(F32 zRads);
+        static Quat CreateRotationXDegs(F32 xDegs);
+        static Quat CreateRotationYDegs(F32 yDegs);
+        static Quat CreateRotationZDegs(F32 zDegs);
+        static Quat CreateRotationAroundAxisRads(const Vec3& axis, F32 rads);
+        static Quat CreateRotationAroundAxisDegs(const Vec3& axis, F32 degs);
+
+        // The rotation must be orthonormal, scale has to be removed first
+        static Quat CreateFromMat33(const Mat33& rotation);
+        static Quat CreateFromMat44(const Mat44& rotation);
+
+        static const Quat kIdentity;
+    };
+
+    F32 Dot(const Quat& a, const Quat& b);
+
+    // Interpolations take the shortest path, b is negated when it is in the other hemisphere from a.
+    // Nlerp is the cheapest but its angular speed is uneven, up to 8.2 degrees off slerp across a 180 degree turn, worst
+    // around a quarter and three quarters of the way while the middle and ends are exact.
+    // FastSlerp corrects t with a polynomial fit for nlerp and stays within 0.05 degrees of Slerp.
+    Quat Nlerp(const Quat& a, const Quat& b, F32 t);
+    Quat FastSlerp(const Quat& a, const Quat& b, F32 t);
+    Quat Slerp(const Quat& a, const Quat& b, F32 t);
+
+    //-------------------------------------------------------------------------
+    // DualQuat
+    //-------------------------------------------------------------------------
+    // Rigid transform, rotation then translation, as real + dual parts. Products follow the Mat44 order like Quat.
+    class DualQuat
+    {
+        public:
+        Quat m_real;
+        Quat m_dual = Quat(0.0f, 0.0f, 0.0f, 0.0f);
+
+        DualQuat() = default;
+        DualQuat(const Quat& rotation, const Vec3& translation);
+
+        DualQuat operator*(const DualQuat& other) const;
+        DualQuat& operator*=(const DualQuat& other);
+
+        // Blends leave dual quaternions unnormalized
+        void Normalize();
+        DualQuat GetNormalized() const;
+
+        // The inverse of a unit dual quaternion
+        void Conjugate();
+        DualQuat GetConjugated() const;
+
+        Quat GetRotation() const;
+        Vec3 GetTranslation() const;
+        Vec3 TransformPoint(const Vec3& point) const;
+        Vec3 TransformDir(const Vec3& dir) const;
+
+        Mat44 ToMat44() const;
+
+        // The matrix must be rotation and translation only
+        static DualQuat CreateFromMat44(const Mat44& transform);
+
+        static const DualQuat kIdentity;
+    };
+
+    // Shortest path linear blend, normalized, the usual way to blend skinning transforms
+    DualQuat Nlerp(const DualQuat& a, const DualQuat& b, F32 t);
+
+    //-------------------------------------------------------------------------
+    // Frustum
+    //-------------------------------------------------------------------------
+    enum FrustumPlane
+    {
+        kFrustumLeft,
+        kFrustumRight,
+        kFrustumBottom,
+        kFrustumTop,
+        kFrustumNear,
+        kFrustumFar,
+        kNumFrustumPlanes
+    };
+
+    // Planes are (normal, distance) with unit normals pointing inwards, p is on the inside when Dot(normal, p) + distance >= 0.
+    // Visibility tests are conservative, bounds outside the frustum near its corners can still count as visible.
+    class Frustum
+    {
+        public:
+        Vec4 m_planes[kNumFrustumPlanes];
+
+        bool IsSphereVisible(const Vec3& center, F32 radius) const;
+        bool IsAabbVisible(const Vec3& center, const Vec3& extents) const;
+
+        // Expects 0 <= z <= w clip space depth, as produced by MakePerspectiveProjection
+        static Frustum CreateFromViewProjection(const Mat44& viewProjection);
+    };
+
     //-------------------------------------------------------------------------
     // General
     //-------------------------------------------------------------------------
@@ -389,49 +531,6 @@ namespace SM
         return tanf(DegToRad(deg));
     }
 
-    inline void SeedRng()
-    {
-        ::srand((U32)time(NULL));
-    }
-
-    inline F32 RandomNumZeroToOne()
-    {
-        I32 num = ::rand();
-        return (F32)num / (F32)RAND_MAX;
-    }
-
-    inline F32 RandomNumBetween(F32 low, F32 high)
-    {
-        F32 range = high - low;
-        return low + (RandomNumZeroToOne() * range);
-    }
-
-    inline I32 RandomNumBetween(I32 low, I32 high)
-    {
-        I32 range = high - low;
-        return low + (::rand() % range);
-    }
-
-    template<typename T>
-    inline T Min(T a, T b)
-    {
-        return (a < b) ? a : b;
-    }
-
-    template<typename T>
-    inline T Max(T a, T b)
-    {
-        return (a > b) ? a : b;
-    }
-
-    template<typename T>
-    inline T Clamp(T value, T min, T max)
-    {
-        if(value < min) return min;
-        if(value > max) return max;
-        return value;
-    }
-
     inline F32 Remap(F32 value, F32 inMin, F32 inMax, F32 outMin, F32 outMax)
     {
         return ((value / (inMax - inMin)) * (outMax - outMin)) + outMin;
@@ -733,77 +832,134 @@ namespace SM
     {
     }
 
+    #if SM_SIMD_ENABLED
+    inline Vec4::Vec4(F32x4 v)
+    {
+        SimdStore(&x, v);
+    }
+
+    inline F32x4 Vec4::ToSimd() const
+    {
+        return SimdLoad(&x);
+    }
+    #endif
+
     inline Vec4 Vec4::operator*(F32 s) const
     {
+        #if SM_SIMD_ENABLED
+        return Vec4(SimdMul(ToSimd(), SimdSplat(s)));
+        #else
         return Vec4(x * s, y * s, z * s, w * s);
+        #endif
     }
 
     inline Vec4 Vec4::operator/(F32 s) const
     {
         F32 invS = 1.0f / s;
+        #if SM_SIMD_ENABLED
+        return Vec4(SimdMul(ToSimd(), SimdSplat(invS)));
+        #else
         return Vec4(x * invS, y * invS, z * invS, w * invS);
+        #endif
     }
 
     inline Vec4& Vec4::operator*=(F32 s)
     {
+        #if SM_SIMD_ENABLED
+        SimdStore(&x, SimdMul(ToSimd(), SimdSplat(s)));
+        #else
         x *= s;
         y *= s;
         z *= s;
         w *= s;
+        #endif
         return *this;
     }
 
     inline Vec4& Vec4::operator/=(F32 s)
     {
         F32 invS = 1.0f / s;
+        #if SM_SIMD_ENABLED
+        SimdStore(&x, SimdMul(ToSimd(), SimdSplat(invS)));
+        #else
         x *= invS;
         y *= invS;
         z *= invS;
         w *= invS;
+        #endif
         return *this;
     }
 
     inline Vec4 Vec4::operator+(const Vec4& other) const
     {
+        #if SM_SIMD_ENABLED
+        return Vec4(SimdAdd(ToSimd(), other.ToSimd()));
+        #else
         return Vec4(x + other.x, y + other.y, z + other.z, w + other.w);
+        #endif
     }
 
     inline Vec4 Vec4::operator-(const Vec4& other) const
     {
+        #if SM_SIMD_ENABLED
+        return Vec4(SimdSub(ToSimd(), other.ToSimd()));
+        #else
         return Vec4(x - other.x, y - other.y, z - other.z, w - other.w);
+        #endif
     }
 
     inline Vec4& Vec4::operator+=(const Vec4& other)
     {
+        #if SM_SIMD_ENABLED
+        SimdStore(&x, SimdAdd(ToSimd(), other.ToSimd()));
+        #else
         x += other.x;
         y += other.y;
         z += other.z;
         w += other.w;
+        #endif
         return *this;
     }
 
     inline Vec4& Vec4::operator-=(const Vec4& other)
     {
+        #if SM_SIMD_ENABLED
+        SimdStore(&x, SimdSub(ToSimd(), other.ToSimd()));
+        #else
         x -= other.x;
         y -= other.y;
         z -= other.z;
         w -= other.w;
+        #endif
         return *this;
     }
 
     inline Vec4 Vec4::operator-() const
     {
+        #if SM_SIMD_ENABLED
+        return Vec4(SimdNegate(ToSimd()));
+        #else
         return Vec4(-x, -y, -z, -w);
+        #endif
     }
 
     inline bool Vec4::operator==(const Vec4& other) const
     {
+        #if SM_SIMD_ENABLED
+        return SimdAllEqual(ToSimd(), other.ToSimd());
+        #else
         return (x == other.x) && (y == other.y) && (z == other.z) && (w == other.w);
+        #endif
     }
 
     inline F32 Vec4::CalcLengthSq() const
     {
+        #if SM_SIMD_ENABLED
+        F32x4 v = ToSimd();
+        return SimdGetX(SimdDot4(v, v));
+        #else
         return (x * x) + (y * y) + (z * z) + (w * w);
+        #endif
     }
 
     inline F32 Vec4::CalcLength()
@@ -849,7 +1005,11 @@ namespace SM
 
     inline F32 Dot(const Vec4& a, const Vec4& b)
     {
+        #if SM_SIMD_ENABLED
+        return SimdGetX(SimdDot4(a.ToSimd(), b.ToSimd()));
+        #else
         return (a.x * b.x) + (a.y * b.y) + (a.z * b.z) + (a.w * b.w);
+        #endif
     }
 
     //-------------------------------------------------------------------------
@@ -1247,32 +1407,75 @@ namespace SM
 
     inline Mat44 Mat44::operator*(F32 s) const
     {
+        #if SM_SIMD_ENABLED
+        Mat44 copy = *this;
+        copy *= s;
+        return copy;
+        #else
         return Mat44(ix * s, iy * s, iz * s, iw * s, 
                      jx * s, jy * s, jz * s, jw * s, 
                      kx * s, ky * s, kz * s, kw * s, 
                      tx * s, ty * s, tz * s, tw * s);
+        #endif
     }
 
     inline Mat44& Mat44::operator*=(F32 s)
     {
         F32* data = &ix;
+        #if SM_SIMD_ENABLED
+        F32x4 scale = SimdSplat(s);
+        for (int row = 0; row < 4; row++)
+        {
+            SimdStore(&data[row * 4], SimdMul(SimdLoad(&data[row * 4]), scale));
+        }
+        #else
        	for (int idx = 0; idx < 16; idx++)
        	{
        		data[idx] *= s;
        	}
+        #endif
        
        	return *this;
     }
 
     inline Mat44 Mat44::operator*(const Mat44& other) const
     {
+        #if SM_SIMD_ENABLED
+        F32x4 otherI = SimdLoad(&other.ix);
+        F32x4 otherJ = SimdLoad(&other.jx);
+        F32x4 otherK = SimdLoad(&other.kx);
+        F32x4 otherT = SimdLoad(&other.tx);
+        Mat44 result;
+        SimdStore(&result.ix, SimdLinearCombine(SimdLoad(&ix), otherI, otherJ, otherK, otherT));
+        SimdStore(&result.jx, SimdLinearCombine(SimdLoad(&jx), otherI, otherJ, otherK, otherT));
+        SimdStore(&result.kx, SimdLinearCombine(SimdLoad(&kx), otherI, otherJ, otherK, otherT));
+        SimdStore(&result.tx, SimdLinearCombine(SimdLoad(&tx), otherI, otherJ, otherK, otherT));
+        return result;
+        #else
     	Mat44 copy = *this;
     	copy *= other;
     	return copy;
+        #endif
     }
 
     inline Mat44& Mat44::operator*=(const Mat44& other)
     {
+        #if SM_SIMD_ENABLED
+        // each result row is this row as a row vector times other, same order of operations as the scalar path
+        F32x4 otherI = SimdLoad(&other.ix);
+        F32x4 otherJ = SimdLoad(&other.jx);
+        F32x4 otherK = SimdLoad(&other.kx);
+        F32x4 otherT = SimdLoad(&other.tx);
+        F32x4 i = SimdLinearCombine(SimdLoad(&ix), otherI, otherJ, otherK, otherT);
+        F32x4 j = SimdLinearCombine(SimdLoad(&jx), otherI, otherJ, otherK, otherT);
+        F32x4 k = SimdLinearCombine(SimdLoad(&kx), otherI, otherJ, otherK, otherT);
+        F32x4 t = SimdLinearCombine(SimdLoad(&tx), otherI, otherJ, otherK, otherT);
+        SimdStore(&ix, i);
+        SimdStore(&jx, j);
+        SimdStore(&kx, k);
+        SimdStore(&tx, t);
+        return *this;
+        #else
     	Mat44 result;
     
     	result.ix = (ix * other.ix) + (iy * other.jx) + (iz * other.kx) + (iw * other.tx);
@@ -1297,6 +1500,7 @@ namespace SM
     
     	*this = result;
     	return *this;
+        #endif
     }
 
     inline Vec3 Mat44::GetIBasis() const
@@ -1356,6 +1560,17 @@ namespace SM
 
     inline void Mat44::Transpose()
     {
+        #if SM_SIMD_ENABLED
+        F32x4 i = SimdLoad(&ix);
+        F32x4 j = SimdLoad(&jx);
+        F32x4 k = SimdLoad(&kx);
+        F32x4 t = SimdLoad(&tx);
+        SimdTranspose(i, j, k, t);
+        SimdStore(&ix, i);
+        SimdStore(&jx, j);
+        SimdStore(&kx, k);
+        SimdStore(&tx, t);
+        #else
         F32* data = &ix;
         Swap(data[1], data[4]);
         Swap(data[2], data[8]);
@@ -1363,6 +1578,7 @@ namespace SM
         Swap(data[6], data[9]);
         Swap(data[7], data[13]);
         Swap(data[11], data[14]);
+        #endif
     }
 
     inline Mat44 Mat44::GetTransposed() const
@@ -1379,18 +1595,39 @@ namespace SM
         return copy;
     }
 
+    inline Mat44 Mat44::GetAffineInversed() const
+    {
+        Mat44 copy = *this;
+        copy.AffineInverse();
+        return copy;
+    }
+
     inline void Mat44::FastOrthoInverse()
     {
+        #if SM_SIMD_ENABLED
+        // Stays in registers, scalar swaps followed by vector loads of the same rows stall on store forwarding
+        F32x4 i = SimdLoad(&ix);
+        F32x4 j = SimdLoad(&jx);
+        F32x4 k = SimdLoad(&kx);
+        F32x4 t = SimdLoad(&tx);
+        F32x4 zero = SimdZero();
+        SimdTranspose(i, j, k, zero);
+
+        F32x4 rotatedT = SimdMulAdd(SimdSplatZ(t), k, SimdMulAdd(SimdSplatY(t), j, SimdMul(SimdSplatX(t), i)));
+        SimdStore(&ix, i);
+        SimdStore(&jx, j);
+        SimdStore(&kx, k);
+        SimdStore(&tx, SimdSub(SimdSet(0.0f, 0.0f, 0.0f, 1.0f), rotatedT));
+        #else
         // Transpose upper 3x3 matrix
         F32* data = &ix;
         Swap(data[1], data[4]);
         Swap(data[2], data[8]);
         Swap(data[6], data[9]);
 
-        // Negate translation
-        tx *= -1.0f;
-        ty *= -1.0f;
-        tz *= -1.0f;
+        // Translation is negated and rotated by the inverse rotation
+        SetTranslation(-TransformDir(GetTranslation()));
+        #endif
     }
 
     inline Mat44 Mat44::GetFastOrthoInversed() const
@@ -1433,9 +1670,9 @@ namespace SM
 
     inline void Mat44::SetScale(F32 uniformScale)
     {
-        Vec3 iBasis = *((Vec3*)(&ix));
-        Vec3 jBasis = *((Vec3*)(&jx));
-        Vec3 kBasis = *((Vec3*)(&kx));
+        Vec3& iBasis = *((Vec3*)(&ix));
+        Vec3& jBasis = *((Vec3*)(&jx));
+        Vec3& kBasis = *((Vec3*)(&kx));
 
         iBasis.SetLength(uniformScale);
         jBasis.SetLength(uniformScale);
@@ -1444,9 +1681,9 @@ namespace SM
 
     inline void Mat44::SetScale(F32 i, F32 j, F32 k)
     {
-        Vec3 iBasis = *((Vec3*)(&ix));
-        Vec3 jBasis = *((Vec3*)(&jx));
-        Vec3 kBasis = *((Vec3*)(&kx));
+        Vec3& iBasis = *((Vec3*)(&ix));
+        Vec3& jBasis = *((Vec3*)(&jx));
+        Vec3& kBasis = *((Vec3*)(&kx));
 
         iBasis.SetLength(i);
         jBasis.SetLength(j);
@@ -1455,9 +1692,9 @@ namespace SM
 
     inline void Mat44::SetScale(const Vec3& ijk)
     {
-        Vec3 iBasis = *((Vec3*)(&ix));
-        Vec3 jBasis = *((Vec3*)(&jx));
-        Vec3 kBasis = *((Vec3*)(&kx));
+        Vec3& iBasis = *((Vec3*)(&ix));
+        Vec3& jBasis = *((Vec3*)(&jx));
+        Vec3& kBasis = *((Vec3*)(&kx));
 
         iBasis.SetLength(ijk.x);
         jBasis.SetLength(ijk.y);
@@ -1733,14 +1970,14 @@ namespace SM
     inline Mat44 Mat44::CreateTranslation(F32 _tx, F32 _ty, F32 _tz)
     {
         Mat44 translation;
-        translation.SetScale(_tx, _ty, _tz);
+        translation.SetTranslation(_tx, _ty, _tz);
         return translation;
     }
 
     inline Mat44 Mat44::CreateTranslation(const Vec3& t)
     {
         Mat44 translation;
-        translation.SetScale(t);
+        translation.SetTranslation(t);
         return translation;
     }
 
@@ -1802,11 +2039,401 @@ namespace SM
 
     inline Vec4 operator*(const Vec4& v, const Mat44& mat)
     {
+        #if SM_SIMD_ENABLED
+        return Vec4(SimdLinearCombine(v.ToSimd(), SimdLoad(&mat.ix), SimdLoad(&mat.jx), SimdLoad(&mat.kx), SimdLoad(&mat.tx)));
+        #else
         Vec4 result;
         result.x = (v.x * mat.ix) + (v.y * mat.jx) + (v.z * mat.kx) + (v.w * mat.tx);
         result.y = (v.x * mat.iy) + (v.y * mat.jy) + (v.z * mat.ky) + (v.w * mat.ty);
         result.z = (v.x * mat.iz) + (v.y * mat.jz) + (v.z * mat.kz) + (v.w * mat.tz);
         result.w = (v.x * mat.iw) + (v.y * mat.jw) + (v.z * mat.kw) + (v.w * mat.tw);
         return result;
+        #endif
+    }
+
+    //-------------------------------------------------------------------------
+    // Quat
+    //-------------------------------------------------------------------------
+    inline Quat::Quat(F32 _x, F32 _y, F32 _z, F32 _w)
+        :x(_x)
+        ,y(_y)
+        ,z(_z)
+        ,w(_w)
+    {
+    }
+
+    inline Quat Quat::operator*(const Quat& other) const
+    {
+        // Hamilton product other * this, this rotation applies first
+        return Quat(other.w * x + other.x * w + other.y * z - other.z * y,
+                    other.w * y - other.x * z + other.y * w + other.z * x,
+                    other.w * z + other.x * y - other.y * x + other.z * w,
+                    other.w * w - other.x * x - other.y * y - other.z * z);
+    }
+
+    inline Quat& Quat::operator*=(const Quat& other)
+    {
+        *this = *this * other;
+        return *this;
+    }
+
+    inline Quat Quat::operator*(F32 s) const
+    {
+        return Quat(x * s, y * s, z * s, w * s);
+    }
+
+    inline Quat Quat::operator+(const Quat& other) const
+    {
+        return Quat(x + other.x, y + other.y, z + other.z, w + other.w);
+    }
+
+    inline Quat Quat::operator-() const
+    {
+        return Quat(-x, -y, -z, -w);
+    }
+
+    inline bool Quat::operator==(const Quat& other) const
+    {
+        return (x == other.x) && (y == other.y) && (z == other.z) && (w == other.w);
+    }
+
+    inline F32 Quat::CalcLength() const
+    {
+        return ::sqrtf(CalcLengthSq());
+    }
+
+    inline F32 Quat::CalcLengthSq() const
+    {
+        return (x * x) + (y * y) + (z * z) + (w * w);
+    }
+
+    inline void Quat::Normalize()
+    {
+        F32 lenSq = CalcLengthSq();
+        SM_ASSERT(!IsCloseEnoughToZero(lenSq));
+
+        F32 invLen = 1.0f / ::sqrtf(lenSq);
+        *this = *this * invLen;
+    }
+
+    inline Quat Quat::GetNormalized() const
+    {
+        Quat copy = *this;
+        copy.Normalize();
+        return copy;
+    }
+
+    inline void Quat::Conjugate()
+    {
+        x = -x;
+        y = -y;
+        z = -z;
+    }
+
+    inline Quat Quat::GetConjugated() const
+    {
+        return Quat(-x, -y, -z, w);
+    }
+
+    inline Vec3 Quat::Rotate(const Vec3& v) const
+    {
+        // v + 2w(u x v) + 2u x (u x v) with u = (x, y, z)
+        Vec3 u(x, y, z);
+        Vec3 t = Cross(u, v) * 2.0f;
+        return v + (t * w) + Cross(u, t);
+    }
+
+    inline Mat33 Quat::ToMat33() const
+    {
+        F32 xx = x * x; F32 yy = y * y; F32 zz = z * z;
+        F32 xy = x * y; F32 xz = x * z; F32 yz = y * z;
+        F32 wx = w * x; F32 wy = w * y; F32 wz = w * z;
+        return Mat33(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy),
+                     2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx),
+                     2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy));
+    }
+
+    inline Mat44 Quat::ToMat44() const
+    {
+        Mat33 rotation = ToMat33();
+        return Mat44(rotation.GetIBasis(), rotation.GetJBasis(), rotation.GetKBasis(), Vec3::kZero);
+    }
+
+    inline Quat Quat::CreateRotationXRads(F32 xRads)
+    {
+        return Quat(::sinf(xRads * 0.5f), 0.0f, 0.0f, ::cosf(xRads * 0.5f));
+    }
+
+    inline Quat Quat::CreateRotationYRads(F32 yRads)
+    {
+        return Quat(0.0f, ::sinf(yRads * 0.5f), 0.0f, ::cosf(yRads * 0.5f));
+    }
+
+    inline Quat Quat::CreateRotationZRads(F32 zRads)
+    {
+        return Quat(0.0f, 0.0f, ::sinf(zRads * 0.5f), ::cosf(zRads * 0.5f));
+    }
+
+    inline Quat Quat::CreateRotationXDegs(F32 xDegs)
+    {
+        return CreateRotationXRads(DegToRad(xDegs));
+    }
+
+    inline Quat Quat::CreateRotationYDegs(F32 yDegs)
+    {
+        return CreateRotationYRads(DegToRad(yDegs));
+    }
+
+    inline Quat Quat::CreateRotationZDegs(F32 zDegs)
+    {
+        return CreateRotationZRads(DegToRad(zDegs));
+    }
+
+    inline Quat Quat::CreateRotationAroundAxisRads(const Vec3& axis, F32 rads)
+    {
+        Vec3 scaledAxis = axis.GetNormalized() * ::sinf(rads * 0.5f);
+        return Quat(scaledAxis.x, scaledAxis.y, scaledAxis.z, ::cosf(rads * 0.5f));
+    }
+
+    inline Quat Quat::CreateRotationAroundAxisDegs(const Vec3& axis, F32 degs)
+    {
+        return CreateRotationAroundAxisRads(axis, DegToRad(degs));
+    }
+
+    inline Quat Quat::CreateFromMat33(const Mat33& m)
+    {
+        // Pick the largest of w, x, y, z to divide by so the square root never sees a small value
+        F32 trace = m.ix + m.jy + m.kz;
+        if(trace > 0.0f)
+        {
+            F32 s = ::sqrtf(trace + 1.0f) * 2.0f;
+            F32 invS = 1.0f / s;
+            return Quat((m.jz - m.ky) * invS, (m.kx - m.iz) * invS, (m.iy - m.jx) * invS, 0.25f * s);
+        }
+        else if(m.ix > m.jy && m.ix > m.kz)
+        {
+            F32 s = ::sqrtf(1.0f + m.ix - m.jy - m.kz) * 2.0f;
+            F32 invS = 1.0f / s;
+            return Quat(0.25f * s, (m.jx + m.iy) * invS, (m.kx + m.iz) * invS, (m.jz - m.ky) * invS);
+        }
+        else if(m.jy > m.kz)
+        {
+            F32 s = ::sqrtf(1.0f + m.jy - m.ix - m.kz) * 2.0f;
+            F32 invS = 1.0f / s;
+            return Quat((m.jx + m.iy) * invS, 0.25f * s, (m.ky + m.jz) * invS, (m.kx - m.iz) * invS);
+        }
+        else
+        {
+            F32 s = ::sqrtf(1.0f + m.kz - m.ix - m.jy) * 2.0f;
+            F32 invS = 1.0f / s;
+            return Quat((m.kx + m.iz) * invS, (m.ky + m.jz) * invS, 0.25f * s, (m.iy - m.jx) * invS);
+        }
+    }
+
+    inline Quat Quat::CreateFromMat44(const Mat44& rotation)
+    {
+        return CreateFromMat33(rotation.GetRotationMat33());
+    }
+
+    inline F32 Dot(const Quat& a, const Quat& b)
+    {
+        return (a.x * b.x) + (a.y * b.y) + (a.z * b.z) + (a.w * b.w);
+    }
+
+    inline Quat Nlerp(const Quat& a, const Quat& b, F32 t)
+    {
+        Quat closestB = std::signbit(Dot(a, b)) ? -b : b;
+        Quat result = (a * (1.0f - t)) + (closestB * t);
+        result.Normalize();
+        return result;
+    }
+
+    inline F32 CalcFastSlerpT(F32 t, F32 absDot)
+    {
+        // Polynomial fit from https://zeux.io/2015/07/23/approximating-slerp/, stretches t towards the ends so nlerp
+        // moves at close to constant angular speed
+        F32 a = 1.0904f + absDot * (-3.2452f + absDot * (3.55645f - absDot * 1.43519f));
+        F32 b = 0.848013f + absDot * (-1.06021f + absDot * 0.215638f);
+        F32 k = (a * (t - 0.5f) * (t - 0.5f)) + b;
+        return t + (t * (t - 0.5f) * (t - 1.0f) * k);
+    }
+
+    inline Quat FastSlerp(const Quat& a, const Quat& b, F32 t)
+    {
+        return Nlerp(a, b, CalcFastSlerpT(t, ::fabsf(Dot(a, b))));
+    }
+
+    inline Quat Slerp(const Quat& a, const Quat& b, F32 t)
+    {
+        F32 cosAngle = Dot(a, b);
+        Quat closestB = b;
+        if(cosAngle < 0.0f)
+        {
+            cosAngle = -cosAngle;
+            closestB = -b;
+        }
+
+        // nearly identical rotations would divide by a tiny sine
+        if(cosAngle > 0.9995f)
+        {
+            return Nlerp(a, closestB, t);
+        }
+
+        F32 angle = ::acosf(cosAngle);
+        F32 invSinAngle = 1.0f / ::sinf(angle);
+        return (a * (::sinf((1.0f - t) * angle) * invSinAngle)) + (closestB * (::sinf(t * angle) * invSinAngle));
+    }
+
+    //-------------------------------------------------------------------------
+    // DualQuat
+    //-------------------------------------------------------------------------
+    inline DualQuat::DualQuat(const Quat& rotation, const Vec3& translation)
+        :m_real(rotation)
+        ,m_dual((rotation * Quat(translation.x, translation.y, translation.z, 0.0f)) * 0.5f)
+    {
+    }
+
+    inline DualQuat DualQuat::operator*(const DualQuat& other) const
+    {
+        DualQuat result;
+        result.m_real = m_real * other.m_real;
+        result.m_dual = (m_dual * other.m_real) + (m_real * other.m_dual);
+        return result;
+    }
+
+    inline DualQuat& DualQuat::operator*=(const DualQuat& other)
+    {
+        *this = *this * other;
+        return *this;
+    }
+
+    inline void DualQuat::Normalize()
+    {
+        F32 lenSq = m_real.CalcLengthSq();
+        SM_ASSERT(!IsCloseEnoughToZero(lenSq));
+
+        F32 invLen = 1.0f / ::sqrtf(lenSq);
+        m_real = m_real * invLen;
+        m_dual = m_dual * invLen;
+    }
+
+    inline DualQuat DualQuat::GetNormalized() const
+    {
+        DualQuat copy = *this;
+        copy.Normalize();
+        return copy;
+    }
+
+    inline void DualQuat::Conjugate()
+    {
+        m_real.Conjugate();
+        m_dual.Conjugate();
+    }
+
+    inline DualQuat DualQuat::GetConjugated() const
+    {
+        DualQuat copy = *this;
+        copy.Conjugate();
+        return copy;
+    }
+
+    inline Quat DualQuat::GetRotation() const
+    {
+        return m_real;
+    }
+
+    inline Vec3 DualQuat::GetTranslation() const
+    {
+        Quat t = m_real.GetConjugated() * m_dual;
+        return Vec3(t.x, t.y, t.z) * 2.0f;
+    }
+
+    inline Vec3 DualQuat::TransformPoint(const Vec3& point) const
+    {
+        return m_real.Rotate(point) + GetTranslation();
+    }
+
+    inline Vec3 DualQuat::TransformDir(const Vec3& dir) const
+    {
+        return m_real.Rotate(dir);
+    }
+
+    inline Mat44 DualQuat::ToMat44() const
+    {
+        Mat44 transform = m_real.ToMat44();
+        transform.SetTranslation(GetTranslation());
+        return transform;
+    }
+
+    inline DualQuat DualQuat::CreateFromMat44(const Mat44& transform)
+    {
+        return DualQuat(Quat::CreateFromMat44(transform), transform.GetTranslation());
+    }
+
+    inline DualQuat Nlerp(const DualQuat& a, const DualQuat& b, F32 t)
+    {
+        F32 bWeight = std::signbit(Dot(a.m_real, b.m_real)) ? -t : t;
+        DualQuat result;
+        result.m_real = (a.m_real * (1.0f - t)) + (b.m_real * bWeight);
+        result.m_dual = (a.m_dual * (1.0f - t)) + (b.m_dual * bWeight);
+        result.Normalize();
+        return result;
+    }
+
+    //-------------------------------------------------------------------------
+    // Frustum
+    //-------------------------------------------------------------------------
+    inline bool Frustum::IsSphereVisible(const Vec3& center, F32 radius) const
+    {
+        for(U32 i = 0; i < kNumFrustumPlanes; i++)
+        {
+            const Vec4& plane = m_planes[i];
+            F32 distance = (plane.x * center.x) + (plane.y * center.y) + (plane.z * center.z) + plane.w;
+            if(distance + radius < 0.0f)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline bool Frustum::IsAabbVisible(const Vec3& center, const Vec3& extents) const
+    {
+        for(U32 i = 0; i < kNumFrustumPlanes; i++)
+        {
+            // the box reaches as far towards the plane as its extents projected onto the normal
+            const Vec4& plane = m_planes[i];
+            F32 distance = (plane.x * center.x) + (plane.y * center.y) + (plane.z * center.z) + plane.w;
+            F32 reach = (::fabsf(plane.x) * extents.x) + (::fabsf(plane.y) * extents.y) + (::fabsf(plane.z) * extents.z);
+            if(distance + reach < 0.0f)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline Frustum Frustum::CreateFromViewProjection(const Mat44& m)
+    {
+        // Each clip space bound, e.g. -w <= x, is a plane in world space built from columns of the matrix since vectors are rows
+        Vec4 x(m.ix, m.jx, m.kx, m.tx);
+        Vec4 y(m.iy, m.jy, m.ky, m.ty);
+        Vec4 z(m.iz, m.jz, m.kz, m.tz);
+        Vec4 w(m.iw, m.jw, m.kw, m.tw);
+
+        Frustum frustum;
+        frustum.m_planes[kFrustumLeft] = w + x;
+        frustum.m_planes[kFrustumRight] = w - x;
+        frustum.m_planes[kFrustumBottom] = w + y;
+        frustum.m_planes[kFrustumTop] = w - y;
+        frustum.m_planes[kFrustumNear] = z;
+        frustum.m_planes[kFrustumFar] = w - z;
+
+        for(U32 i = 0; i < kNumFrustumPlanes; i++)
+        {
+            Vec4& plane = frustum.m_planes[i];
+            plane *= 1.0f / ::sqrtf((plane.x * plane.x) + (plane.y * plane.y) + (plane.z * plane.z));
+        }
+        return frustum;
     }
 }
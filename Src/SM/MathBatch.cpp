@@ -0,0 +1,1752 @@
+#include "SM/MathBatch.h"
+#include "SM/Assert.h"
+#include "SM/Simd.h"
+
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+using namespace SM;
+
+// gcc warns when a kernel without a target touches a wide vector, but kernels only ever run inlined into an entry point
+// that has the target so no vector crosses a call with the wrong abi
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+static const U32 kCullMaxThreads = 64;
+static const size_t kCullMinObjectsPerThread = KiB(16);
+
+//-------------------------------------------------------------------------
+// Lanes
+//-------------------------------------------------------------------------
+// Kernels are written once against these and instantiated per width. Load and Store are unaligned.
+struct ScalarLanes
+{
+    typedef F32 Lane;
+    static const size_t kWidth = 1;
+    static Lane Load(const F32* p) { return *p; }
+    static void Store(F32* p, Lane v) { *p = v; }
+    static Lane Splat(F32 s) { return s; }
+    static Lane Add(Lane a, Lane b) { return a + b; }
+    static Lane Sub(Lane a, Lane b) { return a - b; }
+    static Lane Mul(Lane a, Lane b) { return a * b; }
+    static Lane Div(Lane a, Lane b) { return a / b; }
+    static Lane Sqrt(Lane v) { return ::sqrtf(v); }
+    static Lane Abs(Lane v) { return ::fabsf(v); }
+    static Lane FlipSign(Lane v, Lane signSource) { return std::signbit(signSource) ? -v : v; }
+    static U32 LessThanMask(Lane a, Lane b) { return a < b ? 1 : 0; }
+
+    // Min and Max pick b when either is nan like minps / maxps
+    static Lane Min(Lane a, Lane b) { return a < b ? a : b; }
+    static Lane Max(Lane a, Lane b) { return a > b ? a : b; }
+
+    // Bit operations, see SimdAnd etc.
+    static U32 ToBits(Lane v) { U32 bits; ::memcpy(&bits, &v, sizeof(bits)); return bits; }
+    static Lane FromBits(U32 bits) { Lane v; ::memcpy(&v, &bits, sizeof(v)); return v; }
+    static Lane SplatBits(U32 bits) { return FromBits(bits); }
+    static Lane And(Lane a, Lane b) { return FromBits(ToBits(a) & ToBits(b)); }
+    static Lane Or(Lane a, Lane b) { return FromBits(ToBits(a) | ToBits(b)); }
+    static Lane Xor(Lane a, Lane b) { return FromBits(ToBits(a) ^ ToBits(b)); }
+    static Lane AndNot(Lane a, Lane b) { return FromBits(~ToBits(a) & ToBits(b)); }
+    static Lane Select(Lane mask, Lane a, Lane b) { return ToBits(mask) ? a : b; }
+    static Lane CmpLessThan(Lane a, Lane b) { return FromBits(a < b ? 0xffffffff : 0); }
+    static Lane SignMask(Lane v) { return FromBits((ToBits(v) & 0x80000000) ? 0xffffffff : 0); }
+    static Lane AddBits(Lane a, Lane b) { return FromBits(ToBits(a) + ToBits(b)); }
+    template<U32 k> static Lane ShiftLeftBits(Lane v) { return FromBits(ToBits(v) << k); }
+    template<U32 k> static Lane ShiftRightBits(Lane v) { return FromBits(ToBits(v) >> k); }
+    static Lane CmpLessThanBits(Lane a, Lane b) { return FromBits((I32)ToBits(a) < (I32)ToBits(b) ? 0xffffffff : 0); }
+
+    // Integer loads zero extend into the lane bits, stores keep the low bits of each lane. Interleaved stores write
+    // a0 b0 a1 b1 ...
+    static Lane LoadU16(const U16* p) { return FromBits(*p); }
+    static void StoreU16(U16* p, Lane bits) { *p = (U16)ToBits(bits); }
+    static void StoreU8(U8* p, Lane bits) { *p = (U8)ToBits(bits); }
+    static void StoreBits(U32* p, Lane bits) { U32 b = ToBits(bits); ::memcpy(p, &b, sizeof(b)); }
+    static void StoreInterleavedBits(U32* p, Lane a, Lane b) { StoreBits(p, a); StoreBits(p + 1, b); }
+
+    // Hardware half float conversions, see StoreF16 / LoadF16 on the avx lanes
+    static const bool kHasF16 = false;
+};
+
+#if SM_SIMD_ENABLED
+struct F32x4Lanes
+{
+    typedef F32x4 Lane;
+    static const size_t kWidth = 4;
+    static Lane Load(const F32* p) { return SimdLoadUnaligned(p); }
+    static void Store(F32* p, Lane v) { SimdStoreUnaligned(p, v); }
+    static Lane Splat(F32 s) { return SimdSplat(s); }
+    static Lane Add(Lane a, Lane b) { return SimdAdd(a, b); }
+    static Lane Sub(Lane a, Lane b) { return SimdSub(a, b); }
+    static Lane Mul(Lane a, Lane b) { return SimdMul(a, b); }
+    static Lane Div(Lane a, Lane b) { return SimdDiv(a, b); }
+    static Lane Sqrt(Lane v) { return SimdSqrt(v); }
+    static Lane Abs(Lane v) { return SimdAbs(v); }
+    static Lane FlipSign(Lane v, Lane signSource) { return SimdFlipSign(v, signSource); }
+    static U32 LessThanMask(Lane a, Lane b) { return SimdLessThanMask(a, b); }
+    static Lane Min(Lane a, Lane b) { return SimdMin(a, b); }
+    static Lane Max(Lane a, Lane b) { return SimdMax(a, b); }
+    static Lane SplatBits(U32 bits) { return SimdSplatBits(bits); }
+    static Lane And(Lane a, Lane b) { return SimdAnd(a, b); }
+    static Lane Or(Lane a, Lane b) { return SimdOr(a, b); }
+    static Lane Xor(Lane a, Lane b) { return SimdXor(a, b); }
+    static Lane AndNot(Lane a, Lane b) { return SimdAndNot(a, b); }
+    static Lane Select(Lane mask, Lane a, Lane b) { return SimdSelect(mask, a, b); }
+    static Lane CmpLessThan(Lane a, Lane b) { return SimdCmpLessThan(a, b); }
+    static Lane SignMask(Lane v) { return SimdSignMask(v); }
+    static Lane AddBits(Lane a, Lane b) { return SimdAddBits(a, b); }
+    template<U32 k> static Lane ShiftLeftBits(Lane v) { return SimdShiftLeftBits<k>(v); }
+    template<U32 k> static Lane ShiftRightBits(Lane v) { return SimdShiftRightBits<k>(v); }
+    static Lane CmpLessThanBits(Lane a, Lane b) { return SimdCmpLessThanBits(a, b); }
+    static Lane LoadU16(const U16* p) { return SimdLoadU16(p); }
+    static void StoreU16(U16* p, Lane bits) { SimdStoreU16(p, bits); }
+    static void StoreU8(U8* p, Lane bits) { SimdStoreU8(p, bits); }
+    static void StoreBits(U32* p, Lane bits) { SimdStoreUnaligned((F32*)p, bits); }
+    static void StoreInterleavedBits(U32* p, Lane a, Lane b)
+    {
+        SimdStoreUnaligned((F32*)p, SimdSwizzle<0, 2, 1, 3>(SimdShuffle<0, 1, 0, 1>(a, b)));
+        SimdStoreUnaligned((F32*)p + 4, SimdSwizzle<0, 2, 1, 3>(SimdShuffle<2, 3, 2, 3>(a, b)));
+    }
+    static const bool kHasF16 = false;
+};
+#endif
+
+#if SM_SIMD_AVX
+struct Avx2Lanes
+{
+    typedef __m256 Lane;
+    static const size_t kWidth = 8;
+    SM_SIMD_TARGET_AVX2 static Lane Load(const F32* p) { return _mm256_loadu_ps(p); }
+    SM_SIMD_TARGET_AVX2 static void Store(F32* p, Lane v) { _mm256_storeu_ps(p, v); }
+    SM_SIMD_TARGET_AVX2 static Lane Splat(F32 s) { return _mm256_set1_ps(s); }
+    SM_SIMD_TARGET_AVX2 static Lane Add(Lane a, Lane b) { return _mm256_add_ps(a, b); }
+    SM_SIMD_TARGET_AVX2 static Lane Sub(Lane a, Lane b) { return _mm256_sub_ps(a, b); }
+    SM_SIMD_TARGET_AVX2 static Lane Mul(Lane a, Lane b) { return _mm256_mul_ps(a, b); }
+    SM_SIMD_TARGET_AVX2 static Lane Div(Lane a, Lane b) { return _mm256_div_ps(a, b); }
+    SM_SIMD_TARGET_AVX2 static Lane Sqrt(Lane v) { return _mm256_sqrt_ps(v); }
+    SM_SIMD_TARGET_AVX2 static Lane Abs(Lane v) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v); }
+    SM_SIMD_TARGET_AVX2 static Lane FlipSign(Lane v, Lane signSource) { return _mm256_xor_ps(v, _mm256_and_ps(signSource, _mm256_set1_ps(-0.0f))); }
+    SM_SIMD_TARGET_AVX2 static U32 LessThanMask(Lane a, Lane b) { return (U32)_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LT_OQ)); }
+    SM_SIMD_TARGET_AVX2 static Lane Min(Lane a, Lane b) { return _mm256_min_ps(a, b); }
+    SM_SIMD_TARGET_AVX2 static Lane Max(Lane a, Lane b) { return _mm256_max_ps(a, b); }
+    SM_SIMD_TARGET_AVX2 static Lane SplatBits(U32 bits) { return _mm256_castsi256_ps(_mm256_set1_epi32((I32)bits)); }
+    SM_SIMD_TARGET_AVX2 static Lane And(Lane a, Lane b) { return _mm256_and_ps(a, b); }
+    SM_SIMD_TARGET_AVX2 static Lane Or(Lane a, Lane b) { return _mm256_or_ps(a, b); }
+    SM_SIMD_TARGET_AVX2 static Lane Xor(Lane a, Lane b) { return _mm256_xor_ps(a, b); }
+    SM_SIMD_TARGET_AVX2 static Lane AndNot(Lane a, Lane b) { return _mm256_andnot_ps(a, b); }
+    SM_SIMD_TARGET_AVX2 static Lane Select(Lane mask, Lane a, Lane b) { return _mm256_blendv_ps(b, a, mask); }
+    SM_SIMD_TARGET_AVX2 static Lane CmpLessThan(Lane a, Lane b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    SM_SIMD_TARGET_AVX2 static Lane SignMask(Lane v) { return _mm256_castsi256_ps(_mm256_srai_epi32(_mm256_castps_si256(v), 31)); }
+    SM_SIMD_TARGET_AVX2 static Lane AddBits(Lane a, Lane b) { return _mm256_castsi256_ps(_mm256_add_epi32(_mm256_castps_si256(a), _mm256_castps_si256(b))); }
+    template<U32 k> SM_SIMD_TARGET_AVX2 static Lane ShiftLeftBits(Lane v) { return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_castps_si256(v), k)); }
+    template<U32 k> SM_SIMD_TARGET_AVX2 static Lane ShiftRightBits(Lane v) { return _mm256_castsi256_ps(_mm256_srli_epi32(_mm256_castps_si256(v), k)); }
+    SM_SIMD_TARGET_AVX2 static Lane CmpLessThanBits(Lane a, Lane b) { return _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_castps_si256(b), _mm256_castps_si256(a))); }
+    SM_SIMD_TARGET_AVX2 static Lane LoadU16(const U16* p) { return _mm256_castsi256_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)p))); }
+
+    // masked first so the saturating packs keep every value as it is
+    SM_SIMD_TARGET_AVX2 static void StoreU16(U16* p, Lane bits)
+    {
+        __m256i words = _mm256_and_si256(_mm256_castps_si256(bits), _mm256_set1_epi32(0xffff));
+        _mm_storeu_si128((__m128i*)p, _mm_packus_epi32(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1)));
+    }
+
+    SM_SIMD_TARGET_AVX2 static void StoreU8(U8* p, Lane bits)
+    {
+        __m256i bytes = _mm256_and_si256(_mm256_castps_si256(bits), _mm256_set1_epi32(0xff));
+        __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(bytes), _mm256_extracti128_si256(bytes, 1));
+        _mm_storel_epi64((__m128i*)p, _mm_packus_epi16(words, words));
+    }
+
+    SM_SIMD_TARGET_AVX2 static void StoreBits(U32* p, Lane bits) { _mm256_storeu_ps((F32*)p, bits); }
+
+    SM_SIMD_TARGET_AVX2 static void StoreInterleavedBits(U32* p, Lane a, Lane b)
+    {
+        // unpacks work within 128 bit halves, low = a0 b0 a1 b1 | a4 b4 a5 b5 and high = a2 b2 a3 b3 | a6 b6 a7 b7
+        __m256 low = _mm256_unpacklo_ps(a, b);
+        __m256 high = _mm256_unpackhi_ps(a, b);
+        _mm256_storeu_ps((F32*)p, _mm256_permute2f128_ps(low, high, 0x20));
+        _mm256_storeu_ps((F32*)p + 8, _mm256_permute2f128_ps(low, high, 0x31));
+    }
+
+    static const bool kHasF16 = true;
+    SM_SIMD_TARGET_AVX2 static void StoreF16(U16* p, Lane v) { _mm_storeu_si128((__m128i*)p, _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT)); }
+    SM_SIMD_TARGET_AVX2 static Lane LoadF16(const U16* p) { return _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)p)); }
+};
+
+struct Avx512Lanes
+{
+    typedef __m512 Lane;
+    static const size_t kWidth = 16;
+    SM_SIMD_TARGET_AVX512 static Lane Load(const F32* p) { return _mm512_loadu_ps(p); }
+    SM_SIMD_TARGET_AVX512 static void Store(F32* p, Lane v) { _mm512_storeu_ps(p, v); }
+    SM_SIMD_TARGET_AVX512 static Lane Splat(F32 s) { return _mm512_set1_ps(s); }
+    SM_SIMD_TARGET_AVX512 static Lane Add(Lane a, Lane b) { return _mm512_add_ps(a, b); }
+    SM_SIMD_TARGET_AVX512 static Lane Sub(Lane a, Lane b) { return _mm512_sub_ps(a, b); }
+    SM_SIMD_TARGET_AVX512 static Lane Mul(Lane a, Lane b) { return _mm512_mul_ps(a, b); }
+    SM_SIMD_TARGET_AVX512 static Lane Div(Lane a, Lane b) { return _mm512_div_ps(a, b); }
+    SM_SIMD_TARGET_AVX512 static Lane Sqrt(Lane v) { return _mm512_sqrt_ps(v); }
+
+    // float and / xor need avx512dq, the integer forms only need avx512f
+    SM_SIMD_TARGET_AVX512 static Lane Abs(Lane v)
+    {
+        return _mm512_castsi512_ps(_mm512_and_epi32(_mm512_castps_si512(v), _mm512_set1_epi32(0x7fffffff)));
+    }
+
+    SM_SIMD_TARGET_AVX512 static Lane FlipSign(Lane v, Lane signSource)
+    {
+        __m512i signBits = _mm512_and_epi32(_mm512_castps_si512(signSource), _mm512_set1_epi32((I32)0x80000000));
+        return _mm512_castsi512_ps(_mm512_xor_epi32(_mm512_castps_si512(v), signBits));
+    }
+
+    SM_SIMD_TARGET_AVX512 static U32 LessThanMask(Lane a, Lane b) { return (U32)_mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+    SM_SIMD_TARGET_AVX512 static Lane Min(Lane a, Lane b) { return _mm512_min_ps(a, b); }
+    SM_SIMD_TARGET_AVX512 static Lane Max(Lane a, Lane b) { return _mm512_max_ps(a, b); }
+    SM_SIMD_TARGET_AVX512 static __m512i ToBits(Lane v) { return _mm512_castps_si512(v); }
+    SM_SIMD_TARGET_AVX512 static Lane FromBits(__m512i bits) { return _mm512_castsi512_ps(bits); }
+    SM_SIMD_TARGET_AVX512 static Lane SplatBits(U32 bits) { return FromBits(_mm512_set1_epi32((I32)bits)); }
+    SM_SIMD_TARGET_AVX512 static Lane And(Lane a, Lane b) { return FromBits(_mm512_and_epi32(ToBits(a), ToBits(b))); }
+    SM_SIMD_TARGET_AVX512 static Lane Or(Lane a, Lane b) { return FromBits(_mm512_or_epi32(ToBits(a), ToBits(b))); }
+    SM_SIMD_TARGET_AVX512 static Lane Xor(Lane a, Lane b) { return FromBits(_mm512_xor_epi32(ToBits(a), ToBits(b))); }
+    SM_SIMD_TARGET_AVX512 static Lane AndNot(Lane a, Lane b) { return FromBits(_mm512_andnot_epi32(ToBits(a), ToBits(b))); }
+    SM_SIMD_TARGET_AVX512 static Lane Select(Lane mask, Lane a, Lane b)
+    {
+        return _mm512_mask_blend_ps(_mm512_test_epi32_mask(ToBits(mask), ToBits(mask)), b, a);
+    }
+    SM_SIMD_TARGET_AVX512 static Lane CmpLessThan(Lane a, Lane b)
+    {
+        return FromBits(_mm512_maskz_mov_epi32(_mm512_cmp_ps_mask(a, b, _CMP_LT_OQ), _mm512_set1_epi32(-1)));
+    }
+    SM_SIMD_TARGET_AVX512 static Lane SignMask(Lane v) { return FromBits(_mm512_srai_epi32(ToBits(v), 31)); }
+    SM_SIMD_TARGET_AVX512 static Lane AddBits(Lane a, Lane b) { return FromBits(_mm512_add_epi32(ToBits(a), ToBits(b))); }
+    template<U32 k> SM_SIMD_TARGET_AVX512 static Lane ShiftLeftBits(Lane v) { return FromBits(_mm512_slli_epi32(ToBits(v), k)); }
+    template<U32 k> SM_SIMD_TARGET_AVX512 static Lane ShiftRightBits(Lane v) { return FromBits(_mm512_srli_epi32(ToBits(v), k)); }
+    SM_SIMD_TARGET_AVX512 static Lane CmpLessThanBits(Lane a, Lane b)
+    {
+        return FromBits(_mm512_maskz_mov_epi32(_mm512_cmplt_epi32_mask(ToBits(a), ToBits(b)), _mm512_set1_epi32(-1)));
+    }
+    SM_SIMD_TARGET_AVX512 static Lane LoadU16(const U16* p) { return FromBits(_mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*)p))); }
+    SM_SIMD_TARGET_AVX512 static void StoreU16(U16* p, Lane bits) { _mm256_storeu_si256((__m256i*)p, _mm512_cvtepi32_epi16(ToBits(bits))); }
+    SM_SIMD_TARGET_AVX512 static void StoreU8(U8* p, Lane bits) { _mm_storeu_si128((__m128i*)p, _mm512_cvtepi32_epi8(ToBits(bits))); }
+    SM_SIMD_TARGET_AVX512 static void StoreBits(U32* p, Lane bits) { _mm512_storeu_ps((F32*)p, bits); }
+    SM_SIMD_TARGET_AVX512 static void StoreInterleavedBits(U32* p, Lane a, Lane b)
+    {
+        const __m512i lowIndices = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+        const __m512i highIndices = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+        _mm512_storeu_ps((F32*)p, _mm512_permutex2var_ps(a, lowIndices, b));
+        _mm512_storeu_ps((F32*)p + 16, _mm512_permutex2var_ps(a, highIndices, b));
+    }
+
+    static const bool kHasF16 = true;
+    SM_SIMD_TARGET_AVX512 static void StoreF16(U16* p, Lane v) { _mm256_storeu_si256((__m256i*)p, _mm512_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT)); }
+    SM_SIMD_TARGET_AVX512 static Lane LoadF16(const U16* p) { return _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)p)); }
+};
+
+template<template<typename> class Kernel, typename... Args>
+SM_SIMD_ENTRY_AVX2 static size_t RunKernelAvx2(size_t count, const Args&... args)
+{
+    return Kernel<Avx2Lanes>::Run(0, count, args...);
+}
+
+template<template<typename> class Kernel, typename... Args>
+SM_SIMD_ENTRY_AVX512 static size_t RunKernelAvx512(size_t count, const Args&... args)
+{
+    return Kernel<Avx512Lanes>::Run(0, count, args...);
+}
+#endif
+
+// Runs the widest kernel the current simd level allows, then narrower ones over whatever is left.
+// Kernel<Lanes>::Run(begin, count, args...) handles whole groups of kWidth elements from begin and returns where it stopped.
+template<template<typename> class Kernel, typename... Args>
+static void RunKernel(size_t count, const Args&... args)
+{
+    size_t i = 0;
+    SimdLevel level = GetSimdLevel();
+
+    #if SM_SIMD_AVX
+    if(level >= kSimdLevelAvx512)
+    {
+        i = RunKernelAvx512<Kernel>(count, args...);
+    }
+    else if(level >= kSimdLevelAvx2)
+    {
+        i = RunKernelAvx2<Kernel>(count, args...);
+    }
+    #endif
+
+    #if SM_SIMD_ENABLED
+    if(level >= kSimdLevelF32x4)
+    {
+        i = Kernel<F32x4Lanes>::Run(i, count, args...);
+    }
+    #endif
+
+    Kernel<ScalarLanes>::Run(i, count, args...);
+}
+
+//-------------------------------------------------------------------------
+// Approximations
+//-------------------------------------------------------------------------
+// Single precision polynomials from Cephes (sinf, cosf, expf, logf, atanf) after Cody-Waite range reduction. Every
+// width runs the same operations in the same order so scalar and simd results are bit identical.
+
+// Adding 1.5 * 2^23 rounds any |v| < 2^22 to the nearest integer, which then sits in the low mantissa bits
+static const F32 kRoundMagic = 12582912.0f;
+
+// pi / 2 split so the first two parts times a quadrant count are exact
+static const F32 kApproxHalfPi0 = 1.5703125f;
+static const F32 kApproxHalfPi1 = 4.837512969970703125e-4f;
+static const F32 kApproxHalfPi2 = 7.54978995489188216e-8f;
+
+// ln 2 split the same way
+static const F32 kApproxLn2Hi = 0.693359375f;
+static const F32 kApproxLn2Lo = -2.12194440e-4f;
+
+// expf is clamped to where 2^n can be added straight into the exponent bits
+static const F32 kApproxExpMin = -86.9f;
+static const F32 kApproxExpMax = 88.72f;
+
+template<typename L, bool bDegrees>
+SM_SIMD_KERNEL static void ApproxSinCos(const typename L::Lane& x, typename L::Lane& outSin, typename L::Lane& outCos)
+{
+    typedef typename L::Lane Lane;
+    const Lane magic = L::Splat(kRoundMagic);
+
+    // x = r + quadrant * pi / 2 with |r| <= pi / 4, degrees reduce exactly before converting
+    Lane quadrantBits;
+    Lane r;
+    if constexpr (bDegrees)
+    {
+        quadrantBits = L::Add(L::Mul(x, L::Splat(1.0f / 90.0f)), magic);
+        Lane quadrant = L::Sub(quadrantBits, magic);
+        r = L::Mul(L::Sub(x, L::Mul(quadrant, L::Splat(90.0f))), L::Splat(kPi / 180.0f));
+    }
+    else
+    {
+        quadrantBits = L::Add(L::Mul(x, L::Splat(2.0f / kPi)), magic);
+        Lane quadrant = L::Sub(quadrantBits, magic);
+        r = L::Sub(L::Sub(L::Sub(x, L::Mul(quadrant, L::Splat(kApproxHalfPi0))), L::Mul(quadrant, L::Splat(kApproxHalfPi1))), L::Mul(quadrant, L::Splat(kApproxHalfPi2)));
+    }
+
+    Lane z = L::Mul(r, r);
+    Lane sinR = L::Add(L::Mul(L::Mul(L::Sub(L::Mul(L::Add(L::Mul(L::Splat(-1.9515295891e-4f), z), L::Splat(8.3321608736e-3f)), z), L::Splat(1.6666654611e-1f)), z), r), r);
+    Lane cosR = L::Mul(L::Mul(L::Add(L::Mul(L::Sub(L::Mul(L::Splat(2.443315711809948e-5f), z), L::Splat(1.388731625493765e-3f)), z), L::Splat(4.166664568298827e-2f)), z), z);
+    cosR = L::Add(L::Sub(cosR, L::Mul(L::Splat(0.5f), z)), L::Splat(1.0f));
+
+    // odd quadrants swap sin and cos, quadrants 2 and 3 negate sin and quadrants 1 and 2 negate cos
+    const Lane signBit = L::SplatBits(0x80000000);
+    Lane swap = L::SignMask(L::template ShiftLeftBits<31>(quadrantBits));
+    Lane sinSign = L::And(L::template ShiftLeftBits<30>(quadrantBits), signBit);
+    Lane cosSign = L::And(L::template ShiftLeftBits<30>(L::AddBits(quadrantBits, L::SplatBits(1))), signBit);
+    outSin = L::Xor(L::Select(swap, cosR, sinR), sinSign);
+    outCos = L::Xor(L::Select(swap, sinR, cosR), cosSign);
+}
+
+template<typename L>
+SM_SIMD_KERNEL static void ApproxExp(const typename L::Lane& x, typename L::Lane& outResult)
+{
+    typedef typename L::Lane Lane;
+    const Lane magic = L::Splat(kRoundMagic);
+
+    // e^x = 2^n * e^r with |r| <= ln 2 / 2
+    Lane clamped = L::Min(L::Max(x, L::Splat(kApproxExpMin)), L::Splat(kApproxExpMax));
+    Lane nBits = L::Add(L::Mul(clamped, L::Splat(1.44269504088896341f)), magic);
+    Lane n = L::Sub(nBits, magic);
+    Lane r = L::Sub(L::Sub(clamped, L::Mul(n, L::Splat(kApproxLn2Hi))), L::Mul(n, L::Splat(kApproxLn2Lo)));
+
+    Lane p = L::Add(L::Mul(L::Splat(1.9875691500e-4f), r), L::Splat(1.3981999507e-3f));
+    p = L::Add(L::Mul(p, r), L::Splat(8.3334519073e-3f));
+    p = L::Add(L::Mul(p, r), L::Splat(4.1665795894e-2f));
+    p = L::Add(L::Mul(p, r), L::Splat(1.6666665459e-1f));
+    p = L::Add(L::Mul(p, r), L::Splat(5.0000001201e-1f));
+    p = L::Add(L::Add(L::Mul(p, L::Mul(r, r)), r), L::Splat(1.0f));
+
+    // the low bits of nBits hold n, shifted up they add n to the exponent of p
+    Lane result = L::AddBits(p, L::template ShiftLeftBits<23>(nBits));
+    result = L::AndNot(L::CmpLessThan(x, L::Splat(kApproxExpMin)), result);
+    outResult = L::Select(L::CmpLessThan(L::Splat(kApproxExpMax), x), L::Splat(INFINITY), result);
+}
+
+template<typename L>
+SM_SIMD_KERNEL static void ApproxLog(const typename L::Lane& x, typename L::Lane& outResult)
+{
+    typedef typename L::Lane Lane;
+
+    // x = m * 2^e with m in [sqrt(0.5), sqrt(2)), the biased exponent is turned into a float by making it the
+    // mantissa of 2^23
+    Lane e = L::Sub(L::Or(L::template ShiftRightBits<23>(x), L::SplatBits(0x4b000000)), L::Splat(8388608.0f + 126.0f));
+    Lane m = L::Or(L::And(x, L::SplatBits(0x007fffff)), L::SplatBits(0x3f000000));
+    Lane small = L::CmpLessThan(m, L::Splat(0.707106781186547524f));
+    e = L::Sub(e, L::And(small, L::Splat(1.0f)));
+    m = L::Sub(L::Add(m, L::And(small, m)), L::Splat(1.0f));
+
+    Lane z = L::Mul(m, m);
+    Lane p = L::Sub(L::Mul(L::Splat(7.0376836292e-2f), m), L::Splat(1.1514610310e-1f));
+    p = L::Add(L::Mul(p, m), L::Splat(1.1676998740e-1f));
+    p = L::Sub(L::Mul(p, m), L::Splat(1.2420140846e-1f));
+    p = L::Add(L::Mul(p, m), L::Splat(1.4249322787e-1f));
+    p = L::Sub(L::Mul(p, m), L::Splat(1.6668057665e-1f));
+    p = L::Add(L::Mul(p, m), L::Splat(2.0000714765e-1f));
+    p = L::Sub(L::Mul(p, m), L::Splat(2.4999993993e-1f));
+    p = L::Add(L::Mul(p, m), L::Splat(3.3333331174e-1f));
+    p = L::Mul(L::Mul(p, m), z);
+    p = L::Add(p, L::Mul(e, L::Splat(kApproxLn2Lo)));
+    p = L::Sub(p, L::Mul(z, L::Splat(0.5f)));
+    outResult = L::Add(L::Add(m, p), L::Mul(e, L::Splat(kApproxLn2Hi)));
+}
+
+template<typename L>
+SM_SIMD_KERNEL static void ApproxAtan2(const typename L::Lane& y, const typename L::Lane& x, typename L::Lane& outResult)
+{
+    typedef typename L::Lane Lane;
+    const Lane zero = L::Splat(0.0f);
+
+    // atan of min / max in [0, 1], then mirrored into the right octant. 0 / 0 gives 0.
+    Lane absX = L::Abs(x);
+    Lane absY = L::Abs(y);
+    Lane maxAbs = L::Max(absX, absY);
+    Lane a = L::And(L::CmpLessThan(zero, maxAbs), L::Div(L::Min(absX, absY), maxAbs));
+
+    // above tan(pi / 8) use atan(a) = pi / 4 + atan((a - 1) / (a + 1))
+    Lane upper = L::CmpLessThan(L::Splat(0.414213562373095f), a);
+    Lane t = L::Select(upper, L::Div(L::Sub(a, L::Splat(1.0f)), L::Add(a, L::Splat(1.0f))), a);
+    Lane z = L::Mul(t, t);
+    Lane p = L::Sub(L::Mul(L::Splat(8.05374449538e-2f), z), L::Splat(1.38776856032e-1f));
+    p = L::Add(L::Mul(p, z), L::Splat(1.99777106478e-1f));
+    p = L::Sub(L::Mul(p, z), L::Splat(3.33329491539e-1f));
+    Lane result = L::Add(L::Add(L::Mul(L::Mul(p, z), t), t), L::And(upper, L::Splat(kPi * 0.25f)));
+
+    result = L::Select(L::CmpLessThan(absX, absY), L::Sub(L::Splat(kPi * 0.5f), result), result);
+    result = L::Select(L::SignMask(x), L::Sub(L::Splat(kPi), result), result);
+    outResult = L::FlipSign(result, y);
+}
+
+//-------------------------------------------------------------------------
+// Kernels
+//-------------------------------------------------------------------------
+template<bool bPoints>
+struct TransformKernels
+{
+    template<typename L>
+    struct Uniform
+    {
+        SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const Mat44& m, const Vec3SoA& in, const Vec3SoA& out)
+        {
+            typedef typename L::Lane Lane;
+            Lane ix = L::Splat(m.ix); Lane iy = L::Splat(m.iy); Lane iz = L::Splat(m.iz);
+            Lane jx = L::Splat(m.jx); Lane jy = L::Splat(m.jy); Lane jz = L::Splat(m.jz);
+            Lane kx = L::Splat(m.kx); Lane ky = L::Splat(m.ky); Lane kz = L::Splat(m.kz);
+            Lane tx = L::Splat(m.tx); Lane ty = L::Splat(m.ty); Lane tz = L::Splat(m.tz);
+
+            for(; i + L::kWidth <= count; i += L::kWidth)
+            {
+                Lane x = L::Load(in.m_pX + i);
+                Lane y = L::Load(in.m_pY + i);
+                Lane z = L::Load(in.m_pZ + i);
+                Lane resultX = L::Add(L::Add(L::Mul(x, ix), L::Mul(y, jx)), L::Mul(z, kx));
+                Lane resultY = L::Add(L::Add(L::Mul(x, iy), L::Mul(y, jy)), L::Mul(z, ky));
+                Lane resultZ = L::Add(L::Add(L::Mul(x, iz), L::Mul(y, jz)), L::Mul(z, kz));
+                if constexpr (bPoints)
+                {
+                    resultX = L::Add(resultX, tx);
+                    resultY = L::Add(resultY, ty);
+                    resultZ = L::Add(resultZ, tz);
+                }
+                L::Store(out.m_pX + i, resultX);
+                L::Store(out.m_pY + i, resultY);
+                L::Store(out.m_pZ + i, resultZ);
+            }
+            return i;
+        }
+    };
+
+    template<typename L>
+    struct PerElement
+    {
+        SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const Mat44SoA& m, const Vec3SoA& in, const Vec3SoA& out)
+        {
+            typedef typename L::Lane Lane;
+            F32* const* e = m.m_pElements;
+
+            for(; i + L::kWidth <= count; i += L::kWidth)
+            {
+                Lane x = L::Load(in.m_pX + i);
+                Lane y = L::Load(in.m_pY + i);
+                Lane z = L::Load(in.m_pZ + i);
+                Lane resultX = L::Add(L::Add(L::Mul(x, L::Load(e[0] + i)), L::Mul(y, L::Load(e[4] + i))), L::Mul(z, L::Load(e[8] + i)));
+                Lane resultY = L::Add(L::Add(L::Mul(x, L::Load(e[1] + i)), L::Mul(y, L::Load(e[5] + i))), L::Mul(z, L::Load(e[9] + i)));
+                Lane resultZ = L::Add(L::Add(L::Mul(x, L::Load(e[2] + i)), L::Mul(y, L::Load(e[6] + i))), L::Mul(z, L::Load(e[10] + i)));
+                if constexpr (bPoints)
+                {
+                    resultX = L::Add(resultX, L::Load(e[12] + i));
+                    resultY = L::Add(resultY, L::Load(e[13] + i));
+                    resultZ = L::Add(resultZ, L::Load(e[14] + i));
+                }
+                L::Store(out.m_pX + i, resultX);
+                L::Store(out.m_pY + i, resultY);
+                L::Store(out.m_pZ + i, resultZ);
+            }
+            return i;
+        }
+    };
+};
+
+template<typename L>
+struct MultiplyMatricesKernel
+{
+    SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const Mat44SoA& a, const Mat44SoA& b, const Mat44SoA& out)
+    {
+        typedef typename L::Lane Lane;
+
+        for(; i + L::kWidth <= count; i += L::kWidth)
+        {
+            // all of b is loaded up front and each row of a is read before that row of out is written, so out may alias either input
+            Lane bElements[16];
+            for(U32 e = 0; e < 16; e++)
+            {
+                bElements[e] = L::Load(b.m_pElements[e] + i);
+            }
+
+            for(U32 row = 0; row < 4; row++)
+            {
+                Lane a0 = L::Load(a.m_pElements[row * 4 + 0] + i);
+                Lane a1 = L::Load(a.m_pElements[row * 4 + 1] + i);
+                Lane a2 = L::Load(a.m_pElements[row * 4 + 2] + i);
+                Lane a3 = L::Load(a.m_pElements[row * 4 + 3] + i);
+
+                Lane results[4];
+                for(U32 col = 0; col < 4; col++)
+                {
+                    results[col] = L::Add(L::Add(L::Add(L::Mul(a0, bElements[col]),
+                                                        L::Mul(a1, bElements[4 + col])),
+                                                        L::Mul(a2, bElements[8 + col])),
+                                                        L::Mul(a3, bElements[12 + col]));
+                }
+
+                for(U32 col = 0; col < 4; col++)
+                {
+                    L::Store(out.m_pElements[row * 4 + col] + i, results[col]);
+                }
+            }
+        }
+        return i;
+    }
+};
+
+template<typename L>
+struct MultiplyQuatsKernel
+{
+    SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const QuatSoA& a, const QuatSoA& b, const QuatSoA& out)
+    {
+        typedef typename L::Lane Lane;
+
+        for(; i + L::kWidth <= count; i += L::kWidth)
+        {
+            Lane ax = L::Load(a.m_pX + i); Lane ay = L::Load(a.m_pY + i); Lane az = L::Load(a.m_pZ + i); Lane aw = L::Load(a.m_pW + i);
+            Lane bx = L::Load(b.m_pX + i); Lane by = L::Load(b.m_pY + i); Lane bz = L::Load(b.m_pZ + i); Lane bw = L::Load(b.m_pW + i);
+
+            // same terms and order as Quat::operator*
+            Lane x = L::Sub(L::Add(L::Add(L::Mul(bw, ax), L::Mul(bx, aw)), L::Mul(by, az)), L::Mul(bz, ay));
+            Lane y = L::Add(L::Add(L::Sub(L::Mul(bw, ay), L::Mul(bx, az)), L::Mul(by, aw)), L::Mul(bz, ax));
+            Lane z = L::Add(L::Sub(L::Add(L::Mul(bw, az), L::Mul(bx, ay)), L::Mul(by, ax)), L::Mul(bz, aw));
+            Lane w = L::Sub(L::Sub(L::Sub(L::Mul(bw, aw), L::Mul(bx, ax)), L::Mul(by, ay)), L::Mul(bz, az));
+            L::Store(out.m_pX + i, x);
+            L::Store(out.m_pY + i, y);
+            L::Store(out.m_pZ + i, z);
+            L::Store(out.m_pW + i, w);
+        }
+        return i;
+    }
+};
+
+template<bool bFastSlerp>
+struct LerpQuatsKernels
+{
+    template<typename L>
+    struct Kernel
+    {
+        SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const QuatSoA& a, const QuatSoA& b, const F32& t, const QuatSoA& out)
+        {
+            typedef typename L::Lane Lane;
+            Lane one = L::Splat(1.0f);
+            Lane uniformT = L::Splat(t);
+
+            for(; i + L::kWidth <= count; i += L::kWidth)
+            {
+                Lane ax = L::Load(a.m_pX + i); Lane ay = L::Load(a.m_pY + i); Lane az = L::Load(a.m_pZ + i); Lane aw = L::Load(a.m_pW + i);
+                Lane bx = L::Load(b.m_pX + i); Lane by = L::Load(b.m_pY + i); Lane bz = L::Load(b.m_pZ + i); Lane bw = L::Load(b.m_pW + i);
+                Lane dot = L::Add(L::Add(L::Add(L::Mul(ax, bx), L::Mul(ay, by)), L::Mul(az, bz)), L::Mul(aw, bw));
+
+                // same steps as Nlerp and CalcFastSlerpT
+                Lane lerpT = uniformT;
+                if constexpr (bFastSlerp)
+                {
+                    Lane absDot = L::Abs(dot);
+                    Lane tMinusHalf = L::Sub(uniformT, L::Splat(0.5f));
+                    Lane polyA = L::Add(L::Splat(1.0904f), L::Mul(absDot, L::Add(L::Splat(-3.2452f), L::Mul(absDot, L::Sub(L::Splat(3.55645f), L::Mul(absDot, L::Splat(1.43519f)))))));
+                    Lane polyB = L::Add(L::Splat(0.848013f), L::Mul(absDot, L::Add(L::Splat(-1.06021f), L::Mul(absDot, L::Splat(0.215638f)))));
+                    Lane k = L::Add(L::Mul(L::Mul(polyA, tMinusHalf), tMinusHalf), polyB);
+                    lerpT = L::Add(uniformT, L::Mul(L::Mul(L::Mul(uniformT, tMinusHalf), L::Sub(uniformT, one)), k));
+                }
+
+                Lane aWeight = L::Sub(one, lerpT);
+                Lane x = L::Add(L::Mul(ax, aWeight), L::Mul(L::FlipSign(bx, dot), lerpT));
+                Lane y = L::Add(L::Mul(ay, aWeight), L::Mul(L::FlipSign(by, dot), lerpT));
+                Lane z = L::Add(L::Mul(az, aWeight), L::Mul(L::FlipSign(bz, dot), lerpT));
+                Lane w = L::Add(L::Mul(aw, aWeight), L::Mul(L::FlipSign(bw, dot), lerpT));
+
+                Lane lenSq = L::Add(L::Add(L::Add(L::Mul(x, x), L::Mul(y, y)), L::Mul(z, z)), L::Mul(w, w));
+                Lane invLen = L::Div(one, L::Sqrt(lenSq));
+                L::Store(out.m_pX + i, L::Mul(x, invLen));
+                L::Store(out.m_pY + i, L::Mul(y, invLen));
+                L::Store(out.m_pZ + i, L::Mul(z, invLen));
+                L::Store(out.m_pW + i, L::Mul(w, invLen));
+            }
+            return i;
+        }
+    };
+};
+
+template<typename L>
+struct RotateVecsKernel
+{
+    SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const QuatSoA& rotations, const Vec3SoA& in, const Vec3SoA& out)
+    {
+        typedef typename L::Lane Lane;
+        Lane two = L::Splat(2.0f);
+
+        for(; i + L::kWidth <= count; i += L::kWidth)
+        {
+            Lane qx = L::Load(rotations.m_pX + i); Lane qy = L::Load(rotations.m_pY + i); Lane qz = L::Load(rotations.m_pZ + i); Lane qw = L::Load(rotations.m_pW + i);
+            Lane vx = L::Load(in.m_pX + i); Lane vy = L::Load(in.m_pY + i); Lane vz = L::Load(in.m_pZ + i);
+
+            // same steps as Quat::Rotate, t = 2(u x v), v + wt + u x t
+            Lane tx = L::Mul(L::Sub(L::Mul(qy, vz), L::Mul(qz, vy)), two);
+            Lane ty = L::Mul(L::Sub(L::Mul(qz, vx), L::Mul(qx, vz)), two);
+            Lane tz = L::Mul(L::Sub(L::Mul(qx, vy), L::Mul(qy, vx)), two);
+            L::Store(out.m_pX + i, L::Add(L::Add(vx, L::Mul(tx, qw)), L::Sub(L::Mul(qy, tz), L::Mul(qz, ty))));
+            L::Store(out.m_pY + i, L::Add(L::Add(vy, L::Mul(ty, qw)), L::Sub(L::Mul(qz, tx), L::Mul(qx, tz))));
+            L::Store(out.m_pZ + i, L::Add(L::Add(vz, L::Mul(tz, qw)), L::Sub(L::Mul(qx, ty), L::Mul(qy, tx))));
+        }
+        return i;
+    }
+};
+
+// Writes the kWidth result bits of the group starting at i, lane n of setMask to bit i + n. Groups never straddle words
+// since every kernel starts on a multiple of its own width.
+template<typename L>
+SM_SIMD_KERNEL static void StoreGroupBits(U64* pWords, size_t i, U32 setMask)
+{
+    const U32 shift = (U32)(i % kBitSetWordBits);
+    const U64 groupMask = ((1ull << L::kWidth) - 1) << shift;
+    U64& word = pWords[i / kBitSetWordBits];
+    word = (word & ~groupMask) | (((U64)setMask << shift) & groupMask);
+}
+
+template<bool bAabbs>
+struct CullKernels
+{
+    typedef typename std::conditional<bAabbs, AabbSoA, SphereSoA>::type Bounds;
+
+    template<typename L>
+    struct Kernel
+    {
+        SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const Frustum& frustum, const Bounds& bounds, U64* pVisibleWords)
+        {
+            typedef typename L::Lane Lane;
+            Lane zero = L::Splat(0.0f);
+            Lane planeX[kNumFrustumPlanes];
+            Lane planeY[kNumFrustumPlanes];
+            Lane planeZ[kNumFrustumPlanes];
+            Lane planeW[kNumFrustumPlanes];
+            for(U32 p = 0; p < kNumFrustumPlanes; p++)
+            {
+                planeX[p] = L::Splat(frustum.m_planes[p].x);
+                planeY[p] = L::Splat(frustum.m_planes[p].y);
+                planeZ[p] = L::Splat(frustum.m_planes[p].z);
+                planeW[p] = L::Splat(frustum.m_planes[p].w);
+            }
+
+            for(; i + L::kWidth <= count; i += L::kWidth)
+            {
+                Lane cx = L::Load(bounds.m_pCenterX + i);
+                Lane cy = L::Load(bounds.m_pCenterY + i);
+                Lane cz = L::Load(bounds.m_pCenterZ + i);
+
+                // same steps as Frustum::IsSphereVisible / IsAabbVisible, a lane is culled as soon as one plane rejects it
+                U32 culledMask = 0;
+                for(U32 p = 0; p < kNumFrustumPlanes; p++)
+                {
+                    Lane distance = L::Add(L::Add(L::Add(L::Mul(planeX[p], cx), L::Mul(planeY[p], cy)), L::Mul(planeZ[p], cz)), planeW[p]);
+                    Lane reach;
+                    if constexpr (bAabbs)
+                    {
+                        reach = L::Add(L::Add(L::Mul(L::Abs(planeX[p]), L::Load(bounds.m_pExtentX + i)),
+                                              L::Mul(L::Abs(planeY[p]), L::Load(bounds.m_pExtentY + i))),
+                                              L::Mul(L::Abs(planeZ[p]), L::Load(bounds.m_pExtentZ + i)));
+                    }
+                    else
+                    {
+                        reach = L::Load(bounds.m_pRadius + i);
+                    }
+                    culledMask |= L::LessThanMask(L::Add(distance, reach), zero);
+                }
+                StoreGroupBits<L>(pVisibleWords, i, ~culledMask);
+            }
+            return i;
+        }
+    };
+};
+
+template<bool bDegrees>
+struct SinCosKernels
+{
+    template<typename L>
+    struct Kernel
+    {
+        SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const F32* pAngles, F32* pOutSin, F32* pOutCos)
+        {
+            typedef typename L::Lane Lane;
+
+            for(; i + L::kWidth <= count; i += L::kWidth)
+            {
+                Lane sinResult;
+                Lane cosResult;
+                ApproxSinCos<L, bDegrees>(L::Load(pAngles + i), sinResult, cosResult);
+                if(pOutSin)
+                {
+                    L::Store(pOutSin + i, sinResult);
+                }
+                if(pOutCos)
+                {
+                    L::Store(pOutCos + i, cosResult);
+                }
+            }
+            return i;
+        }
+    };
+};
+
+template<typename L>
+struct ExpKernel
+{
+    SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const F32* pValues, F32* pOutValues)
+    {
+        for(; i + L::kWidth <= count; i += L::kWidth)
+        {
+            typename L::Lane result;
+            ApproxExp<L>(L::Load(pValues + i), result);
+            L::Store(pOutValues + i, result);
+        }
+        return i;
+    }
+};
+
+template<typename L>
+struct LogKernel
+{
+    SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const F32* pValues, F32* pOutValues)
+    {
+        for(; i + L::kWidth <= count; i += L::kWidth)
+        {
+            typename L::Lane result;
+            ApproxLog<L>(L::Load(pValues + i), result);
+            L::Store(pOutValues + i, result);
+        }
+        return i;
+    }
+};
+
+template<typename L>
+struct Atan2Kernel
+{
+    SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const F32* pY, const F32* pX, F32* pOutRads)
+    {
+        for(; i + L::kWidth <= count; i += L::kWidth)
+        {
+            typename L::Lane result;
+            ApproxAtan2<L>(L::Load(pY + i), L::Load(pX + i), result);
+            L::Store(pOutRads + i, result);
+        }
+        return i;
+    }
+};
+
+//-------------------------------------------------------------------------
+// Geometry
+//-------------------------------------------------------------------------
+// Same steps as Geometry.cpp, one shape splatted against kWidth others. Ray kernels write the hit distance or inf.
+
+// CalcSlabTs in Geometry.cpp, bParallel is the same for every lane
+template<typename L>
+SM_SIMD_KERNEL static void CalcSlabTLanes(const typename L::Lane& toMin, const typename L::Lane& toMax, const typename L::Lane& invDir, bool bParallel,
+                                          typename L::Lane& outT0, typename L::Lane& outT1)
+{
+    if(bParallel)
+    {
+        typename L::Lane outside = L::Or(L::CmpLessThan(L::Splat(0.0f), toMin), L::CmpLessThan(toMax, L::Splat(0.0f)));
+        outT0 = L::Select(outside, L::Splat(INFINITY), L::Splat(-INFINITY));
+        outT1 = L::Splat(INFINITY);
+        return;
+    }
+
+    outT0 = L::Mul(toMin, invDir);
+    outT1 = L::Mul(toMax, invDir);
+}
+
+template<typename L>
+struct RayAabbsKernel
+{
+    SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const Ray& ray, const AabbSoA& aabbs, const F32& maxT, F32* pOutT)
+    {
+        typedef typename L::Lane Lane;
+        const Vec3 invDir = CalcRayInvDir(ray.m_dir);
+        const bool bParallelX = ::fabsf(invDir.x) >= kRayParallelInvDir;
+        const bool bParallelY = ::fabsf(invDir.y) >= kRayParallelInvDir;
+        const bool bParallelZ = ::fabsf(invDir.z) >= kRayParallelInvDir;
+        const Lane invDirX = L::Splat(invDir.x); const Lane invDirY = L::Splat(invDir.y); const Lane invDirZ = L::Splat(invDir.z);
+        const Lane originX = L::Splat(ray.m_origin.x); const Lane originY = L::Splat(ray.m_origin.y); const Lane originZ = L::Splat(ray.m_origin.z);
+        const Lane maxTLane = L::Splat(maxT);
+
+        for(; i + L::kWidth <= count; i += L::kWidth)
+        {
+            Lane cx = L::Load(aabbs.m_pCenterX + i); Lane cy = L::Load(aabbs.m_pCenterY + i); Lane cz = L::Load(aabbs.m_pCenterZ + i);
+            Lane ex = L::Load(aabbs.m_pExtentX + i); Lane ey = L::Load(aabbs.m_pExtentY + i); Lane ez = L::Load(aabbs.m_pExtentZ + i);
+            Lane tx0, tx1, ty0, ty1, tz0, tz1;
+            CalcSlabTLanes<L>(L::Sub(L::Sub(cx, ex), originX), L::Sub(L::Add(cx, ex), originX), invDirX, bParallelX, tx0, tx1);
+            CalcSlabTLanes<L>(L::Sub(L::Sub(cy, ey), originY), L::Sub(L::Add(cy, ey), originY), invDirY, bParallelY, ty0, ty1);
+            CalcSlabTLanes<L>(L::Sub(L::Sub(cz, ez), originZ), L::Sub(L::Add(cz, ez), originZ), invDirZ, bParallelZ, tz0, tz1);
+
+            Lane entryT = L::Max(L::Max(L::Min(tx0, tx1), L::Min(ty0, ty1)), L::Max(L::Min(tz0, tz1), L::Splat(0.0f)));
+            Lane exitT = L::Min(L::Min(L::Max(tx0, tx1), L::Max(ty0, ty1)), L::Min(L::Max(tz0, tz1), maxTLane));
+            L::Store(pOutT + i, L::Select(L::CmpLessThan(exitT, entryT), L::Splat(INFINITY), entryT));
+        }
+        return i;
+    }
+};
+
+template<typename L>
+struct RaySpheresKernel
+{
+    SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const Ray& ray, const SphereSoA& spheres, const F32& maxT, F32* pOutT)
+    {
+        typedef typename L::Lane Lane;
+        const Lane zero = L::Splat(0.0f);
+        const Lane dirX = L::Splat(ray.m_dir.x); const Lane dirY = L::Splat(ray.m_dir.y); const Lane dirZ = L::Splat(ray.m_dir.z);
+        const Lane originX = L::Splat(ray.m_origin.x); const Lane originY = L::Splat(ray.m_origin.y); const Lane originZ = L::Splat(ray.m_origin.z);
+        const Lane a = L::Splat(Dot(ray.m_dir, ray.m_dir));
+        const Lane maxTLane = L::Splat(maxT);
+
+        for(; i + L::kWidth <= count; i += L::kWidth)
+        {
+            Lane mx = L::Sub(originX, L::Load(spheres.m_pCenterX + i));
+            Lane my = L::Sub(originY, L::Load(spheres.m_pCenterY + i));
+            Lane mz = L::Sub(originZ, L::Load(spheres.m_pCenterZ + i));
+            Lane radius = L::Load(spheres.m_pRadius + i);
+            Lane radiusSq = L::Mul(radius, radius);
+            Lane b = L::Add(L::Add(L::Mul(mx, dirX), L::Mul(my, dirY)), L::Mul(mz, dirZ));
+            Lane c = L::Sub(L::Add(L::Add(L::Mul(mx, mx), L::Mul(my, my)), L::Mul(mz, mz)), radiusSq);
+
+            Lane bOverA = L::Div(b, a);
+            Lane lx = L::Sub(mx, L::Mul(dirX, bOverA));
+            Lane ly = L::Sub(my, L::Mul(dirY, bOverA));
+            Lane lz = L::Sub(mz, L::Mul(dirZ, bOverA));
+            Lane discriminant = L::Mul(a, L::Sub(radiusSq, L::Add(L::Add(L::Mul(lx, lx), L::Mul(ly, ly)), L::Mul(lz, lz))));
+
+            Lane outside = L::CmpLessThan(zero, c);
+            Lane miss = L::Or(L::And(outside, L::CmpLessThan(zero, b)), L::CmpLessThan(discriminant, zero));
+            Lane t = L::And(outside, L::Div(c, L::Sub(L::Sqrt(discriminant), b)));
+            Lane hit = L::AndNot(miss, L::CmpLessThan(t, maxTLane));
+            L::Store(pOutT + i, L::Select(hit, t, L::Splat(INFINITY)));
+        }
+        return i;
+    }
+};
+
+template<typename L>
+struct RayTrianglesKernel
+{
+    SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const Ray& ray, const TriangleSoA& triangles, const F32& maxT, F32* pOutT)
+    {
+        typedef typename L::Lane Lane;
+        const Lane zero = L::Splat(0.0f);
+        const Lane one = L::Splat(1.0f);
+        const Lane dirX = L::Splat(ray.m_dir.x); const Lane dirY = L::Splat(ray.m_dir.y); const Lane dirZ = L::Splat(ray.m_dir.z);
+        const Lane originX = L::Splat(ray.m_origin.x); const Lane originY = L::Splat(ray.m_origin.y); const Lane originZ = L::Splat(ray.m_origin.z);
+        const Lane maxTLane = L::Splat(maxT);
+        const Lane minDetSqScale = L::Splat(kRayTriangleParallelEpsilon * kRayTriangleParallelEpsilon * Dot(ray.m_dir, ray.m_dir));
+
+        for(; i + L::kWidth <= count; i += L::kWidth)
+        {
+            Lane v0x = L::Load(triangles.m_v0.m_pX + i); Lane v0y = L::Load(triangles.m_v0.m_pY + i); Lane v0z = L::Load(triangles.m_v0.m_pZ + i);
+            Lane e1x = L::Sub(L::Load(triangles.m_v1.m_pX + i), v0x); Lane e1y = L::Sub(L::Load(triangles.m_v1.m_pY + i), v0y); Lane e1z = L::Sub(L::Load(triangles.m_v1.m_pZ + i), v0z);
+            Lane e2x = L::Sub(L::Load(triangles.m_v2.m_pX + i), v0x); Lane e2y = L::Sub(L::Load(triangles.m_v2.m_pY + i), v0y); Lane e2z = L::Sub(L::Load(triangles.m_v2.m_pZ + i), v0z);
+
+            // p = dir x edge2
+            Lane px = L::Sub(L::Mul(dirY, e2z), L::Mul(dirZ, e2y));
+            Lane py = L::Sub(L::Mul(dirZ, e2x), L::Mul(dirX, e2z));
+            Lane pz = L::Sub(L::Mul(dirX, e2y), L::Mul(dirY, e2x));
+            Lane det = L::Add(L::Add(L::Mul(e1x, px), L::Mul(e1y, py)), L::Mul(e1z, pz));
+            Lane invDet = L::Div(one, det);
+            Lane e1LengthSq = L::Add(L::Add(L::Mul(e1x, e1x), L::Mul(e1y, e1y)), L::Mul(e1z, e1z));
+            Lane e2LengthSq = L::Add(L::Add(L::Mul(e2x, e2x), L::Mul(e2y, e2y)), L::Mul(e2z, e2z));
+            Lane minDetSq = L::Mul(minDetSqScale, L::Mul(e1LengthSq, e2LengthSq));
+
+            Lane ox = L::Sub(originX, v0x); Lane oy = L::Sub(originY, v0y); Lane oz = L::Sub(originZ, v0z);
+            Lane u = L::Mul(L::Add(L::Add(L::Mul(ox, px), L::Mul(oy, py)), L::Mul(oz, pz)), invDet);
+
+            // q = toOrigin x edge1
+            Lane qx = L::Sub(L::Mul(oy, e1z), L::Mul(oz, e1y));
+            Lane qy = L::Sub(L::Mul(oz, e1x), L::Mul(ox, e1z));
+            Lane qz = L::Sub(L::Mul(ox, e1y), L::Mul(oy, e1x));
+            Lane v = L::Mul(L::Add(L::Add(L::Mul(dirX, qx), L::Mul(dirY, qy)), L::Mul(dirZ, qz)), invDet);
+            Lane t = L::Mul(L::Add(L::Add(L::Mul(e2x, qx), L::Mul(e2y, qy)), L::Mul(e2z, qz)), invDet);
+
+            Lane miss = L::Or(L::Or(L::CmpLessThan(u, zero), L::CmpLessThan(one, u)), L::Or(L::CmpLessThan(v, zero), L::CmpLessThan(one, L::Add(u, v))));
+            miss = L::Or(miss, L::CmpLessThan(t, zero));
+            Lane hit = L::AndNot(miss, L::And(L::CmpLessThan(t, maxTLane), L::CmpLessThan(minDetSq, L::Mul(det, det))));
+            L::Store(pOutT + i, L::Select(hit, t, L::Splat(INFINITY)));
+        }
+        return i;
+    }
+};
+
+template<typename L>
+struct OverlapSphereSpheresKernel
+{
+    SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const Sphere& sphere, const SphereSoA& spheres, U64* pOverlappingWords)
+    {
+        typedef typename L::Lane Lane;
+        const Lane centerX = L::Splat(sphere.m_center.x); const Lane centerY = L::Splat(sphere.m_center.y); const Lane centerZ = L::Splat(sphere.m_center.z);
+        const Lane radius = L::Splat(sphere.m_radius);
+
+        for(; i + L::kWidth <= count; i += L::kWidth)
+        {
+            Lane dx = L::Sub(L::Load(spheres.m_pCenterX + i), centerX);
+            Lane dy = L::Sub(L::Load(spheres.m_pCenterY + i), centerY);
+            Lane dz = L::Sub(L::Load(spheres.m_pCenterZ + i), centerZ);
+            Lane radiusSum = L::Add(radius, L::Load(spheres.m_pRadius + i));
+            Lane distanceSq = L::Add(L::Add(L::Mul(dx, dx), L::Mul(dy, dy)), L::Mul(dz, dz));
+            StoreGroupBits<L>(pOverlappingWords, i, ~L::LessThanMask(L::Mul(radiusSum, radiusSum), distanceSq));
+        }
+        return i;
+    }
+};
+
+template<typename L>
+struct OverlapSphereAabbsKernel
+{
+    SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const Sphere& sphere, const AabbSoA& aabbs, U64* pOverlappingWords)
+    {
+        typedef typename L::Lane Lane;
+        const Lane zero = L::Splat(0.0f);
+        const Lane centerX = L::Splat(sphere.m_center.x); const Lane centerY = L::Splat(sphere.m_center.y); const Lane centerZ = L::Splat(sphere.m_center.z);
+        const Lane radiusSq = L::Splat(sphere.m_radius * sphere.m_radius);
+
+        for(; i + L::kWidth <= count; i += L::kWidth)
+        {
+            Lane dx = L::Max(L::Sub(L::Abs(L::Sub(centerX, L::Load(aabbs.m_pCenterX + i))), L::Load(aabbs.m_pExtentX + i)), zero);
+            Lane dy = L::Max(L::Sub(L::Abs(L::Sub(centerY, L::Load(aabbs.m_pCenterY + i))), L::Load(aabbs.m_pExtentY + i)), zero);
+            Lane dz = L::Max(L::Sub(L::Abs(L::Sub(centerZ, L::Load(aabbs.m_pCenterZ + i))), L::Load(aabbs.m_pExtentZ + i)), zero);
+            Lane distanceSq = L::Add(L::Add(L::Mul(dx, dx), L::Mul(dy, dy)), L::Mul(dz, dz));
+            StoreGroupBits<L>(pOverlappingWords, i, ~L::LessThanMask(radiusSq, distanceSq));
+        }
+        return i;
+    }
+};
+
+template<typename L>
+struct OverlapAabbAabbsKernel
+{
+    SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const Aabb& aabb, const AabbSoA& aabbs, U64* pOverlappingWords)
+    {
+        typedef typename L::Lane Lane;
+        const Lane centerX = L::Splat(aabb.m_center.x); const Lane centerY = L::Splat(aabb.m_center.y); const Lane centerZ = L::Splat(aabb.m_center.z);
+        const Lane extentX = L::Splat(aabb.m_extents.x); const Lane extentY = L::Splat(aabb.m_extents.y); const Lane extentZ = L::Splat(aabb.m_extents.z);
+
+        for(; i + L::kWidth <= count; i += L::kWidth)
+        {
+            U32 separatedMask = L::LessThanMask(L::Add(extentX, L::Load(aabbs.m_pExtentX + i)), L::Abs(L::Sub(centerX, L::Load(aabbs.m_pCenterX + i))));
+            separatedMask |= L::LessThanMask(L::Add(extentY, L::Load(aabbs.m_pExtentY + i)), L::Abs(L::Sub(centerY, L::Load(aabbs.m_pCenterY + i))));
+            separatedMask |= L::LessThanMask(L::Add(extentZ, L::Load(aabbs.m_pExtentZ + i)), L::Abs(L::Sub(centerZ, L::Load(aabbs.m_pCenterZ + i))));
+            StoreGroupBits<L>(pOverlappingWords, i, ~separatedMask);
+        }
+        return i;
+    }
+};
+
+template<typename L>
+struct OverlapObbObbsKernel
+{
+    SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const Obb& obb, const ObbSoA& obbs, U64* pOverlappingWords)
+    {
+        typedef typename L::Lane Lane;
+        const Lane epsilon = L::Splat(kObbParallelEpsilon);
+        const Vec3 axesA[3] = { obb.m_axes.GetIBasis(), obb.m_axes.GetJBasis(), obb.m_axes.GetKBasis() };
+        const Lane extentsA[3] = { L::Splat(obb.m_extents.x), L::Splat(obb.m_extents.y), L::Splat(obb.m_extents.z) };
+        Lane axesALanes[3][3];
+        for(U32 a = 0; a < 3; a++)
+        {
+            axesALanes[a][0] = L::Splat(axesA[a].x);
+            axesALanes[a][1] = L::Splat(axesA[a].y);
+            axesALanes[a][2] = L::Splat(axesA[a].z);
+        }
+        const Lane centerX = L::Splat(obb.m_center.x); const Lane centerY = L::Splat(obb.m_center.y); const Lane centerZ = L::Splat(obb.m_center.z);
+
+        for(; i + L::kWidth <= count; i += L::kWidth)
+        {
+            // same axes in the same order as OverlapObbObb
+            const Lane extentsB[3] = { L::Load(obbs.m_pExtentX + i), L::Load(obbs.m_pExtentY + i), L::Load(obbs.m_pExtentZ + i) };
+            Lane rotation[3][3];
+            Lane absRotation[3][3];
+            for(U32 b = 0; b < 3; b++)
+            {
+                Lane bx = L::Load(obbs.m_pAxes[b * 3 + 0] + i);
+                Lane by = L::Load(obbs.m_pAxes[b * 3 + 1] + i);
+                Lane bz = L::Load(obbs.m_pAxes[b * 3 + 2] + i);
+                for(U32 a = 0; a < 3; a++)
+                {
+                    rotation[a][b] = L::Add(L::Add(L::Mul(axesALanes[a][0], bx), L::Mul(axesALanes[a][1], by)), L::Mul(axesALanes[a][2], bz));
+                    absRotation[a][b] = L::Add(L::Abs(rotation[a][b]), epsilon);
+                }
+            }
+
+            Lane dx = L::Sub(L::Load(obbs.m_pCenterX + i), centerX);
+            Lane dy = L::Sub(L::Load(obbs.m_pCenterY + i), centerY);
+            Lane dz = L::Sub(L::Load(obbs.m_pCenterZ + i), centerZ);
+            Lane translation[3];
+            for(U32 a = 0; a < 3; a++)
+            {
+                translation[a] = L::Add(L::Add(L::Mul(dx, axesALanes[a][0]), L::Mul(dy, axesALanes[a][1])), L::Mul(dz, axesALanes[a][2]));
+            }
+
+            U32 separatedMask = 0;
+            for(U32 a = 0; a < 3; a++)
+            {
+                Lane reachB = L::Add(L::Add(L::Mul(extentsB[0], absRotation[a][0]), L::Mul(extentsB[1], absRotation[a][1])), L::Mul(extentsB[2], absRotation[a][2]));
+                separatedMask |= L::LessThanMask(L::Add(extentsA[a], reachB), L::Abs(translation[a]));
+            }
+            for(U32 b = 0; b < 3; b++)
+            {
+                Lane reachA = L::Add(L::Add(L::Mul(extentsA[0], absRotation[0][b]), L::Mul(extentsA[1], absRotation[1][b])), L::Mul(extentsA[2], absRotation[2][b]));
+                Lane distance = L::Add(L::Add(L::Mul(translation[0], rotation[0][b]), L::Mul(translation[1], rotation[1][b])), L::Mul(translation[2], rotation[2][b]));
+                separatedMask |= L::LessThanMask(L::Add(reachA, extentsB[b]), L::Abs(distance));
+            }
+            for(U32 a = 0; a < 3; a++)
+            {
+                const U32 a1 = (a + 1) % 3;
+                const U32 a2 = (a + 2) % 3;
+                for(U32 b = 0; b < 3; b++)
+                {
+                    const U32 b1 = (b + 1) % 3;
+                    const U32 b2 = (b + 2) % 3;
+                    Lane reachA = L::Add(L::Mul(extentsA[a1], absRotation[a2][b]), L::Mul(extentsA[a2], absRotation[a1][b]));
+                    Lane reachB = L::Add(L::Mul(extentsB[b1], absRotation[a][b2]), L::Mul(extentsB[b2], absRotation[a][b1]));
+                    Lane distance = L::Sub(L::Mul(translation[a2], rotation[a1][b]), L::Mul(translation[a1], rotation[a2][b]));
+                    separatedMask |= L::LessThanMask(L::Add(reachA, reachB), L::Abs(distance));
+                }
+            }
+            StoreGroupBits<L>(pOverlappingWords, i, ~separatedMask);
+        }
+        return i;
+    }
+};
+
+//-------------------------------------------------------------------------
+// Quantization
+//-------------------------------------------------------------------------
+// Same steps as Quantize.h. Results are left as bits in the lanes, the integer stores keep the low bits.
+
+template<typename L>
+SM_SIMD_KERNEL static void QuantizeLanes(const typename L::Lane& v, F32 low, F32 high, F32 scale, typename L::Lane& outBits)
+{
+    // after adding the magic number the rounded integer sits in the low mantissa bits
+    typename L::Lane clamped = L::Min(L::Max(v, L::Splat(low)), L::Splat(high));
+    outBits = L::Add(L::Mul(clamped, L::Splat(scale)), L::Splat(kRoundMagic));
+}
+
+// Pack two quantized lanes into one integer per lane, x in the low bits
+template<typename L, U32 kBits>
+SM_SIMD_KERNEL static void PackPair(const typename L::Lane& x, const typename L::Lane& y, typename L::Lane& outPacked)
+{
+    const typename L::Lane fieldMask = L::SplatBits((1u << kBits) - 1);
+    outPacked = L::Or(L::And(x, fieldMask), L::template ShiftLeftBits<kBits>(L::And(y, fieldMask)));
+}
+
+template<typename L>
+SM_SIMD_KERNEL static void EmulateF32ToF16(const typename L::Lane& x, typename L::Lane& outHalfs)
+{
+    typedef typename L::Lane Lane;
+    Lane sign = L::And(x, L::SplatBits(0x80000000));
+    Lane bits = L::Xor(x, sign);
+
+    // 65536 and up, inf and nan
+    Lane large = L::Select(L::CmpLessThanBits(L::SplatBits(0x7f800000), bits),
+                           L::Or(L::SplatBits(0x7e00), L::And(L::template ShiftRightBits<13>(bits), L::SplatBits(0x3ff))),
+                           L::SplatBits(0x7c00));
+
+    // below the smallest normal half
+    Lane denormal = L::AddBits(L::Add(bits, L::Splat(0.5f)), L::SplatBits(0u - 0x3f000000));
+
+    // rebias and round to nearest even
+    Lane mantissaOdd = L::And(L::template ShiftRightBits<13>(bits), L::SplatBits(1));
+    Lane normal = L::AddBits(L::AddBits(bits, L::SplatBits(((U32)(15 - 127) << 23) + 0xfff)), mantissaOdd);
+    normal = L::template ShiftRightBits<13>(normal);
+
+    Lane half = L::Select(L::CmpLessThanBits(bits, L::SplatBits(0x38800000)), denormal, normal);
+    half = L::Select(L::CmpLessThanBits(bits, L::SplatBits(0x47800000)), half, large);
+    outHalfs = L::Or(half, L::template ShiftRightBits<16>(sign));
+}
+
+template<typename L>
+SM_SIMD_KERNEL static void EmulateF16ToF32(const typename L::Lane& h, typename L::Lane& outValues)
+{
+    typedef typename L::Lane Lane;
+    Lane bits = L::template ShiftLeftBits<13>(L::And(h, L::SplatBits(0x7fff)));
+    Lane exponent = L::And(bits, L::SplatBits(0x0f800000));
+    bits = L::AddBits(bits, L::SplatBits((U32)(127 - 15) << 23));
+
+    // inf and nan
+    Lane infNan = L::AddBits(bits, L::SplatBits((U32)(128 - 16) << 23));
+    Lane isNan = L::CmpLessThanBits(L::SplatBits(0), L::And(infNan, L::SplatBits(0x007fffff)));
+    infNan = L::Or(infNan, L::And(isNan, L::SplatBits(0x00400000)));
+
+    // denormal
+    Lane denormal = L::Sub(L::AddBits(bits, L::SplatBits(1 << 23)), L::Splat(6.103515625e-05f));
+
+    bits = L::Select(L::CmpLessThanBits(exponent, L::SplatBits(1)), denormal, bits);
+    bits = L::Select(L::CmpLessThanBits(exponent, L::SplatBits(0x0f800000)), bits, infNan);
+    outValues = L::Or(bits, L::template ShiftLeftBits<16>(L::And(h, L::SplatBits(0x8000))));
+}
+
+template<typename L>
+SM_SIMD_KERNEL static void EncodeOctahedralLanes(const typename L::Lane& nx, const typename L::Lane& ny, const typename L::Lane& nz,
+                                                 typename L::Lane& outX, typename L::Lane& outY)
+{
+    typedef typename L::Lane Lane;
+    Lane invL1Norm = L::Div(L::Splat(1.0f), L::Add(L::Add(L::Abs(nx), L::Abs(ny)), L::Abs(nz)));
+    Lane x = L::Mul(nx, invL1Norm);
+    Lane y = L::Mul(ny, invL1Norm);
+    Lane lower = L::CmpLessThan(nz, L::Splat(0.0f));
+    Lane foldedX = L::FlipSign(L::Sub(L::Splat(1.0f), L::Abs(y)), x);
+    Lane foldedY = L::FlipSign(L::Sub(L::Splat(1.0f), L::Abs(x)), y);
+    outX = L::Select(lower, foldedX, x);
+    outY = L::Select(lower, foldedY, y);
+}
+
+template<typename L>
+struct ConvertF32ToF16Kernel
+{
+    SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const F32* pValues, U16* pOutHalfs)
+    {
+        for(; i + L::kWidth <= count; i += L::kWidth)
+        {
+            if constexpr (L::kHasF16)
+            {
+                L::StoreF16(pOutHalfs + i, L::Load(pValues + i));
+            }
+            else
+            {
+                typename L::Lane halfs;
+                EmulateF32ToF16<L>(L::Load(pValues + i), halfs);
+                L::StoreU16(pOutHalfs + i, halfs);
+            }
+        }
+        return i;
+    }
+};
+
+template<typename L>
+struct ConvertF16ToF32Kernel
+{
+    SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const U16* pHalfs, F32* pOutValues)
+    {
+        for(; i + L::kWidth <= count; i += L::kWidth)
+        {
+            if constexpr (L::kHasF16)
+            {
+                L::Store(pOutValues + i, L::LoadF16(pHalfs + i));
+            }
+            else
+            {
+                typename L::Lane values;
+                EmulateF16ToF32<L>(L::LoadU16(pHalfs + i), values);
+                L::Store(pOutValues + i, values);
+            }
+        }
+        return i;
+    }
+};
+
+template<typename T>
+struct EncodeNormKernels
+{
+    template<typename L>
+    struct Kernel
+    {
+        SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const F32* pValues, T* pOutValues, const F32& low, const F32& scale)
+        {
+            for(; i + L::kWidth <= count; i += L::kWidth)
+            {
+                typename L::Lane bits;
+                QuantizeLanes<L>(L::Load(pValues + i), low, 1.0f, scale, bits);
+                if constexpr (sizeof(T) == 1)
+                {
+                    L::StoreU8((U8*)(pOutValues + i), bits);
+                }
+                else
+                {
+                    L::StoreU16((U16*)(pOutValues + i), bits);
+                }
+            }
+            return i;
+        }
+    };
+};
+
+template<bool bSigned>
+struct Pack1010102Kernels
+{
+    template<typename L>
+    struct Kernel
+    {
+        SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const Vec3SoA& vecs, const F32* pW, U32* pOutPacked)
+        {
+            typedef typename L::Lane Lane;
+            const F32 low = bSigned ? -1.0f : 0.0f;
+            const F32 scale = bSigned ? 511.0f : 1023.0f;
+            const F32 scaleW = bSigned ? 1.0f : 3.0f;
+
+            for(; i + L::kWidth <= count; i += L::kWidth)
+            {
+                Lane x, y, z, w, xy;
+                QuantizeLanes<L>(L::Load(vecs.m_pX + i), low, 1.0f, scale, x);
+                QuantizeLanes<L>(L::Load(vecs.m_pY + i), low, 1.0f, scale, y);
+                QuantizeLanes<L>(L::Load(vecs.m_pZ + i), low, 1.0f, scale, z);
+                QuantizeLanes<L>(pW ? L::Load(pW + i) : L::Splat(0.0f), low, 1.0f, scaleW, w);
+                PackPair<L, 10>(x, y, xy);
+                Lane xyz = L::Or(xy, L::template ShiftLeftBits<20>(L::And(z, L::SplatBits(0x3ff))));
+                L::StoreBits(pOutPacked + i, L::Or(xyz, L::template ShiftLeftBits<30>(w)));
+            }
+            return i;
+        }
+    };
+};
+
+template<typename T>
+struct EncodeOctahedralKernels
+{
+    template<typename L>
+    struct Kernel
+    {
+        SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const Vec3SoA& normals, T* pOutPacked)
+        {
+            typedef typename L::Lane Lane;
+
+            for(; i + L::kWidth <= count; i += L::kWidth)
+            {
+                Lane x;
+                Lane y;
+                EncodeOctahedralLanes<L>(L::Load(normals.m_pX + i), L::Load(normals.m_pY + i), L::Load(normals.m_pZ + i), x, y);
+                Lane packed;
+                if constexpr (sizeof(T) == 4)
+                {
+                    QuantizeLanes<L>(x, -1.0f, 1.0f, 32767.0f, x);
+                    QuantizeLanes<L>(y, -1.0f, 1.0f, 32767.0f, y);
+                    PackPair<L, 16>(x, y, packed);
+                    L::StoreBits(pOutPacked + i, packed);
+                }
+                else
+                {
+                    QuantizeLanes<L>(x, -1.0f, 1.0f, 127.0f, x);
+                    QuantizeLanes<L>(y, -1.0f, 1.0f, 127.0f, y);
+                    PackPair<L, 8>(x, y, packed);
+                    L::StoreU16(pOutPacked + i, packed);
+                }
+            }
+            return i;
+        }
+    };
+};
+
+template<typename L>
+struct EncodeTangentFramesKernel
+{
+    SM_SIMD_KERNEL static size_t Run(size_t i, size_t count, const Vec3SoA& normals, const Vec3SoA& tangents, const F32* pBitangentSigns,
+                                     PackedTangentFrame* pOutFrames)
+    {
+        typedef typename L::Lane Lane;
+        const Lane zero = L::Splat(0.0f);
+        const Lane one = L::Splat(1.0f);
+        const Lane signBit = L::SplatBits(0x80000000);
+        const Lane minW = L::Splat(1.0f / 32767.0f);
+
+        for(; i + L::kWidth <= count; i += L::kWidth)
+        {
+            Lane nx = L::Load(normals.m_pX + i); Lane ny = L::Load(normals.m_pY + i); Lane nz = L::Load(normals.m_pZ + i);
+            Lane tx = L::Load(tangents.m_pX + i); Lane ty = L::Load(tangents.m_pY + i); Lane tz = L::Load(tangents.m_pZ + i);
+
+            // orthonormalize the tangent and build the bitangent like EncodeTangentFrame
+            Lane d = L::Add(L::Add(L::Mul(nx, tx), L::Mul(ny, ty)), L::Mul(nz, tz));
+            tx = L::Sub(tx, L::Mul(nx, d));
+            ty = L::Sub(ty, L::Mul(ny, d));
+            tz = L::Sub(tz, L::Mul(nz, d));
+            Lane invLength = L::Div(one, L::Sqrt(L::Add(L::Add(L::Mul(tx, tx), L::Mul(ty, ty)), L::Mul(tz, tz))));
+            tx = L::Mul(tx, invLength);
+            ty = L::Mul(ty, invLength);
+            tz = L::Mul(tz, invLength);
+            Lane bx = L::Sub(L::Mul(ny, tz), L::Mul(nz, ty));
+            Lane by = L::Sub(L::Mul(nz, tx), L::Mul(nx, tz));
+            Lane bz = L::Sub(L::Mul(nx, ty), L::Mul(ny, tx));
+
+            // Quat::CreateFromMat33 with rows t, b, n, every branch's square root argument is made and the taken
+            // one picked per lane
+            Lane trace = L::Add(L::Add(tx, by), nz);
+            Lane useTrace = L::CmpLessThan(zero, trace);
+            Lane useX = L::And(L::CmpLessThan(by, tx), L::CmpLessThan(nz, tx));
+            Lane useY = L::CmpLessThan(nz, by);
+            Lane sqrtArg = L::Sub(L::Sub(L::Add(one, nz), tx), by);
+            sqrtArg = L::Select(useY, L::Sub(L::Sub(L::Add(one, by), tx), nz), sqrtArg);
+            sqrtArg = L::Select(useX, L::Sub(L::Sub(L::Add(one, tx), by), nz), sqrtArg);
+            sqrtArg = L::Select(useTrace, L::Add(trace, one), sqrtArg);
+            Lane s = L::Mul(L::Sqrt(sqrtArg), L::Splat(2.0f));
+            Lane invS = L::Div(one, s);
+            Lane quarterS = L::Mul(L::Splat(0.25f), s);
+
+            Lane a = L::Mul(L::Sub(bz, ny), invS);
+            Lane b = L::Mul(L::Sub(nx, tz), invS);
+            Lane c = L::Mul(L::Sub(ty, bx), invS);
+            Lane e = L::Mul(L::Add(bx, ty), invS);
+            Lane f = L::Mul(L::Add(nx, tz), invS);
+            Lane g = L::Mul(L::Add(ny, bz), invS);
+            Lane qx = L::Select(useTrace, a, L::Select(useX, quarterS, L::Select(useY, e, f)));
+            Lane qy = L::Select(useTrace, b, L::Select(useX, e, L::Select(useY, quarterS, g)));
+            Lane qz = L::Select(useTrace, c, L::Select(useX, f, L::Select(useY, g, quarterS)));
+            Lane qw = L::Select(useTrace, quarterS, L::Select(useX, a, L::Select(useY, b, c)));
+
+            // w positive and at least one snorm step, then its sign carries the bitangent sign
+            Lane flip = L::And(L::CmpLessThan(qw, zero), signBit);
+            qx = L::Xor(qx, flip); qy = L::Xor(qy, flip); qz = L::Xor(qz, flip); qw = L::Xor(qw, flip);
+            qw = L::Select(L::CmpLessThan(qw, minW), minW, qw);
+            flip = L::And(L::CmpLessThan(L::Load(pBitangentSigns + i), zero), signBit);
+            qx = L::Xor(qx, flip); qy = L::Xor(qy, flip); qz = L::Xor(qz, flip); qw = L::Xor(qw, flip);
+
+            QuantizeLanes<L>(qx, -1.0f, 1.0f, 32767.0f, qx);
+            QuantizeLanes<L>(qy, -1.0f, 1.0f, 32767.0f, qy);
+            QuantizeLanes<L>(qz, -1.0f, 1.0f, 32767.0f, qz);
+            QuantizeLanes<L>(qw, -1.0f, 1.0f, 32767.0f, qw);
+            Lane xy, zw;
+            PackPair<L, 16>(qx, qy, xy);
+            PackPair<L, 16>(qz, qw, zw);
+            L::StoreInterleavedBits((U32*)(pOutFrames + i), xy, zw);
+        }
+        return i;
+    }
+};
+
+static SphereSoA OffsetBounds(const SphereSoA& spheres, size_t offset)
+{
+    return { spheres.m_pCenterX + offset, spheres.m_pCenterY + offset, spheres.m_pCenterZ + offset, spheres.m_pRadius + offset };
+}
+
+static AabbSoA OffsetBounds(const AabbSoA& aabbs, size_t offset)
+{
+    return { aabbs.m_pCenterX + offset, aabbs.m_pCenterY + offset, aabbs.m_pCenterZ + offset,
+             aabbs.m_pExtentX + offset, aabbs.m_pExtentY + offset, aabbs.m_pExtentZ + offset };
+}
+
+template<typename Func>
+static void CullParallelFor(U32 numThreads, Func&& func)
+{
+    // the calling thread takes the first range
+    std::thread workers[kCullMaxThreads];
+    for(U32 i = 1; i < numThreads; i++)
+    {
+        workers[i] = std::thread(func, i);
+    }
+    func(0);
+    for(U32 i = 1; i < numThreads; i++)
+    {
+        workers[i].join();
+    }
+}
+
+template<bool bAabbs>
+static void Cull(const Frustum& frustum, const typename CullKernels<bAabbs>::Bounds& bounds, size_t count, BitSet& outVisible, U32 numThreads)
+{
+    SM_ASSERT(count <= outVisible.GetNumBits());
+    SM_ASSERT(numThreads >= 1 && numThreads <= kCullMaxThreads);
+
+    // thread startup costs more than culling a small batch
+    const size_t maxThreads = count / kCullMinObjectsPerThread;
+    if(numThreads > maxThreads)
+    {
+        numThreads = maxThreads > 0 ? (U32)maxThreads : 1;
+    }
+
+    U64* pVisibleWords = outVisible.m_words.m_pData;
+    if(numThreads == 1)
+    {
+        RunKernel<CullKernels<bAabbs>::template Kernel>(count, frustum, bounds, pVisibleWords);
+        return;
+    }
+
+    // ranges are whole words so threads never write to the same U64
+    const size_t numWords = (count + kBitSetWordBits - 1) / kBitSetWordBits;
+    const size_t objectsPerThread = ((numWords + numThreads - 1) / numThreads) * kBitSetWordBits;
+    CullParallelFor(numThreads, [&](U32 thread) {
+        size_t begin = thread * objectsPerThread;
+        size_t end = begin + objectsPerThread < count ? begin + objectsPerThread : count;
+        if(begin < end)
+        {
+            RunKernel<CullKernels<bAabbs>::template Kernel>(end - begin, frustum, OffsetBounds(bounds, begin), pVisibleWords + begin / kBitSetWordBits);
+        }
+    });
+}
+
+//-------------------------------------------------------------------------
+// Batch API
+//-------------------------------------------------------------------------
+void SM::TransformPoints(const Mat44& transform, const Vec3SoA& points, const Vec3SoA& outPoints, size_t count)
+{
+    RunKernel<TransformKernels<true>::Uniform>(count, transform, points, outPoints);
+}
+
+void SM::TransformDirs(const Mat44& transform, const Vec3SoA& dirs, const Vec3SoA& outDirs, size_t count)
+{
+    RunKernel<TransformKernels<false>::Uniform>(count, transform, dirs, outDirs);
+}
+
+void SM::TransformPoints(const Mat44SoA& transforms, const Vec3SoA& points, const Vec3SoA& outPoints, size_t count)
+{
+    RunKernel<TransformKernels<true>::PerElement>(count, transforms, points, outPoints);
+}
+
+void SM::TransformDirs(const Mat44SoA& transforms, const Vec3SoA& dirs, const Vec3SoA& outDirs, size_t count)
+{
+    RunKernel<TransformKernels<false>::PerElement>(count, transforms, dirs, outDirs);
+}
+
+void SM::MultiplyMatrices(const Mat44SoA& a, const Mat44SoA& b, const Mat44SoA& outMatrices, size_t count)
+{
+    RunKernel<MultiplyMatricesKernel>(count, a, b, outMatrices);
+}
+
+void SM::ComposeWorldTransforms(const Mat44SoA& parentWorld, const Mat44SoA& local, const Mat44SoA& outWorld, size_t count)
+{
+    RunKernel<MultiplyMatricesKernel>(count, local, parentWorld, outWorld);
+}
+
+void SM::MultiplyQuats(const QuatSoA& a, const QuatSoA& b, const QuatSoA& outQuats, size_t count)
+{
+    RunKernel<MultiplyQuatsKernel>(count, a, b, outQuats);
+}
+
+void SM::NlerpQuats(const QuatSoA& a, const QuatSoA& b, F32 t, const QuatSoA& outQuats, size_t count)
+{
+    RunKernel<LerpQuatsKernels<false>::Kernel>(count, a, b, t, outQuats);
+}
+
+void SM::FastSlerpQuats(const QuatSoA& a, const QuatSoA& b, F32 t, const QuatSoA& outQuats, size_t count)
+{
+    RunKernel<LerpQuatsKernels<true>::Kernel>(count, a, b, t, outQuats);
+}
+
+void SM::RotateVecs(const QuatSoA& rotations, const Vec3SoA& vecs, const Vec3SoA& outVecs, size_t count)
+{
+    RunKernel<RotateVecsKernel>(count, rotations, vecs, outVecs);
+}
+
+void SM::CullSpheres(const Frustum& frustum, const SphereSoA& spheres, size_t count, BitSet& outVisible, U32 numThreads)
+{
+    Cull<false>(frustum, spheres, count, outVisible, numThreads);
+}
+
+void SM::CullAabbs(const Frustum& frustum, const AabbSoA& aabbs, size_t count, BitSet& outVisible, U32 numThreads)
+{
+    Cull<true>(frustum, aabbs, count, outVisible, numThreads);
+}
+
+void SM::ConvertToSoA(const Vec3* pVecs, size_t count, const Vec3SoA& outVecs)
+{
+    for(size_t i = 0; i < count; i++)
+    {
+        outVecs.m_pX[i] = pVecs[i].x;
+        outVecs.m_pY[i] = pVecs[i].y;
+        outVecs.m_pZ[i] = pVecs[i].z;
+    }
+}
+
+void SM::ConvertFromSoA(const Vec3SoA& vecs, size_t count, Vec3* pOutVecs)
+{
+    for(size_t i = 0; i < count; i++)
+    {
+        pOutVecs[i] = Vec3(vecs.m_pX[i], vecs.m_pY[i], vecs.m_pZ[i]);
+    }
+}
+
+void SM::ConvertToSoA(const Mat44* pMatrices, size_t count, const Mat44SoA& outMatrices)
+{
+    for(size_t i = 0; i < count; i++)
+    {
+        const F32* pSrc = &pMatrices[i].ix;
+        for(U32 e = 0; e < 16; e++)
+        {
+            outMatrices.m_pElements[e][i] = pSrc[e];
+        }
+    }
+}
+
+void SM::ConvertFromSoA(const Mat44SoA& matrices, size_t count, Mat44* pOutMatrices)
+{
+    for(size_t i = 0; i < count; i++)
+    {
+        F32* pDst = &pOutMatrices[i].ix;
+        for(U32 e = 0; e < 16; e++)
+        {
+            pDst[e] = matrices.m_pElements[e][i];
+        }
+    }
+}
+
+void SM::ConvertToSoA(const Quat* pQuats, size_t count, const QuatSoA& outQuats)
+{
+    for(size_t i = 0; i < count; i++)
+    {
+        outQuats.m_pX[i] = pQuats[i].x;
+        outQuats.m_pY[i] = pQuats[i].y;
+        outQuats.m_pZ[i] = pQuats[i].z;
+        outQuats.m_pW[i] = pQuats[i].w;
+    }
+}
+
+void SM::ConvertFromSoA(const QuatSoA& quats, size_t count, Quat* pOutQuats)
+{
+    for(size_t i = 0; i < count; i++)
+    {
+        pOutQuats[i] = Quat(quats.m_pX[i], quats.m_pY[i], quats.m_pZ[i], quats.m_pW[i]);
+    }
+}
+
+//-------------------------------------------------------------------------
+// Approximation API
+//-------------------------------------------------------------------------
+F32 SM::FastSin(F32 rads)
+{
+    F32 sinResult;
+    F32 cosResult;
+    ApproxSinCos<ScalarLanes, false>(rads, sinResult, cosResult);
+    return sinResult;
+}
+
+F32 SM::FastCos(F32 rads)
+{
+    F32 sinResult;
+    F32 cosResult;
+    ApproxSinCos<ScalarLanes, false>(rads, sinResult, cosResult);
+    return cosResult;
+}
+
+void SM::FastSinCos(F32 rads, F32& outSin, F32& outCos)
+{
+    ApproxSinCos<ScalarLanes, false>(rads, outSin, outCos);
+}
+
+void SM::FastSinCosDegs(F32 degs, F32& outSin, F32& outCos)
+{
+    ApproxSinCos<ScalarLanes, true>(degs, outSin, outCos);
+}
+
+F32 SM::FastExp(F32 x)
+{
+    F32 result;
+    ApproxExp<ScalarLanes>(x, result);
+    return result;
+}
+
+F32 SM::FastLog(F32 x)
+{
+    F32 result;
+    ApproxLog<ScalarLanes>(x, result);
+    return result;
+}
+
+F32 SM::FastAtan2(F32 y, F32 x)
+{
+    F32 result;
+    ApproxAtan2<ScalarLanes>(y, x, result);
+    return result;
+}
+
+#if SM_SIMD_ENABLED
+F32x4 SM::FastSin(F32x4 rads)
+{
+    F32x4 sinResult;
+    F32x4 cosResult;
+    ApproxSinCos<F32x4Lanes, false>(rads, sinResult, cosResult);
+    return sinResult;
+}
+
+F32x4 SM::FastCos(F32x4 rads)
+{
+    F32x4 sinResult;
+    F32x4 cosResult;
+    ApproxSinCos<F32x4Lanes, false>(rads, sinResult, cosResult);
+    return cosResult;
+}
+
+void SM::FastSinCos(F32x4 rads, F32x4& outSin, F32x4& outCos)
+{
+    ApproxSinCos<F32x4Lanes, false>(rads, outSin, outCos);
+}
+
+void SM::FastSinCosDegs(F32x4 degs, F32x4& outSin, F32x4& outCos)
+{
+    ApproxSinCos<F32x4Lanes, true>(degs, outSin, outCos);
+}
+
+F32x4 SM::FastExp(F32x4 x)
+{
+    F32x4 result;
+    ApproxExp<F32x4Lanes>(x, result);
+    return result;
+}
+
+F32x4 SM::FastLog(F32x4 x)
+{
+    F32x4 result;
+    ApproxLog<F32x4Lanes>(x, result);
+    return result;
+}
+
+F32x4 SM::FastAtan2(F32x4 y, F32x4 x)
+{
+    F32x4 result;
+    ApproxAtan2<F32x4Lanes>(y, x, result);
+    return result;
+}
+#endif
+
+void SM::FastSinCos(const F32* pRads, F32* pOutSin, F32* pOutCos, size_t count)
+{
+    RunKernel<SinCosKernels<false>::Kernel>(count, pRads, pOutSin, pOutCos);
+}
+
+void SM::FastSinCosDegs(const F32* pDegs, F32* pOutSin, F32* pOutCos, size_t count)
+{
+    RunKernel<SinCosKernels<true>::Kernel>(count, pDegs, pOutSin, pOutCos);
+}
+
+void SM::FastExp(const F32* pValues, F32* pOutValues, size_t count)
+{
+    RunKernel<ExpKernel>(count, pValues, pOutValues);
+}
+
+void SM::FastLog(const F32* pValues, F32* pOutValues, size_t count)
+{
+    RunKernel<LogKernel>(count, pValues, pOutValues);
+}
+
+void SM::FastAtan2(const F32* pY, const F32* pX, F32* pOutRads, size_t count)
+{
+    RunKernel<Atan2Kernel>(count, pY, pX, pOutRads);
+}
+
+void SM::ConvertF32ToF16(const F32* pValues, U16* pOutHalfs, size_t count)
+{
+    RunKernel<ConvertF32ToF16Kernel>(count, pValues, pOutHalfs);
+}
+
+void SM::ConvertF16ToF32(const U16* pHalfs, F32* pOutValues, size_t count)
+{
+    RunKernel<ConvertF16ToF32Kernel>(count, pHalfs, pOutValues);
+}
+
+void SM::EncodeSnorm8(const F32* pValues, I8* pOutValues, size_t count)
+{
+    RunKernel<EncodeNormKernels<I8>::Kernel>(count, pValues, pOutValues, -1.0f, 127.0f);
+}
+
+void SM::EncodeSnorm16(const F32* pValues, I16* pOutValues, size_t count)
+{
+    RunKernel<EncodeNormKernels<I16>::Kernel>(count, pValues, pOutValues, -1.0f, 32767.0f);
+}
+
+void SM::EncodeUnorm8(const F32* pValues, U8* pOutValues, size_t count)
+{
+    RunKernel<EncodeNormKernels<U8>::Kernel>(count, pValues, pOutValues, 0.0f, 255.0f);
+}
+
+void SM::EncodeUnorm16(const F32* pValues, U16* pOutValues, size_t count)
+{
+    RunKernel<EncodeNormKernels<U16>::Kernel>(count, pValues, pOutValues, 0.0f, 65535.0f);
+}
+
+void SM::PackSnorm1010102(const Vec3SoA& vecs, const F32* pW, U32* pOutPacked, size_t count)
+{
+    RunKernel<Pack1010102Kernels<true>::Kernel>(count, vecs, pW, pOutPacked);
+}
+
+void SM::PackUnorm1010102(const Vec3SoA& vecs, const F32* pW, U32* pOutPacked, size_t count)
+{
+    RunKernel<Pack1010102Kernels<false>::Kernel>(count, vecs, pW, pOutPacked);
+}
+
+void SM::EncodeOctahedralSnorm16(const Vec3SoA& normals, U32* pOutPacked, size_t count)
+{
+    RunKernel<EncodeOctahedralKernels<U32>::Kernel>(count, normals, pOutPacked);
+}
+
+void SM::EncodeOctahedralSnorm8(const Vec3SoA& normals, U16* pOutPacked, size_t count)
+{
+    RunKernel<EncodeOctahedralKernels<U16>::Kernel>(count, normals, pOutPacked);
+}
+
+void SM::EncodeTangentFrames(const Vec3SoA& normals, const Vec3SoA& tangents, const F32* pBitangentSigns, PackedTangentFrame* pOutFrames, size_t count)
+{
+    RunKernel<EncodeTangentFramesKernel>(count, normals, tangents, pBitangentSigns, pOutFrames);
+}
+
+void SM::IntersectRayAabbs(const Ray& ray, const AabbSoA& aabbs, F32 maxT, F32* pOutT, size_t count)
+{
+    RunKernel<RayAabbsKernel>(count, ray, aabbs, maxT, pOutT);
+}
+
+void SM::IntersectRaySpheres(const Ray& ray, const SphereSoA& spheres, F32 maxT, F32* pOutT, size_t count)
+{
+    RunKernel<RaySpheresKernel>(count, ray, spheres, maxT, pOutT);
+}
+
+void SM::IntersectRayTriangles(const Ray& ray, const TriangleSoA& triangles, F32 maxT, F32* pOutT, size_t count)
+{
+    RunKernel<RayTrianglesKernel>(count, ray, triangles, maxT, pOutT);
+}
+
+void SM::OverlapSphereSpheres(const Sphere& sphere, const SphereSoA& spheres, size_t count, BitSet& outOverlapping)
+{
+    SM_ASSERT(count <= outOverlapping.GetNumBits());
+    RunKernel<OverlapSphereSpheresKernel>(count, sphere, spheres, outOverlapping.m_words.m_pData);
+}
+
+void SM::OverlapSphereAabbs(const Sphere& sphere, const AabbSoA& aabbs, size_t count, BitSet& outOverlapping)
+{
+    SM_ASSERT(count <= outOverlapping.GetNumBits());
+    RunKernel<OverlapSphereAabbsKernel>(count, sphere, aabbs, outOverlapping.m_words.m_pData);
+}
+
+void SM::OverlapAabbAabbs(const Aabb& aabb, const AabbSoA& aabbs, size_t count, BitSet& outOverlapping)
+{
+    SM_ASSERT(count <= outOverlapping.GetNumBits());
+    RunKernel<OverlapAabbAabbsKernel>(count, aabb, aabbs, outOverlapping.m_words.m_pData);
+}
+
+void SM::OverlapObbObbs(const Obb& obb, const ObbSoA& obbs, size_t count, BitSet& outOverlapping)
+{
+    SM_ASSERT(count <= outOverlapping.GetNumBits());
+    RunKernel<OverlapObbObbsKernel>(count, obb, obbs, outOverlapping.m_words.m_pData);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "SM/Containers.h"
+#include "SM/Geometry.h"
+#include "SM/Math.h"
+#include "SM/Quantize.h"
+#include "SM/StandardTypes.h"
+
+namespace SM
+{
+    // Batch math over structure of arrays data. Each component lives in its own stream so kernels load 4, 8 or 16
+    // elements of the same component at once, element i of a Vec3 stream is (m_pX[i], m_pY[i], m_pZ[i]).
+    // The widest kernel allowed by GetSimdLevel runs the bulk of a batch and the scalar kernel finishes the tail.
+    // Every width uses the same order of operations as the scalar Mat44 / Vec4 code, so results never depend on which
+    // kernel ran. Outputs may alias inputs element for element, streams have no alignment requirement.
+    struct Vec3SoA
+    {
+        F32* m_pX = nullptr;
+        F32* m_pY = nullptr;
+        F32* m_pZ = nullptr;
+    };
+
+    // One stream per matrix element in row order, m_pElements[0] holds every ix and m_pElements[15] every tw
+    struct Mat44SoA
+    {
+        F32* m_pElements[16] = {};
+    };
+
+    struct QuatSoA
+    {
+        F32* m_pX = nullptr;
+        F32* m_pY = nullptr;
+        F32* m_pZ = nullptr;
+        F32* m_pW = nullptr;
+    };
+
+    // Bounds for culling, sphere i is centered at (m_pCenterX[i], m_pCenterY[i], m_pCenterZ[i])
+    struct SphereSoA
+    {
+        F32* m_pCenterX = nullptr;
+        F32* m_pCenterY = nullptr;
+        F32* m_pCenterZ = nullptr;
+        F32* m_pRadius = nullptr;
+    };
+
+    // Axis aligned boxes as center and half size
+    struct AabbSoA
+    {
+        F32* m_pCenterX = nullptr;
+        F32* m_pCenterY = nullptr;
+        F32* m_pCenterZ = nullptr;
+        F32* m_pExtentX = nullptr;
+        F32* m_pExtentY = nullptr;
+        F32* m_pExtentZ = nullptr;
+    };
+
+    // Oriented boxes as center, half size and axes. m_pAxes holds one stream per Obb::m_axes element in row order,
+    // m_pAxes[0..2] are every box's local x axis.
+    struct ObbSoA
+    {
+        F32* m_pCenterX = nullptr;
+        F32* m_pCenterY = nullptr;
+        F32* m_pCenterZ = nullptr;
+        F32* m_pExtentX = nullptr;
+        F32* m_pExtentY = nullptr;
+        F32* m_pExtentZ = nullptr;
+        F32* m_pAxes[9] = {};
+    };
+
+    struct TriangleSoA
+    {
+        Vec3SoA m_v0;
+        Vec3SoA m_v1;
+        Vec3SoA m_v2;
+    };
+
+    // Point i is transformed as (x, y, z, 1) and direction i as (x, y, z, 0), matching Mat44::TransformPoint / TransformDir
+    void TransformPoints(const Mat44& transform, const Vec3SoA& points, const Vec3SoA& outPoints, size_t count);
+    void TransformDirs(const Mat44& transform, const Vec3SoA& dirs, const Vec3SoA& outDirs, size_t count);
+
+    // Element i is transformed by matrix i, e.g. skinning with already blended bone matrices
+    void TransformPoints(const Mat44SoA& transforms, const Vec3SoA& points, const Vec3SoA& outPoints, size_t count);
+    void TransformDirs(const Mat44SoA& transforms, const Vec3SoA& dirs, const Vec3SoA& outDirs, size_t count);
+
+    // outMatrices[i] = a[i] * b[i]
+    void MultiplyMatrices(const Mat44SoA& a, const Mat44SoA& b, const Mat44SoA& outMatrices, size_t count);
+
+    // outWorld[i] = local[i] * parentWorld[i], local space first since vectors are rows. For a hierarchy run one depth
+    // level at a time with each parent's world matrix gathered into parentWorld.
+    void ComposeWorldTransforms(const Mat44SoA& parentWorld, const Mat44SoA& local, const Mat44SoA& outWorld, size_t count);
+
+    // outQuats[i] = a[i] * b[i], a[i] rotates first like Quat::operator*
+    void MultiplyQuats(const QuatSoA& a, const QuatSoA& b, const QuatSoA& outQuats, size_t count);
+
+    // Blend every pair by the same t, e.g. two animation poses. Results match Nlerp / FastSlerp exactly.
+    void NlerpQuats(const QuatSoA& a, const QuatSoA& b, F32 t, const QuatSoA& outQuats, size_t count);
+    void FastSlerpQuats(const QuatSoA& a, const QuatSoA& b, F32 t, const QuatSoA& outQuats, size_t count);
+
+    // outVecs[i] = rotations[i].Rotate(vecs[i])
+    void RotateVecs(const QuatSoA& rotations, const Vec3SoA& vecs, const Vec3SoA& outVecs, size_t count);
+
+    // Bit i of outVisible is set when bounds i pass Frustum::IsSphereVisible / IsAabbVisible and cleared otherwise, bits past count
+    // are left alone. outVisible needs at least count bits. Threads each take whole words of the bit set so a frame's worth
+    // of objects can be spread over cores, numThreads is clamped so small batches stay on the calling thread.
+    void CullSpheres(const Frustum& frustum, const SphereSoA& spheres, size_t count, BitSet& outVisible, U32 numThreads = 1);
+    void CullAabbs(const Frustum& frustum, const AabbSoA& aabbs, size_t count, BitSet& outVisible, U32 numThreads = 1);
+
+    // One ray against many shapes, pOutT[i] is the distance IntersectRayAabb / IntersectRaySphere / IntersectRayTriangle
+    // would lower a maxT of maxT to, or inf when they report a miss.
+    void IntersectRayAabbs(const Ray& ray, const AabbSoA& aabbs, F32 maxT, F32* pOutT, size_t count);
+    void IntersectRaySpheres(const Ray& ray, const SphereSoA& spheres, F32 maxT, F32* pOutT, size_t count);
+    void IntersectRayTriangles(const Ray& ray, const TriangleSoA& triangles, F32 maxT, F32* pOutT, size_t count);
+
+    // One shape against many, bit i of outOverlapping is set when the matching Overlap test from Geometry.h passes for
+    // element i and cleared otherwise. Bits past count are left alone, outOverlapping needs at least count bits.
+    void OverlapSphereSpheres(const Sphere& sphere, const SphereSoA& spheres, size_t count, BitSet& outOverlapping);
+    void OverlapSphereAabbs(const Sphere& sphere, const AabbSoA& aabbs, size_t count, BitSet& outOverlapping);
+    void OverlapAabbAabbs(const Aabb& aabb, const AabbSoA& aabbs, size_t count, BitSet& outOverlapping);
+    void OverlapObbObbs(const Obb& obb, const ObbSoA& obbs, size_t count, BitSet& outOverlapping);
+
+    // Polynomial approximations for hot loops where libm is too slow. Every width gives bit identical results, the scalar
+    // and F32x4 overloads run the same code as the array versions. Max errors measured against double precision:
+    //   FastSin / FastCos    7.7e-8 absolute for |rads| <= 1e4, reduction error grows past that to 1e-6 at 1e5
+    //   FastSinCosDegs       7.7e-8 absolute, degrees reduce exactly so multiples of 90 give exact 0 and +-1
+    //   FastExp              7.9e-8 relative
+    //   FastLog              3.9e-8 absolute for x in [0.5, 2], 8.1e-8 relative outside it (2.6e-7 absolute at 100)
+    //   FastAtan2            2.8e-7 absolute
+    // Inputs must be finite. FastExp returns 0 below -86.9 and inf above 88.72, FastLog needs x > 0 and not denormal.
+    F32 FastSin(F32 rads);
+    F32 FastCos(F32 rads);
+    void FastSinCos(F32 rads, F32& outSin, F32& outCos);
+    void FastSinCosDegs(F32 degs, F32& outSin, F32& outCos);
+    F32 FastExp(F32 x);
+    F32 FastLog(F32 x);
+    F32 FastAtan2(F32 y, F32 x);
+
+    #if SM_SIMD_ENABLED
+    F32x4 FastSin(F32x4 rads);
+    F32x4 FastCos(F32x4 rads);
+    void FastSinCos(F32x4 rads, F32x4& outSin, F32x4& outCos);
+    void FastSinCosDegs(F32x4 degs, F32x4& outSin, F32x4& outCos);
+    F32x4 FastExp(F32x4 x);
+    F32x4 FastLog(F32x4 x);
+    F32x4 FastAtan2(F32x4 y, F32x4 x);
+    #endif
+
+    // Array versions run 4, 8 or 16 wide like the batch transforms, either sin or cos output may be null
+    void FastSinCos(const F32* pRads, F32* pOutSin, F32* pOutCos, size_t count);
+    void FastSinCosDegs(const F32* pDegs, F32* pOutSin, F32* pOutCos, size_t count);
+    void FastExp(const F32* pValues, F32* pOutValues, size_t count);
+    void FastLog(const F32* pValues, F32* pOutValues, size_t count);
+    void FastAtan2(const F32* pY, const F32* pX, F32* pOutRads, size_t count);
+
+    // Array versions of the Quantize.h encoders with bit identical results. Half float conversions use F16C at the AVX2
+    // level and above. pW may be null to pack a w of 0.
+    void ConvertF32ToF16(const F32* pValues, U16* pOutHalfs, size_t count);
+    void ConvertF16ToF32(const U16* pHalfs, F32* pOutValues, size_t count);
+    void EncodeSnorm8(const F32* pValues, I8* pOutValues, size_t count);
+    void EncodeSnorm16(const F32* pValues, I16* pOutValues, size_t count);
+    void EncodeUnorm8(const F32* pValues, U8* pOutValues, size_t count);
+    void EncodeUnorm16(const F32* pValues, U16* pOutValues, size_t count);
+    void PackSnorm1010102(const Vec3SoA& vecs, const F32* pW, U32* pOutPacked, size_t count);
+    void PackUnorm1010102(const Vec3SoA& vecs, const F32* pW, U32* pOutPacked, size_t count);
+    void EncodeOctahedralSnorm16(const Vec3SoA& normals, U32* pOutPacked, size_t count);
+    void EncodeOctahedralSnorm8(const Vec3SoA& normals, U16* pOutPacked, size_t count);
+    void EncodeTangentFrames(const Vec3SoA& normals, const Vec3SoA& tangents, const F32* pBitangentSigns, PackedTangentFrame* pOutFrames, size_t count);
+
+    // Conversions between arrays of Vec3 / Mat44 / Quat and structure of arrays streams
+    void ConvertToSoA(const Vec3* pVecs, size_t count, const Vec3SoA& outVecs);
+    void ConvertFromSoA(const Vec3SoA& vecs, size_t count, Vec3* pOutVecs);
+    void ConvertToSoA(const Mat44* pMatrices, size_t count, const Mat44SoA& outMatrices);
+    void ConvertFromSoA(const Mat44SoA& matrices, size_t count, Mat44* pOutMatrices);
+    void ConvertToSoA(const Quat* pQuats, size_t count, const QuatSoA& outQuats);
+    void ConvertFromSoA(const QuatSoA& quats, size_t count, Quat* pOutQuats);
+}
@@ -1,25 +1,141 @@
 #include "SM/Memory.h"
 #include "SM/Assert.h"
+#include "SM/Bits.h"
 #include "SM/Containers.h"
+#include "SM/Math.h"
+#include "SM/Platform.h"
 
-#include <cstdlib>
+#if MEMORY_TRACKING_ENABLED
+#include <atomic>
+#endif
 
 using namespace SM;
 
-static size_t s_memoryArenaSizes[kNumBuiltInArenas] = 
+// built in arenas only reserve address space, pages get committed as they are used
+// arenas with a reserve size of 0 are owned elsewhere and bound with BindBuiltInAllocator
+static size_t s_memoryArenaReserveSizes[kNumBuiltInArenas] = 
 {
-    MiB(1) // kEngineGlobal   
+    GiB(64),    // kEngineGlobal   
+    0           // kFrameTransient
 };
 
+// large page arenas can't grow so they get a fixed size instead, 0 means the arena never uses large pages
+static size_t s_memoryArenaLargePageSizes[kNumBuiltInArenas] = 
+{
+    MiB(256),   // kEngineGlobal   
+    0           // kFrameTransient
+};
+
+static const size_t kThreadScratchArenaReserveSize = GiB(1);
+static const size_t kThreadScratchArenaRetainOnResetSize = MiB(1);
+
+struct ThreadScratchArena
+{
+    ~ThreadScratchArena()
+    {
+        m_allocator.Release();
+    }
+
+    LinearAllocator m_allocator;
+};
+
+static const char* s_builtInAllocatorNames[kNumBuiltInArenas] =
+{
+    "EngineGlobal",     // kEngineGlobal
+    "FrameTransient"    // kFrameTransient
+};
+
+static const size_t kBuiltInHeapReserveSize = GiB(64);
+static const size_t kBuiltInHeapLargePageSize = MiB(256);
+
 LinearAllocator s_allocators[kNumBuiltInArenas];
-Stack<LinearAllocator*, 256> s_allocatorStack;
+LinearAllocator* s_pBuiltInAllocators[kNumBuiltInArenas] = {};
+HeapAllocator s_heap;
 
-void LinearAllocator::Init(void* storage, size_t size)
+// each thread gets its own allocator stack and scratch arena so pushing / popping scopes never needs a lock
+// and never touches a cache line owned by another thread
+static thread_local Stack<LinearAllocator*, 256> s_allocatorStack;
+static thread_local ThreadScratchArena s_threadScratchArena;
+
+#if MEMORY_TRACKING_ENABLED
+static const U32 kMaxMemoryTags = 128;
+
+struct SM::MemoryTagSlot
 {
-    m_pMemory = storage;
-    m_size = size;
-    m_allocatedBytes = 0;
+    std::atomic<const char*> m_name;
+    std::atomic<U64> m_numAllocations;
+    std::atomic<size_t> m_allocatedBytes;
+};
+
+// slots are claimed lock free and never released so any thread can tag allocations
+static MemoryTagSlot s_memoryTagSlots[kMaxMemoryTags];
+static thread_local MemoryTagSlot* s_pCurrentMemoryTag = nullptr;
+
+static MemoryTagSlot* FindOrAddMemoryTag(const char* tag)
+{
+    for(U32 i = 0; i < kMaxMemoryTags; i++)
+    {
+        MemoryTagSlot& slot = s_memoryTagSlots[i];
+        const char* slotName = slot.m_name.load(std::memory_order_acquire);
+        if(slotName == nullptr)
+        {
+            if(slot.m_name.compare_exchange_strong(slotName, tag, std::memory_order_acq_rel))
+                return &slot;
+        }
+
+        if(slotName == tag || ::strcmp(slotName, tag) == 0)
+            return &slot;
+    }
+
+    SM_ERROR_MSG("Ran out of memory tag slots, increase kMaxMemoryTags\n");
+    return nullptr;
+}
+
+MemoryTagSlot* SM::PushMemoryTag(const char* tag)
+{
+    MemoryTagSlot* pPreviousTag = s_pCurrentMemoryTag;
+    s_pCurrentMemoryTag = FindOrAddMemoryTag(tag);
+    return pPreviousTag;
+}
+
+void SM::PopMemoryTag(MemoryTagSlot* pPreviousTag)
+{
+    s_pCurrentMemoryTag = pPreviousTag;
+}
+
+U32 SM::GetMemoryTagStats(MemoryTagStats* outStats, U32 maxStats)
+{
+    U32 numStats = 0;
+    for(U32 i = 0; i < kMaxMemoryTags && numStats < maxStats; i++)
+    {
+        const MemoryTagSlot& slot = s_memoryTagSlots[i];
+        const char* slotName = slot.m_name.load(std::memory_order_acquire);
+        if(slotName == nullptr)
+            break;
+
+        outStats[numStats].m_name = slotName;
+        outStats[numStats].m_numAllocations = slot.m_numAllocations.load(std::memory_order_relaxed);
+        outStats[numStats].m_allocatedBytes = slot.m_allocatedBytes.load(std::memory_order_relaxed);
+        numStats++;
+    }
+    return numStats;
+}
+
+static void TrackAllocation(AllocatorStats& stats, size_t currentAllocatedBytes, size_t requestedBytes, size_t paddingBytes)
+{
+    stats.m_numAllocations++;
+    stats.m_paddingBytes += paddingBytes;
+    stats.m_peakAllocatedBytes = Max(stats.m_peakAllocatedBytes, currentAllocatedBytes);
+
+    static MemoryTagSlot* s_pUntaggedSlot = FindOrAddMemoryTag("Untagged");
+    MemoryTagSlot* pTag = s_pCurrentMemoryTag != nullptr ? s_pCurrentMemoryTag : s_pUntaggedSlot;
+    if(pTag != nullptr)
+    {
+        pTag->m_numAllocations.fetch_add(1, std::memory_order_relaxed);
+        pTag->m_allocatedBytes.fetch_add(requestedBytes, std::memory_order_relaxed);
+    }
 }
+#endif
 
 static uintptr_t AlignAddress(uintptr_t address, uintptr_t alignment)
 {
@@ -40,6 +156,73 @@ static uintptr_t AlignAddress(uintptr_t address, uintptr_t alignment)
     return  nextAlignedAddr;
 }
 
+void LinearAllocator::Init(void* storage, size_t size)
+{
+    m_pMemory = storage;
+    m_size = size;
+    m_allocatedBytes = 0;
+    m_bIsVirtual = false;
+    m_bUsesLargePages = false;
+    m_committedBytes = size;
+    m_retainOnResetBytes = kRetainAllOnReset;
+
+    #if MEMORY_TRACKING_ENABLED
+    m_trackingStats = AllocatorStats();
+    #endif
+}
+
+void LinearAllocator::InitVirtual(size_t reserveSize, size_t retainOnResetBytes)
+{
+    m_pMemory = Platform::ReserveMemory(reserveSize);
+    SM_ASSERT(m_pMemory != nullptr);
+    m_size = reserveSize;
+    m_allocatedBytes = 0;
+    m_bIsVirtual = true;
+    m_bUsesLargePages = false;
+    m_committedBytes = 0;
+    m_retainOnResetBytes = retainOnResetBytes;
+
+    #if MEMORY_TRACKING_ENABLED
+    m_trackingStats = AllocatorStats();
+    #endif
+}
+
+void LinearAllocator::InitLargePages(size_t size)
+{
+    size_t largePageSize = Platform::GetLargePageSize();
+    void* pMemory = nullptr;
+    if(largePageSize > 0)
+    {
+        size = AlignAddress(size, largePageSize);
+        pMemory = Platform::AllocateLargePages(size);
+    }
+
+    if(pMemory == nullptr)
+    {
+        InitVirtual(size);
+        return;
+    }
+
+    Init(pMemory, size);
+    m_bIsVirtual = true;
+    m_bUsesLargePages = true;
+}
+
+void LinearAllocator::Release()
+{
+    if(m_bIsVirtual && m_pMemory != nullptr)
+    {
+        Platform::ReleaseMemory(m_pMemory, m_size);
+    }
+
+    m_pMemory = nullptr;
+    m_bIsVirtual = false;
+    m_bUsesLargePages = false;
+    m_size = 0;
+    m_allocatedBytes = 0;
+    m_committedBytes = 0;
+}
+
 void* LinearAllocator::Alloc(size_t sizeBytes, U32 alignment)
 {
     uintptr_t currentAddr = (uintptr_t)m_pMemory + m_allocatedBytes;
@@ -48,29 +231,623 @@ void* LinearAllocator::Alloc(size_t sizeBytes, U32 alignment)
     uintptr_t alignmentDelta = nextAlignedAddr - currentAddr;
     size_t totalBytesNeeded = alignmentDelta + sizeBytes;
 
-    SM_ASSERT(m_allocatedBytes + totalBytesNeeded <= m_size);
+    size_t requiredBytes = m_allocatedBytes + totalBytesNeeded;
+    SM_ASSERT(requiredBytes <= m_size);
+
+    if(requiredBytes > m_committedBytes)
+    {
+        CommitUpTo(requiredBytes);
+    }
+
+    m_allocatedBytes = requiredBytes; 
+
+    #if MEMORY_TRACKING_ENABLED
+    TrackAllocation(m_trackingStats, m_allocatedBytes, sizeBytes, alignmentDelta);
+    #endif
 
-    m_allocatedBytes += totalBytesNeeded; 
     return (void*)nextAlignedAddr;
 }
 
+bool LinearAllocator::TryExtend(void* ptr, size_t oldSizeBytes, size_t newSizeBytes)
+{
+    uintptr_t allocationEnd = (uintptr_t)ptr + oldSizeBytes;
+    uintptr_t currentAddr = (uintptr_t)m_pMemory + m_allocatedBytes;
+    if(allocationEnd != currentAddr)
+        return false;
+
+    size_t requiredBytes = m_allocatedBytes - oldSizeBytes + newSizeBytes;
+    if(requiredBytes > m_size)
+        return false;
+
+    if(requiredBytes > m_committedBytes)
+    {
+        CommitUpTo(requiredBytes);
+    }
+
+    m_allocatedBytes = requiredBytes;
+
+    #if MEMORY_TRACKING_ENABLED
+    m_trackingStats.m_peakAllocatedBytes = Max(m_trackingStats.m_peakAllocatedBytes, m_allocatedBytes);
+    #endif
+
+    return true;
+}
+
+void LinearAllocator::CommitUpTo(size_t requiredBytes)
+{
+    SM_ASSERT(m_bIsVirtual);
+
+    // commit in large chunks so we aren't calling into the OS for every small allocation
+    size_t newCommittedBytes = Min((size_t)AlignAddress(requiredBytes, kVirtualCommitGranularity), m_size);
+    bool bCommitted = Platform::CommitMemory((Byte*)m_pMemory + m_committedBytes, newCommittedBytes - m_committedBytes);
+    SM_ASSERT(bCommitted);
+    m_committedBytes = newCommittedBytes;
+}
+
 void LinearAllocator::Reset()
 {
     m_allocatedBytes = 0;
+
+    #if MEMORY_TRACKING_ENABLED
+    m_trackingStats.m_paddingBytes = 0;
+    m_trackingStats.m_numAllocations = 0;
+    #endif
+
+    if(m_bIsVirtual && m_committedBytes > m_retainOnResetBytes)
+    {
+        size_t retainedBytes = AlignAddress(m_retainOnResetBytes, kVirtualCommitGranularity);
+        if(retainedBytes < m_committedBytes)
+        {
+            Platform::DecommitMemory((Byte*)m_pMemory + retainedBytes, m_committedBytes - retainedBytes);
+            m_committedBytes = retainedBytes;
+        }
+    }
+}
+
+void PoolAllocator::Init(LinearAllocator* pParentAllocator, size_t blockSize, U32 blocksPerChunk, U32 alignment)
+{
+    SM_ASSERT(pParentAllocator != nullptr);
+    SM_ASSERT(blocksPerChunk > 0);
+
+    // every block has to be able to hold the free list link and keep the next block aligned
+    size_t minBlockSize = Max(blockSize, sizeof(FreeBlock));
+    m_blockSize = AlignAddress(minBlockSize, alignment);
+    m_alignment = alignment;
+    m_blocksPerChunk = blocksPerChunk;
+    m_pParentAllocator = pParentAllocator;
+    m_pFreeList = nullptr;
+    m_pChunkCursor = nullptr;
+    m_pChunkEnd = nullptr;
+    m_numAllocatedBlocks = 0;
 }
 
-void SM::InitBuiltInAllocators()
+void* PoolAllocator::Alloc()
+{
+    m_numAllocatedBlocks++;
+
+    // recycle a previously freed block first
+    if(m_pFreeList != nullptr)
+    {
+        FreeBlock* pBlock = m_pFreeList;
+        m_pFreeList = pBlock->m_pNext;
+        return pBlock;
+    }
+
+    // grab a fresh chunk from the parent when the current one runs out, blocks within it are handed out lazily
+    if(m_pChunkCursor == m_pChunkEnd)
+    {
+        size_t chunkSize = m_blockSize * m_blocksPerChunk;
+        m_pChunkCursor = (Byte*)m_pParentAllocator->Alloc(chunkSize, m_alignment);
+        m_pChunkEnd = m_pChunkCursor + chunkSize;
+    }
+
+    void* pBlock = m_pChunkCursor;
+    m_pChunkCursor += m_blockSize;
+    return pBlock;
+}
+
+void PoolAllocator::Free(void* pBlock)
+{
+    if(pBlock == nullptr)
+        return;
+
+    SM_ASSERT(m_numAllocatedBlocks > 0);
+    m_numAllocatedBlocks--;
+
+    FreeBlock* pFreeBlock = (FreeBlock*)pBlock;
+    pFreeBlock->m_pNext = m_pFreeList;
+    m_pFreeList = pFreeBlock;
+}
+
+void PoolAllocator::Reset()
+{
+    // chunks are owned by the parent allocator, they are reclaimed when it is reset
+    m_pFreeList = nullptr;
+    m_pChunkCursor = nullptr;
+    m_pChunkEnd = nullptr;
+    m_numAllocatedBlocks = 0;
+}
+
+typedef HeapAllocator::BlockHeader HeapBlockHeader;
+
+// block sizes are always multiples of 16 so the low bits of the size are free to use as flags
+static const size_t kHeapBlockFreeFlag = 0x1;
+static const size_t kHeapBlockPrevFreeFlag = 0x2;
+static const size_t kHeapBlockFlagsMask = 0xF;
+
+// while a block is free its payload holds the free list links
+struct HeapFreeLinks
+{
+    HeapBlockHeader* m_pNextFree;
+    HeapBlockHeader* m_pPrevFree;
+};
+
+static size_t GetBlockSize(const HeapBlockHeader* pBlock)
+{
+    return pBlock->m_sizeAndFlags & ~kHeapBlockFlagsMask;
+}
+
+static void SetBlockSize(HeapBlockHeader* pBlock, size_t size)
+{
+    pBlock->m_sizeAndFlags = size | (pBlock->m_sizeAndFlags & kHeapBlockFlagsMask);
+}
+
+static bool IsBlockFree(const HeapBlockHeader* pBlock)
+{
+    return (pBlock->m_sizeAndFlags & kHeapBlockFreeFlag) != 0;
+}
+
+static void SetBlockFree(HeapBlockHeader* pBlock, bool bFree)
+{
+    pBlock->m_sizeAndFlags = bFree ? (pBlock->m_sizeAndFlags | kHeapBlockFreeFlag) : (pBlock->m_sizeAndFlags & ~kHeapBlockFreeFlag);
+}
+
+static bool IsPrevBlockFree(const HeapBlockHeader* pBlock)
+{
+    return (pBlock->m_sizeAndFlags & kHeapBlockPrevFreeFlag) != 0;
+}
+
+static void SetPrevBlockFree(HeapBlockHeader* pBlock, bool bFree)
+{
+    pBlock->m_sizeAndFlags = bFree ? (pBlock->m_sizeAndFlags | kHeapBlockPrevFreeFlag) : (pBlock->m_sizeAndFlags & ~kHeapBlockPrevFreeFlag);
+}
+
+static Byte* GetBlockPayload(HeapBlockHeader* pBlock)
+{
+    return (Byte*)pBlock + sizeof(HeapBlockHeader);
+}
+
+static HeapBlockHeader* GetBlockFromPayload(void* ptr)
+{
+    return (HeapBlockHeader*)((Byte*)ptr - sizeof(HeapBlockHeader));
+}
+
+static HeapBlockHeader* GetNextPhysicalBlock(HeapBlockHeader* pBlock)
+{
+    return (HeapBlockHeader*)(GetBlockPayload(pBlock) + GetBlockSize(pBlock));
+}
+
+static HeapFreeLinks* GetFreeLinks(HeapBlockHeader* pBlock)
+{
+    return (HeapFreeLinks*)GetBlockPayload(pBlock);
+}
+
+static void HeapMappingInsert(size_t size, U32& firstLevel, U32& secondLevel)
+{
+    if(size < HeapAllocator::kSmallBlockSize)
+    {
+        // small sizes are split linearly into the first level
+        firstLevel = 0;
+        secondLevel = (U32)(size / (HeapAllocator::kSmallBlockSize / HeapAllocator::kSecondLevelCount));
+    }
+    else
+    {
+        U32 lastSetBit = FindLastSetBit((U64)size);
+        secondLevel = (U32)(size >> (lastSetBit - HeapAllocator::kSecondLevelCountLog2)) ^ HeapAllocator::kSecondLevelCount;
+        firstLevel = lastSetBit - (HeapAllocator::kFirstLevelShift - 1);
+    }
+}
+
+static void HeapMappingSearch(size_t size, U32& firstLevel, U32& secondLevel)
+{
+    // round up to the next size class so any block found in it is guaranteed to fit
+    if(size >= HeapAllocator::kSmallBlockSize)
+    {
+        size_t round = ((size_t)1 << (FindLastSetBit((U64)size) - HeapAllocator::kSecondLevelCountLog2)) - 1;
+        size += round;
+    }
+    HeapMappingInsert(size, firstLevel, secondLevel);
+}
+
+void HeapAllocator::Init(void* storage, size_t size)
+{
+    SM_ASSERT(((uintptr_t)storage & (kAlign16 - 1)) == 0);
+    m_pMemory = (Byte*)storage;
+    m_size = size & ~(size_t)(kAlign16 - 1);
+    m_committedBytes = m_size;
+    m_bIsVirtual = false;
+    InitRegion(m_committedBytes);
+}
+
+void HeapAllocator::InitVirtual(size_t reserveSize, size_t initialCommitSize)
+{
+    m_pMemory = (Byte*)Platform::ReserveMemory(reserveSize);
+    SM_ASSERT(m_pMemory != nullptr);
+    m_size = reserveSize;
+    m_committedBytes = Min((size_t)AlignAddress(initialCommitSize, kVirtualGrowGranularity), reserveSize);
+    m_bIsVirtual = true;
+
+    bool bCommitted = Platform::CommitMemory(m_pMemory, m_committedBytes);
+    SM_ASSERT(bCommitted);
+    InitRegion(m_committedBytes);
+}
+
+void HeapAllocator::InitLargePages(size_t size)
+{
+    size_t largePageSize = Platform::GetLargePageSize();
+    void* pMemory = nullptr;
+    if(largePageSize > 0)
+    {
+        size = AlignAddress(size, largePageSize);
+        pMemory = Platform::AllocateLargePages(size);
+    }
+
+    if(pMemory == nullptr)
+    {
+        InitVirtual(size, size);
+        return;
+    }
+
+    Init(pMemory, size);
+    m_bIsVirtual = true;
+}
+
+void HeapAllocator::Release()
+{
+    if(m_bIsVirtual && m_pMemory != nullptr)
+    {
+        Platform::ReleaseMemory(m_pMemory, m_size);
+    }
+
+    *this = HeapAllocator();
+}
+
+void HeapAllocator::InitRegion(size_t size)
+{
+    SM_ASSERT(size >= 2 * sizeof(HeapBlockHeader) + kMinBlockSize);
+
+    ::memset(m_freeBlocks, 0, sizeof(m_freeBlocks));
+    ::memset(m_secondLevelBitmaps, 0, sizeof(m_secondLevelBitmaps));
+    m_firstLevelBitmap = 0;
+    m_usedBytes = 0;
+    m_numUsedBlocks = 0;
+
+    #if MEMORY_TRACKING_ENABLED
+    m_trackingStats = AllocatorStats();
+    #endif
+
+    // one free block spanning the region, followed by a zero sized used sentinel so merging never walks off the end
+    HeapBlockHeader* pBlock = (HeapBlockHeader*)m_pMemory;
+    pBlock->m_pPrevPhysical = nullptr;
+    pBlock->m_sizeAndFlags = size - 2 * sizeof(HeapBlockHeader);
+
+    m_pSentinel = GetNextPhysicalBlock(pBlock);
+    m_pSentinel->m_pPrevPhysical = pBlock;
+    m_pSentinel->m_sizeAndFlags = 0;
+
+    SetBlockFree(pBlock, true);
+    SetPrevBlockFree(m_pSentinel, true);
+    InsertFreeBlock(pBlock);
+}
+
+bool HeapAllocator::Grow(size_t minBytes)
+{
+    if(!m_bIsVirtual)
+        return false;
+
+    // leave room for size class round up plus the header of the new block
+    size_t growBytes = AlignAddress(minBytes + (minBytes >> kSecondLevelCountLog2) + 2 * sizeof(HeapBlockHeader), kVirtualGrowGranularity);
+    if(m_committedBytes + growBytes > m_size)
+        return false;
+
+    if(!Platform::CommitMemory(m_pMemory + m_committedBytes, growBytes))
+        return false;
+
+    m_committedBytes += growBytes;
+
+    // the old sentinel becomes a free block covering the new pages and a new sentinel goes at the end
+    HeapBlockHeader* pBlock = m_pSentinel;
+    SetBlockSize(pBlock, growBytes - sizeof(HeapBlockHeader));
+
+    m_pSentinel = GetNextPhysicalBlock(pBlock);
+    m_pSentinel->m_pPrevPhysical = pBlock;
+    m_pSentinel->m_sizeAndFlags = 0;
+
+    SetBlockFree(pBlock, true);
+    pBlock = MergeFreeNeighbors(pBlock);
+    SetPrevBlockFree(GetNextPhysicalBlock(pBlock), true);
+    InsertFreeBlock(pBlock);
+    return true;
+}
+
+void HeapAllocator::InsertFreeBlock(HeapBlockHeader* pBlock)
+{
+    U32 firstLevel = 0;
+    U32 secondLevel = 0;
+    HeapMappingInsert(GetBlockSize(pBlock), firstLevel, secondLevel);
+    SM_ASSERT(firstLevel < kFirstLevelCount);
+
+    HeapBlockHeader* pHead = m_freeBlocks[firstLevel][secondLevel];
+    HeapFreeLinks* pLinks = GetFreeLinks(pBlock);
+    pLinks->m_pNextFree = pHead;
+    pLinks->m_pPrevFree = nullptr;
+    if(pHead != nullptr)
+    {
+        GetFreeLinks(pHead)->m_pPrevFree = pBlock;
+    }
+
+    m_freeBlocks[firstLevel][secondLevel] = pBlock;
+    m_firstLevelBitmap |= (1u << firstLevel);
+    m_secondLevelBitmaps[firstLevel] |= (1u << secondLevel);
+}
+
+void HeapAllocator::RemoveFreeBlock(HeapBlockHeader* pBlock)
+{
+    U32 firstLevel = 0;
+    U32 secondLevel = 0;
+    HeapMappingInsert(GetBlockSize(pBlock), firstLevel, secondLevel);
+
+    HeapFreeLinks* pLinks = GetFreeLinks(pBlock);
+    if(pLinks->m_pNextFree != nullptr)
+    {
+        GetFreeLinks(pLinks->m_pNextFree)->m_pPrevFree = pLinks->m_pPrevFree;
+    }
+    if(pLinks->m_pPrevFree != nullptr)
+    {
+        GetFreeLinks(pLinks->m_pPrevFree)->m_pNextFree = pLinks->m_pNextFree;
+    }
+
+    if(m_freeBlocks[firstLevel][secondLevel] == pBlock)
+    {
+        m_freeBlocks[firstLevel][secondLevel] = pLinks->m_pNextFree;
+        if(pLinks->m_pNextFree == nullptr)
+        {
+            m_secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+            if(m_secondLevelBitmaps[firstLevel] == 0)
+            {
+                m_firstLevelBitmap &= ~(1u << firstLevel);
+            }
+        }
+    }
+}
+
+HeapBlockHeader* HeapAllocator::FindFreeBlock(size_t size)
+{
+    U32 firstLevel = 0;
+    U32 secondLevel = 0;
+    HeapMappingSearch(size, firstLevel, secondLevel);
+    if(firstLevel >= kFirstLevelCount)
+        return nullptr;
+
+    // look for a non empty list in this first level at or above the size class, otherwise take the next first level up
+    U32 secondLevelMap = m_secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+    if(secondLevelMap == 0)
+    {
+        U32 firstLevelMap = (firstLevel + 1 < kFirstLevelCount) ? m_firstLevelBitmap & (~0u << (firstLevel + 1)) : 0;
+        if(firstLevelMap == 0)
+            return nullptr;
+
+        firstLevel = FindFirstSetBit(firstLevelMap);
+        secondLevelMap = m_secondLevelBitmaps[firstLevel];
+    }
+    secondLevel = FindFirstSetBit(secondLevelMap);
+
+    HeapBlockHeader* pBlock = m_freeBlocks[firstLevel][secondLevel];
+    RemoveFreeBlock(pBlock);
+    return pBlock;
+}
+
+HeapBlockHeader* HeapAllocator::SplitBlock(HeapBlockHeader* pBlock, size_t size)
+{
+    // carves size bytes off the front of pBlock and returns the trailing remainder as a new free block
+    HeapBlockHeader* pRemainder = (HeapBlockHeader*)(GetBlockPayload(pBlock) + size);
+    pRemainder->m_pPrevPhysical = pBlock;
+    pRemainder->m_sizeAndFlags = GetBlockSize(pBlock) - size - sizeof(HeapBlockHeader);
+    SetBlockFree(pRemainder, true);
+    SetBlockSize(pBlock, size);
+
+    HeapBlockHeader* pNext = GetNextPhysicalBlock(pRemainder);
+    pNext->m_pPrevPhysical = pRemainder;
+    SetPrevBlockFree(pNext, true);
+    return pRemainder;
+}
+
+HeapBlockHeader* HeapAllocator::MergeFreeNeighbors(HeapBlockHeader* pBlock)
+{
+    if(IsPrevBlockFree(pBlock))
+    {
+        HeapBlockHeader* pPrev = pBlock->m_pPrevPhysical;
+        RemoveFreeBlock(pPrev);
+        SetBlockSize(pPrev, GetBlockSize(pPrev) + sizeof(HeapBlockHeader) + GetBlockSize(pBlock));
+        pBlock = pPrev;
+        GetNextPhysicalBlock(pBlock)->m_pPrevPhysical = pBlock;
+    }
+
+    HeapBlockHeader* pNext = GetNextPhysicalBlock(pBlock);
+    if(IsBlockFree(pNext))
+    {
+        RemoveFreeBlock(pNext);
+        SetBlockSize(pBlock, GetBlockSize(pBlock) + sizeof(HeapBlockHeader) + GetBlockSize(pNext));
+        GetNextPhysicalBlock(pBlock)->m_pPrevPhysical = pBlock;
+    }
+
+    return pBlock;
+}
+
+void* HeapAllocator::Alloc(size_t sizeBytes, U32 alignment)
+{
+    SM_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    size_t size = AlignAddress(Max(sizeBytes, kMinBlockSize), kAlign16);
+
+    // for larger alignments search for enough slack to trim off a leading block that is big enough to be free on its own
+    size_t minLeadingGap = sizeof(HeapBlockHeader) + kMinBlockSize;
+    size_t searchSize = alignment > kAlign16 ? size + alignment + minLeadingGap : size;
+
+    HeapBlockHeader* pBlock = FindFreeBlock(searchSize);
+    if(pBlock == nullptr)
+    {
+        if(!Grow(searchSize))
+        {
+            SM_ERROR_MSG("HeapAllocator is out of memory\n");
+            return nullptr;
+        }
+        pBlock = FindFreeBlock(searchSize);
+        SM_ASSERT(pBlock != nullptr);
+    }
+
+    if(alignment > kAlign16)
+    {
+        uintptr_t payloadAddr = (uintptr_t)GetBlockPayload(pBlock);
+        uintptr_t alignedAddr = AlignAddress(payloadAddr, alignment);
+        if(alignedAddr != payloadAddr && alignedAddr - payloadAddr < minLeadingGap)
+        {
+            alignedAddr = AlignAddress(payloadAddr + minLeadingGap, alignment);
+        }
+
+        size_t gap = alignedAddr - payloadAddr;
+        if(gap != 0)
+        {
+            HeapBlockHeader* pAligned = SplitBlock(pBlock, gap - sizeof(HeapBlockHeader));
+            SetPrevBlockFree(pAligned, true);
+            InsertFreeBlock(pBlock);
+            pBlock = pAligned;
+        }
+    }
+
+    if(GetBlockSize(pBlock) >= size + sizeof(HeapBlockHeader) + kMinBlockSize)
+    {
+        HeapBlockHeader* pRemainder = SplitBlock(pBlock, size);
+        InsertFreeBlock(pRemainder);
+    }
+
+    SetBlockFree(pBlock, false);
+    SetPrevBlockFree(GetNextPhysicalBlock(pBlock), false);
+
+    m_usedBytes += GetBlockSize(pBlock);
+    m_numUsedBlocks++;
+
+    #if MEMORY_TRACKING_ENABLED
+    TrackAllocation(m_trackingStats, m_usedBytes, sizeBytes, GetBlockSize(pBlock) - sizeBytes);
+    #endif
+
+    return GetBlockPayload(pBlock);
+}
+
+void HeapAllocator::Free(void* ptr)
+{
+    if(ptr == nullptr)
+        return;
+
+    HeapBlockHeader* pBlock = GetBlockFromPayload(ptr);
+    SM_ASSERT(!IsBlockFree(pBlock));
+
+    m_usedBytes -= GetBlockSize(pBlock);
+    m_numUsedBlocks--;
+
+    SetBlockFree(pBlock, true);
+    pBlock = MergeFreeNeighbors(pBlock);
+    SetPrevBlockFree(GetNextPhysicalBlock(pBlock), true);
+    InsertFreeBlock(pBlock);
+}
+
+size_t HeapAllocator::GetAllocationSize(void* ptr) const
+{
+    return GetBlockSize(GetBlockFromPayload(ptr));
+}
+
+HeapAllocator::Stats HeapAllocator::GetStats() const
+{
+    Stats stats;
+    stats.m_committedBytes = m_committedBytes;
+    stats.m_usedBytes = m_usedBytes;
+    stats.m_numUsedBlocks = m_numUsedBlocks;
+
+    for(U32 firstLevel = 0; firstLevel < kFirstLevelCount; firstLevel++)
+    {
+        for(U32 secondLevel = 0; secondLevel < kSecondLevelCount; secondLevel++)
+        {
+            for(HeapBlockHeader* pBlock = m_freeBlocks[firstLevel][secondLevel]; pBlock != nullptr; pBlock = GetFreeLinks(pBlock)->m_pNextFree)
+            {
+                size_t blockSize = GetBlockSize(pBlock);
+                stats.m_freeBytes += blockSize;
+                stats.m_largestFreeBlock = Max(stats.m_largestFreeBlock, blockSize);
+                stats.m_numFreeBlocks++;
+            }
+        }
+    }
+
+    return stats;
+}
+
+void SM::InitBuiltInAllocators(bool bUseLargePages)
 {
     for(int i = 0; i < kNumBuiltInArenas; i++)
     {
-        void* allocatorMemory = malloc(s_memoryArenaSizes[i]);
-        s_allocators[i].Init(allocatorMemory, s_memoryArenaSizes[i]);
+        if(s_memoryArenaReserveSizes[i] == 0)
+            continue;
+
+        if(bUseLargePages && s_memoryArenaLargePageSizes[i] > 0)
+        {
+            s_allocators[i].InitLargePages(s_memoryArenaLargePageSizes[i]);
+        }
+        else
+        {
+            s_allocators[i].InitVirtual(s_memoryArenaReserveSizes[i]);
+        }
+        s_pBuiltInAllocators[i] = &s_allocators[i];
+    }
+
+    if(bUseLargePages)
+    {
+        s_heap.InitLargePages(kBuiltInHeapLargePageSize);
+    }
+    else
+    {
+        s_heap.InitVirtual(kBuiltInHeapReserveSize);
     }
 }
 
 LinearAllocator* SM::GetBuiltInAllocator(BuiltInMemoryAllocator builtInArena)
 {
-    return &s_allocators[builtInArena];
+    SM_ASSERT(s_pBuiltInAllocators[builtInArena] != nullptr);
+    return s_pBuiltInAllocators[builtInArena];
+}
+
+const char* SM::GetBuiltInAllocatorName(BuiltInMemoryAllocator builtInArena)
+{
+    return s_builtInAllocatorNames[builtInArena];
+}
+
+void SM::BindBuiltInAllocator(BuiltInMemoryAllocator builtInArena, LinearAllocator* allocator)
+{
+    s_pBuiltInAllocators[builtInArena] = allocator;
+}
+
+HeapAllocator* SM::GetBuiltInHeap()
+{
+    return &s_heap;
+}
+
+LinearAllocator* SM::GetThreadScratchAllocator()
+{
+    LinearAllocator& scratch = s_threadScratchArena.m_allocator;
+    if(scratch.m_pMemory == nullptr)
+    {
+        // lazily create the arena the first time a thread asks for it so threads that never use scratch memory pay nothing
+        scratch.InitVirtual(kThreadScratchArenaReserveSize, kThreadScratchArenaRetainOnResetSize);
+    }
+    return &scratch;
 }
 
 void SM::PushAllocator(LinearAllocator* allocator)
@@ -7,6 +7,7 @@ namespace SM
     enum BuiltInMemoryAllocator
     {
         kEngineGlobal,
+        kFrameTransient,    // bound each frame to the arena of the frame in flight, recycled once the gpu finishes that frame
         kNumBuiltInArenas
     };
 
@@ -27,10 +28,65 @@ namespace SM
         kAlign2MiB = MiB(2)
     };
 
+    #define MEMORY_TRACKING_ENABLED !NDEBUG
+
+    #if MEMORY_TRACKING_ENABLED
+    // Debug only bookkeeping, counts are since the last Init / Reset except the peak which is kept for the allocator lifetime
+    struct AllocatorStats
+    {
+        size_t m_peakAllocatedBytes = 0;
+        size_t m_paddingBytes = 0;
+        U64 m_numAllocations = 0;
+    };
+
+    struct MemoryTagStats
+    {
+        const char* m_name = nullptr;
+        U64 m_numAllocations = 0;
+        size_t m_allocatedBytes = 0;
+    };
+
+    // Allocations made on this thread are attributed to the innermost tag until it is popped
+    struct MemoryTagSlot;
+    MemoryTagSlot* PushMemoryTag(const char* tag);
+    void PopMemoryTag(MemoryTagSlot* pPreviousTag);
+    U32 GetMemoryTagStats(MemoryTagStats* outStats, U32 maxStats);
+
+    class ScopedMemoryTag
+    {
+    public:
+        ScopedMemoryTag(const char* tag)
+        {
+            m_pPreviousTag = PushMemoryTag(tag);
+        }
+
+        ~ScopedMemoryTag()
+        {
+            PopMemoryTag(m_pPreviousTag);
+        }
+
+        MemoryTagSlot* m_pPreviousTag = nullptr;
+    };
+
+    #define SM_MEMORY_TAG(tag) ScopedMemoryTag scopedMemoryTag(tag);
+    #else
+    #define SM_MEMORY_TAG(tag)
+    #endif
+
     class LinearAllocator
     {
         public:
         void Init(void* storage, size_t size);
+
+        // Reserves address space up front and commits pages on demand as allocations grow into it, pointers stay stable.
+        // On Reset any committed memory past retainOnResetBytes is decommitted so resident memory tracks the high water mark.
+        void InitVirtual(size_t reserveSize, size_t retainOnResetBytes = kRetainAllOnReset);
+
+        // Fixed size and fully committed up front using large pages to cut down on TLB misses when walking big data sets.
+        // Falls back to InitVirtual when large pages are unavailable.
+        void InitLargePages(size_t size);
+        void Release();
+
         void* Alloc(size_t sizeBytes, U32 alignment = kAlign1);
         template<typename T>
         T* Alloc(size_t numElements);
@@ -38,9 +94,27 @@ namespace SM
         T* Alloc();
         void Reset();
 
+        // Grows ptr in place when it is the most recent allocation, returns false if something was allocated after it
+        bool TryExtend(void* ptr, size_t oldSizeBytes, size_t newSizeBytes);
+
         void* m_pMemory = nullptr;
         size_t m_size = 0;
-        U32 m_allocatedBytes = 0;
+        size_t m_allocatedBytes = 0;
+
+        bool m_bIsVirtual = false;
+        bool m_bUsesLargePages = false;
+        size_t m_committedBytes = 0;
+        size_t m_retainOnResetBytes = kRetainAllOnReset;
+
+        #if MEMORY_TRACKING_ENABLED
+        AllocatorStats m_trackingStats;
+        #endif
+
+        static const size_t kRetainAllOnReset = SIZE_MAX;
+        static const size_t kVirtualCommitGranularity = KiB(64);
+
+        private:
+        void CommitUpTo(size_t requiredBytes);
     };
 
     template<typename T>
@@ -55,9 +129,149 @@ namespace SM
         return Alloc<T>(1);
     }
 
-    void InitBuiltInAllocators();
+    // Fixed size block allocator for objects with dynamic lifetimes. Blocks are carved in chunks out of a parent LinearAllocator
+    // and freed blocks are recycled through an intrusive free list stored inside the blocks themselves, alloc / free are O(1).
+    class PoolAllocator
+    {
+        public:
+        void Init(LinearAllocator* pParentAllocator, size_t blockSize, U32 blocksPerChunk = 64, U32 alignment = kAlign64);
+        template<typename T>
+        void Init(LinearAllocator* pParentAllocator, U32 blocksPerChunk = 64);
+
+        void* Alloc();
+        template<typename T>
+        T* Alloc();
+        void Free(void* pBlock);
+        void Reset();
+
+        struct FreeBlock
+        {
+            FreeBlock* m_pNext;
+        };
+
+        LinearAllocator* m_pParentAllocator = nullptr;
+        FreeBlock* m_pFreeList = nullptr;
+        Byte* m_pChunkCursor = nullptr;
+        Byte* m_pChunkEnd = nullptr;
+        size_t m_blockSize = 0;
+        U32 m_alignment = kAlign64;
+        U32 m_blocksPerChunk = 0;
+        U32 m_numAllocatedBlocks = 0;
+    };
+
+    template<typename T>
+    void PoolAllocator::Init(LinearAllocator* pParentAllocator, U32 blocksPerChunk)
+    {
+        U32 alignment = Max<U32>((U32)alignof(T), (U32)kAlign64);
+        Init(pParentAllocator, sizeof(T), blocksPerChunk, alignment);
+    }
+
+    template<typename T>
+    T* PoolAllocator::Alloc()
+    {
+        return (T*)Alloc();
+    }
+
+    // Two Level Segregated Fit general purpose heap for variable sized allocations with unpredictable lifetimes.
+    // Free blocks are binned by a first level power of two and a linear second level subdivision, with a bitmap per level,
+    // so finding a fitting block and merging neighbors on free are both O(1) with no searching.
+    // Every block has a 16 byte header and payloads are always kAlign16 aligned, larger alignments trim a leading free block.
+    class HeapAllocator
+    {
+        public:
+        void Init(void* storage, size_t size);
+        void InitVirtual(size_t reserveSize, size_t initialCommitSize = MiB(1));
+        void InitLargePages(size_t size);
+        void Release();
+
+        void* Alloc(size_t sizeBytes, U32 alignment = kAlign16);
+        template<typename T>
+        T* Alloc(size_t numElements);
+        template<typename T>
+        T* Alloc();
+        void Free(void* ptr);
+        size_t GetAllocationSize(void* ptr) const;
+
+        struct Stats
+        {
+            size_t m_committedBytes = 0;
+            size_t m_usedBytes = 0;
+            size_t m_freeBytes = 0;
+            size_t m_largestFreeBlock = 0;
+            U32 m_numUsedBlocks = 0;
+            U32 m_numFreeBlocks = 0;
+
+            // 0 when all free memory is one contiguous block, approaches 1 as free memory gets split into small pieces
+            F32 CalcFragmentation() const { return m_freeBytes > 0 ? 1.0f - ((F32)m_largestFreeBlock / (F32)m_freeBytes) : 0.0f; }
+        };
+        Stats GetStats() const;
+
+        struct BlockHeader
+        {
+            BlockHeader* m_pPrevPhysical;
+            size_t m_sizeAndFlags;
+        };
+
+        static const U32 kSecondLevelCountLog2 = 4;
+        static const U32 kSecondLevelCount = 1 << kSecondLevelCountLog2;
+        static const U32 kFirstLevelShift = kSecondLevelCountLog2 + 4;
+        static const U32 kFirstLevelMax = 38;
+        static const U32 kFirstLevelCount = kFirstLevelMax - kFirstLevelShift + 1;
+        static const size_t kSmallBlockSize = 1 << kFirstLevelShift;
+        static const size_t kMinBlockSize = 16;
+        static const size_t kVirtualGrowGranularity = MiB(1);
+
+        private:
+        BlockHeader* FindFreeBlock(size_t size);
+        void InsertFreeBlock(BlockHeader* pBlock);
+        void RemoveFreeBlock(BlockHeader* pBlock);
+        BlockHeader* SplitBlock(BlockHeader* pBlock, size_t size);
+        BlockHeader* MergeFreeNeighbors(BlockHeader* pBlock);
+        void InitRegion(size_t size);
+        bool Grow(size_t minBytes);
+
+        BlockHeader* m_freeBlocks[kFirstLevelCount][kSecondLevelCount] = {};
+        U32 m_secondLevelBitmaps[kFirstLevelCount] = {};
+        U32 m_firstLevelBitmap = 0;
+
+        Byte* m_pMemory = nullptr;
+        size_t m_size = 0;
+        size_t m_committedBytes = 0;
+        size_t m_usedBytes = 0;
+        U32 m_numUsedBlocks = 0;
+        bool m_bIsVirtual = false;
+        BlockHeader* m_pSentinel = nullptr;
+
+        public:
+        #if MEMORY_TRACKING_ENABLED
+        AllocatorStats m_trackingStats;
+        #endif
+    };
+
+    template<typename T>
+    T* HeapAllocator::Alloc(size_t numElements)
+    {
+        U32 alignment = Max<U32>((U32)alignof(T), (U32)kAlign16);
+        return (T*)Alloc(sizeof(T) * numElements, alignment);
+    }
+
+    template<typename T>
+    T* HeapAllocator::Alloc()
+    {
+        return Alloc<T>(1);
+    }
+
+    // Built in allocators are shared by every thread and are not thread safe, only allocate from them on the main thread
+    void InitBuiltInAllocators(bool bUseLargePages = false);
     LinearAllocator* GetBuiltInAllocator(BuiltInMemoryAllocator builtInArena);
+    void BindBuiltInAllocator(BuiltInMemoryAllocator builtInArena, LinearAllocator* allocator);
+    HeapAllocator* GetBuiltInHeap();
+    const char* GetBuiltInAllocatorName(BuiltInMemoryAllocator builtInArena);
+
+    // Every thread owns a scratch arena, prefer ScopedScratchAllocator over using it directly so it gets rewound
+    LinearAllocator* GetThreadScratchAllocator();
 
+    // The allocator stack is per thread, worker threads must push their own allocator before calling SM::Alloc
     void PushAllocator(LinearAllocator* allocator);
     void PushAllocator(BuiltInMemoryAllocator builtInAllocator);
     void PopAllocator();
@@ -82,6 +296,26 @@ namespace SM
         }
     };
 
+    class ScopedScratchAllocator
+    {
+    public:
+        ScopedScratchAllocator()
+            :m_pScratch(GetThreadScratchAllocator())
+            ,m_restoreAllocatedBytes(m_pScratch->m_allocatedBytes)
+        {
+            PushAllocator(m_pScratch);
+        }
+
+        ~ScopedScratchAllocator()
+        {
+            PopAllocator();
+            m_pScratch->m_allocatedBytes = m_restoreAllocatedBytes;
+        }
+
+        LinearAllocator* m_pScratch = nullptr;
+        size_t m_restoreAllocatedBytes = 0;
+    };
+
     #define PushScopedStackAllocator(stackMemorySize) \
         LinearAllocator stackLinearAllocator; \
         void* stackMemory = Platform::StackAllocate(stackMemorySize); \
@@ -21,6 +21,20 @@ namespace SM
         void Update(Window* pWindow);
         void* StackAllocate(size_t bytes);
 
+        //------------------------------------------------------------------------------------------------------------------------
+        // Virtual Memory
+        //------------------------------------------------------------------------------------------------------------------------
+        void* ReserveMemory(size_t bytes);
+        bool CommitMemory(void* address, size_t bytes);
+        void DecommitMemory(void* address, size_t bytes);
+        void ReleaseMemory(void* address, size_t bytes);
+
+        // Large pages are reserved and committed in one go and can't be decommitted, bytes must be a multiple of the large page size.
+        // GetLargePageSize returns 0 and AllocateLargePages returns nullptr when the OS or user privileges don't allow them.
+        // The OS support and privileges are only probed on the first call, so nothing is adjusted or logged unless large pages are used.
+        size_t GetLargePageSize();
+        void* AllocateLargePages(size_t bytes);
+
         //------------------------------------------------------------------------------------------------------------------------
         // Logging
         //------------------------------------------------------------------------------------------------------------------------
@@ -68,6 +82,11 @@ namespace SM
         F32 GetMillisecondsSinceAppStart();
         F32 GetSecondsSinceAppStart();
 
+        // Raw high resolution counter and its ticks per second. Unlike the F32 seconds above it keeps full precision no
+        // matter how long the machine has been up, use it for anything that needs steady millisecond or finer steps.
+        U64 GetPerformanceCounter();
+        U64 GetPerformanceFrequency();
+
         //------------------------------------------------------------------------------------------------------------------------
         // Threads
         //------------------------------------------------------------------------------------------------------------------------
@@ -161,6 +161,29 @@ static void ReportLastWindowsError()
 }
 
 
+static bool EnableLockMemoryPrivilege()
+{
+    // large page allocations require the user to have the "Lock pages in memory" right and for it to be enabled on the process
+    HANDLE token;
+    if(!::OpenProcessToken(::GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+    {
+        ReportLastWindowsError();
+        return false;
+    }
+
+    TOKEN_PRIVILEGES privileges = {};
+    privileges.PrivilegeCount = 1;
+    privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+
+    // AdjustTokenPrivileges succeeds with ERROR_NOT_ALL_ASSIGNED when the user doesn't hold the right
+    bool bEnabled = ::LookupPrivilegeValueA(NULL, "SeLockMemoryPrivilege", &privileges.Privileges[0].Luid) &&
+                    ::AdjustTokenPrivileges(token, FALSE, &privileges, 0, NULL, NULL) &&
+                    ::GetLastError() == ERROR_SUCCESS;
+
+    ::CloseHandle(token);
+    return bEnabled;
+}
+
 void Platform::Init()
 {
     // timing
@@ -550,6 +573,81 @@ void* Platform::StackAllocate(size_t bytes)
     return _alloca(bytes);    
 }
 
+void* Platform::ReserveMemory(size_t bytes)
+{
+    void* address = ::VirtualAlloc(NULL, bytes, MEM_RESERVE, PAGE_NOACCESS);
+    if(address == NULL)
+    {
+        ReportLastWindowsError();
+    }
+    return address;
+}
+
+bool Platform::CommitMemory(void* address, size_t bytes)
+{
+    void* committed = ::VirtualAlloc(address, bytes, MEM_COMMIT, PAGE_READWRITE);
+    if(committed == NULL)
+    {
+        ReportLastWindowsError();
+        return false;
+    }
+    return true;
+}
+
+void Platform::DecommitMemory(void* address, size_t bytes)
+{
+    BOOL success = ::VirtualFree(address, bytes, MEM_DECOMMIT);
+    if(!success)
+    {
+        ReportLastWindowsError();
+    }
+}
+
+void Platform::ReleaseMemory(void* address, size_t bytes)
+{
+    UNUSED(bytes);
+
+    // MEM_RELEASE requires a size of 0 and frees the entire reservation
+    BOOL success = ::VirtualFree(address, 0, MEM_RELEASE);
+    if(!success)
+    {
+        ReportLastWindowsError();
+    }
+}
+
+static size_t ProbeLargePageSize()
+{
+    if(!EnableLockMemoryPrivilege())
+    {
+        Platform::Log("[memory] Large pages unavailable, grant \"Lock pages in memory\" to enable them\n");
+        return 0;
+    }
+
+    return ::GetLargePageMinimum();
+}
+
+size_t Platform::GetLargePageSize()
+{
+    // probed the first time large pages are asked for so processes that never use them leave their token alone
+    static const size_t s_largePageSize = ProbeLargePageSize();
+    return s_largePageSize;
+}
+
+void* Platform::AllocateLargePages(size_t bytes)
+{
+    size_t largePageSize = GetLargePageSize();
+    if(largePageSize == 0)
+        return nullptr;
+
+    SM_ASSERT(bytes % largePageSize == 0);
+    void* address = ::VirtualAlloc(NULL, bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+    if(address == NULL)
+    {
+        ReportLastWindowsError();
+    }
+    return address;
+}
+
 void Platform::GetScreenDimensions(U32& screenWidth, U32& screenHeight)
 {
     screenWidth = GetSystemMetrics(SM_CXVIRTUALSCREEN);
@@ -794,6 +892,20 @@ F32 Platform::GetSecondsSinceAppStart()
     return secondsElapsed;
 }
 
+U64 Platform::GetPerformanceCounter()
+{
+    LARGE_INTEGER perfCounter;
+    BOOL res = ::QueryPerformanceCounter(&perfCounter);
+    SM_ASSERT(res);
+    return (U64)perfCounter.QuadPart;
+}
+
+U64 Platform::GetPerformanceFrequency()
+{
+    SM_ASSERT(s_timingFreqPerSec != 0);
+    return (U64)s_timingFreqPerSec;
+}
+
 void Platform::YieldThread()
 {
 	::SwitchToThread();
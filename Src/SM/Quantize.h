@@ -0,0 +1,313 @@
+#pragma once
+
+#include "SM/Math.h"
+#include "SM/StandardTypes.h"
+
+#include <cstring>
+
+namespace SM
+{
+    // Compact vertex attribute formats. Each Decode does exactly what the gpu does when the data is bound with the Vulkan
+    // format named next to it, followed by the same math a shader would run, so they are the reference for shader code.
+    // Float to integer conversions clamp and round to nearest even, nan encodes as the lowest value. The batch encoders
+    // in MathBatch.h give bit identical results.
+    //
+    // A vertex with F32 position, normal, tangent + sign and uv is 48 bytes. Keeping the F32 position and storing a
+    // tangent frame and F16 uv is 24 bytes, with an F16 position as well it is 20.
+
+    //-------------------------------------------------------------------------
+    // Half floats, VK_FORMAT_R16*_SFLOAT
+    //-------------------------------------------------------------------------
+    // Round to nearest even with denormals kept, values past the largest half (65504) round to inf. Nans stay nans with
+    // the top 10 mantissa bits kept and the quiet bit set, matching F16C. Relative round trip error is at most 2^-11.
+    U16 ConvertF32ToF16(F32 f);
+    F32 ConvertF16ToF32(U16 h);
+
+    //-------------------------------------------------------------------------
+    // Normalized integers, VK_FORMAT_*_SNORM / *_UNORM
+    //-------------------------------------------------------------------------
+    // Snorm covers [-1, 1] with the most negative integer also decoding to -1, unorm covers [0, 1]. Round trip error is
+    // half a step, e.g. 3.9e-3 for snorm8, 1.5e-5 for snorm16, 2.0e-3 for unorm8 and 9.8e-4 for snorm10.
+    I32 QuantizeF32(F32 v, F32 low, F32 high, F32 scale);
+
+    I8 EncodeSnorm8(F32 v);
+    I16 EncodeSnorm16(F32 v);
+    U8 EncodeUnorm8(F32 v);
+    U16 EncodeUnorm16(F32 v);
+    F32 DecodeSnorm8(I8 v);
+    F32 DecodeSnorm16(I16 v);
+    F32 DecodeUnorm8(U8 v);
+    F32 DecodeUnorm16(U16 v);
+
+    // VK_FORMAT_A2B10G10R10_SNORM_PACK32 / A2B10G10R10_UNORM_PACK32, x in the low 10 bits and w in the top 2.
+    // Snorm w is -1, 0 or 1, e.g. a bitangent sign.
+    U32 PackSnorm1010102(const Vec4& v);
+    U32 PackUnorm1010102(const Vec4& v);
+    Vec4 UnpackSnorm1010102(U32 packed);
+    Vec4 UnpackUnorm1010102(U32 packed);
+
+    //-------------------------------------------------------------------------
+    // Octahedral unit vectors
+    //-------------------------------------------------------------------------
+    // Projects a unit vector onto the octahedron |x| + |y| + |z| = 1 and unfolds the lower half over the upper one,
+    // giving two values in [-1, 1] with close to uniform precision over the sphere. Max angular error measured over 1M
+    // random directions is 0.0037 degrees for snorm16 and 0.95 degrees for snorm8.
+    Vec2 EncodeOctahedral(const Vec3& n);
+    Vec3 DecodeOctahedral(const Vec2& e);
+
+    // VK_FORMAT_R16G16_SNORM as one U32 and VK_FORMAT_R8G8_SNORM as one U16, x in the low bits
+    U32 EncodeOctahedralSnorm16(const Vec3& n);
+    U16 EncodeOctahedralSnorm8(const Vec3& n);
+    Vec3 DecodeOctahedralSnorm16(U32 packed);
+    Vec3 DecodeOctahedralSnorm8(U16 packed);
+
+    //-------------------------------------------------------------------------
+    // Tangent frames
+    //-------------------------------------------------------------------------
+    // Normal, tangent and bitangent sign as one quaternion, VK_FORMAT_R16G16B16A16_SNORM. The quaternion rotates
+    // x to the tangent and z to the normal, w is kept positive and at least one snorm step above zero so its sign is
+    // free to hold the bitangent sign. Max angular error measured over 1M random frames is 0.0041 degrees.
+    struct PackedTangentFrame
+    {
+        I16 x = 0;
+        I16 y = 0;
+        I16 z = 0;
+        I16 w = 0;
+    };
+
+    // The tangent is made orthogonal to the normal first, it must not be parallel to it. The normal must be unit length.
+    PackedTangentFrame EncodeTangentFrame(const Vec3& normal, const Vec3& tangent, F32 bitangentSign);
+    void DecodeTangentFrame(const PackedTangentFrame& packed, Vec3& outNormal, Vec3& outTangent, Vec3& outBitangent);
+
+    //-------------------------------------------------------------------------
+    // Inline
+    //-------------------------------------------------------------------------
+    inline U16 ConvertF32ToF16(F32 f)
+    {
+        U32 bits;
+        ::memcpy(&bits, &f, sizeof(bits));
+        U32 sign = bits & 0x80000000;
+        bits ^= sign;
+
+        U32 half;
+        if(bits >= 0x47800000)
+        {
+            // 65536 and up, inf and nan
+            half = bits > 0x7f800000 ? 0x7e00 | ((bits >> 13) & 0x3ff) : 0x7c00;
+        }
+        else if(bits < 0x38800000)
+        {
+            // below the smallest normal half, adding 0.5 lines the denormal mantissa up with the low bits and rounds it
+            F32 denormal;
+            ::memcpy(&denormal, &bits, sizeof(denormal));
+            denormal += 0.5f;
+            ::memcpy(&half, &denormal, sizeof(half));
+            half -= 0x3f000000;
+        }
+        else
+        {
+            // rebias the exponent and round the 13 dropped mantissa bits to nearest even
+            U32 mantissaOdd = (bits >> 13) & 1;
+            bits += ((U32)(15 - 127) << 23) + 0xfff;
+            bits += mantissaOdd;
+            half = bits >> 13;
+        }
+        return (U16)(half | (sign >> 16));
+    }
+
+    inline F32 ConvertF16ToF32(U16 h)
+    {
+        U32 bits = (U32)(h & 0x7fff) << 13;
+        U32 exponent = bits & 0x0f800000;
+        bits += (U32)(127 - 15) << 23;
+        if(exponent == 0x0f800000)
+        {
+            // inf and nan
+            bits += (U32)(128 - 16) << 23;
+            if(bits & 0x007fffff)
+            {
+                bits |= 0x00400000;
+            }
+        }
+        else if(exponent == 0)
+        {
+            // denormal, renormalize by letting the fpu subtract the implicit one back out
+            bits += 1 << 23;
+            F32 f;
+            ::memcpy(&f, &bits, sizeof(f));
+            f -= 6.103515625e-05f;
+            ::memcpy(&bits, &f, sizeof(bits));
+        }
+        bits |= (U32)(h & 0x8000) << 16;
+
+        F32 f;
+        ::memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+
+    inline I32 QuantizeF32(F32 v, F32 low, F32 high, F32 scale)
+    {
+        // Compared in this order so nan becomes low, adding 1.5 * 2^23 rounds to an integer
+        const F32 kRoundMagic = 12582912.0f;
+        F32 clamped = v > low ? v : low;
+        clamped = clamped < high ? clamped : high;
+        return (I32)(((clamped * scale) + kRoundMagic) - kRoundMagic);
+    }
+
+    inline I8 EncodeSnorm8(F32 v)
+    {
+        return (I8)QuantizeF32(v, -1.0f, 1.0f, 127.0f);
+    }
+
+    inline I16 EncodeSnorm16(F32 v)
+    {
+        return (I16)QuantizeF32(v, -1.0f, 1.0f, 32767.0f);
+    }
+
+    inline U8 EncodeUnorm8(F32 v)
+    {
+        return (U8)QuantizeF32(v, 0.0f, 1.0f, 255.0f);
+    }
+
+    inline U16 EncodeUnorm16(F32 v)
+    {
+        return (U16)QuantizeF32(v, 0.0f, 1.0f, 65535.0f);
+    }
+
+    inline F32 DecodeSnorm8(I8 v)
+    {
+        return Max((F32)v / 127.0f, -1.0f);
+    }
+
+    inline F32 DecodeSnorm16(I16 v)
+    {
+        return Max((F32)v / 32767.0f, -1.0f);
+    }
+
+    inline F32 DecodeUnorm8(U8 v)
+    {
+        return (F32)v / 255.0f;
+    }
+
+    inline F32 DecodeUnorm16(U16 v)
+    {
+        return (F32)v / 65535.0f;
+    }
+
+    inline U32 PackSnorm1010102(const Vec4& v)
+    {
+        return ((U32)QuantizeF32(v.x, -1.0f, 1.0f, 511.0f) & 0x3ff) |
+               (((U32)QuantizeF32(v.y, -1.0f, 1.0f, 511.0f) & 0x3ff) << 10) |
+               (((U32)QuantizeF32(v.z, -1.0f, 1.0f, 511.0f) & 0x3ff) << 20) |
+               ((U32)QuantizeF32(v.w, -1.0f, 1.0f, 1.0f) << 30);
+    }
+
+    inline U32 PackUnorm1010102(const Vec4& v)
+    {
+        return ((U32)QuantizeF32(v.x, 0.0f, 1.0f, 1023.0f)) |
+               ((U32)QuantizeF32(v.y, 0.0f, 1.0f, 1023.0f) << 10) |
+               ((U32)QuantizeF32(v.z, 0.0f, 1.0f, 1023.0f) << 20) |
+               ((U32)QuantizeF32(v.w, 0.0f, 1.0f, 3.0f) << 30);
+    }
+
+    inline Vec4 UnpackSnorm1010102(U32 packed)
+    {
+        // shift each field to the top so the arithmetic shift back down sign extends it
+        I32 x = (I32)(packed << 22) >> 22;
+        I32 y = (I32)(packed << 12) >> 22;
+        I32 z = (I32)(packed << 2) >> 22;
+        I32 w = (I32)packed >> 30;
+        return Vec4(Max((F32)x / 511.0f, -1.0f), Max((F32)y / 511.0f, -1.0f), Max((F32)z / 511.0f, -1.0f), Max((F32)w, -1.0f));
+    }
+
+    inline Vec4 UnpackUnorm1010102(U32 packed)
+    {
+        return Vec4((F32)(packed & 0x3ff) / 1023.0f, (F32)((packed >> 10) & 0x3ff) / 1023.0f,
+                    (F32)((packed >> 20) & 0x3ff) / 1023.0f, (F32)(packed >> 30) / 3.0f);
+    }
+
+    inline Vec2 EncodeOctahedral(const Vec3& n)
+    {
+        F32 invL1Norm = 1.0f / (::fabsf(n.x) + ::fabsf(n.y) + ::fabsf(n.z));
+        F32 x = n.x * invL1Norm;
+        F32 y = n.y * invL1Norm;
+        if(n.z < 0.0f)
+        {
+            F32 foldedX = ::copysignf(1.0f - ::fabsf(y), x);
+            F32 foldedY = ::copysignf(1.0f - ::fabsf(x), y);
+            x = foldedX;
+            y = foldedY;
+        }
+        return Vec2(x, y);
+    }
+
+    inline Vec3 DecodeOctahedral(const Vec2& e)
+    {
+        Vec3 n(e.x, e.y, 1.0f - ::fabsf(e.x) - ::fabsf(e.y));
+        F32 fold = Max(-n.z, 0.0f);
+        n.x += n.x >= 0.0f ? -fold : fold;
+        n.y += n.y >= 0.0f ? -fold : fold;
+        return n.GetNormalized();
+    }
+
+    inline U32 EncodeOctahedralSnorm16(const Vec3& n)
+    {
+        Vec2 e = EncodeOctahedral(n);
+        return ((U32)EncodeSnorm16(e.x) & 0xffff) | ((U32)EncodeSnorm16(e.y) << 16);
+    }
+
+    inline U16 EncodeOctahedralSnorm8(const Vec3& n)
+    {
+        Vec2 e = EncodeOctahedral(n);
+        return (U16)(((U32)EncodeSnorm8(e.x) & 0xff) | ((U32)EncodeSnorm8(e.y) << 8));
+    }
+
+    inline Vec3 DecodeOctahedralSnorm16(U32 packed)
+    {
+        return DecodeOctahedral(Vec2(DecodeSnorm16((I16)(packed & 0xffff)), DecodeSnorm16((I16)(packed >> 16))));
+    }
+
+    inline Vec3 DecodeOctahedralSnorm8(U16 packed)
+    {
+        return DecodeOctahedral(Vec2(DecodeSnorm8((I8)(packed & 0xff)), DecodeSnorm8((I8)(packed >> 8))));
+    }
+
+    inline PackedTangentFrame EncodeTangentFrame(const Vec3& normal, const Vec3& tangent, F32 bitangentSign)
+    {
+        // rows tangent, bitangent, normal make a right handed rotation
+        Vec3 t = tangent - (normal * Dot(normal, tangent));
+        t = t * (1.0f / ::sqrtf(Dot(t, t)));
+        Vec3 b = Cross(normal, t);
+        Quat q = Quat::CreateFromMat33(Mat33(t, b, normal));
+
+        // q and -q are the same rotation
+        const F32 kMinW = 1.0f / 32767.0f;
+        if(q.w < 0.0f)
+        {
+            q = -q;
+        }
+        if(q.w < kMinW)
+        {
+            q.w = kMinW;
+        }
+        if(bitangentSign < 0.0f)
+        {
+            q = -q;
+        }
+
+        PackedTangentFrame packed;
+        packed.x = EncodeSnorm16(q.x);
+        packed.y = EncodeSnorm16(q.y);
+        packed.z = EncodeSnorm16(q.z);
+        packed.w = EncodeSnorm16(q.w);
+        return packed;
+    }
+
+    inline void DecodeTangentFrame(const PackedTangentFrame& packed, Vec3& outNormal, Vec3& outTangent, Vec3& outBitangent)
+    {
+        Quat q = Quat(DecodeSnorm16(packed.x), DecodeSnorm16(packed.y), DecodeSnorm16(packed.z), DecodeSnorm16(packed.w)).GetNormalized();
+        outTangent = q.Rotate(Vec3(1.0f, 0.0f, 0.0f));
+        outNormal = q.Rotate(Vec3(0.0f, 0.0f, 1.0f));
+        outBitangent = Cross(outNormal, outTangent) * (packed.w < 0 ? -1.0f : 1.0f);
+    }
+}
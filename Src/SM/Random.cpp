@@ -0,0 +1,500 @@
+#include "SM/Random.h"
+#include "SM/Assert.h"
+#include "SM/Simd.h"
+
+#include <atomic>
+#include <cstring>
+#include <ctime>
+
+using namespace SM;
+
+// The wide fill kernels only run inlined into their target entry points, same as in MathBatch.cpp
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+// Precomputed by the xoshiro256** authors, equivalent to 2^128 and 2^192 calls to NextU64
+static const U64 kRngJump[4] = { 0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c };
+static const U64 kRngLongJump[4] = { 0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635 };
+
+static std::atomic<U64> s_rngSeed = 0;
+static std::atomic<U32> s_numRngStreams = 0;
+static thread_local Rng s_threadRng;
+static thread_local bool s_bThreadRngSeeded = false;
+
+static U64 SplitMix64(U64& state)
+{
+    U64 z = (state += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+static void RngApplyJump(Rng& rng, const U64 (&jump)[4])
+{
+    U64 s0 = 0;
+    U64 s1 = 0;
+    U64 s2 = 0;
+    U64 s3 = 0;
+    for(U32 word = 0; word < 4; word++)
+    {
+        for(U32 bit = 0; bit < 64; bit++)
+        {
+            if(jump[word] & ((U64)1 << bit))
+            {
+                s0 ^= rng.m_state[0];
+                s1 ^= rng.m_state[1];
+                s2 ^= rng.m_state[2];
+                s3 ^= rng.m_state[3];
+            }
+            rng.NextU64();
+        }
+    }
+    rng.m_state[0] = s0;
+    rng.m_state[1] = s1;
+    rng.m_state[2] = s2;
+    rng.m_state[3] = s3;
+}
+
+//-------------------------------------------------------------------------
+// Lanes
+//-------------------------------------------------------------------------
+// The 8 WideRng lanes split over however many 64 bit registers a width needs. The xoshiro256** multiplies by 5 and 9
+// are done as shifts and adds since there is no 64 bit multiply below AVX-512DQ, they wrap the same as the multiply.
+// StoreLow32 writes the low 32 bits of all 8 lanes in order, StoreUnitF32 converts 24 bit integers the same way and
+// clamps the results to maxValue.
+struct RngScalarLanes
+{
+    typedef U64 Reg;
+    static const U32 kNumRegs = 8;
+    static Reg Load(const U64* p) { return *p; }
+    static void Store(U64* p, Reg v) { *p = v; }
+    static Reg Splat(U64 s) { return s; }
+    static Reg Add(Reg a, Reg b) { return a + b; }
+    static Reg Xor(Reg a, Reg b) { return a ^ b; }
+    template<U32 k> static Reg ShiftLeft(Reg v) { return v << k; }
+    template<U32 k> static Reg ShiftRight(Reg v) { return v >> k; }
+    template<U32 k> static Reg RotateLeft(Reg v) { return RngRotateLeft(v, k); }
+    static Reg MulLow32(Reg a, Reg b) { return (a & 0xffffffff) * (b & 0xffffffff); }
+
+    static void StoreLow32(U32* p, const Reg* regs)
+    {
+        for(U32 i = 0; i < kNumRegs; i++)
+        {
+            p[i] = (U32)regs[i];
+        }
+    }
+
+    static void StoreUnitF32(F32* p, const Reg* regs, F32 low, F32 range, F32 maxValue)
+    {
+        for(U32 i = 0; i < kNumRegs; i++)
+        {
+            F32 value = low + ((F32)(U32)regs[i] * (1.0f / 16777216.0f)) * range;
+            p[i] = value < maxValue ? value : maxValue;
+        }
+    }
+};
+
+#if SM_SIMD_SSE2
+struct RngU64x2Lanes
+{
+    typedef __m128i Reg;
+    static const U32 kNumRegs = 4;
+    static Reg Load(const U64* p) { return _mm_loadu_si128((const __m128i*)p); }
+    static void Store(U64* p, Reg v) { _mm_storeu_si128((__m128i*)p, v); }
+    static Reg Splat(U64 s) { return _mm_set1_epi64x((I64)s); }
+    static Reg Add(Reg a, Reg b) { return _mm_add_epi64(a, b); }
+    static Reg Xor(Reg a, Reg b) { return _mm_xor_si128(a, b); }
+    template<U32 k> static Reg ShiftLeft(Reg v) { return _mm_slli_epi64(v, k); }
+    template<U32 k> static Reg ShiftRight(Reg v) { return _mm_srli_epi64(v, k); }
+    template<U32 k> static Reg RotateLeft(Reg v) { return _mm_or_si128(_mm_slli_epi64(v, k), _mm_srli_epi64(v, 64 - k)); }
+    static Reg MulLow32(Reg a, Reg b) { return _mm_mul_epu32(a, b); }
+
+    static __m128i PackLow32(Reg a, Reg b)
+    {
+        return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(2, 0, 2, 0)));
+    }
+
+    static void StoreLow32(U32* p, const Reg* regs)
+    {
+        _mm_storeu_si128((__m128i*)p, PackLow32(regs[0], regs[1]));
+        _mm_storeu_si128((__m128i*)(p + 4), PackLow32(regs[2], regs[3]));
+    }
+
+    static void StoreUnitF32(F32* p, const Reg* regs, F32 low, F32 range, F32 maxValue)
+    {
+        for(U32 i = 0; i < 2; i++)
+        {
+            __m128 unit = _mm_mul_ps(_mm_cvtepi32_ps(PackLow32(regs[i * 2], regs[i * 2 + 1])), _mm_set1_ps(1.0f / 16777216.0f));
+            __m128 value = _mm_add_ps(_mm_set1_ps(low), _mm_mul_ps(unit, _mm_set1_ps(range)));
+            _mm_storeu_ps(p + i * 4, _mm_min_ps(value, _mm_set1_ps(maxValue)));
+        }
+    }
+};
+#elif SM_SIMD_NEON
+struct RngU64x2Lanes
+{
+    typedef uint64x2_t Reg;
+    static const U32 kNumRegs = 4;
+    static Reg Load(const U64* p) { return vld1q_u64(p); }
+    static void Store(U64* p, Reg v) { vst1q_u64(p, v); }
+    static Reg Splat(U64 s) { return vdupq_n_u64(s); }
+    static Reg Add(Reg a, Reg b) { return vaddq_u64(a, b); }
+    static Reg Xor(Reg a, Reg b) { return veorq_u64(a, b); }
+    template<U32 k> static Reg ShiftLeft(Reg v) { return vshlq_n_u64(v, k); }
+    template<U32 k> static Reg ShiftRight(Reg v) { return vshrq_n_u64(v, k); }
+    template<U32 k> static Reg RotateLeft(Reg v) { return vsriq_n_u64(vshlq_n_u64(v, k), v, 64 - k); }
+    static Reg MulLow32(Reg a, Reg b) { return vmull_u32(vmovn_u64(a), vmovn_u64(b)); }
+
+    static uint32x4_t PackLow32(Reg a, Reg b)
+    {
+        return vcombine_u32(vmovn_u64(a), vmovn_u64(b));
+    }
+
+    static void StoreLow32(U32* p, const Reg* regs)
+    {
+        vst1q_u32(p, PackLow32(regs[0], regs[1]));
+        vst1q_u32(p + 4, PackLow32(regs[2], regs[3]));
+    }
+
+    static void StoreUnitF32(F32* p, const Reg* regs, F32 low, F32 range, F32 maxValue)
+    {
+        for(U32 i = 0; i < 2; i++)
+        {
+            float32x4_t unit = vmulq_f32(vcvtq_f32_u32(PackLow32(regs[i * 2], regs[i * 2 + 1])), vdupq_n_f32(1.0f / 16777216.0f));
+            float32x4_t value = vaddq_f32(vdupq_n_f32(low), vmulq_f32(unit, vdupq_n_f32(range)));
+            vst1q_f32(p + i * 4, vminq_f32(value, vdupq_n_f32(maxValue)));
+        }
+    }
+};
+#endif
+
+#if SM_SIMD_AVX
+struct RngAvx2Lanes
+{
+    typedef __m256i Reg;
+    static const U32 kNumRegs = 2;
+    SM_SIMD_TARGET_AVX2 static Reg Load(const U64* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    SM_SIMD_TARGET_AVX2 static void Store(U64* p, Reg v) { _mm256_storeu_si256((__m256i*)p, v); }
+    SM_SIMD_TARGET_AVX2 static Reg Splat(U64 s) { return _mm256_set1_epi64x((I64)s); }
+    SM_SIMD_TARGET_AVX2 static Reg Add(Reg a, Reg b) { return _mm256_add_epi64(a, b); }
+    SM_SIMD_TARGET_AVX2 static Reg Xor(Reg a, Reg b) { return _mm256_xor_si256(a, b); }
+    template<U32 k> SM_SIMD_TARGET_AVX2 static Reg ShiftLeft(Reg v) { return _mm256_slli_epi64(v, k); }
+    template<U32 k> SM_SIMD_TARGET_AVX2 static Reg ShiftRight(Reg v) { return _mm256_srli_epi64(v, k); }
+    template<U32 k> SM_SIMD_TARGET_AVX2 static Reg RotateLeft(Reg v) { return _mm256_or_si256(_mm256_slli_epi64(v, k), _mm256_srli_epi64(v, 64 - k)); }
+    SM_SIMD_TARGET_AVX2 static Reg MulLow32(Reg a, Reg b) { return _mm256_mul_epu32(a, b); }
+
+    // the shuffle packs within 128 bit halves, the permute puts the two halves of each register back in order
+    SM_SIMD_TARGET_AVX2 static __m256i PackLow32(const Reg* regs)
+    {
+        __m256 packed = _mm256_shuffle_ps(_mm256_castsi256_ps(regs[0]), _mm256_castsi256_ps(regs[1]), _MM_SHUFFLE(2, 0, 2, 0));
+        return _mm256_permute4x64_epi64(_mm256_castps_si256(packed), _MM_SHUFFLE(3, 1, 2, 0));
+    }
+
+    SM_SIMD_TARGET_AVX2 static void StoreLow32(U32* p, const Reg* regs)
+    {
+        _mm256_storeu_si256((__m256i*)p, PackLow32(regs));
+    }
+
+    SM_SIMD_TARGET_AVX2 static void StoreUnitF32(F32* p, const Reg* regs, F32 low, F32 range, F32 maxValue)
+    {
+        __m256 unit = _mm256_mul_ps(_mm256_cvtepi32_ps(PackLow32(regs)), _mm256_set1_ps(1.0f / 16777216.0f));
+        __m256 value = _mm256_add_ps(_mm256_set1_ps(low), _mm256_mul_ps(unit, _mm256_set1_ps(range)));
+        _mm256_storeu_ps(p, _mm256_min_ps(value, _mm256_set1_ps(maxValue)));
+    }
+};
+
+struct RngAvx512Lanes
+{
+    typedef __m512i Reg;
+    static const U32 kNumRegs = 1;
+    SM_SIMD_TARGET_AVX512 static Reg Load(const U64* p) { return _mm512_loadu_si512(p); }
+    SM_SIMD_TARGET_AVX512 static void Store(U64* p, Reg v) { _mm512_storeu_si512(p, v); }
+    SM_SIMD_TARGET_AVX512 static Reg Splat(U64 s) { return _mm512_set1_epi64((I64)s); }
+    SM_SIMD_TARGET_AVX512 static Reg Add(Reg a, Reg b) { return _mm512_add_epi64(a, b); }
+    SM_SIMD_TARGET_AVX512 static Reg Xor(Reg a, Reg b) { return _mm512_xor_si512(a, b); }
+    template<U32 k> SM_SIMD_TARGET_AVX512 static Reg ShiftLeft(Reg v) { return _mm512_slli_epi64(v, k); }
+    template<U32 k> SM_SIMD_TARGET_AVX512 static Reg ShiftRight(Reg v) { return _mm512_srli_epi64(v, k); }
+    template<U32 k> SM_SIMD_TARGET_AVX512 static Reg RotateLeft(Reg v) { return _mm512_rol_epi64(v, k); }
+    SM_SIMD_TARGET_AVX512 static Reg MulLow32(Reg a, Reg b) { return _mm512_mul_epu32(a, b); }
+
+    SM_SIMD_TARGET_AVX512 static void StoreLow32(U32* p, const Reg* regs)
+    {
+        _mm256_storeu_si256((__m256i*)p, _mm512_cvtepi64_epi32(regs[0]));
+    }
+
+    SM_SIMD_TARGET_AVX512 static void StoreUnitF32(F32* p, const Reg* regs, F32 low, F32 range, F32 maxValue)
+    {
+        __m256 unit = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm512_cvtepi64_epi32(regs[0])), _mm256_set1_ps(1.0f / 16777216.0f));
+        __m256 value = _mm256_add_ps(_mm256_set1_ps(low), _mm256_mul_ps(unit, _mm256_set1_ps(range)));
+        _mm256_storeu_ps(p, _mm256_min_ps(value, _mm256_set1_ps(maxValue)));
+    }
+};
+#endif
+
+//-------------------------------------------------------------------------
+// Fill kernels
+//-------------------------------------------------------------------------
+enum RngFillType
+{
+    kRngFillU32,
+    kRngFillI32,
+    kRngFillF32
+};
+
+struct RngFillArgs
+{
+    void* m_pOut;
+    size_t m_count;
+    U32 m_intLow;
+    U32 m_intRange;
+    F32 m_low;
+    F32 m_range;
+    F32 m_max;
+};
+
+template<typename L, RngFillType kType>
+SM_SIMD_KERNEL static void RngFill(U64 (&state)[4][WideRng::kNumLanes], const RngFillArgs& args)
+{
+    typedef typename L::Reg Reg;
+    const U32 kLanesPerReg = WideRng::kNumLanes / L::kNumRegs;
+
+    Reg s0[L::kNumRegs];
+    Reg s1[L::kNumRegs];
+    Reg s2[L::kNumRegs];
+    Reg s3[L::kNumRegs];
+    for(U32 r = 0; r < L::kNumRegs; r++)
+    {
+        s0[r] = L::Load(&state[0][r * kLanesPerReg]);
+        s1[r] = L::Load(&state[1][r * kLanesPerReg]);
+        s2[r] = L::Load(&state[2][r * kLanesPerReg]);
+        s3[r] = L::Load(&state[3][r * kLanesPerReg]);
+    }
+
+    const Reg intLow = L::Splat(args.m_intLow);
+    const Reg intRange = L::Splat(args.m_intRange);
+    const size_t count = args.m_count;
+    U32* pOut = (U32*)args.m_pOut;
+    for(size_t i = 0; i < count; i += WideRng::kNumLanes)
+    {
+        Reg results[L::kNumRegs];
+        for(U32 r = 0; r < L::kNumRegs; r++)
+        {
+            Reg x5 = L::Add(s1[r], L::template ShiftLeft<2>(s1[r]));
+            Reg rotated = L::template RotateLeft<7>(x5);
+            results[r] = L::Add(rotated, L::template ShiftLeft<3>(rotated));
+
+            Reg t = L::template ShiftLeft<17>(s1[r]);
+            s2[r] = L::Xor(s2[r], s0[r]);
+            s3[r] = L::Xor(s3[r], s1[r]);
+            s1[r] = L::Xor(s1[r], s2[r]);
+            s0[r] = L::Xor(s0[r], s3[r]);
+            s2[r] = L::Xor(s2[r], t);
+            s3[r] = L::template RotateLeft<45>(s3[r]);
+        }
+
+        // U32, I32 and F32 are all 4 bytes so the partial last group goes through one buffer
+        U32 tail[WideRng::kNumLanes];
+        U32* pDst = (i + WideRng::kNumLanes <= count) ? pOut + i : tail;
+        if constexpr(kType == kRngFillF32)
+        {
+            for(U32 r = 0; r < L::kNumRegs; r++)
+            {
+                results[r] = L::template ShiftRight<40>(results[r]);
+            }
+            L::StoreUnitF32((F32*)pDst, results, args.m_low, args.m_range, args.m_max);
+        }
+        else
+        {
+            for(U32 r = 0; r < L::kNumRegs; r++)
+            {
+                results[r] = L::template ShiftRight<32>(results[r]);
+                if constexpr(kType == kRngFillI32)
+                {
+                    results[r] = L::Add(L::template ShiftRight<32>(L::MulLow32(results[r], intRange)), intLow);
+                }
+            }
+            L::StoreLow32(pDst, results);
+        }
+
+        if(pDst == tail)
+        {
+            ::memcpy(pOut + i, tail, (count - i) * sizeof(U32));
+        }
+    }
+
+    for(U32 r = 0; r < L::kNumRegs; r++)
+    {
+        L::Store(&state[0][r * kLanesPerReg], s0[r]);
+        L::Store(&state[1][r * kLanesPerReg], s1[r]);
+        L::Store(&state[2][r * kLanesPerReg], s2[r]);
+        L::Store(&state[3][r * kLanesPerReg], s3[r]);
+    }
+}
+
+#if SM_SIMD_AVX
+template<RngFillType kType>
+SM_SIMD_ENTRY_AVX2 static void RngFillAvx2(U64 (&state)[4][WideRng::kNumLanes], const RngFillArgs& args)
+{
+    RngFill<RngAvx2Lanes, kType>(state, args);
+}
+
+template<RngFillType kType>
+SM_SIMD_ENTRY_AVX512 static void RngFillAvx512(U64 (&state)[4][WideRng::kNumLanes], const RngFillArgs& args)
+{
+    RngFill<RngAvx512Lanes, kType>(state, args);
+}
+#endif
+
+// Every width gives the same results, so unlike the batch math kernels there is no narrower pass over a remainder
+template<RngFillType kType>
+static void RunRngFill(U64 (&state)[4][WideRng::kNumLanes], const RngFillArgs& args)
+{
+    SimdLevel level = GetSimdLevel();
+
+    #if SM_SIMD_AVX
+    if(level >= kSimdLevelAvx512)
+    {
+        RngFillAvx512<kType>(state, args);
+        return;
+    }
+    if(level >= kSimdLevelAvx2)
+    {
+        RngFillAvx2<kType>(state, args);
+        return;
+    }
+    #endif
+
+    #if SM_SIMD_ENABLED
+    if(level >= kSimdLevelF32x4)
+    {
+        RngFill<RngU64x2Lanes, kType>(state, args);
+        return;
+    }
+    #endif
+
+    RngFill<RngScalarLanes, kType>(state, args);
+}
+
+//-------------------------------------------------------------------------
+// Rng
+//-------------------------------------------------------------------------
+void Rng::Seed(U64 seed)
+{
+    U64 splitMixState = seed;
+    m_state[0] = SplitMix64(splitMixState);
+    m_state[1] = SplitMix64(splitMixState);
+    m_state[2] = SplitMix64(splitMixState);
+    m_state[3] = SplitMix64(splitMixState);
+}
+
+void Rng::Jump()
+{
+    RngApplyJump(*this, kRngJump);
+}
+
+void Rng::LongJump()
+{
+    RngApplyJump(*this, kRngLongJump);
+}
+
+Rng Rng::CreateStream(U64 seed, U32 streamIndex)
+{
+    Rng rng(seed);
+    for(U32 i = 0; i < streamIndex; i++)
+    {
+        rng.LongJump();
+    }
+    return rng;
+}
+
+//-------------------------------------------------------------------------
+// WideRng
+//-------------------------------------------------------------------------
+WideRng::WideRng()
+{
+    Seed(Rng());
+}
+
+WideRng::WideRng(U64 seed)
+{
+    Seed(Rng(seed));
+}
+
+WideRng::WideRng(const Rng& rng)
+{
+    Seed(rng);
+}
+
+void WideRng::Seed(U64 seed)
+{
+    Seed(Rng(seed));
+}
+
+void WideRng::Seed(const Rng& rng)
+{
+    Rng lane = rng;
+    for(U32 i = 0; i < kNumLanes; i++)
+    {
+        if(i > 0)
+        {
+            lane.Jump();
+        }
+        m_state[0][i] = lane.m_state[0];
+        m_state[1][i] = lane.m_state[1];
+        m_state[2][i] = lane.m_state[2];
+        m_state[3][i] = lane.m_state[3];
+    }
+}
+
+void WideRng::FillU32(U32* pOut, size_t count)
+{
+    RngFillArgs args = { pOut, count, 0, 0, 0.0f, 0.0f, 0.0f };
+    RunRngFill<kRngFillU32>(m_state, args);
+}
+
+void WideRng::FillI32(I32* pOut, size_t count, I32 low, I32 high)
+{
+    SM_ASSERT(high > low);
+    RngFillArgs args = { pOut, count, (U32)low, (U32)high - (U32)low, 0.0f, 0.0f, 0.0f };
+    RunRngFill<kRngFillI32>(m_state, args);
+}
+
+void WideRng::FillF32(F32* pOut, size_t count, F32 low, F32 high)
+{
+    SM_ASSERT(high > low);
+    // largest float below high, results that round up to high are clamped to it like Rng::NextF32(low, high)
+    RngFillArgs args = { pOut, count, 0, 0, low, high - low, ::nextafterf(high, low) };
+    RunRngFill<kRngFillF32>(m_state, args);
+}
+
+//-------------------------------------------------------------------------
+// Thread generators
+//-------------------------------------------------------------------------
+void SM::SeedRng()
+{
+    SeedRng((U64)::time(NULL));
+}
+
+void SM::SeedRng(U64 seed)
+{
+    s_rngSeed = seed;
+    s_numRngStreams = 1;
+    s_threadRng = Rng::CreateStream(seed, 0);
+    s_bThreadRngSeeded = true;
+}
+
+Rng& SM::GetThreadRng()
+{
+    if(!s_bThreadRngSeeded)
+    {
+        s_threadRng = Rng::CreateStream(s_rngSeed, s_numRngStreams++);
+        s_bThreadRngSeeded = true;
+    }
+    return s_threadRng;
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
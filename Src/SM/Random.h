@@ -0,0 +1,181 @@
+#pragma once
+
+#include "SM/StandardTypes.h"
+
+#include <cmath>
+
+namespace SM
+{
+    //-------------------------------------------------------------------------
+    // Rng
+    //-------------------------------------------------------------------------
+    // xoshiro256** by Blackman and Vigna, 256 bits of state and a period of 2^256 - 1. Only integer adds, shifts,
+    // rotates and xors so a seed gives the same sequence with every compiler and platform. Not for cryptography.
+    class Rng
+    {
+        public:
+        Rng();
+        explicit Rng(U64 seed);
+
+        // Expands seed into the full state with splitmix64, every seed is valid including 0
+        void Seed(U64 seed);
+
+        U64 NextU64();
+        U32 NextU32();
+
+        // Uniform in [0, range), unbiased. range must be > 0.
+        U32 NextU32(U32 range);
+
+        // Uniform in [low, high), high must be > low
+        I32 NextI32(I32 low, I32 high);
+
+        // Uniform in [0, 1) on a grid of 2^-24, every value is exactly representable
+        F32 NextF32();
+
+        // low + NextF32() * (high - low), high must be > low. The sum can round up to high, that is moved down to the
+        // largest float below high so the result stays in [low, high).
+        F32 NextF32(F32 low, F32 high);
+
+        // Advance the state as if NextU64 had been called 2^128 / 2^192 times, giving sequences that never overlap
+        void Jump();
+        void LongJump();
+
+        // Stream n of seed starts 2^192 outputs past stream n - 1, one per thread or job keeps them independent while the
+        // whole set stays reproducible from one seed. Costs one LongJump per stream index.
+        static Rng CreateStream(U64 seed, U32 streamIndex);
+
+        U64 m_state[4];
+    };
+
+    //-------------------------------------------------------------------------
+    // WideRng
+    //-------------------------------------------------------------------------
+    // Eight Rng lanes stepped together for filling arrays, e.g. spawning particles or scattering procedural content.
+    // Element i of a fill comes from lane i % 8 and every simd level produces the same values. Lane n starts Jump()'d n
+    // times past lane 0, so a WideRng built from a stream stays within that stream's 2^192 outputs. A fill always
+    // advances every lane by (count + 7) / 8 outputs, the unused end of a partial group is dropped.
+    class WideRng
+    {
+        public:
+        static const U32 kNumLanes = 8;
+
+        WideRng();
+        explicit WideRng(U64 seed);
+        explicit WideRng(const Rng& rng);
+
+        void Seed(U64 seed);
+        void Seed(const Rng& rng);
+
+        // High 32 bits of each xoshiro256** output
+        void FillU32(U32* pOut, size_t count);
+
+        // Uniform in [low, high), high must be > low. The range is mapped with a multiply instead of rejection
+        // so lanes stay in step, the bias is below (high - low) / 2^32.
+        void FillI32(I32* pOut, size_t count, I32 low, I32 high);
+
+        // Uniform in [low, high), computed and clamped below high exactly as Rng::NextF32(low, high)
+        void FillF32(F32* pOut, size_t count, F32 low = 0.0f, F32 high = 1.0f);
+
+        // Lane n of state word w is m_state[w][n]
+        alignas(64) U64 m_state[4][kNumLanes];
+    };
+
+    //-------------------------------------------------------------------------
+    // Thread generators
+    //-------------------------------------------------------------------------
+    // Each thread lazily gets its own stream of the global seed, numbered in the order threads first ask for one.
+    // SeedRng resets the numbering and reseeds the calling thread as stream 0, threads that already have a stream keep it.
+    void SeedRng();
+    void SeedRng(U64 seed);
+    Rng& GetThreadRng();
+
+    F32 RandomNumZeroToOne();
+
+    // [low, high)
+    F32 RandomNumBetween(F32 low, F32 high);
+    I32 RandomNumBetween(I32 low, I32 high);
+
+    //-------------------------------------------------------------------------
+    // Inline
+    //-------------------------------------------------------------------------
+    inline U64 RngRotateLeft(U64 x, U32 k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    inline Rng::Rng()
+    {
+        Seed(0);
+    }
+
+    inline Rng::Rng(U64 seed)
+    {
+        Seed(seed);
+    }
+
+    inline U64 Rng::NextU64()
+    {
+        const U64 result = RngRotateLeft(m_state[1] * 5, 7) * 9;
+        const U64 t = m_state[1] << 17;
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= t;
+        m_state[3] = RngRotateLeft(m_state[3], 45);
+        return result;
+    }
+
+    inline U32 Rng::NextU32()
+    {
+        return (U32)(NextU64() >> 32);
+    }
+
+    inline U32 Rng::NextU32(U32 range)
+    {
+        // Lemire's multiply and shift, only the rare products whose low half lands in the short first interval are redrawn
+        U64 product = (U64)NextU32() * range;
+        U32 low = (U32)product;
+        if(low < range)
+        {
+            const U32 threshold = (0u - range) % range;
+            while(low < threshold)
+            {
+                product = (U64)NextU32() * range;
+                low = (U32)product;
+            }
+        }
+        return (U32)(product >> 32);
+    }
+
+    inline I32 Rng::NextI32(I32 low, I32 high)
+    {
+        return (I32)((U32)low + NextU32((U32)high - (U32)low));
+    }
+
+    inline F32 Rng::NextF32()
+    {
+        return (F32)(U32)(NextU64() >> 40) * (1.0f / 16777216.0f);
+    }
+
+    inline F32 Rng::NextF32(F32 low, F32 high)
+    {
+        F32 result = low + NextF32() * (high - low);
+        return result < high ? result : ::nextafterf(high, low);
+    }
+
+    inline F32 RandomNumZeroToOne()
+    {
+        return GetThreadRng().NextF32();
+    }
+
+    inline F32 RandomNumBetween(F32 low, F32 high)
+    {
+        return GetThreadRng().NextF32(low, high);
+    }
+
+    inline I32 RandomNumBetween(I32 low, I32 high)
+    {
+        return GetThreadRng().NextI32(low, high);
+    }
+}
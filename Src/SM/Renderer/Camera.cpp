@@ -19,10 +19,11 @@ Vec3 Camera::GetUp() const
 
 Mat44 Camera::GetRotation() const
 {
-	Mat44 pitch = Mat44::CreateRotationYDegs(m_worldPitchDegrees);
-	Mat44 yaw = Mat44::CreateRotationZDegs(m_worldYawDegrees);
+	// Pitch then yaw composed as quaternions, one matrix build instead of two builds and a multiply
+	Quat pitch = Quat::CreateRotationYDegs(m_worldPitchDegrees);
+	Quat yaw = Quat::CreateRotationZDegs(m_worldYawDegrees);
 
-	return pitch * yaw;
+	return (pitch * yaw).ToMat44();
 }
 
 Mat44 Camera::GetViewTransform() const
@@ -58,6 +59,11 @@ Mat44 Camera::GetViewProjectionTransform() const
     return GetViewTransform() * GetProjectionTransform();
 }
 
+Frustum Camera::GetFrustum() const
+{
+    return Frustum::CreateFromViewProjection(GetViewProjectionTransform());
+}
+
 void Camera::LookAt(const Vec3& lookAtPosition, const Vec3& upReference)
 {
 	Vec3 viewDir = lookAtPosition - m_worldPos;
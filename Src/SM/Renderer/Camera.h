@@ -14,6 +14,7 @@ namespace SM
         Mat44 GetViewTransform() const;
         Mat44 GetProjectionTransform() const;
         Mat44 GetViewProjectionTransform() const;
+        Frustum GetFrustum() const;
 
         void LookAt(const Vec3& lookAtPosition, const Vec3& upReference = Vec3::kZAxis);
 
@@ -1,6 +1,7 @@
 #include "SM/Renderer/VulkanRenderer.h"
 #include "SM/Assert.h"
 #include "SM/Bits.h"
+#include "SM/Containers.h"
 #include "SM/Engine.h"
 #include "SM/Math.h"
 #include "SM/Memory.h"
@@ -29,6 +30,86 @@ static PFN_vkVoidFunction ImguiVulkanFuncLoader(const char* functionName, void*
     return vkGetInstanceProcAddr(instance, functionName);
 }
 
+#if MEMORY_TRACKING_ENABLED
+static void ImguiShowMemoryStatsWindow(bool* pOpen)
+{
+    if(!ImGui::Begin("Memory", pOpen))
+    {
+        ImGui::End();
+        return;
+    }
+
+    const F32 kBytesToKiB = 1.0f / 1024.0f;
+
+    if(ImGui::BeginTable("Allocators", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Allocator");
+        ImGui::TableSetupColumn("Allocated KiB");
+        ImGui::TableSetupColumn("Peak KiB");
+        ImGui::TableSetupColumn("Committed KiB");
+        ImGui::TableSetupColumn("Reserved KiB");
+        ImGui::TableSetupColumn("Padding KiB");
+        ImGui::TableSetupColumn("Allocations");
+        ImGui::TableHeadersRow();
+
+        for(int i = 0; i < kNumBuiltInArenas; i++)
+        {
+            BuiltInMemoryAllocator builtInArena = (BuiltInMemoryAllocator)i;
+            const LinearAllocator* pAllocator = GetBuiltInAllocator(builtInArena);
+            const AllocatorStats& stats = pAllocator->m_trackingStats;
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(GetBuiltInAllocatorName(builtInArena));
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", pAllocator->m_allocatedBytes * kBytesToKiB);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", stats.m_peakAllocatedBytes * kBytesToKiB);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", pAllocator->m_committedBytes * kBytesToKiB);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", pAllocator->m_size * kBytesToKiB);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", stats.m_paddingBytes * kBytesToKiB);
+            ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)stats.m_numAllocations);
+        }
+
+        const HeapAllocator* pHeap = GetBuiltInHeap();
+        HeapAllocator::Stats heapStats = pHeap->GetStats();
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn(); ImGui::TextUnformatted("Heap");
+        ImGui::TableNextColumn(); ImGui::Text("%.1f", heapStats.m_usedBytes * kBytesToKiB);
+        ImGui::TableNextColumn(); ImGui::Text("%.1f", pHeap->m_trackingStats.m_peakAllocatedBytes * kBytesToKiB);
+        ImGui::TableNextColumn(); ImGui::Text("%.1f", heapStats.m_committedBytes * kBytesToKiB);
+        ImGui::TableNextColumn(); ImGui::TextUnformatted("-");
+        ImGui::TableNextColumn(); ImGui::Text("%.1f", pHeap->m_trackingStats.m_paddingBytes * kBytesToKiB);
+        ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)pHeap->m_trackingStats.m_numAllocations);
+
+        ImGui::EndTable();
+
+        ImGui::Text("Heap fragmentation: %.1f%% (%u free blocks)", heapStats.CalcFragmentation() * 100.0f, heapStats.m_numFreeBlocks);
+    }
+
+    static const U32 kMaxDisplayedTags = 128;
+    MemoryTagStats tagStats[kMaxDisplayedTags];
+    U32 numTags = GetMemoryTagStats(tagStats, kMaxDisplayedTags);
+
+    if(ImGui::BeginTable("Tags", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Tag");
+        ImGui::TableSetupColumn("Total Requested KiB");
+        ImGui::TableSetupColumn("Allocations");
+        ImGui::TableHeadersRow();
+
+        for(U32 i = 0; i < numTags; i++)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(tagStats[i].m_name);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", tagStats[i].m_allocatedBytes * kBytesToKiB);
+            ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)tagStats[i].m_numAllocations);
+        }
+
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
+#endif
+
 void FrameResources::Init(VulkanRenderer* pRenderer)
 {
     m_pRenderer = pRenderer;
@@ -86,6 +167,11 @@ void FrameResources::Init(VulkanRenderer* pRenderer)
         };
         SM_ASSERT(vkCreateSemaphore(m_pRenderer->m_device, &createInfo, nullptr, &m_allGpuWorkCompletedSemaphore) == VK_SUCCESS);
     }
+
+    // m_transientAllocator
+    {
+        m_transientAllocator.InitVirtual(kTransientMemoryReserveSize);
+    }
 }
 
 void FrameResources::BeginFrame()
@@ -100,6 +186,12 @@ void FrameResources::BeginFrame()
         vkResetFences(m_pRenderer->m_device, ARRAY_LEN(fencesToReset), fencesToReset);
     }
 
+    // nothing can still be referencing last use of this frame's transient memory now that the fence has signaled
+    {
+        m_transientAllocator.Reset();
+        BindBuiltInAllocator(kFrameTransient, &m_transientAllocator);
+    }
+
     // swapchain update
     {
         bool bSwapchainStillUsable = m_pRenderer->UpdateSwapchain(m_swapchainImageIndex, m_swapchainImageAcquiredSemaphore, m_swapchainImageAcquiredFence);
@@ -259,13 +351,13 @@ void VulkanRenderer::CreateSwapchain()
 
     U32 numSurfaceFormats = 0;
     vkGetPhysicalDeviceSurfaceFormatsKHR(m_physicalDevice, m_surface, &numSurfaceFormats, nullptr);
-    VkSurfaceFormatKHR* surfaceFormats = SM::Alloc<VkSurfaceFormatKHR>(numSurfaceFormats);
-    vkGetPhysicalDeviceSurfaceFormatsKHR(m_physicalDevice, m_surface, &numSurfaceFormats, surfaceFormats);
+    Array<VkSurfaceFormatKHR> surfaceFormats(GetCurrentAllocator());
+    surfaceFormats.Resize(numSurfaceFormats);
+    vkGetPhysicalDeviceSurfaceFormatsKHR(m_physicalDevice, m_surface, &numSurfaceFormats, surfaceFormats.GetData());
 
     m_swapchainFormat = surfaceFormats[0];
-    for(int i = 0; i < numSurfaceFormats; i++)
+    for(const VkSurfaceFormatKHR& format : surfaceFormats)
     {
-        const VkSurfaceFormatKHR& format = surfaceFormats[i];
         if (format.format == VK_FORMAT_B8G8R8A8_UNORM && format.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR)
         {
             m_swapchainFormat = format;
@@ -274,13 +366,13 @@ void VulkanRenderer::CreateSwapchain()
 
     U32 numPresentModes = 0;
     vkGetPhysicalDeviceSurfacePresentModesKHR(m_physicalDevice, m_surface, &numPresentModes, nullptr);
-    VkPresentModeKHR* presentModes = SM::Alloc<VkPresentModeKHR>(numPresentModes);
-    vkGetPhysicalDeviceSurfacePresentModesKHR(m_physicalDevice, m_surface, &numPresentModes, presentModes);
+    Array<VkPresentModeKHR> presentModes(GetCurrentAllocator());
+    presentModes.Resize(numPresentModes);
+    vkGetPhysicalDeviceSurfacePresentModesKHR(m_physicalDevice, m_surface, &numPresentModes, presentModes.GetData());
 
     VkPresentModeKHR swapchainPresentMode = VK_PRESENT_MODE_FIFO_KHR;
-    for(int i = 0; i < numPresentModes; i++)
+    for(const VkPresentModeKHR& mode : presentModes)
     {
-        const VkPresentModeKHR& mode = presentModes[i];
         if (mode == VK_PRESENT_MODE_MAILBOX_KHR)
         {
             swapchainPresentMode = mode;
@@ -1010,6 +1102,7 @@ void VulkanRenderer::RenderFrame()
     // imgui
     {
         static bool s_showImguiDemo = true;
+        static bool s_showMemoryStats = false;
 
         if (ImGui::BeginMainMenuBar())
         {
@@ -1017,11 +1110,24 @@ void VulkanRenderer::RenderFrame()
             {
                 s_showImguiDemo = true;
             }
+            #if MEMORY_TRACKING_ENABLED
+            if (ImGui::MenuItem("Memory"))
+            {
+                s_showMemoryStats = true;
+            }
+            #endif
             ImGui::EndMainMenuBar();
         }
 
         ImGui::ShowDemoWindow(&s_showImguiDemo);
 
+        #if MEMORY_TRACKING_ENABLED
+        if (s_showMemoryStats)
+        {
+            ImguiShowMemoryStatsWindow(&s_showMemoryStats);
+        }
+        #endif
+
         VkRenderingAttachmentInfo colorAttachmentInfo{
             .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
             .pNext = nullptr,
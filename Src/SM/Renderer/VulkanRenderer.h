@@ -39,7 +39,12 @@ namespace SM
         VkSemaphore m_allGpuWorkCompletedSemaphore = VK_NULL_HANDLE;
         VkFence m_frameCompletedFence = VK_NULL_HANDLE;
 
+        // cpu scratch memory that lives exactly as long as this frame, bound to kFrameTransient while the frame is recorded
+        LinearAllocator m_transientAllocator;
+
         VulkanRenderer* m_pRenderer = nullptr;
+
+        static const size_t kTransientMemoryReserveSize = GiB(1);
     };
 
 
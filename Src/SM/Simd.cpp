@@ -0,0 +1,77 @@
+#include "SM/Simd.h"
+
+using namespace SM;
+
+static SimdLevel DetectSimdLevel()
+{
+    #if SM_SIMD_AVX
+        #if defined(_MSC_VER) && !defined(__clang__)
+        int cpuInfo[4];
+        __cpuid(cpuInfo, 0);
+        int maxLeaf = cpuInfo[0];
+
+        __cpuid(cpuInfo, 1);
+        bool bF16c = (cpuInfo[2] & (1 << 29)) != 0;
+        bool bOsSavesYmm = false;
+        bool bOsSavesZmm = false;
+        if((cpuInfo[2] & (1 << 27)) && (cpuInfo[2] & (1 << 28)))
+        {
+            // osxsave and avx, then ask the os which register files it saves on context switches
+            U64 xcr0 = _xgetbv(0);
+            bOsSavesYmm = (xcr0 & 0x6) == 0x6;
+            bOsSavesZmm = (xcr0 & 0xe6) == 0xe6;
+        }
+
+        if(maxLeaf < 7 || !bOsSavesYmm)
+        {
+            return kSimdLevelF32x4;
+        }
+
+        __cpuidex(cpuInfo, 7, 0);
+        bool bAvx2 = (cpuInfo[1] & (1 << 5)) != 0 && bF16c;
+        bool bAvx512 = (cpuInfo[1] & (1 << 16)) != 0;
+        if(bAvx512 && bAvx2 && bOsSavesZmm)
+        {
+            return kSimdLevelAvx512;
+        }
+        return bAvx2 ? kSimdLevelAvx2 : kSimdLevelF32x4;
+        #else
+        // the builtins already check that the os saves the wider registers
+        __builtin_cpu_init();
+        bool bAvx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+        if(__builtin_cpu_supports("avx512f") && bAvx2)
+        {
+            return kSimdLevelAvx512;
+        }
+        return bAvx2 ? kSimdLevelAvx2 : kSimdLevelF32x4;
+        #endif
+    #elif SM_SIMD_ENABLED
+    return kSimdLevelF32x4;
+    #else
+    return kSimdLevelScalar;
+    #endif
+}
+
+static const SimdLevel s_supportedSimdLevel = DetectSimdLevel();
+static SimdLevel s_simdLevel = s_supportedSimdLevel;
+
+SimdLevel SM::GetSupportedSimdLevel()
+{
+    return s_supportedSimdLevel;
+}
+
+SimdLevel SM::GetSimdLevel()
+{
+    return s_simdLevel;
+}
+
+void SM::SetSimdLevel(SimdLevel level)
+{
+    s_simdLevel = level < s_supportedSimdLevel ? level : s_supportedSimdLevel;
+}
+
+const char* SM::GetSimdLevelName(SimdLevel level)
+{
+    static const char* s_simdLevelNames[kNumSimdLevels] = { "scalar", "F32x4", "AVX2", "AVX-512" };
+    return level < kNumSimdLevels ? s_simdLevelNames[level] : "unknown";
+}
@@ -0,0 +1,267 @@
+#pragma once
+
+#include "SM/StandardTypes.h"
+
+#include <cstring>
+
+// Compile time instruction set selection, define SM_SIMD_SCALAR before including to force the scalar reference paths
+#if !defined(SM_SIMD_SCALAR)
+    #if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define SM_SIMD_SSE2 1
+        #include <emmintrin.h>
+    #elif defined(__ARM_NEON) || defined(_M_ARM64)
+        #define SM_SIMD_NEON 1
+        #include <arm_neon.h>
+    #endif
+#endif
+
+#if SM_SIMD_SSE2 || SM_SIMD_NEON
+    #define SM_SIMD_ENABLED 1
+#endif
+
+// 64 bit x86 builds also carry AVX2 and AVX-512 code paths that are only entered after checking GetSimdLevel at runtime.
+// MSVC accepts any intrinsic anywhere, gcc and clang need the instruction set enabled on each function that uses it.
+// Mark helpers with SM_SIMD_TARGET_* and the dispatched entry points with SM_SIMD_ENTRY_*, the entry points flatten
+// every helper into themselves so templated kernels never need their own target. Kernels shared between widths are
+// SM_SIMD_KERNEL so unoptimized builds still inline them into the entry point instead of calling them without the target.
+// The AVX2 level also requires F16C for half float conversions, every AVX2 cpu has it.
+#if SM_SIMD_SSE2 && (defined(_M_X64) || defined(__x86_64__))
+    #define SM_SIMD_AVX 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define SM_SIMD_TARGET_AVX2
+        #define SM_SIMD_TARGET_AVX512
+        #define SM_SIMD_ENTRY_AVX2
+        #define SM_SIMD_ENTRY_AVX512
+        #define SM_SIMD_KERNEL inline
+    #elif defined(__clang__)
+        #define SM_SIMD_TARGET_AVX2 __attribute__((target("avx2,f16c")))
+        #define SM_SIMD_TARGET_AVX512 __attribute__((target("avx512f")))
+        #define SM_SIMD_ENTRY_AVX2 __attribute__((target("avx2,f16c"), flatten))
+        #define SM_SIMD_ENTRY_AVX512 __attribute__((target("avx512f"), flatten))
+        #define SM_SIMD_KERNEL __attribute__((always_inline)) inline
+    #else
+        // avx512f implies fma and gcc would otherwise fuse separate multiply and add intrinsics
+        #define SM_SIMD_TARGET_AVX2 __attribute__((target("avx2,f16c")))
+        #define SM_SIMD_TARGET_AVX512 __attribute__((target("avx512f")))
+        #define SM_SIMD_ENTRY_AVX2 __attribute__((target("avx2,f16c"), flatten))
+        #define SM_SIMD_ENTRY_AVX512 __attribute__((target("avx512f"), optimize("fp-contract=off"), flatten))
+        #define SM_SIMD_KERNEL __attribute__((always_inline)) inline
+    #endif
+#else
+    #define SM_SIMD_KERNEL inline
+#endif
+
+namespace SM
+{
+    // Widest instruction set batch kernels may use, each level implies the ones below it
+    enum SimdLevel
+    {
+        kSimdLevelScalar,
+        kSimdLevelF32x4,    // SSE2 or NEON, always available when SM_SIMD_ENABLED
+        kSimdLevelAvx2,     // AVX2 and F16C
+        kSimdLevelAvx512,
+        kNumSimdLevels
+    };
+
+    // Detected once from the cpu and os. SetSimdLevel lowers the level batch kernels dispatch to, requests above what
+    // the machine supports are clamped, used to compare code paths against each other.
+    SimdLevel GetSupportedSimdLevel();
+    SimdLevel GetSimdLevel();
+    void SetSimdLevel(SimdLevel level);
+    const char* GetSimdLevelName(SimdLevel level);
+}
+
+#if SM_SIMD_ENABLED
+namespace SM
+{
+    //-------------------------------------------------------------------------
+    // F32x4
+    //-------------------------------------------------------------------------
+    // Thin wrappers over 4 wide float registers so math code is written once for SSE and NEON.
+    // Nothing here fuses multiplies and adds, results round the same way as the equivalent scalar expressions.
+    #if SM_SIMD_SSE2
+    typedef __m128 F32x4;
+    #else
+    typedef float32x4_t F32x4;
+    #endif
+
+    #if SM_SIMD_SSE2
+    inline F32x4 SimdLoad(const F32* p) { return _mm_load_ps(p); }
+    inline F32x4 SimdLoadUnaligned(const F32* p) { return _mm_loadu_ps(p); }
+    inline void SimdStore(F32* p, F32x4 v) { _mm_store_ps(p, v); }
+    inline void SimdStoreUnaligned(F32* p, F32x4 v) { _mm_storeu_ps(p, v); }
+    inline F32x4 SimdSet(F32 x, F32 y, F32 z, F32 w) { return _mm_set_ps(w, z, y, x); }
+    inline F32x4 SimdSplat(F32 s) { return _mm_set1_ps(s); }
+    inline F32x4 SimdZero() { return _mm_setzero_ps(); }
+    inline F32 SimdGetX(F32x4 v) { return _mm_cvtss_f32(v); }
+
+    inline F32x4 SimdSplatX(F32x4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)); }
+    inline F32x4 SimdSplatY(F32x4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)); }
+    inline F32x4 SimdSplatZ(F32x4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)); }
+    inline F32x4 SimdSplatW(F32x4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)); }
+
+    inline F32x4 SimdAdd(F32x4 a, F32x4 b) { return _mm_add_ps(a, b); }
+    inline F32x4 SimdSub(F32x4 a, F32x4 b) { return _mm_sub_ps(a, b); }
+    inline F32x4 SimdMul(F32x4 a, F32x4 b) { return _mm_mul_ps(a, b); }
+    inline F32x4 SimdDiv(F32x4 a, F32x4 b) { return _mm_div_ps(a, b); }
+    inline F32x4 SimdMin(F32x4 a, F32x4 b) { return _mm_min_ps(a, b); }
+    inline F32x4 SimdMax(F32x4 a, F32x4 b) { return _mm_max_ps(a, b); }
+    inline F32x4 SimdSqrt(F32x4 v) { return _mm_sqrt_ps(v); }
+    inline F32x4 SimdNegate(F32x4 v) { return _mm_xor_ps(v, _mm_set1_ps(-0.0f)); }
+    inline F32x4 SimdAbs(F32x4 v) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+    // negates the lanes of v where signSource has its sign bit set, -0 included
+    inline F32x4 SimdFlipSign(F32x4 v, F32x4 signSource) { return _mm_xor_ps(v, _mm_and_ps(signSource, _mm_set1_ps(-0.0f))); }
+    inline bool SimdAllEqual(F32x4 a, F32x4 b) { return _mm_movemask_ps(_mm_cmpeq_ps(a, b)) == 0xf; }
+    // Bit n is set when lane n of a < lane n of b, never for nan lanes
+    inline U32 SimdLessThanMask(F32x4 a, F32x4 b) { return (U32)_mm_movemask_ps(_mm_cmplt_ps(a, b)); }
+
+    inline void SimdTranspose(F32x4& r0, F32x4& r1, F32x4& r2, F32x4& r3) { _MM_TRANSPOSE4_PS(r0, r1, r2, r3); }
+
+    // Operations on the raw bits of each lane, masks are all ones or all zeros per lane
+    inline F32x4 SimdSplatBits(U32 bits) { return _mm_castsi128_ps(_mm_set1_epi32((I32)bits)); }
+    inline F32x4 SimdAnd(F32x4 a, F32x4 b) { return _mm_and_ps(a, b); }
+    inline F32x4 SimdOr(F32x4 a, F32x4 b) { return _mm_or_ps(a, b); }
+    inline F32x4 SimdXor(F32x4 a, F32x4 b) { return _mm_xor_ps(a, b); }
+    // ~a & b
+    inline F32x4 SimdAndNot(F32x4 a, F32x4 b) { return _mm_andnot_ps(a, b); }
+    // a where mask is set, b elsewhere
+    inline F32x4 SimdSelect(F32x4 mask, F32x4 a, F32x4 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+    inline F32x4 SimdCmpLessThan(F32x4 a, F32x4 b) { return _mm_cmplt_ps(a, b); }
+    // all ones in lanes with the sign bit set, -0 and negative nans included
+    inline F32x4 SimdSignMask(F32x4 v) { return _mm_castsi128_ps(_mm_srai_epi32(_mm_castps_si128(v), 31)); }
+    // lanes added and shifted as 32 bit integers, right shifts fill with zeros
+    inline F32x4 SimdAddBits(F32x4 a, F32x4 b) { return _mm_castsi128_ps(_mm_add_epi32(_mm_castps_si128(a), _mm_castps_si128(b))); }
+    template<U32 k>
+    inline F32x4 SimdShiftLeftBits(F32x4 v) { return _mm_castsi128_ps(_mm_slli_epi32(_mm_castps_si128(v), k)); }
+    template<U32 k>
+    inline F32x4 SimdShiftRightBits(F32x4 v) { return _mm_castsi128_ps(_mm_srli_epi32(_mm_castps_si128(v), k)); }
+    // signed 32 bit integer compare
+    inline F32x4 SimdCmpLessThanBits(F32x4 a, F32x4 b) { return _mm_castsi128_ps(_mm_cmplt_epi32(_mm_castps_si128(a), _mm_castps_si128(b))); }
+    // 4 U16 zero extended into the lane bits, and the low 16 / 8 bits of each lane stored back out
+    inline F32x4 SimdLoadU16(const U16* p) { return _mm_castsi128_ps(_mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)p), _mm_setzero_si128())); }
+    inline void SimdStoreU16(U16* p, F32x4 v)
+    {
+        // sign extended so the saturating pack keeps every value as it is
+        __m128i bits = _mm_srai_epi32(_mm_slli_epi32(_mm_castps_si128(v), 16), 16);
+        _mm_storel_epi64((__m128i*)p, _mm_packs_epi32(bits, bits));
+    }
+    inline void SimdStoreU8(U8* p, F32x4 v)
+    {
+        __m128i bits = _mm_and_si128(_mm_castps_si128(v), _mm_set1_epi32(0xff));
+        bits = _mm_packs_epi32(bits, bits);
+        I32 bytes = _mm_cvtsi128_si32(_mm_packus_epi16(bits, bits));
+        ::memcpy(p, &bytes, sizeof(bytes));
+    }
+
+    // (a[X], a[Y], b[Z], b[W])
+    template<U32 X, U32 Y, U32 Z, U32 W>
+    inline F32x4 SimdShuffle(F32x4 a, F32x4 b) { return _mm_shuffle_ps(a, b, _MM_SHUFFLE(W, Z, Y, X)); }
+    #else
+    inline F32x4 SimdLoad(const F32* p) { return vld1q_f32(p); }
+    inline F32x4 SimdLoadUnaligned(const F32* p) { return vld1q_f32(p); }
+    inline void SimdStore(F32* p, F32x4 v) { vst1q_f32(p, v); }
+    inline void SimdStoreUnaligned(F32* p, F32x4 v) { vst1q_f32(p, v); }
+    inline F32x4 SimdSet(F32 x, F32 y, F32 z, F32 w) { const F32 values[4] = { x, y, z, w }; return vld1q_f32(values); }
+    inline F32x4 SimdSplat(F32 s) { return vdupq_n_f32(s); }
+    inline F32x4 SimdZero() { return vdupq_n_f32(0.0f); }
+    inline F32 SimdGetX(F32x4 v) { return vgetq_lane_f32(v, 0); }
+
+    inline F32x4 SimdSplatX(F32x4 v) { return vdupq_laneq_f32(v, 0); }
+    inline F32x4 SimdSplatY(F32x4 v) { return vdupq_laneq_f32(v, 1); }
+    inline F32x4 SimdSplatZ(F32x4 v) { return vdupq_laneq_f32(v, 2); }
+    inline F32x4 SimdSplatW(F32x4 v) { return vdupq_laneq_f32(v, 3); }
+
+    inline F32x4 SimdAdd(F32x4 a, F32x4 b) { return vaddq_f32(a, b); }
+    inline F32x4 SimdSub(F32x4 a, F32x4 b) { return vsubq_f32(a, b); }
+    inline F32x4 SimdMul(F32x4 a, F32x4 b) { return vmulq_f32(a, b); }
+    inline F32x4 SimdDiv(F32x4 a, F32x4 b) { return vdivq_f32(a, b); }
+    inline F32x4 SimdMin(F32x4 a, F32x4 b) { return vminq_f32(a, b); }
+    inline F32x4 SimdMax(F32x4 a, F32x4 b) { return vmaxq_f32(a, b); }
+    inline F32x4 SimdSqrt(F32x4 v) { return vsqrtq_f32(v); }
+    inline F32x4 SimdNegate(F32x4 v) { return vnegq_f32(v); }
+    inline F32x4 SimdAbs(F32x4 v) { return vabsq_f32(v); }
+    inline F32x4 SimdFlipSign(F32x4 v, F32x4 signSource)
+    {
+        uint32x4_t signBits = vandq_u32(vreinterpretq_u32_f32(signSource), vdupq_n_u32(0x80000000));
+        return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(v), signBits));
+    }
+    inline bool SimdAllEqual(F32x4 a, F32x4 b) { return vminvq_u32(vceqq_f32(a, b)) == 0xffffffff; }
+    inline U32 SimdLessThanMask(F32x4 a, F32x4 b)
+    {
+        const U32 laneBits[4] = { 1, 2, 4, 8 };
+        return vaddvq_u32(vandq_u32(vcltq_f32(a, b), vld1q_u32(laneBits)));
+    }
+
+    inline F32x4 SimdSplatBits(U32 bits) { return vreinterpretq_f32_u32(vdupq_n_u32(bits)); }
+    inline F32x4 SimdAnd(F32x4 a, F32x4 b) { return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+    inline F32x4 SimdOr(F32x4 a, F32x4 b) { return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+    inline F32x4 SimdXor(F32x4 a, F32x4 b) { return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+    inline F32x4 SimdAndNot(F32x4 a, F32x4 b) { return vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(b), vreinterpretq_u32_f32(a))); }
+    inline F32x4 SimdSelect(F32x4 mask, F32x4 a, F32x4 b) { return vbslq_f32(vreinterpretq_u32_f32(mask), a, b); }
+    inline F32x4 SimdCmpLessThan(F32x4 a, F32x4 b) { return vreinterpretq_f32_u32(vcltq_f32(a, b)); }
+    inline F32x4 SimdSignMask(F32x4 v) { return vreinterpretq_f32_s32(vshrq_n_s32(vreinterpretq_s32_f32(v), 31)); }
+    inline F32x4 SimdAddBits(F32x4 a, F32x4 b) { return vreinterpretq_f32_u32(vaddq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+    template<U32 k>
+    inline F32x4 SimdShiftLeftBits(F32x4 v) { return vreinterpretq_f32_u32(vshlq_n_u32(vreinterpretq_u32_f32(v), k)); }
+    template<U32 k>
+    inline F32x4 SimdShiftRightBits(F32x4 v) { return vreinterpretq_f32_u32(vshrq_n_u32(vreinterpretq_u32_f32(v), k)); }
+    inline F32x4 SimdCmpLessThanBits(F32x4 a, F32x4 b) { return vreinterpretq_f32_u32(vcltq_s32(vreinterpretq_s32_f32(a), vreinterpretq_s32_f32(b))); }
+    inline F32x4 SimdLoadU16(const U16* p) { return vreinterpretq_f32_u32(vmovl_u16(vld1_u16(p))); }
+    inline void SimdStoreU16(U16* p, F32x4 v) { vst1_u16(p, vmovn_u32(vreinterpretq_u32_f32(v))); }
+    inline void SimdStoreU8(U8* p, F32x4 v)
+    {
+        uint8x8_t bytes = vmovn_u16(vcombine_u16(vmovn_u32(vreinterpretq_u32_f32(v)), vdup_n_u16(0)));
+        U32 packed = vget_lane_u32(vreinterpret_u32_u8(bytes), 0);
+        ::memcpy(p, &packed, sizeof(packed));
+    }
+
+    inline void SimdTranspose(F32x4& r0, F32x4& r1, F32x4& r2, F32x4& r3)
+    {
+        float32x4x2_t t01 = vtrnq_f32(r0, r1);
+        float32x4x2_t t23 = vtrnq_f32(r2, r3);
+        r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+        r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+        r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+        r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+    }
+
+    // (a[X], a[Y], b[Z], b[W])
+    template<U32 X, U32 Y, U32 Z, U32 W>
+    inline F32x4 SimdShuffle(F32x4 a, F32x4 b)
+    {
+        F32x4 result = vdupq_n_f32(vgetq_lane_f32(a, X));
+        result = vsetq_lane_f32(vgetq_lane_f32(a, Y), result, 1);
+        result = vsetq_lane_f32(vgetq_lane_f32(b, Z), result, 2);
+        return vsetq_lane_f32(vgetq_lane_f32(b, W), result, 3);
+    }
+    #endif
+
+    // (v[X], v[Y], v[Z], v[W])
+    template<U32 X, U32 Y, U32 Z, U32 W>
+    inline F32x4 SimdSwizzle(F32x4 v) { return SimdShuffle<X, Y, Z, W>(v, v); }
+
+    // a * b + c as a separate multiply and add
+    inline F32x4 SimdMulAdd(F32x4 a, F32x4 b, F32x4 c) { return SimdAdd(SimdMul(a, b), c); }
+
+    // Sum of the four lanes broadcast to every lane, added in x, y, z, w order to match scalar code
+    inline F32x4 SimdHorizontalSum(F32x4 v)
+    {
+        F32x4 sum = SimdAdd(SimdSplatX(v), SimdSplatY(v));
+        sum = SimdAdd(sum, SimdSplatZ(v));
+        return SimdAdd(sum, SimdSplatW(v));
+    }
+
+    inline F32x4 SimdDot4(F32x4 a, F32x4 b) { return SimdHorizontalSum(SimdMul(a, b)); }
+
+    // v.x * r0 + v.y * r1 + v.z * r2 + v.w * r3, a row vector times a matrix given as its four rows
+    inline F32x4 SimdLinearCombine(F32x4 v, F32x4 r0, F32x4 r1, F32x4 r2, F32x4 r3)
+    {
+        F32x4 result = SimdMul(SimdSplatX(v), r0);
+        result = SimdMulAdd(SimdSplatY(v), r1, result);
+        result = SimdMulAdd(SimdSplatZ(v), r2, result);
+        return SimdMulAdd(SimdSplatW(v), r3, result);
+    }
+}
+#endif
@@ -0,0 +1,216 @@
+#include "SM/Sort.h"
+#include "SM/Assert.h"
+#include "SM/Util.h"
+
+#include <thread>
+#include <type_traits>
+
+using namespace SM;
+
+static const U32 kRadixNumBuckets = 256;
+static const size_t kRadixMinKeysPerThread = KiB(64);
+
+struct RadixNoValue {};
+
+template<typename Func>
+static void RadixParallelFor(U32 numThreads, Func&& func)
+{
+    if(numThreads == 1)
+    {
+        func(0);
+        return;
+    }
+
+    // the calling thread takes the first range
+    std::thread workers[64];
+    for(U32 i = 1; i < numThreads; i++)
+    {
+        workers[i] = std::thread(func, i);
+    }
+    func(0);
+    for(U32 i = 1; i < numThreads; i++)
+    {
+        workers[i].join();
+    }
+}
+
+template<typename Key>
+static void RadixCountDigits(const Key* pKeys, size_t begin, size_t end, size_t* pHistograms)
+{
+    // one read of the keys fills in the histogram for every digit
+    for(size_t i = begin; i < end; i++)
+    {
+        Key key = pKeys[i];
+        for(U32 pass = 0; pass < sizeof(Key); pass++)
+        {
+            pHistograms[pass * kRadixNumBuckets + ((key >> (pass * 8)) & 0xff)]++;
+        }
+    }
+}
+
+template<typename Key>
+static void RadixCountDigit(const Key* pKeys, size_t begin, size_t end, U32 shift, size_t* pHistogram)
+{
+    for(size_t i = begin; i < end; i++)
+    {
+        pHistogram[(pKeys[i] >> shift) & 0xff]++;
+    }
+}
+
+template<typename Key, typename Value>
+static void RadixScatter(const Key* pSrcKeys, const Value* pSrcValues, Key* pDstKeys, Value* pDstValues, size_t begin, size_t end, U32 shift, size_t* pOffsets)
+{
+    for(size_t i = begin; i < end; i++)
+    {
+        Key key = pSrcKeys[i];
+        size_t dst = pOffsets[(key >> shift) & 0xff]++;
+        pDstKeys[dst] = key;
+        if constexpr (!std::is_same_v<Value, RadixNoValue>)
+        {
+            pDstValues[dst] = pSrcValues[i];
+        }
+    }
+}
+
+template<typename Key, typename Value>
+static void RadixSortImpl(Key* pKeys, Value* pValues, size_t numKeys, LinearAllocator* scratchAllocator, U32 numThreads)
+{
+    const U32 kNumPasses = sizeof(Key);
+    const bool bHasValues = !std::is_same_v<Value, RadixNoValue>;
+
+    if(numKeys < 2)
+        return;
+
+    SM_ASSERT(numThreads >= 1 && numThreads <= 64);
+    size_t maxThreads = numKeys / kRadixMinKeysPerThread;
+    if(numThreads > maxThreads)
+    {
+        numThreads = maxThreads > 0 ? (U32)maxThreads : 1;
+    }
+
+    size_t restoreAllocatedBytes = scratchAllocator->m_allocatedBytes;
+
+    Key* pTempKeys = scratchAllocator->Alloc<Key>(numKeys);
+    Value* pTempValues = bHasValues ? scratchAllocator->Alloc<Value>(numKeys) : nullptr;
+
+    // per thread histograms for every digit, then summed into the totals used to skip passes and place buckets
+    size_t* pThreadHistograms = scratchAllocator->Alloc<size_t>(numThreads * kNumPasses * kRadixNumBuckets);
+    size_t* pThreadOffsets = scratchAllocator->Alloc<size_t>(numThreads * kRadixNumBuckets);
+    size_t histograms[kNumPasses * kRadixNumBuckets] = {};
+    ::memset(pThreadHistograms, 0, sizeof(size_t) * numThreads * kNumPasses * kRadixNumBuckets);
+
+    const size_t keysPerThread = (numKeys + numThreads - 1) / numThreads;
+    auto CalcRangeBegin = [=](U32 thread) { return thread * keysPerThread; };
+    auto CalcRangeEnd = [=](U32 thread) { return thread + 1 == numThreads ? numKeys : (thread + 1) * keysPerThread; };
+
+    RadixParallelFor(numThreads, [&](U32 thread) {
+        RadixCountDigits(pKeys, CalcRangeBegin(thread), CalcRangeEnd(thread), pThreadHistograms + thread * kNumPasses * kRadixNumBuckets);
+    });
+    for(U32 thread = 0; thread < numThreads; thread++)
+    {
+        const size_t* pThreadHistogram = pThreadHistograms + thread * kNumPasses * kRadixNumBuckets;
+        for(U32 i = 0; i < kNumPasses * kRadixNumBuckets; i++)
+        {
+            histograms[i] += pThreadHistogram[i];
+        }
+    }
+
+    Key* pSrcKeys = pKeys;
+    Key* pDstKeys = pTempKeys;
+    Value* pSrcValues = pValues;
+    Value* pDstValues = pTempValues;
+    bool bThreadHistogramsMatchSrc = true;
+
+    for(U32 pass = 0; pass < kNumPasses; pass++)
+    {
+        const size_t* pHistogram = histograms + pass * kRadixNumBuckets;
+        const U32 shift = pass * 8;
+
+        // every key has the same digit, the pass would not move anything
+        if(pHistogram[(pSrcKeys[0] >> shift) & 0xff] == numKeys)
+            continue;
+
+        // the per range histograms only describe the input order, once keys have moved they need recounting
+        size_t* pPassHistograms = pThreadHistograms;
+        size_t passHistogramStride = kNumPasses * kRadixNumBuckets;
+        if(bThreadHistogramsMatchSrc)
+        {
+            pPassHistograms += pass * kRadixNumBuckets;
+        }
+        else
+        {
+            passHistogramStride = kRadixNumBuckets;
+            if(numThreads > 1)
+            {
+                ::memset(pThreadHistograms, 0, sizeof(size_t) * numThreads * kRadixNumBuckets);
+                RadixParallelFor(numThreads, [&](U32 thread) {
+                    RadixCountDigit(pSrcKeys, CalcRangeBegin(thread), CalcRangeEnd(thread), shift, pThreadHistograms + thread * kRadixNumBuckets);
+                });
+            }
+            else
+            {
+                ::memcpy(pThreadHistograms, pHistogram, sizeof(size_t) * kRadixNumBuckets);
+            }
+        }
+
+        // bucket b of thread t starts after all smaller buckets and after bucket b of every earlier thread
+        size_t offset = 0;
+        for(U32 bucket = 0; bucket < kRadixNumBuckets; bucket++)
+        {
+            for(U32 thread = 0; thread < numThreads; thread++)
+            {
+                pThreadOffsets[thread * kRadixNumBuckets + bucket] = offset;
+                offset += pPassHistograms[thread * passHistogramStride + bucket];
+            }
+        }
+
+        RadixParallelFor(numThreads, [&](U32 thread) {
+            RadixScatter(pSrcKeys, pSrcValues, pDstKeys, pDstValues, CalcRangeBegin(thread), CalcRangeEnd(thread), shift, pThreadOffsets + thread * kRadixNumBuckets);
+        });
+
+        Swap(pSrcKeys, pDstKeys);
+        Swap(pSrcValues, pDstValues);
+        bThreadHistogramsMatchSrc = false;
+    }
+
+    if(pSrcKeys != pKeys)
+    {
+        ::memcpy(pKeys, pSrcKeys, sizeof(Key) * numKeys);
+        if constexpr (!std::is_same_v<Value, RadixNoValue>)
+        {
+            ::memcpy(pValues, pSrcValues, sizeof(Value) * numKeys);
+        }
+    }
+
+    scratchAllocator->m_allocatedBytes = restoreAllocatedBytes;
+}
+
+void SM::RadixSort(U32* pKeys, size_t numKeys, LinearAllocator* scratchAllocator, U32 numThreads)
+{
+    RadixSortImpl<U32, RadixNoValue>(pKeys, nullptr, numKeys, scratchAllocator, numThreads);
+}
+
+void SM::RadixSort(U64* pKeys, size_t numKeys, LinearAllocator* scratchAllocator, U32 numThreads)
+{
+    RadixSortImpl<U64, RadixNoValue>(pKeys, nullptr, numKeys, scratchAllocator, numThreads);
+}
+
+void SM::RadixSort(U32* pKeys, U32* pValues, size_t numKeys, LinearAllocator* scratchAllocator, U32 numThreads)
+{
+    RadixSortImpl(pKeys, pValues, numKeys, scratchAllocator, numThreads);
+}
+
+void SM::RadixSort(U32* pKeys, U64* pValues, size_t numKeys, LinearAllocator* scratchAllocator, U32 numThreads)
+{
+    RadixSortImpl(pKeys, pValues, numKeys, scratchAllocator, numThreads);
+}
+
+void SM::RadixSort(U64* pKeys, U32* pValues, size_t numKeys, LinearAllocator* scratchAllocator, U32 numThreads)
+{
+    RadixSortImpl(pKeys, pValues, numKeys, scratchAllocator, numThreads);
+}
+
+void SM::RadixSort(U64* pKeys, U64* pValues, size_t numKeys, LinearAllocator* scratchAllocator, U32 numThreads)
+{
+    RadixSortImpl(pKeys, pValues, numKeys, scratchAllocator, numThreads);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "SM/Memory.h"
+#include "SM/StandardTypes.h"
+
+#include <cstring>
+
+namespace SM
+{
+    // LSD radix sorts, ascending and stable, 8 bits per pass.
+    // Scratch space for a second copy of the keys (and values) comes from scratchAllocator and is given back before
+    // returning. Passes where every key lands in the same bucket are skipped. numThreads > 1 splits the histogram and
+    // scatter of each pass across that many threads, small inputs always sort on the calling thread.
+    void RadixSort(U32* pKeys, size_t numKeys, LinearAllocator* scratchAllocator = GetThreadScratchAllocator(), U32 numThreads = 1);
+    void RadixSort(U64* pKeys, size_t numKeys, LinearAllocator* scratchAllocator = GetThreadScratchAllocator(), U32 numThreads = 1);
+
+    // Sorts keys and moves each value along with its key, sort U32 indices as values to order arbitrary payloads
+    void RadixSort(U32* pKeys, U32* pValues, size_t numKeys, LinearAllocator* scratchAllocator = GetThreadScratchAllocator(), U32 numThreads = 1);
+    void RadixSort(U32* pKeys, U64* pValues, size_t numKeys, LinearAllocator* scratchAllocator = GetThreadScratchAllocator(), U32 numThreads = 1);
+    void RadixSort(U64* pKeys, U32* pValues, size_t numKeys, LinearAllocator* scratchAllocator = GetThreadScratchAllocator(), U32 numThreads = 1);
+    void RadixSort(U64* pKeys, U64* pValues, size_t numKeys, LinearAllocator* scratchAllocator = GetThreadScratchAllocator(), U32 numThreads = 1);
+
+    // Maps a float to a U32 that radix sorts in the same order as the float, negative values included
+    inline U32 CalcRadixKey(F32 f)
+    {
+        U32 bits;
+        ::memcpy(&bits, &f, sizeof(bits));
+        U32 mask = (bits & 0x80000000) ? 0xffffffff : 0x80000000;
+        return bits ^ mask;
+    }
+}
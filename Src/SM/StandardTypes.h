@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 namespace SM
@@ -19,8 +20,28 @@ namespace SM
 
     typedef		U8			Byte;
 
-    #define KiB(i) (i * 1024)
-    #define MiB(i) (i * KiB(1024))
-    #define GiB(i) (i * MiB(1024))
-    #define TiB(i) (i * GiB(1024))
+    #define KiB(i) ((size_t)(i) * 1024)
+    #define MiB(i) (KiB(i) * 1024)
+    #define GiB(i) (MiB(i) * 1024)
+    #define TiB(i) (GiB(i) * 1024)
+
+    template<typename T>
+    inline T Min(T a, T b)
+    {
+        return (a < b) ? a : b;
+    }
+
+    template<typename T>
+    inline T Max(T a, T b)
+    {
+        return (a > b) ? a : b;
+    }
+
+    template<typename T>
+    inline T Clamp(T value, T min, T max)
+    {
+        if(value < min) return min;
+        if(value > max) return max;
+        return value;
+    }
 }
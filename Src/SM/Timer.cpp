@@ -0,0 +1,293 @@
+#include "SM/Timer.h"
+#include "SM/Math.h"
+#include "SM/Platform.h"
+
+using namespace SM;
+
+TimerWheel::TimerWheel(LinearAllocator* allocator)
+    :m_timers(allocator)
+{
+}
+
+TimerWheel::TimerWheel(HeapAllocator* allocator)
+    :m_timers(allocator)
+{
+}
+
+TimerHandle TimerWheel::Schedule(F32 delaySeconds, TimerCallback callback, void* pUserData, F32 intervalSeconds)
+{
+    SM_ASSERT(callback != nullptr);
+
+    // reuse a released timer when there is one, otherwise grow the bucket array which never moves existing timers
+    Timer* pTimer = nullptr;
+    if(m_freeTimers.m_pNext != &m_freeTimers)
+    {
+        pTimer = (Timer*)m_freeTimers.m_pNext;
+        pTimer->m_pPrev->m_pNext = pTimer->m_pNext;
+        pTimer->m_pNext->m_pPrev = pTimer->m_pPrev;
+    }
+    else
+    {
+        U32 index = 0;
+        pTimer = m_timers.Add(Timer(), &index);
+        pTimer->m_index = index;
+    }
+
+    pTimer->m_expiryTick = m_lastUpdateTick + SecondsToTicks(delaySeconds);
+    pTimer->m_intervalTicks = intervalSeconds > 0.0f ? Max<U64>(SecondsToTicks(intervalSeconds), 1) : 0;
+    pTimer->m_callback = callback;
+    pTimer->m_pUserData = pUserData;
+    pTimer->m_bPending = true;
+    m_numPending++;
+    AddToWheel(pTimer);
+
+    return TimerHandle{ pTimer->m_index, pTimer->m_generation };
+}
+
+bool TimerWheel::Cancel(TimerHandle handle)
+{
+    Timer* pTimer = FindTimer(handle);
+    if(pTimer == nullptr)
+        return false;
+
+    Unlink(pTimer);
+    ReleaseTimer(pTimer);
+    return true;
+}
+
+bool TimerWheel::IsPending(TimerHandle handle)
+{
+    return FindTimer(handle) != nullptr;
+}
+
+void TimerWheel::Update()
+{
+    // stay in integers, F32 seconds stop resolving a 1 ms tick after a couple of hours of uptime.
+    // splitting off whole seconds keeps the multiply from overflowing and stays exact for any counter frequency.
+    U64 counter = Platform::GetPerformanceCounter();
+    U64 frequency = Platform::GetPerformanceFrequency();
+    U64 nowTick = (counter / frequency) * kTimerWheelTicksPerSecond + ((counter % frequency) * kTimerWheelTicksPerSecond) / frequency;
+    UpdateToTick(nowTick);
+}
+
+void TimerWheel::Update(F64 nowSeconds)
+{
+    UpdateToTick(SecondsToTicks(nowSeconds));
+}
+
+void TimerWheel::UpdateToTick(U64 nowTick)
+{
+    // counting from tick 0 would treat all the uptime before the first Update as elapsed and fire every early timer,
+    // instead the first Update becomes tick 0 which moves anything already scheduled along with it
+    if(!m_bHasTimeBase)
+    {
+        m_baseTick = nowTick;
+        m_bHasTimeBase = true;
+        return;
+    }
+    nowTick = nowTick > m_baseTick ? nowTick - m_baseTick : 0;
+
+    m_lastUpdateTick = Max(m_lastUpdateTick, nowTick);
+
+    while(m_currentTick <= nowTick)
+    {
+        if(m_numPending == 0)
+        {
+            m_currentTick = nowTick + 1;
+            break;
+        }
+
+        U64 tick = m_currentTick;
+        if((tick & (kLevel0NumSlots - 1)) == 0)
+        {
+            Cascade(tick);
+        }
+
+        // jump to the next occupied first level slot, or to the start of the next window where the upper levels cascade
+        U32 nextSlot = m_level0Occupied.FindNextSet((U32)(tick & (kLevel0NumSlots - 1)));
+        U64 windowStart = tick & ~(U64)(kLevel0NumSlots - 1);
+        if(nextSlot == kBitSetInvalidIndex)
+        {
+            m_currentTick = Min(windowStart + kLevel0NumSlots, nowTick + 1);
+            continue;
+        }
+
+        U64 fireTick = windowStart + nextSlot;
+        if(fireTick > nowTick)
+        {
+            m_currentTick = nowTick + 1;
+            break;
+        }
+
+        FireSlot(fireTick);
+    }
+}
+
+TimerWheel::Timer* TimerWheel::FindTimer(TimerHandle handle)
+{
+    if(handle.m_generation == 0 || !m_timers.IsValidIndex(handle.m_index))
+        return nullptr;
+
+    Timer* pTimer = &m_timers[handle.m_index];
+    return (pTimer->m_bPending && pTimer->m_generation == handle.m_generation) ? pTimer : nullptr;
+}
+
+void TimerWheel::AddToWheel(Timer* pTimer)
+{
+    U64 expiryTick = Max(pTimer->m_expiryTick, m_currentTick);
+    U64 deltaTicks = expiryTick - m_currentTick;
+
+    TimerLink* pSlot = nullptr;
+    if(deltaTicks < kLevel0NumSlots)
+    {
+        pTimer->m_level = 0;
+        pTimer->m_slot = (U8)(expiryTick & (kLevel0NumSlots - 1));
+        pSlot = &m_level0Slots[pTimer->m_slot];
+        m_level0Occupied.Set(pTimer->m_slot);
+    }
+    else
+    {
+        // timers past the end of the wheel sit in the furthest slot and are re-bucketed when it cascades
+        if(deltaTicks > kMaxDeltaTicks)
+        {
+            expiryTick = m_currentTick + kMaxDeltaTicks;
+            deltaTicks = kMaxDeltaTicks;
+        }
+
+        U32 level = 0;
+        U32 shift = kLevel0Bits;
+        while(deltaTicks >= (1ull << (shift + kLevelBits)))
+        {
+            level++;
+            shift += kLevelBits;
+        }
+
+        pTimer->m_level = (U8)(level + 1);
+        pTimer->m_slot = (U8)((expiryTick >> shift) & (kLevelNumSlots - 1));
+        pSlot = &m_upperSlots[level][pTimer->m_slot];
+        m_upperOccupied[level].Set(pTimer->m_slot);
+    }
+
+    LinkAppend(pSlot, pTimer);
+}
+
+void TimerWheel::Unlink(Timer* pTimer)
+{
+    pTimer->m_pPrev->m_pNext = pTimer->m_pNext;
+    pTimer->m_pNext->m_pPrev = pTimer->m_pPrev;
+
+    TimerLink* pSlot = pTimer->m_level == 0 ? &m_level0Slots[pTimer->m_slot] : &m_upperSlots[pTimer->m_level - 1][pTimer->m_slot];
+    if(pSlot->m_pNext == pSlot)
+    {
+        if(pTimer->m_level == 0)
+        {
+            m_level0Occupied.UnSet(pTimer->m_slot);
+        }
+        else
+        {
+            m_upperOccupied[pTimer->m_level - 1].UnSet(pTimer->m_slot);
+        }
+    }
+}
+
+void TimerWheel::DetachSlot(U32 level, U32 slot, TimerLink* pOutList)
+{
+    // move the whole slot onto a local list so callbacks can schedule and cancel while it is being walked
+    TimerLink* pSlot = level == 0 ? &m_level0Slots[slot] : &m_upperSlots[level - 1][slot];
+    if(pSlot->m_pNext != pSlot)
+    {
+        pOutList->m_pNext = pSlot->m_pNext;
+        pOutList->m_pPrev = pSlot->m_pPrev;
+        pOutList->m_pNext->m_pPrev = pOutList;
+        pOutList->m_pPrev->m_pNext = pOutList;
+        pSlot->m_pNext = pSlot;
+        pSlot->m_pPrev = pSlot;
+    }
+
+    if(level == 0)
+    {
+        m_level0Occupied.UnSet(slot);
+    }
+    else
+    {
+        m_upperOccupied[level - 1].UnSet(slot);
+    }
+}
+
+void TimerWheel::Cascade(U64 tick)
+{
+    // each level cascades when the level below it wraps around, the slot it empties is the one that just came due
+    U32 shift = kLevel0Bits;
+    for(U32 level = 0; level < kNumUpperLevels; level++)
+    {
+        U32 slot = (U32)((tick >> shift) & (kLevelNumSlots - 1));
+        if(m_upperOccupied[level].IsSet(slot))
+        {
+            TimerLink list;
+            DetachSlot(level + 1, slot, &list);
+            while(list.m_pNext != &list)
+            {
+                Timer* pTimer = (Timer*)list.m_pNext;
+                list.m_pNext = pTimer->m_pNext;
+                pTimer->m_pNext->m_pPrev = &list;
+                AddToWheel(pTimer);
+            }
+        }
+
+        if(slot != 0)
+            break;
+
+        shift += kLevelBits;
+    }
+}
+
+void TimerWheel::FireSlot(U64 tick)
+{
+    // anything scheduled from a callback lands on a later tick
+    m_currentTick = tick + 1;
+
+    TimerLink list;
+    DetachSlot(0, (U32)(tick & (kLevel0NumSlots - 1)), &list);
+    while(list.m_pNext != &list)
+    {
+        Timer* pTimer = (Timer*)list.m_pNext;
+        list.m_pNext = pTimer->m_pNext;
+        pTimer->m_pNext->m_pPrev = &list;
+
+        TimerCallback callback = pTimer->m_callback;
+        void* pUserData = pTimer->m_pUserData;
+        if(pTimer->m_intervalTicks > 0)
+        {
+            pTimer->m_expiryTick += pTimer->m_intervalTicks;
+            AddToWheel(pTimer);
+        }
+        else
+        {
+            ReleaseTimer(pTimer);
+        }
+
+        callback(pUserData);
+    }
+}
+
+void TimerWheel::ReleaseTimer(Timer* pTimer)
+{
+    // bumping the generation invalidates every handle that still points at this timer
+    pTimer->m_bPending = false;
+    pTimer->m_generation++;
+    if(pTimer->m_generation == 0)
+    {
+        pTimer->m_generation = 1;
+    }
+    m_numPending--;
+
+    LinkAppend(&m_freeTimers, pTimer);
+}
+
+void TimerWheel::LinkAppend(TimerLink* pList, TimerLink* pLink)
+{
+    pLink->m_pPrev = pList->m_pPrev;
+    pLink->m_pNext = pList;
+    pList->m_pPrev->m_pNext = pLink;
+    pList->m_pPrev = pLink;
+}
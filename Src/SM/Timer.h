@@ -0,0 +1,99 @@
+#pragma once
+
+#include "SM/Containers.h"
+#include "SM/StandardTypes.h"
+
+namespace SM
+{
+    typedef void (*TimerCallback)(void* pUserData);
+
+    struct TimerHandle
+    {
+        U32 m_index = 0;
+        U32 m_generation = 0;
+    };
+
+    // Hierarchical timer wheel for scheduling callbacks in the future.
+    // Time is split into ticks of 1 / kTimerWheelTicksPerSecond seconds. The first level has a slot per tick for the next 256 ticks and
+    // each coarser level has 64 slots covering 64 times the span of the level below it. Timers further out than the last
+    // level can reach wait in its furthest slot and get re-bucketed when it comes around. Scheduling and cancelling
+    // are O(1), a timer is re-bucketed at most once per level, and Update jumps straight to the next occupied slot so a
+    // frame with nothing expiring does no per tick work.
+    class TimerWheel
+    {
+    public:
+        static const U32 kTimerWheelTicksPerSecond = 1000;
+
+        TimerWheel(LinearAllocator* allocator);
+        TimerWheel(HeapAllocator* allocator);
+        TimerWheel(const TimerWheel&) = delete;
+        TimerWheel& operator=(const TimerWheel&) = delete;
+
+        // Delays are measured from the time passed to the most recent Update, intervalSeconds > 0 makes the timer repeat.
+        // The first Update only sets the time base and fires nothing, timers scheduled before it count from that time.
+        TimerHandle Schedule(F32 delaySeconds, TimerCallback callback, void* pUserData = nullptr, F32 intervalSeconds = 0.0f);
+        bool Cancel(TimerHandle handle);
+        bool IsPending(TimerHandle handle);
+
+        // Fires every timer that has expired by nowSeconds, the overload without a time reads the platform performance counter.
+        // Stick to one overload per wheel, caller supplied seconds don't have to share a time base with the counter.
+        void Update();
+        void Update(F64 nowSeconds);
+
+        U32 GetNumPending() const { return m_numPending; }
+
+    private:
+        static const U32 kLevel0Bits = 8;
+        static const U32 kLevel0NumSlots = 1 << kLevel0Bits;
+        static const U32 kLevelBits = 6;
+        static const U32 kLevelNumSlots = 1 << kLevelBits;
+        static const U32 kNumUpperLevels = 3;
+        static const U64 kMaxDeltaTicks = (1ull << (kLevel0Bits + kLevelBits * kNumUpperLevels)) - 1;
+
+        struct TimerLink
+        {
+            TimerLink* m_pPrev = this;
+            TimerLink* m_pNext = this;
+        };
+
+        struct Timer : public TimerLink
+        {
+            U64 m_expiryTick = 0;
+            U64 m_intervalTicks = 0;
+            TimerCallback m_callback = nullptr;
+            void* m_pUserData = nullptr;
+            U32 m_index = 0;
+            U32 m_generation = 1;
+            U8 m_level = 0;
+            U8 m_slot = 0;
+            bool m_bPending = false;
+        };
+
+        Timer* FindTimer(TimerHandle handle);
+        void AddToWheel(Timer* pTimer);
+        void Unlink(Timer* pTimer);
+        void DetachSlot(U32 level, U32 slot, TimerLink* pOutList);
+        void Cascade(U64 tick);
+        void FireSlot(U64 tick);
+        void ReleaseTimer(Timer* pTimer);
+        static void LinkAppend(TimerLink* pList, TimerLink* pLink);
+
+        void UpdateToTick(U64 nowTick);
+        static U64 SecondsToTicks(F64 seconds) { return (U64)(seconds * kTimerWheelTicksPerSecond + 0.5); }
+
+        TimerLink m_level0Slots[kLevel0NumSlots];
+        TimerLink m_upperSlots[kNumUpperLevels][kLevelNumSlots];
+        FixedBitSet<kLevel0NumSlots> m_level0Occupied;
+        FixedBitSet<kLevelNumSlots> m_upperOccupied[kNumUpperLevels];
+
+        BucketArray<Timer> m_timers;
+        TimerLink m_freeTimers;
+
+        // wheel ticks count from the time of the first Update, before it everything sits at tick 0
+        U64 m_baseTick = 0;
+        bool m_bHasTimeBase = false;
+        U64 m_lastUpdateTick = 0;
+        U64 m_currentTick = 0;
+        U32 m_numPending = 0;
+    };
+}
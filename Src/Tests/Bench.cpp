@@ -0,0 +1,50 @@
+// Benchmark runner, built by EngineBuild.bat as SM-Bench.exe with optimizations on.
+// Pass a suite name to run only that suite, e.g. SM-Bench.exe Memory
+
+#include "SM/Engine.h"
+#include "Tests/Bench.h"
+
+#include <cstring>
+
+#include "Tests/MemoryBench.cpp"
+#include "Tests/ContainersBench.cpp"
+#include "Tests/SortBench.cpp"
+#include "Tests/MathBench.cpp"
+#include "Tests/QuantizeBench.cpp"
+#include "Tests/GeometryBench.cpp"
+
+using namespace SM;
+
+struct BenchSuite
+{
+    const char* m_name;
+    void (*m_run)();
+};
+
+static const BenchSuite s_benchSuites[] =
+{
+    { "Memory", RunMemoryBenchmarks },
+    { "Containers", RunContainerBenchmarks },
+    { "Sort", RunSortBenchmarks },
+    { "Math", RunMathBenchmarks },
+    { "Quantize", RunQuantizeBenchmarks },
+    { "Geometry", RunGeometryBenchmarks },
+};
+
+int main(int argc, char** argv)
+{
+    EngineConfig config;
+    SM::Init(config);
+
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    for(const BenchSuite& suite : s_benchSuites)
+    {
+        if(filter != nullptr && ::strcmp(filter, suite.m_name) != 0)
+            continue;
+
+        printf("\n==== %s ====\n", suite.m_name);
+        suite.m_run();
+    }
+
+    return 0;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "SM/StandardTypes.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+namespace SM
+{
+    // Number of timed runs per measurement, the fastest one is reported since slower runs are mostly scheduler and cache noise
+    static const U32 kBenchNumRuns = 5;
+
+    class BenchTimer
+    {
+    public:
+        BenchTimer()
+            :m_start(std::chrono::steady_clock::now())
+        {
+        }
+
+        F64 GetElapsedMs() const
+        {
+            return std::chrono::duration<F64, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+        }
+
+        F64 GetElapsedNs() const
+        {
+            return std::chrono::duration<F64, std::nano>(std::chrono::steady_clock::now() - m_start).count();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    // Runs func numRuns times and returns the fastest run in milliseconds
+    template<typename Func>
+    F64 BenchMinMs(Func func, U32 numRuns = kBenchNumRuns)
+    {
+        F64 bestMs = 1e300;
+        for(U32 run = 0; run < numRuns; run++)
+        {
+            BenchTimer timer;
+            func();
+            F64 elapsedMs = timer.GetElapsedMs();
+            bestMs = elapsedMs < bestMs ? elapsedMs : bestMs;
+        }
+        return bestMs;
+    }
+
+    // Runs func(threadIndex) on numThreads threads at once and returns the wall time until the last one finishes
+    template<typename Func>
+    F64 BenchThreadsMs(U32 numThreads, Func func)
+    {
+        static const U32 kMaxBenchThreads = 256;
+        std::thread threads[kMaxBenchThreads];
+        numThreads = numThreads < kMaxBenchThreads ? numThreads : kMaxBenchThreads;
+
+        BenchTimer timer;
+        for(U32 i = 0; i < numThreads; i++)
+        {
+            threads[i] = std::thread(func, i);
+        }
+        for(U32 i = 0; i < numThreads; i++)
+        {
+            threads[i].join();
+        }
+        return timer.GetElapsedMs();
+    }
+
+    // Thread counts to sweep are 1, 2, 4, ... up to the number of hardware threads, which is always included
+    inline U32 GetBenchMaxThreads()
+    {
+        U32 numHardwareThreads = std::thread::hardware_concurrency();
+        return numHardwareThreads > 0 ? numHardwareThreads : 1;
+    }
+
+    inline U32 GetNextBenchThreadCount(U32 numThreads)
+    {
+        U32 maxThreads = GetBenchMaxThreads();
+        return (numThreads < maxThreads && numThreads * 2 > maxThreads) ? maxThreads : numThreads * 2;
+    }
+
+    // Keeps the optimizer from dropping work whose result is otherwise unused
+    template<typename T>
+    void BenchKeep(const T& value)
+    {
+        static volatile T s_sink = T();
+        s_sink = s_sink + value;
+    }
+
+    inline void BenchHeader(const char* title)
+    {
+        printf("\n%s\n", title);
+    }
+
+    inline void BenchReport(const char* name, F64 ms, U64 numItems)
+    {
+        printf("    %-44s %10.3f ms %10.2f ns/item %12.0f items/ms\n", name, ms, ms * 1e6 / (F64)numItems, (F64)numItems / ms);
+    }
+
+    // Sorts the per op samples in place and prints their distribution, the tail matters more than the mean for anything
+    // that runs inside a frame. Samples include the clock read overhead and are limited by the clock resolution.
+    inline void BenchReportLatency(const char* name, F32* pSamplesNs, size_t numSamples)
+    {
+        std::sort(pSamplesNs, pSamplesNs + numSamples);
+
+        F64 totalNs = 0.0;
+        for(size_t i = 0; i < numSamples; i++)
+        {
+            totalNs += pSamplesNs[i];
+        }
+
+        printf("    %-44s avg %8.1f ns  p50 %8.1f  p99 %8.1f  p99.9 %8.1f  max %10.1f ns\n",
+               name,
+               totalNs / (F64)numSamples,
+               pSamplesNs[numSamples / 2],
+               pSamplesNs[(size_t)((F64)numSamples * 0.99)],
+               pSamplesNs[(size_t)((F64)numSamples * 0.999)],
+               pSamplesNs[numSamples - 1]);
+    }
+}
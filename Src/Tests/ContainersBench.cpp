@@ -0,0 +1,381 @@
+#include "SM/Containers.h"
+#include "SM/Platform.h"
+#include "SM/Random.h"
+#include "Tests/Bench.h"
+
+#include <unordered_map>
+
+using namespace SM;
+
+//------------------------------------------------------------------------------------------------------------------------
+// HashMap
+//------------------------------------------------------------------------------------------------------------------------
+// Small maps are rebuilt many times so every size does roughly the same amount of work
+static const U64 kHashMapMinOpsPerRun = 10000000;
+
+static void BenchHashMapSize(LinearAllocator& arena, U64 numItems)
+{
+    U64 numRepeats = Max<U64>(kHashMapMinOpsPerRun / numItems, 1);
+    U32 numRuns = numItems >= 1000000 ? 1 : kBenchNumRuns;
+    U64 numOps = numItems * numRepeats;
+
+    // keys are scrambled up front so std::hash's identity hash on integers doesn't get an unfair sequential layout
+    F64 insertMs = BenchMinMs([&]()
+    {
+        for(U64 repeat = 0; repeat < numRepeats; repeat++)
+        {
+            arena.Reset();
+            HashMap<U64, U64> map(&arena);
+            for(U64 i = 0; i < numItems; i++)
+            {
+                map.Insert(HashU64(i), i);
+            }
+        }
+    }, numRuns);
+
+    F64 stdInsertMs = BenchMinMs([&]()
+    {
+        for(U64 repeat = 0; repeat < numRepeats; repeat++)
+        {
+            std::unordered_map<U64, U64> map;
+            for(U64 i = 0; i < numItems; i++)
+            {
+                map[HashU64(i)] = i;
+            }
+        }
+    }, numRuns);
+
+    arena.Reset();
+    HashMap<U64, U64> map(&arena);
+    std::unordered_map<U64, U64> stdMap;
+    for(U64 i = 0; i < numItems; i++)
+    {
+        map.Insert(HashU64(i), i);
+        stdMap[HashU64(i)] = i;
+    }
+
+    F64 hitMs = BenchMinMs([&]()
+    {
+        U64 sum = 0;
+        for(U64 repeat = 0; repeat < numRepeats; repeat++)
+        {
+            for(U64 i = 0; i < numItems; i++)
+            {
+                sum += *map.Find(HashU64(i));
+            }
+        }
+        BenchKeep(sum);
+    }, numRuns);
+
+    F64 stdHitMs = BenchMinMs([&]()
+    {
+        U64 sum = 0;
+        for(U64 repeat = 0; repeat < numRepeats; repeat++)
+        {
+            for(U64 i = 0; i < numItems; i++)
+            {
+                sum += stdMap.find(HashU64(i))->second;
+            }
+        }
+        BenchKeep(sum);
+    }, numRuns);
+
+    F64 missMs = BenchMinMs([&]()
+    {
+        U64 sum = 0;
+        for(U64 repeat = 0; repeat < numRepeats; repeat++)
+        {
+            for(U64 i = 0; i < numItems; i++)
+            {
+                sum += map.Find(HashU64(i + numItems)) != nullptr;
+            }
+        }
+        BenchKeep(sum);
+    }, numRuns);
+
+    F64 stdMissMs = BenchMinMs([&]()
+    {
+        U64 sum = 0;
+        for(U64 repeat = 0; repeat < numRepeats; repeat++)
+        {
+            for(U64 i = 0; i < numItems; i++)
+            {
+                sum += stdMap.find(HashU64(i + numItems)) != stdMap.end();
+            }
+        }
+        BenchKeep(sum);
+    }, numRuns);
+
+    F64 iterateMs = BenchMinMs([&]()
+    {
+        U64 sum = 0;
+        for(U64 repeat = 0; repeat < numRepeats; repeat++)
+        {
+            for(auto& slot : map)
+            {
+                sum += slot.m_value;
+            }
+        }
+        BenchKeep(sum);
+    }, numRuns);
+
+    F64 stdIterateMs = BenchMinMs([&]()
+    {
+        U64 sum = 0;
+        for(U64 repeat = 0; repeat < numRepeats; repeat++)
+        {
+            for(auto& pair : stdMap)
+            {
+                sum += pair.second;
+            }
+        }
+        BenchKeep(sum);
+    }, numRuns);
+
+    char header[128];
+    snprintf(header, sizeof(header), "HashMap vs std::unordered_map, %llu U64 -> U64 entries", (unsigned long long)numItems);
+    BenchHeader(header);
+    BenchReport("HashMap insert", insertMs, numOps);
+    BenchReport("unordered_map insert", stdInsertMs, numOps);
+    BenchReport("HashMap find hit", hitMs, numOps);
+    BenchReport("unordered_map find hit", stdHitMs, numOps);
+    BenchReport("HashMap find miss", missMs, numOps);
+    BenchReport("unordered_map find miss", stdMissMs, numOps);
+    BenchReport("HashMap iterate", iterateMs, numOps);
+    BenchReport("unordered_map iterate", stdIterateMs, numOps);
+}
+
+static void BenchHashMap()
+{
+    LinearAllocator arena;
+    arena.InitVirtual(GiB(16));
+    BenchHashMapSize(arena, 1000);
+    BenchHashMapSize(arena, 1000000);
+    BenchHashMapSize(arena, 10000000);
+    arena.Release();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// Queues
+//------------------------------------------------------------------------------------------------------------------------
+static const U32 kQueueBenchCapacity = 1024;
+static const U32 kQueueBenchItems = 4000000;
+static const U32 kQueueBenchMaxBatch = 16;
+
+template<typename Queue>
+static void ProduceBenchItems(Queue& queue, U32 numItems, U32 batchSize)
+{
+    U64 items[kQueueBenchMaxBatch] = {};
+    U32 next = 0;
+    while(next < numItems)
+    {
+        U32 numPushed = queue.PushBatch(items, Min(batchSize, numItems - next));
+        next += numPushed;
+        if(numPushed == 0)
+        {
+            Platform::YieldThread();
+        }
+    }
+}
+
+template<typename Queue>
+static void ConsumeBenchItems(Queue& queue, std::atomic<U32>& numRemaining, U32 batchSize)
+{
+    U64 items[kQueueBenchMaxBatch];
+    while(numRemaining.load(std::memory_order_relaxed) > 0)
+    {
+        U32 numPopped = queue.PopBatch(items, batchSize);
+        if(numPopped == 0)
+        {
+            Platform::YieldThread();
+            continue;
+        }
+        numRemaining.fetch_sub(numPopped, std::memory_order_relaxed);
+    }
+}
+
+static void BenchQueues()
+{
+    BenchHeader("SpscQueue / MpmcQueue throughput, U64 items through a 1024 item queue");
+
+    static const U32 s_batchSizes[] = { 1, kQueueBenchMaxBatch };
+    char label[64];
+
+    for(U32 batchSize : s_batchSizes)
+    {
+        F64 ms = BenchMinMs([batchSize]()
+        {
+            SpscQueue<U64> queue;
+            queue.Init(GetBuiltInHeap(), kQueueBenchCapacity);
+            std::atomic<U32> numRemaining = kQueueBenchItems;
+            BenchThreadsMs(2, [&](U32 threadIndex)
+            {
+                if(threadIndex == 0)
+                {
+                    ProduceBenchItems(queue, kQueueBenchItems, batchSize);
+                }
+                else
+                {
+                    ConsumeBenchItems(queue, numRemaining, batchSize);
+                }
+            });
+        }, 3);
+
+        snprintf(label, sizeof(label), "spsc, batch %u", batchSize);
+        BenchReport(label, ms, kQueueBenchItems);
+    }
+
+    // n producers and n consumers, the total item count stays the same so items/ms shows how throughput scales
+    for(U32 numThreads = 1; numThreads <= GetBenchMaxThreads(); numThreads = GetNextBenchThreadCount(numThreads))
+    {
+        U32 itemsPerProducer = kQueueBenchItems / numThreads;
+        for(U32 batchSize : s_batchSizes)
+        {
+            F64 ms = BenchMinMs([=]()
+            {
+                MpmcQueue<U64> queue;
+                queue.Init(GetBuiltInHeap(), kQueueBenchCapacity);
+                std::atomic<U32> numRemaining = itemsPerProducer * numThreads;
+                BenchThreadsMs(numThreads * 2, [&](U32 threadIndex)
+                {
+                    if(threadIndex < numThreads)
+                    {
+                        ProduceBenchItems(queue, itemsPerProducer, batchSize);
+                    }
+                    else
+                    {
+                        ConsumeBenchItems(queue, numRemaining, batchSize);
+                    }
+                });
+            }, 3);
+
+            snprintf(label, sizeof(label), "mpmc, %u producers + %u consumers, batch %u", numThreads, numThreads, batchSize);
+            BenchReport(label, ms, (U64)itemsPerProducer * numThreads);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// SlotMap
+//------------------------------------------------------------------------------------------------------------------------
+static const U32 kSlotMapBenchItems = 1000000;
+static const U32 kSlotMapBenchLookups = 4000000;
+
+struct BenchEntity
+{
+    F32 m_position[3];
+    F32 m_velocity[3];
+    U32 m_flags;
+    U32 m_id;
+};
+
+static void UpdateBenchEntity(BenchEntity& entity)
+{
+    for(U32 axis = 0; axis < 3; axis++)
+    {
+        entity.m_position[axis] += entity.m_velocity[axis] * 0.016f;
+    }
+}
+
+static void BenchSlotMapItems(LinearAllocator& arena)
+{
+    // erase a third of the items so the dense array has been compacted by swap removal, like a live object list would be
+    SlotMap<BenchEntity> slotMap(&arena, kSlotMapBenchItems);
+    SlotHandle64* pHandles = arena.Alloc<SlotHandle64>(kSlotMapBenchItems);
+    for(U32 i = 0; i < kSlotMapBenchItems; i++)
+    {
+        BenchEntity entity = {};
+        entity.m_velocity[0] = 1.0f;
+        entity.m_id = i;
+        pHandles[i] = slotMap.Insert(entity);
+    }
+
+    U32 numLiveHandles = 0;
+    for(U32 i = 0; i < kSlotMapBenchItems; i++)
+    {
+        if(i % 3 == 0)
+        {
+            slotMap.Erase(pHandles[i]);
+        }
+        else
+        {
+            pHandles[numLiveHandles++] = pHandles[i];
+        }
+    }
+
+    size_t numItems = slotMap.GetCount();
+    // start on a large page boundary like the slot map storage at the start of the arena so transparent huge pages favour neither
+    BenchEntity* pArray = (BenchEntity*)arena.Alloc(numItems * sizeof(BenchEntity), kAlign2MiB);
+    for(size_t i = 0; i < numItems; i++)
+    {
+        pArray[i] = BenchEntity();
+        pArray[i].m_velocity[0] = 1.0f;
+    }
+
+    F64 slotMapIterateMs = BenchMinMs([&]()
+    {
+        for(BenchEntity& entity : slotMap)
+        {
+            UpdateBenchEntity(entity);
+        }
+    });
+
+    F64 arrayIterateMs = BenchMinMs([pArray, numItems]()
+    {
+        for(size_t i = 0; i < numItems; i++)
+        {
+            UpdateBenchEntity(pArray[i]);
+        }
+    });
+
+    BenchReport("SlotMap iterate + update", slotMapIterateMs, numItems);
+    BenchReport("array iterate + update", arrayIterateMs, numItems);
+
+    // random access by handle pays for the generation check and the extra indirection
+    U32* pLookupOrder = arena.Alloc<U32>(kSlotMapBenchLookups);
+    Rng rng(11);
+    for(U32 i = 0; i < kSlotMapBenchLookups; i++)
+    {
+        pLookupOrder[i] = rng.NextU32(numLiveHandles);
+    }
+
+    F64 slotMapLookupMs = BenchMinMs([&]()
+    {
+        U32 sum = 0;
+        for(U32 i = 0; i < kSlotMapBenchLookups; i++)
+        {
+            sum += slotMap.Get(pHandles[pLookupOrder[i]])->m_id;
+        }
+        BenchKeep(sum);
+    });
+
+    F64 arrayLookupMs = BenchMinMs([&]()
+    {
+        U32 sum = 0;
+        for(U32 i = 0; i < kSlotMapBenchLookups; i++)
+        {
+            sum += pArray[pLookupOrder[i]].m_id;
+        }
+        BenchKeep(sum);
+    });
+
+    BenchReport("SlotMap random Get by handle", slotMapLookupMs, kSlotMapBenchLookups);
+    BenchReport("array random index", arrayLookupMs, kSlotMapBenchLookups);
+}
+
+static void BenchSlotMap()
+{
+    BenchHeader("SlotMap vs plain array, 1M 32 byte items with every third one erased");
+
+    LinearAllocator arena;
+    arena.InitVirtual(GiB(1));
+    BenchSlotMapItems(arena);
+    arena.Release();
+}
+
+void RunContainerBenchmarks()
+{
+    BenchHashMap();
+    BenchQueues();
+    BenchSlotMap();
+}
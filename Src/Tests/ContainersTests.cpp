@@ -0,0 +1,697 @@
+#include "SM/Containers.h"
+#include "SM/Platform.h"
+#include "SM/Random.h"
+#include "Tests/Test.h"
+
+#include <new>
+#include <unordered_map>
+
+using namespace SM;
+
+//------------------------------------------------------------------------------------------------------------------------
+// HashMap
+//------------------------------------------------------------------------------------------------------------------------
+static const U32 kHashMapTestNumOps = 20000;
+
+// Homes every key in the last few slots of the table whatever its capacity, so probe runs cross the end of the table
+// through the cloned control tail and removals have long runs to shift back across the wrap
+struct EndClusterHash
+{
+    U64 operator()(const U64& key) const { return ((U64)(SIZE_MAX - (key % 5)) << 7) | (key & 0x7f); }
+};
+
+// Walks the map and checks every entry against the reference and that nothing is missing or reported twice
+template<typename Hasher>
+static bool CheckHashMapMatches(HashMap<U64, U64, Hasher>& map, const std::unordered_map<U64, U64>& reference)
+{
+    size_t numVisited = 0;
+    size_t numWrong = 0;
+    for(auto& slot : map)
+    {
+        auto it = reference.find(slot.m_key);
+        numWrong += (it == reference.end() || it->second != slot.m_value) ? 1 : 0;
+        numVisited++;
+    }
+    return numWrong == 0 && numVisited == reference.size() && map.m_numItems == reference.size();
+}
+
+// Random inserts, removes and finds over a key range small enough that most operations hit an existing key
+template<typename Hasher>
+static void StressHashMap(HashMap<U64, U64, Hasher>& map, U32 numKeys, const char* name)
+{
+    std::unordered_map<U64, U64> reference;
+    Rng rng(9);
+    U32 numFindMismatches = 0;
+    U32 numUpdateMismatches = 0;
+    U32 numIterationMismatches = 0;
+    for(U32 op = 0; op < kHashMapTestNumOps; op++)
+    {
+        U64 key = rng.NextU32(numKeys);
+        U32 action = rng.NextU32(8);
+        if(action < 3)
+        {
+            U64 value = rng.NextU64();
+            bool bExisted = reference.count(key) != 0;
+            reference[key] = value;
+            if(action == 0)
+            {
+                U64* pValue = map.Insert(key, value);
+                numUpdateMismatches += *pValue != value ? 1 : 0;
+            }
+            else
+            {
+                // operator[] value initializes a new entry before it gets assigned
+                U64& mapValue = map[key];
+                numUpdateMismatches += (!bExisted && mapValue != 0) ? 1 : 0;
+                mapValue = value;
+            }
+        }
+        else if(action < 6)
+        {
+            bool bRemoved = map.Remove(key);
+            numUpdateMismatches += bRemoved != (reference.erase(key) != 0) ? 1 : 0;
+        }
+        else
+        {
+            U64* pValue = map.Find(key);
+            auto it = reference.find(key);
+            numFindMismatches += (it == reference.end()) != (pValue == nullptr) || (pValue != nullptr && *pValue != it->second) ? 1 : 0;
+            numFindMismatches += map.Contains(key) != (it != reference.end()) ? 1 : 0;
+        }
+
+        if(op % 1000 == 999)
+        {
+            numIterationMismatches += CheckHashMapMatches(map, reference) ? 0 : 1;
+        }
+    }
+
+    // every key that was ever possible, including ones that were removed, after the last operation
+    for(U64 key = 0; key < numKeys; key++)
+    {
+        U64* pValue = map.Find(key);
+        auto it = reference.find(key);
+        numFindMismatches += (it == reference.end()) != (pValue == nullptr) || (pValue != nullptr && *pValue != it->second) ? 1 : 0;
+    }
+
+    if(!SM_TEST_CHECK(numFindMismatches == 0 && numUpdateMismatches == 0 && numIterationMismatches == 0))
+    {
+        printf("    %s with %u keys: %u find, %u update and %u iteration mismatches\n", name, numKeys, numFindMismatches,
+               numUpdateMismatches, numIterationMismatches);
+    }
+
+    // removing everything has to leave an empty map that still works
+    for(U64 key = 0; key < numKeys; key++)
+    {
+        map.Remove(key);
+    }
+    SM_TEST_CHECK(map.IsEmpty() && !(map.begin() != map.end()));
+    map.Insert(numKeys, 1);
+    SM_TEST_CHECK(map.Find(numKeys) != nullptr && *map.Find(numKeys) == 1);
+    map.Clear();
+    SM_TEST_CHECK(map.IsEmpty() && map.Find(numKeys) == nullptr);
+}
+
+static void TestHashMap()
+{
+    static const U32 s_numKeys[] = { 12, 100, 4000 };
+
+    for(U32 numKeys : s_numKeys)
+    {
+        HashMap<U64, U64> map(GetBuiltInHeap());
+        StressHashMap(map, numKeys, "HashMap");
+    }
+
+    // clustered keys make every probe linear in the number of entries so these stay small
+    for(U32 numKeys : { 12u, 40u, 300u })
+    {
+        HashMap<U64, U64, EndClusterHash> map(GetBuiltInHeap());
+        StressHashMap(map, numKeys, "HashMap with end clustered hash");
+    }
+
+    LinearAllocator arena;
+    arena.InitVirtual(MiB(64));
+    {
+        HashMap<U64, U64, EndClusterHash> map(&arena, 200);
+        StressHashMap(map, 200, "HashMap on linear allocator with end clustered hash");
+    }
+    arena.Release();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// Queues
+//------------------------------------------------------------------------------------------------------------------------
+// Small queues keep them cycling between full and empty so the contended paths get hit constantly
+static const U32 kQueueStressCapacity = 64;
+static const U32 kQueueStressItems = 400000;
+static const U32 kQueueMaxStressThreads = 64;
+static const U32 kQueueStressMaxBatch = 16;
+
+// Items carry their producer in the high bits and a per producer sequence number in the low bits
+static U64 MakeStressItem(U32 producer, U32 sequence)
+{
+    return ((U64)producer << 32) | sequence;
+}
+
+static void StressSpscQueue(U32 batchSize)
+{
+    SpscQueue<U64> queue;
+    queue.Init(GetBuiltInHeap(), kQueueStressCapacity);
+
+    std::thread producer([&queue, batchSize]()
+    {
+        U64 items[kQueueStressMaxBatch];
+        U32 next = 0;
+        while(next < kQueueStressItems)
+        {
+            U32 numItems = 0;
+            while(numItems < batchSize && next + numItems < kQueueStressItems)
+            {
+                items[numItems] = MakeStressItem(0, next + numItems);
+                numItems++;
+            }
+
+            U32 numPushed = queue.PushBatch(items, numItems);
+            next += numPushed;
+            if(numPushed == 0)
+            {
+                Platform::YieldThread();
+            }
+        }
+    });
+
+    // a single consumer has to see every item exactly once and in push order
+    U32 numOutOfOrder = 0;
+    U32 expected = 0;
+    U64 items[kQueueStressMaxBatch];
+    while(expected < kQueueStressItems)
+    {
+        U32 numPopped = queue.PopBatch(items, batchSize);
+        for(U32 i = 0; i < numPopped; i++)
+        {
+            numOutOfOrder += items[i] != MakeStressItem(0, expected) ? 1 : 0;
+            expected++;
+        }
+        if(numPopped == 0)
+        {
+            Platform::YieldThread();
+        }
+    }
+    producer.join();
+
+    U64 leftover;
+    SM_TEST_CHECK(numOutOfOrder == 0);
+    SM_TEST_CHECK(!queue.Pop(&leftover));
+}
+
+static void StressMpmcQueue(U32 numProducers, U32 numConsumers, U32 batchSize)
+{
+    U32 itemsPerProducer = kQueueStressItems / numProducers;
+    U64 numItems = (U64)itemsPerProducer * numProducers;
+
+    HeapAllocator* pHeap = GetBuiltInHeap();
+    MpmcQueue<U64> queue;
+    queue.Init(pHeap, kQueueStressCapacity);
+
+    std::atomic<U8>* pTimesSeen = pHeap->Alloc<std::atomic<U8>>(numItems);
+    for(U64 i = 0; i < numItems; i++)
+    {
+        new (&pTimesSeen[i]) std::atomic<U8>(0);
+    }
+
+    std::atomic<U64> numConsumed = 0;
+    std::atomic<U32> numDuplicates = 0;
+    std::atomic<U32> numOutOfOrder = 0;
+
+    auto produce = [&](U32 producer)
+    {
+        U64 items[kQueueStressMaxBatch];
+        U32 next = 0;
+        while(next < itemsPerProducer)
+        {
+            U32 numBatchItems = 0;
+            while(numBatchItems < batchSize && next + numBatchItems < itemsPerProducer)
+            {
+                items[numBatchItems] = MakeStressItem(producer, next + numBatchItems);
+                numBatchItems++;
+            }
+
+            U32 numPushed = queue.PushBatch(items, numBatchItems);
+            next += numPushed;
+            if(numPushed == 0)
+            {
+                Platform::YieldThread();
+            }
+        }
+    };
+
+    // every consumer must see each producer's items in increasing order even though other consumers take some of them
+    auto consume = [&]()
+    {
+        U32 nextMinSequence[kQueueMaxStressThreads] = {};
+        U32 duplicates = 0;
+        U32 outOfOrder = 0;
+        U64 items[kQueueStressMaxBatch];
+        while(numConsumed.load(std::memory_order_relaxed) < numItems)
+        {
+            U32 numPopped = queue.PopBatch(items, batchSize);
+            for(U32 i = 0; i < numPopped; i++)
+            {
+                U32 producer = (U32)(items[i] >> 32);
+                U32 sequence = (U32)items[i];
+                outOfOrder += sequence < nextMinSequence[producer] ? 1 : 0;
+                nextMinSequence[producer] = sequence + 1;
+
+                U64 itemIndex = (U64)producer * itemsPerProducer + sequence;
+                duplicates += pTimesSeen[itemIndex].fetch_add(1) != 0 ? 1 : 0;
+            }
+
+            numConsumed += numPopped;
+            if(numPopped == 0)
+            {
+                Platform::YieldThread();
+            }
+        }
+
+        numDuplicates += duplicates;
+        numOutOfOrder += outOfOrder;
+    };
+
+    std::thread threads[kQueueMaxStressThreads * 2];
+    for(U32 i = 0; i < numProducers; i++)
+    {
+        threads[i] = std::thread(produce, i);
+    }
+    for(U32 i = 0; i < numConsumers; i++)
+    {
+        threads[numProducers + i] = std::thread(consume);
+    }
+    for(U32 i = 0; i < numProducers + numConsumers; i++)
+    {
+        threads[i].join();
+    }
+
+    U64 numMissing = 0;
+    for(U64 i = 0; i < numItems; i++)
+    {
+        numMissing += pTimesSeen[i].load() == 0 ? 1 : 0;
+    }
+
+    U64 leftover;
+    bool bPassed = SM_TEST_CHECK(numMissing == 0) &&
+                   SM_TEST_CHECK(numDuplicates.load() == 0) &&
+                   SM_TEST_CHECK(numOutOfOrder.load() == 0) &&
+                   SM_TEST_CHECK(numConsumed.load() == numItems) &&
+                   SM_TEST_CHECK(!queue.Pop(&leftover));
+    if(!bPassed)
+    {
+        printf("    MpmcQueue with %u producers, %u consumers, batch %u\n", numProducers, numConsumers, batchSize);
+    }
+
+    pHeap->Free(pTimesSeen);
+}
+
+static void TestQueues()
+{
+    static const U32 s_batchSizes[] = { 1, 7, kQueueStressMaxBatch };
+
+    for(U32 batchSize : s_batchSizes)
+    {
+        StressSpscQueue(batchSize);
+    }
+
+    U32 maxThreads = Min(GetTestMaxThreads(), kQueueMaxStressThreads);
+    for(U32 numProducers = 1; numProducers <= maxThreads; numProducers = GetNextTestThreadCount(numProducers))
+    {
+        for(U32 numConsumers = 1; numConsumers <= maxThreads; numConsumers = GetNextTestThreadCount(numConsumers))
+        {
+            for(U32 batchSize : s_batchSizes)
+            {
+                StressMpmcQueue(numProducers, numConsumers, batchSize);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// SlotMap
+//------------------------------------------------------------------------------------------------------------------------
+// Erasing and reusing a slot has to leave every handle to the erased item stale while the swapped back item keeps working
+template<typename Handle>
+static void TestSlotMapStaleHandles(const char* name)
+{
+    SlotMap<U32, Handle> map(GetBuiltInHeap());
+    Handle a = map.Insert(10);
+    Handle b = map.Insert(11);
+    Handle c = map.Insert(12);
+    SM_TEST_CHECK(Handle().IsNull() && !map.IsValid(Handle()) && map.Get(Handle()) == nullptr);
+
+    // c is swapped into b's dense position
+    SM_TEST_CHECK(map.Erase(a));
+    Handle d = map.Insert(13);
+    bool bPassed = SM_TEST_CHECK(d.GetIndex() == a.GetIndex() && d.GetGeneration() != a.GetGeneration());
+    bPassed &= SM_TEST_CHECK(!map.IsValid(a) && map.Get(a) == nullptr && !map.Erase(a));
+    bPassed &= SM_TEST_CHECK(map.Get(b) != nullptr && *map.Get(b) == 11);
+    bPassed &= SM_TEST_CHECK(map.Get(c) != nullptr && *map.Get(c) == 12);
+    bPassed &= SM_TEST_CHECK(map.Get(d) != nullptr && *map.Get(d) == 13);
+    bPassed &= SM_TEST_CHECK(map.GetCount() == 3);
+
+    // GetHandle on every dense index gives back the live handles
+    U32 numHandleMismatches = 0;
+    for(size_t i = 0; i < map.GetCount(); i++)
+    {
+        Handle handle = map.GetHandle(i);
+        numHandleMismatches += (handle != b && handle != c && handle != d) || map.Get(handle) != &map.begin()[i] ? 1 : 0;
+    }
+    bPassed &= SM_TEST_CHECK(numHandleMismatches == 0);
+
+    // a handle from outside the slot range is rejected rather than read past the end
+    bPassed &= SM_TEST_CHECK(!map.IsValid(Handle::Make(3, 1)));
+
+    map.Clear();
+    bPassed &= SM_TEST_CHECK(map.IsEmpty() && !map.IsValid(b) && !map.IsValid(c) && !map.IsValid(d));
+    Handle e = map.Insert(14);
+    bPassed &= SM_TEST_CHECK(!map.IsValid(b) && !map.IsValid(c) && !map.IsValid(d) && *map.Get(e) == 14);
+    if(!bPassed)
+    {
+        printf("    %s\n", name);
+    }
+}
+
+// Reusing one slot until its generation runs out retires the slot instead of wrapping back to a generation an old handle has
+static void TestSlotMapGenerationWrap()
+{
+    SlotMap<U32, SlotHandle32> map(GetBuiltInHeap());
+    SlotHandle32 first = map.Insert(0);
+    SlotHandle32 previous = first;
+    SM_TEST_CHECK(first.GetIndex() == 0 && first.GetGeneration() == 1);
+    SM_TEST_CHECK(map.Erase(first));
+
+    U32 numReuses = 0;
+    U32 numBadHandles = 0;
+    SlotHandle32 handle;
+    while(true)
+    {
+        handle = map.Insert(numReuses + 1);
+        if(handle.GetIndex() != 0)
+            break;
+
+        // generations climb by one and stay inside their 12 bits so the index is never disturbed
+        numBadHandles += (handle.GetGeneration() != previous.GetGeneration() + 1 || handle.IsNull() ||
+                          map.IsValid(previous) || map.IsValid(first) || *map.Get(handle) != numReuses + 1) ? 1 : 0;
+        previous = handle;
+        numReuses++;
+        map.Erase(handle);
+    }
+
+    bool bPassed = SM_TEST_CHECK(numBadHandles == 0);
+    bPassed &= SM_TEST_CHECK(previous.GetGeneration() == SlotHandle32::kMaxGeneration - 1);
+    bPassed &= SM_TEST_CHECK(numReuses == SlotHandle32::kMaxGeneration - 2);
+    bPassed &= SM_TEST_CHECK(handle.GetIndex() == 1 && handle.GetGeneration() == 1);
+
+    // no generation of the retired slot matches anymore, including the max that was never handed out
+    U32 numStaleMatches = 0;
+    for(U32 generation = 0; generation <= SlotHandle32::kMaxGeneration; generation++)
+    {
+        numStaleMatches += map.IsValid(SlotHandle32::Make(0, generation)) ? 1 : 0;
+    }
+    bPassed &= SM_TEST_CHECK(numStaleMatches == 0 && map.IsValid(handle) && map.GetCount() == 1);
+    if(!bPassed)
+    {
+        printf("    %u reuses, last generation %u, next handle index %u generation %u\n", numReuses, previous.GetGeneration(),
+               handle.GetIndex(), handle.GetGeneration());
+    }
+}
+
+static void TestSlotMap()
+{
+    TestSlotMapStaleHandles<SlotHandle64>("SlotHandle64");
+    TestSlotMapStaleHandles<SlotHandle32>("SlotHandle32");
+    TestSlotMapGenerationWrap();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// BitSet
+//------------------------------------------------------------------------------------------------------------------------
+// One summary bit covers a 64 bit word so bit 4096 is the first one under the second summary word
+static const U32 kBitSetBoundaryBits[] = { 0, 1, 62, 63, 64, 65, 127, 128, 4031, 4032, 4095, 4096, 4097, 4159, 4160, 8191, 8192 };
+
+// FindNextSet from every start index, ForEachSetBit and CountSetBits all have to agree with a plain bool per bit
+template<typename SetType>
+static bool CheckBitSetSearch(const SetType& set, const bool* pReference, U32 numBits)
+{
+    U32 numSearchMismatches = 0;
+    U32 expectedNext = kBitSetInvalidIndex;
+    U32 numExpectedSet = 0;
+    for(U32 i = numBits; i-- > 0;)
+    {
+        expectedNext = pReference[i] ? i : expectedNext;
+        numExpectedSet += pReference[i] ? 1 : 0;
+        numSearchMismatches += set.FindNextSet(i) != expectedNext ? 1 : 0;
+    }
+    numSearchMismatches += set.FindFirstSet() != expectedNext ? 1 : 0;
+    numSearchMismatches += set.FindNextSet(numBits) != kBitSetInvalidIndex ? 1 : 0;
+
+    // iteration has to be in increasing order and visit each set bit once
+    U32 numIterationMismatches = 0;
+    U32 numVisited = 0;
+    U32 lastVisited = 0;
+    set.ForEachSetBit([&](U32 index)
+    {
+        numIterationMismatches += (index >= numBits || !pReference[index] || (numVisited > 0 && index <= lastVisited)) ? 1 : 0;
+        lastVisited = index;
+        numVisited++;
+    });
+
+    bool bPassed = SM_TEST_CHECK(numSearchMismatches == 0);
+    bPassed &= SM_TEST_CHECK(numIterationMismatches == 0 && numVisited == numExpectedSet);
+    bPassed &= SM_TEST_CHECK(set.CountSetBits() == numExpectedSet);
+    return bPassed;
+}
+
+template<typename SetType>
+static void StressBitSetSearch(SetType& set, U32 numBits, const char* name)
+{
+    LinearAllocator arena;
+    arena.InitVirtual(MiB(1));
+    bool* pReference = arena.Alloc<bool>(numBits);
+    ::memset(pReference, 0, numBits);
+
+    auto setBit = [&](U32 index, bool bSet)
+    {
+        pReference[index] = bSet;
+        if(bSet)
+        {
+            set.Set(index);
+        }
+        else
+        {
+            set.UnSet(index);
+        }
+    };
+
+    bool bPassed = CheckBitSetSearch(set, pReference, numBits);
+
+    // single bits on either side of word and summary word boundaries, each alone and then all together
+    for(U32 boundary : kBitSetBoundaryBits)
+    {
+        if(boundary >= numBits)
+            continue;
+
+        setBit(boundary, true);
+        bPassed &= CheckBitSetSearch(set, pReference, numBits);
+        setBit(boundary, false);
+    }
+    for(U32 boundary : kBitSetBoundaryBits)
+    {
+        if(boundary < numBits)
+        {
+            setBit(boundary, true);
+        }
+    }
+    setBit(numBits - 1, true);
+    bPassed &= CheckBitSetSearch(set, pReference, numBits);
+
+    // sparse and dense random fills, then unsetting most bits again so words and summary bits go back to empty
+    Rng rng(numBits);
+    for(U32 oneIn : { 300u, 2u })
+    {
+        for(U32 i = 0; i < numBits; i++)
+        {
+            setBit(i, rng.NextU32(oneIn) == 0);
+        }
+        bPassed &= CheckBitSetSearch(set, pReference, numBits);
+
+        for(U32 i = 0; i < numBits; i++)
+        {
+            if(rng.NextU32(8) != 0)
+            {
+                setBit(i, false);
+            }
+        }
+        bPassed &= CheckBitSetSearch(set, pReference, numBits);
+    }
+
+    set.SetAll();
+    ::memset(pReference, 1, numBits);
+    bPassed &= CheckBitSetSearch(set, pReference, numBits);
+
+    set.ClearAll();
+    ::memset(pReference, 0, numBits);
+    bPassed &= CheckBitSetSearch(set, pReference, numBits);
+
+    if(!bPassed)
+    {
+        printf("    %s with %u bits\n", name, numBits);
+    }
+    arena.Release();
+}
+
+static void TestBitSets()
+{
+    static const U32 s_numBits[] = { 1, 63, 64, 65, 4096, 4097, 9000 };
+
+    for(U32 numBits : s_numBits)
+    {
+        BitSet set(GetBuiltInHeap(), numBits);
+        StressBitSetSearch(set, numBits, "BitSet");
+
+        HierarchicalBitSet hierarchicalSet(GetBuiltInHeap(), numBits);
+        StressBitSetSearch(hierarchicalSet, numBits, "HierarchicalBitSet");
+    }
+
+    FixedBitSet<4097> fixedSet;
+    StressBitSetSearch(fixedSet, 4097, "FixedBitSet");
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// BucketArray
+//------------------------------------------------------------------------------------------------------------------------
+static const U32 kBucketArrayTestNumItems = 1000;
+
+// Counts live instances so Remove and Clear can be checked for running destructors exactly once
+struct BucketTestItem
+{
+    BucketTestItem(U32 value) :m_value(value) { s_numLive++; }
+    BucketTestItem(const BucketTestItem& other) :m_value(other.m_value) { s_numLive++; }
+    ~BucketTestItem() { s_numLive--; }
+
+    U32 m_value;
+    static inline I32 s_numLive = 0;
+};
+
+template<U32 CHUNK_SIZE>
+static void TestBucketArraySize()
+{
+    LinearAllocator arena;
+    arena.InitVirtual(MiB(16));
+    BucketTestItem** pPointers = arena.Alloc<BucketTestItem*>(kBucketArrayTestNumItems);
+    U32* pIndices = arena.Alloc<U32>(kBucketArrayTestNumItems);
+    bool* pRemoved = arena.Alloc<bool>(kBucketArrayTestNumItems);
+    ::memset(pRemoved, 0, kBucketArrayTestNumItems);
+
+    U32 numMoved = 0;
+    U32 numBadIndices = 0;
+    {
+        BucketArray<BucketTestItem, CHUNK_SIZE> items(GetBuiltInHeap());
+        for(U32 i = 0; i < kBucketArrayTestNumItems; i++)
+        {
+            pPointers[i] = items.Add(BucketTestItem(i), &pIndices[i]);
+        }
+        size_t numChunks = items.m_chunks.m_numItems;
+
+        // growing the chunk table many times over must not have moved any item
+        auto checkItems = [&]()
+        {
+            for(U32 i = 0; i < kBucketArrayTestNumItems; i++)
+            {
+                if(pRemoved[i])
+                {
+                    numBadIndices += items.IsValidIndex(pIndices[i]) ? 1 : 0;
+                    continue;
+                }
+
+                numMoved += pPointers[i]->m_value != i ? 1 : 0;
+                numBadIndices += (!items.IsValidIndex(pIndices[i]) || &items[pIndices[i]] != pPointers[i] ||
+                                  items.FindIndex(pPointers[i]) != pIndices[i]) ? 1 : 0;
+            }
+        };
+        checkItems();
+        SM_TEST_CHECK(numChunks == (kBucketArrayTestNumItems + CHUNK_SIZE - 1) / CHUNK_SIZE);
+        SM_TEST_CHECK(!items.IsValidIndex((U32)numChunks * CHUNK_SIZE) && !items.IsValidIndex(0xffffffff));
+        SM_TEST_CHECK(numChunks * CHUNK_SIZE == kBucketArrayTestNumItems || !items.IsValidIndex(kBucketArrayTestNumItems));
+
+        // remove a random half, alternating between removal by index and by pointer
+        Rng rng(CHUNK_SIZE);
+        U32 numRemoved = 0;
+        for(U32 i = 0; i < kBucketArrayTestNumItems; i++)
+        {
+            if(rng.NextU32(2) == 0)
+                continue;
+
+            if(numRemoved % 2 == 0)
+            {
+                items.Remove(pIndices[i]);
+            }
+            else
+            {
+                items.Remove(pPointers[i]);
+            }
+            pRemoved[i] = true;
+            numRemoved++;
+        }
+        checkItems();
+        SM_TEST_CHECK(items.GetCount() == kBucketArrayTestNumItems - numRemoved);
+        SM_TEST_CHECK(BucketTestItem::s_numLive == (I32)(kBucketArrayTestNumItems - numRemoved));
+
+        // iteration only visits the items that are left
+        U32 numVisited = 0;
+        U32 numVisitedRemoved = 0;
+        items.ForEach([&](BucketTestItem& item)
+        {
+            numVisitedRemoved += pRemoved[item.m_value] ? 1 : 0;
+            numVisited++;
+        });
+        SM_TEST_CHECK(numVisited == items.GetCount() && numVisitedRemoved == 0);
+
+        // adding back fills the holes without new chunks and without disturbing the items that stayed
+        for(U32 i = 0; i < kBucketArrayTestNumItems; i++)
+        {
+            if(pRemoved[i])
+            {
+                pPointers[i] = items.Add(BucketTestItem(i), &pIndices[i]);
+                pRemoved[i] = false;
+            }
+        }
+        checkItems();
+        SM_TEST_CHECK(items.m_chunks.m_numItems == numChunks && items.GetCount() == kBucketArrayTestNumItems);
+
+        items.Clear();
+        SM_TEST_CHECK(items.IsEmpty() && BucketTestItem::s_numLive == 0 && !items.IsValidIndex(pIndices[0]));
+        pPointers[0] = items.Add(BucketTestItem(0), &pIndices[0]);
+        SM_TEST_CHECK(pIndices[0] == 0 && items.IsValidIndex(0) && items[0].m_value == 0);
+    }
+    SM_TEST_CHECK(BucketTestItem::s_numLive == 0);
+
+    if(!SM_TEST_CHECK(numMoved == 0 && numBadIndices == 0))
+    {
+        printf("    BucketArray with %u item chunks: %u moved items, %u bad indices\n", CHUNK_SIZE, numMoved, numBadIndices);
+    }
+    arena.Release();
+}
+
+static void TestBucketArray()
+{
+    TestBucketArraySize<1>();
+    TestBucketArraySize<7>();
+    TestBucketArraySize<64>();
+    TestBucketArraySize<100>();
+}
+
+void RunContainerTests()
+{
+    TestHashMap();
+    TestQueues();
+    TestSlotMap();
+    TestBitSets();
+    TestBucketArray();
+}
@@ -0,0 +1,347 @@
+#include "SM/Bvh.h"
+#include "SM/Geometry.h"
+#include "SM/MathBatch.h"
+#include "SM/Memory.h"
+#include "SM/Random.h"
+#include "SM/Simd.h"
+#include "Tests/Bench.h"
+
+#include <cmath>
+
+using namespace SM;
+
+//------------------------------------------------------------------------------------------------------------------------
+// Bvh
+//------------------------------------------------------------------------------------------------------------------------
+// Heightfield terrain, kBvhBenchGridSize^2 quads split into two triangles each for 2M triangles
+static const U32 kBvhBenchGridSize = 1000;
+static const U32 kBvhBenchImageSize = 1000;
+static const U32 kBvhBenchRays = kBvhBenchImageSize * kBvhBenchImageSize;
+
+struct BenchMesh
+{
+    Vec3* m_pPositions = nullptr;
+    U32* m_pIndices = nullptr;
+    U32 m_numTriangles = 0;
+};
+
+static BenchMesh MakeBenchTerrain(LinearAllocator& arena)
+{
+    const U32 numVertsPerSide = kBvhBenchGridSize + 1;
+
+    BenchMesh mesh;
+    mesh.m_numTriangles = kBvhBenchGridSize * kBvhBenchGridSize * 2;
+    mesh.m_pPositions = arena.Alloc<Vec3>(numVertsPerSide * numVertsPerSide);
+    mesh.m_pIndices = arena.Alloc<U32>(mesh.m_numTriangles * 3);
+
+    Rng rng(21);
+    for(U32 y = 0; y < numVertsPerSide; y++)
+    {
+        for(U32 x = 0; x < numVertsPerSide; x++)
+        {
+            F32 height = 20.0f * ::sinf((F32)x * 0.02f) * ::cosf((F32)y * 0.03f) + rng.NextF32(0.0f, 2.0f);
+            mesh.m_pPositions[y * numVertsPerSide + x] = Vec3((F32)x, (F32)y, height);
+        }
+    }
+
+    U32* pIndex = mesh.m_pIndices;
+    for(U32 y = 0; y < kBvhBenchGridSize; y++)
+    {
+        for(U32 x = 0; x < kBvhBenchGridSize; x++)
+        {
+            U32 corner = y * numVertsPerSide + x;
+            U32 above = corner + numVertsPerSide;
+            pIndex[0] = corner;
+            pIndex[1] = corner + 1;
+            pIndex[2] = above + 1;
+            pIndex[3] = corner;
+            pIndex[4] = above + 1;
+            pIndex[5] = above;
+            pIndex += 6;
+        }
+    }
+    return mesh;
+}
+
+struct BenchRays
+{
+    Vec3* m_pOrigins = nullptr;
+    Vec3* m_pDirs = nullptr;
+};
+
+// One ray per pixel of a camera looking over the terrain, cast in scanline order like primary rays
+static BenchRays MakeCameraRays(LinearAllocator& arena)
+{
+    Vec3 eye((F32)kBvhBenchGridSize * 0.5f, -100.0f, 150.0f);
+    Vec3 forward = (Vec3((F32)kBvhBenchGridSize * 0.5f, (F32)kBvhBenchGridSize * 0.5f, 0.0f) - eye).GetNormalized();
+    Vec3 right = Cross(forward, Vec3::kWorldUp).GetNormalized();
+    Vec3 up = Cross(right, forward);
+
+    BenchRays rays;
+    rays.m_pOrigins = arena.Alloc<Vec3>(kBvhBenchRays);
+    rays.m_pDirs = arena.Alloc<Vec3>(kBvhBenchRays);
+    for(U32 y = 0; y < kBvhBenchImageSize; y++)
+    {
+        for(U32 x = 0; x < kBvhBenchImageSize; x++)
+        {
+            F32 u = ((F32)x + 0.5f) / (F32)kBvhBenchImageSize * 2.0f - 1.0f;
+            F32 v = 1.0f - ((F32)y + 0.5f) / (F32)kBvhBenchImageSize * 2.0f;
+            U32 i = y * kBvhBenchImageSize + x;
+            rays.m_pOrigins[i] = eye;
+            rays.m_pDirs[i] = (forward + right * u + up * v).GetNormalized();
+        }
+    }
+    return rays;
+}
+
+// Random origins just above the surface and random directions, many rays graze the terrain or escape it
+static BenchRays MakeIncoherentRays(LinearAllocator& arena, Rng& rng)
+{
+    BenchRays rays;
+    rays.m_pOrigins = arena.Alloc<Vec3>(kBvhBenchRays);
+    rays.m_pDirs = arena.Alloc<Vec3>(kBvhBenchRays);
+    for(U32 i = 0; i < kBvhBenchRays; i++)
+    {
+        rays.m_pOrigins[i] = Vec3(rng.NextF32(0.0f, (F32)kBvhBenchGridSize), rng.NextF32(0.0f, (F32)kBvhBenchGridSize), rng.NextF32(25.0f, 40.0f));
+        rays.m_pDirs[i] = Vec3(rng.NextF32(-1.0f, 1.0f), rng.NextF32(-1.0f, 1.0f), rng.NextF32(-1.0f, 1.0f)).GetNormalized();
+    }
+    return rays;
+}
+
+template<typename Tree>
+static F64 BenchRayCastMs(const Tree& tree, const BenchMesh& mesh, const BenchRays& rays)
+{
+    return BenchMinMs([&]()
+    {
+        U32 numHits = 0;
+        for(U32 i = 0; i < kBvhBenchRays; i++)
+        {
+            F32 maxT = 2000.0f;
+            numHits += tree.RayCastTriangles(mesh.m_pPositions, mesh.m_pIndices, rays.m_pOrigins[i], rays.m_pDirs[i], maxT) != kBvhInvalidIndex ? 1 : 0;
+        }
+        BenchKeep(numHits);
+    }, 3);
+}
+
+static void BenchBvh()
+{
+    LinearAllocator arena;
+    arena.InitVirtual(GiB(1));
+    LinearAllocator scratch;
+    scratch.InitVirtual(GiB(4));
+
+    BenchMesh mesh = MakeBenchTerrain(arena);
+    Bvh bvh(GetBuiltInHeap());
+    Bvh4 bvh4(GetBuiltInHeap());
+
+    char label[96];
+    snprintf(label, sizeof(label), "Bvh build, %u triangle terrain", mesh.m_numTriangles);
+    BenchHeader(label);
+    for(U32 numThreads = 1; numThreads <= GetBenchMaxThreads(); numThreads = GetNextBenchThreadCount(numThreads))
+    {
+        F64 buildMs = BenchMinMs([&]() { bvh.BuildFromTriangles(mesh.m_pPositions, mesh.m_pIndices, mesh.m_numTriangles, &scratch, numThreads); }, 3);
+        snprintf(label, sizeof(label), "Bvh::BuildFromTriangles, %u threads", numThreads);
+        BenchReport(label, buildMs, mesh.m_numTriangles);
+    }
+    F64 collapseMs = BenchMinMs([&]() { bvh4.Build(bvh); }, 3);
+    BenchReport("Bvh4::Build from the binary tree", collapseMs, mesh.m_numTriangles);
+
+    Rng rng(21);
+    BenchRays cameraRays = MakeCameraRays(arena);
+    BenchRays incoherentRays = MakeIncoherentRays(arena, rng);
+
+    BenchHeader("Bvh ray casts, closest hit, items are rays");
+    BenchReport("Bvh::RayCastTriangles, camera", BenchRayCastMs(bvh, mesh, cameraRays), kBvhBenchRays);
+    BenchReport("Bvh4::RayCastTriangles, camera", BenchRayCastMs(bvh4, mesh, cameraRays), kBvhBenchRays);
+    BenchReport("Bvh::RayCastTriangles, incoherent", BenchRayCastMs(bvh, mesh, incoherentRays), kBvhBenchRays);
+    BenchReport("Bvh4::RayCastTriangles, incoherent", BenchRayCastMs(bvh4, mesh, incoherentRays), kBvhBenchRays);
+
+    scratch.Release();
+    arena.Release();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// Batch kernels
+//------------------------------------------------------------------------------------------------------------------------
+// Every shape against one ray or query shape per call, a few queries per timing. Shapes fit in L2 so this measures the
+// math rather than memory.
+static const U32 kKernelBenchShapes = 16 * 1024;
+static const U32 kKernelBenchQueries = 16;
+static const U32 kKernelBenchItems = kKernelBenchShapes * kKernelBenchQueries;
+
+static Vec3 MakeKernelBenchVec3(Rng& rng, F32 low, F32 high)
+{
+    return Vec3(rng.NextF32(low, high), rng.NextF32(low, high), rng.NextF32(low, high));
+}
+
+static Vec3SoA AllocKernelBenchVec3s(LinearAllocator& arena)
+{
+    Vec3SoA vecs;
+    vecs.m_pX = arena.Alloc<F32>(kKernelBenchShapes);
+    vecs.m_pY = arena.Alloc<F32>(kKernelBenchShapes);
+    vecs.m_pZ = arena.Alloc<F32>(kKernelBenchShapes);
+    return vecs;
+}
+
+static void StoreKernelBenchVec3(const Vec3SoA& vecs, U32 i, const Vec3& v)
+{
+    vecs.m_pX[i] = v.x;
+    vecs.m_pY[i] = v.y;
+    vecs.m_pZ[i] = v.z;
+}
+
+// The scalar loop over Geometry.h first, then the batch version at every supported simd level
+template<typename ScalarFunc, typename BatchFunc>
+static void BenchKernel(const char* name, ScalarFunc scalarFunc, BatchFunc batchFunc)
+{
+    char label[96];
+    snprintf(label, sizeof(label), "%s, scalar loop", name);
+    BenchReport(label, BenchMinMs([&]() { for(U32 query = 0; query < kKernelBenchQueries; query++) scalarFunc(query); }), kKernelBenchItems);
+
+    SimdLevel supportedLevel = GetSupportedSimdLevel();
+    for(U32 level = kSimdLevelScalar; level <= (U32)supportedLevel; level++)
+    {
+        SetSimdLevel((SimdLevel)level);
+        snprintf(label, sizeof(label), "%s, %s", name, GetSimdLevelName((SimdLevel)level));
+        BenchReport(label, BenchMinMs([&]() { for(U32 query = 0; query < kKernelBenchQueries; query++) batchFunc(query); }), kKernelBenchItems);
+    }
+    SetSimdLevel(supportedLevel);
+}
+
+static void BenchGeometryKernels()
+{
+    LinearAllocator arena;
+    arena.InitVirtual(MiB(64));
+    Rng rng(25);
+
+    // shapes packed into a 40 unit cube so queries hit a fair share of them
+    Sphere* pSpheres = arena.Alloc<Sphere>(kKernelBenchShapes);
+    Aabb* pAabbs = arena.Alloc<Aabb>(kKernelBenchShapes);
+    Obb* pObbs = arena.Alloc<Obb>(kKernelBenchShapes);
+    Triangle* pTriangles = arena.Alloc<Triangle>(kKernelBenchShapes);
+    Vec3SoA sphereCenters = AllocKernelBenchVec3s(arena);
+    SphereSoA spheres = { sphereCenters.m_pX, sphereCenters.m_pY, sphereCenters.m_pZ, arena.Alloc<F32>(kKernelBenchShapes) };
+    Vec3SoA aabbCenters = AllocKernelBenchVec3s(arena);
+    Vec3SoA aabbExtents = AllocKernelBenchVec3s(arena);
+    AabbSoA aabbs = { aabbCenters.m_pX, aabbCenters.m_pY, aabbCenters.m_pZ, aabbExtents.m_pX, aabbExtents.m_pY, aabbExtents.m_pZ };
+    Vec3SoA obbCenters = AllocKernelBenchVec3s(arena);
+    Vec3SoA obbExtents = AllocKernelBenchVec3s(arena);
+    ObbSoA obbs;
+    obbs.m_pCenterX = obbCenters.m_pX;
+    obbs.m_pCenterY = obbCenters.m_pY;
+    obbs.m_pCenterZ = obbCenters.m_pZ;
+    obbs.m_pExtentX = obbExtents.m_pX;
+    obbs.m_pExtentY = obbExtents.m_pY;
+    obbs.m_pExtentZ = obbExtents.m_pZ;
+    for(U32 axis = 0; axis < 9; axis++)
+    {
+        obbs.m_pAxes[axis] = arena.Alloc<F32>(kKernelBenchShapes);
+    }
+    TriangleSoA triangles = { AllocKernelBenchVec3s(arena), AllocKernelBenchVec3s(arena), AllocKernelBenchVec3s(arena) };
+
+    for(U32 i = 0; i < kKernelBenchShapes; i++)
+    {
+        pSpheres[i].m_center = MakeKernelBenchVec3(rng, -20.0f, 20.0f);
+        pSpheres[i].m_radius = rng.NextF32(0.5f, 2.0f);
+        StoreKernelBenchVec3(sphereCenters, i, pSpheres[i].m_center);
+        spheres.m_pRadius[i] = pSpheres[i].m_radius;
+
+        pAabbs[i].m_center = MakeKernelBenchVec3(rng, -20.0f, 20.0f);
+        pAabbs[i].m_extents = MakeKernelBenchVec3(rng, 0.5f, 2.0f);
+        StoreKernelBenchVec3(aabbCenters, i, pAabbs[i].m_center);
+        StoreKernelBenchVec3(aabbExtents, i, pAabbs[i].m_extents);
+
+        Vec3 axis = MakeKernelBenchVec3(rng, -1.0f, 1.0f) + Vec3(0.0f, 0.0f, 2.0f);
+        Aabb local = Aabb::CreateFromMinMax(Vec3(0.0f, 0.0f, 0.0f), MakeKernelBenchVec3(rng, 1.0f, 4.0f));
+        pObbs[i] = Obb::CreateFromAabb(local, Mat44::CreateRotationAroundAxisDegs(axis.GetNormalized(), rng.NextF32(-180.0f, 180.0f)));
+        pObbs[i].m_center = MakeKernelBenchVec3(rng, -20.0f, 20.0f);
+        StoreKernelBenchVec3(obbCenters, i, pObbs[i].m_center);
+        StoreKernelBenchVec3(obbExtents, i, pObbs[i].m_extents);
+        for(U32 element = 0; element < 9; element++)
+        {
+            obbs.m_pAxes[element][i] = pObbs[i].m_axes[element / 3][element % 3];
+        }
+
+        pTriangles[i].m_v0 = MakeKernelBenchVec3(rng, -20.0f, 20.0f);
+        pTriangles[i].m_v1 = pTriangles[i].m_v0 + MakeKernelBenchVec3(rng, -3.0f, 3.0f);
+        pTriangles[i].m_v2 = pTriangles[i].m_v0 + MakeKernelBenchVec3(rng, -3.0f, 3.0f);
+        StoreKernelBenchVec3(triangles.m_v0, i, pTriangles[i].m_v0);
+        StoreKernelBenchVec3(triangles.m_v1, i, pTriangles[i].m_v1);
+        StoreKernelBenchVec3(triangles.m_v2, i, pTriangles[i].m_v2);
+    }
+
+    Ray rays[kKernelBenchQueries];
+    Sphere querySpheres[kKernelBenchQueries];
+    Aabb queryAabbs[kKernelBenchQueries];
+    Obb queryObbs[kKernelBenchQueries];
+    for(U32 query = 0; query < kKernelBenchQueries; query++)
+    {
+        rays[query].m_origin = MakeKernelBenchVec3(rng, -40.0f, 40.0f);
+        rays[query].m_dir = (MakeKernelBenchVec3(rng, -10.0f, 10.0f) - rays[query].m_origin).GetNormalized();
+        querySpheres[query] = pSpheres[query];
+        queryAabbs[query] = pAabbs[query];
+        queryObbs[query] = pObbs[query];
+    }
+
+    const F32 maxT = 1000.0f;
+    F32* pOutT = arena.Alloc<F32>(kKernelBenchShapes);
+    BitSet overlapping(&arena, kKernelBenchShapes);
+
+    // the scalar loops store the same outputs as the batch versions
+    auto castScalar = [&](auto intersect)
+    {
+        return [&, intersect](U32 query)
+        {
+            for(U32 i = 0; i < kKernelBenchShapes; i++)
+            {
+                F32 t = maxT;
+                pOutT[i] = intersect(rays[query], i, t) ? t : INFINITY;
+            }
+            BenchKeep(pOutT[0]);
+        };
+    };
+    auto overlapScalar = [&](auto overlap)
+    {
+        return [&, overlap](U32 query)
+        {
+            for(U32 i = 0; i < kKernelBenchShapes; i++)
+            {
+                if(overlap(query, i))
+                {
+                    overlapping.Set(i);
+                }
+                else
+                {
+                    overlapping.UnSet(i);
+                }
+            }
+            BenchKeep(overlapping.GetNumWords());
+        };
+    };
+
+    char label[96];
+    snprintf(label, sizeof(label), "Geometry batch kernels, %u shapes x %u queries", kKernelBenchShapes, kKernelBenchQueries);
+    BenchHeader(label);
+    BenchKernel("IntersectRayAabbs", castScalar([&](const Ray& ray, U32 i, F32& t) { return IntersectRayAabb(ray, pAabbs[i], t); }),
+                [&](U32 query) { IntersectRayAabbs(rays[query], aabbs, maxT, pOutT, kKernelBenchShapes); BenchKeep(pOutT[0]); });
+    BenchKernel("IntersectRaySpheres", castScalar([&](const Ray& ray, U32 i, F32& t) { return IntersectRaySphere(ray, pSpheres[i], t); }),
+                [&](U32 query) { IntersectRaySpheres(rays[query], spheres, maxT, pOutT, kKernelBenchShapes); BenchKeep(pOutT[0]); });
+    BenchKernel("IntersectRayTriangles", castScalar([&](const Ray& ray, U32 i, F32& t) { return IntersectRayTriangle(ray, pTriangles[i], t); }),
+                [&](U32 query) { IntersectRayTriangles(rays[query], triangles, maxT, pOutT, kKernelBenchShapes); BenchKeep(pOutT[0]); });
+    BenchKernel("OverlapSphereSpheres", overlapScalar([&](U32 query, U32 i) { return OverlapSphereSphere(querySpheres[query], pSpheres[i]); }),
+                [&](U32 query) { OverlapSphereSpheres(querySpheres[query], spheres, kKernelBenchShapes, overlapping); });
+    BenchKernel("OverlapSphereAabbs", overlapScalar([&](U32 query, U32 i) { return OverlapSphereAabb(querySpheres[query], pAabbs[i]); }),
+                [&](U32 query) { OverlapSphereAabbs(querySpheres[query], aabbs, kKernelBenchShapes, overlapping); });
+    BenchKernel("OverlapAabbAabbs", overlapScalar([&](U32 query, U32 i) { return OverlapAabbAabb(queryAabbs[query], pAabbs[i]); }),
+                [&](U32 query) { OverlapAabbAabbs(queryAabbs[query], aabbs, kKernelBenchShapes, overlapping); });
+    BenchKernel("OverlapObbObbs", overlapScalar([&](U32 query, U32 i) { return OverlapObbObb(queryObbs[query], pObbs[i]); }),
+                [&](U32 query) { OverlapObbObbs(queryObbs[query], obbs, kKernelBenchShapes, overlapping); });
+
+    arena.Release();
+}
+
+void RunGeometryBenchmarks()
+{
+    BenchGeometryKernels();
+    BenchBvh();
+}
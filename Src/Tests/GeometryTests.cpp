@@ -0,0 +1,704 @@
+#include "SM/Bvh.h"
+#include "SM/Geometry.h"
+#include "SM/MathBatch.h"
+#include "SM/Memory.h"
+#include "SM/Random.h"
+#include "SM/Simd.h"
+#include "Tests/Test.h"
+
+#include <cmath>
+#include <cstring>
+
+using namespace SM;
+
+//------------------------------------------------------------------------------------------------------------------------
+// Scalar tests
+//------------------------------------------------------------------------------------------------------------------------
+static Ray MakeRay(const Vec3& origin, const Vec3& dir)
+{
+    Ray ray;
+    ray.m_origin = origin;
+    ray.m_dir = dir;
+    return ray;
+}
+
+static Aabb MakeAabb(const Vec3& center, const Vec3& extents)
+{
+    Aabb aabb;
+    aabb.m_center = center;
+    aabb.m_extents = extents;
+    return aabb;
+}
+
+static Sphere MakeSphere(const Vec3& center, F32 radius)
+{
+    Sphere sphere;
+    sphere.m_center = center;
+    sphere.m_radius = radius;
+    return sphere;
+}
+
+// Returns the hit distance, or -1 on a miss after checking a miss left maxT alone
+static F32 CastRayAabb(const Ray& ray, const Aabb& aabb, F32 maxT = 100.0f)
+{
+    F32 t = maxT;
+    if(IntersectRayAabb(ray, aabb, t))
+        return t;
+
+    SM_TEST_CHECK(t == maxT);
+    return -1.0f;
+}
+
+static F32 CastRayTriangle(const Ray& ray, const Vec3& v0, const Vec3& v1, const Vec3& v2, F32 maxT = 100.0f)
+{
+    F32 t = maxT;
+    if(IntersectRayTriangle(ray.m_origin, ray.m_dir, v0, v1, v2, t))
+        return t;
+
+    SM_TEST_CHECK(t == maxT);
+    return -1.0f;
+}
+
+static void TestRayAabb()
+{
+    const Aabb box = MakeAabb(Vec3(0.0f, 0.0f, 0.0f), Vec3(1.0f, 1.0f, 1.0f));
+    SM_TEST_CHECK(CastRayAabb(MakeRay(Vec3(-5.0f, 0.0f, 0.0f), Vec3(1.0f, 0.0f, 0.0f)), box) == 4.0f);
+    SM_TEST_CHECK(CastRayAabb(MakeRay(Vec3(0.0f, 0.0f, 6.0f), Vec3(0.0f, 0.0f, -2.0f)), box) == 2.5f);
+    SM_TEST_CHECK(CastRayAabb(MakeRay(Vec3(-5.0f, 2.0f, 0.0f), Vec3(1.0f, 0.0f, 0.0f)), box) == -1.0f);
+    SM_TEST_CHECK(CastRayAabb(MakeRay(Vec3(-5.0f, -5.0f, 0.0f), Vec3(1.0f, 1.0f, 0.0f)), box) == 4.0f);
+    SM_TEST_CHECK(CastRayAabb(MakeRay(Vec3(-5.0f, -4.0f, 0.0f), Vec3(1.0f, 1.0f, 0.0f)), box) == 4.0f);
+    SM_TEST_CHECK(CastRayAabb(MakeRay(Vec3(-5.0f, -2.5f, 0.0f), Vec3(1.0f, 1.0f, 0.0f)), box) == -1.0f);
+
+    // grazing a face and running along an edge both hit, with the zero direction components on the slab boundary
+    SM_TEST_CHECK(CastRayAabb(MakeRay(Vec3(-5.0f, 1.0f, 0.0f), Vec3(1.0f, 0.0f, 0.0f)), box) == 4.0f);
+    SM_TEST_CHECK(CastRayAabb(MakeRay(Vec3(-5.0f, 1.0f, -1.0f), Vec3(1.0f, 0.0f, 0.0f)), box) == 4.0f);
+
+    // inside hits at 0, behind the origin and past maxT miss
+    SM_TEST_CHECK(CastRayAabb(MakeRay(Vec3(0.5f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f)), box) == 0.0f);
+    SM_TEST_CHECK(CastRayAabb(MakeRay(Vec3(5.0f, 0.0f, 0.0f), Vec3(1.0f, 0.0f, 0.0f)), box) == -1.0f);
+    SM_TEST_CHECK(CastRayAabb(MakeRay(Vec3(-5.0f, 0.0f, 0.0f), Vec3(1.0f, 0.0f, 0.0f)), box, 3.0f) == -1.0f);
+}
+
+static void TestRayTriangle()
+{
+    const Vec3 v0(0.0f, 0.0f, 0.0f);
+    const Vec3 v1(1.0f, 0.0f, 0.0f);
+    const Vec3 v2(0.0f, 1.0f, 0.0f);
+    SM_TEST_CHECK(CastRayTriangle(MakeRay(Vec3(0.25f, 0.25f, 5.0f), Vec3(0.0f, 0.0f, -1.0f)), v0, v1, v2) == 5.0f);
+    SM_TEST_CHECK(CastRayTriangle(MakeRay(Vec3(0.25f, 0.25f, 5.0f), Vec3(0.0f, 0.0f, -4.0f)), v0, v1, v2) == 1.25f);
+
+    // the back face hits too
+    SM_TEST_CHECK(CastRayTriangle(MakeRay(Vec3(0.25f, 0.25f, -5.0f), Vec3(0.0f, 0.0f, 1.0f)), v0, v1, v2) == 5.0f);
+
+    // on the edges and corners counts, just outside does not
+    SM_TEST_CHECK(CastRayTriangle(MakeRay(Vec3(0.5f, 0.5f, 1.0f), Vec3(0.0f, 0.0f, -1.0f)), v0, v1, v2) == 1.0f);
+    SM_TEST_CHECK(CastRayTriangle(MakeRay(Vec3(0.0f, 0.5f, 1.0f), Vec3(0.0f, 0.0f, -1.0f)), v0, v1, v2) == 1.0f);
+    SM_TEST_CHECK(CastRayTriangle(MakeRay(Vec3(0.0f, 0.0f, 1.0f), Vec3(0.0f, 0.0f, -1.0f)), v0, v1, v2) == 1.0f);
+    SM_TEST_CHECK(CastRayTriangle(MakeRay(Vec3(0.5f, 0.51f, 1.0f), Vec3(0.0f, 0.0f, -1.0f)), v0, v1, v2) == -1.0f);
+    SM_TEST_CHECK(CastRayTriangle(MakeRay(Vec3(-0.01f, 0.5f, 1.0f), Vec3(0.0f, 0.0f, -1.0f)), v0, v1, v2) == -1.0f);
+
+    // behind the origin, past maxT, parallel to the plane and degenerate triangles miss
+    SM_TEST_CHECK(CastRayTriangle(MakeRay(Vec3(0.25f, 0.25f, -5.0f), Vec3(0.0f, 0.0f, -1.0f)), v0, v1, v2) == -1.0f);
+    SM_TEST_CHECK(CastRayTriangle(MakeRay(Vec3(0.25f, 0.25f, 5.0f), Vec3(0.0f, 0.0f, -1.0f)), v0, v1, v2, 4.0f) == -1.0f);
+    SM_TEST_CHECK(CastRayTriangle(MakeRay(Vec3(-1.0f, 0.25f, 0.0f), Vec3(1.0f, 0.0f, 0.0f)), v0, v1, v2) == -1.0f);
+    SM_TEST_CHECK(CastRayTriangle(MakeRay(Vec3(0.25f, 0.0f, 5.0f), Vec3(0.0f, 0.0f, -1.0f)), v0, v1, Vec3(2.0f, 0.0f, 0.0f)) == -1.0f);
+    SM_TEST_CHECK(CastRayTriangle(MakeRay(Vec3(0.0f, 0.0f, 5.0f), Vec3(0.0f, 0.0f, -1.0f)), v0, v0, v0) == -1.0f);
+}
+
+// The parallel cutoff is relative to the triangle's size so tiny triangles hit like big ones
+static void TestRayTriangleScale()
+{
+    const F32 scales[] = { 1e-4f, 1e-2f, 1e2f, 1e4f };
+    for(F32 scale : scales)
+    {
+        const Vec3 v0(10.0f, 10.0f, 0.0f);
+        const Vec3 v1 = v0 + Vec3(scale, 0.0f, 0.0f);
+        const Vec3 v2 = v0 + Vec3(0.0f, scale, 0.0f);
+        const Vec3 center = v0 + Vec3(scale * 0.25f, scale * 0.25f, 0.0f);
+
+        F32 hitT = CastRayTriangle(MakeRay(center + Vec3(0.0f, 0.0f, 2.0f), Vec3(0.0f, 0.0f, -1.0f)), v0, v1, v2);
+        F32 slantedHitT = CastRayTriangle(MakeRay(center + Vec3(-1.0f, 0.0f, 2.0f), Vec3(0.5f, 0.0f, -1.0f)), v0, v1, v2);
+        F32 parallelT = CastRayTriangle(MakeRay(center + Vec3(-1.0f, 0.0f, 0.0f), Vec3(1.0f, 0.0f, 0.0f)), v0, v1, v2);
+
+        bool bPassed = SM_TEST_CHECK(::fabsf(hitT - 2.0f) <= 1e-6f) &&
+                       SM_TEST_CHECK(::fabsf(slantedHitT - 2.0f) <= 1e-6f) &&
+                       SM_TEST_CHECK(parallelT == -1.0f);
+        if(!bPassed)
+        {
+            printf("    IntersectRayTriangle, edges of %g: hit %g, slanted hit %g, parallel %g\n", scale, hitT, slantedHitT, parallelT);
+        }
+    }
+}
+
+static void TestOverlapSphereAabb()
+{
+    const Aabb box = MakeAabb(Vec3(1.0f, 2.0f, 3.0f), Vec3(1.0f, 1.0f, 1.0f));
+    SM_TEST_CHECK(OverlapSphereAabb(MakeSphere(Vec3(1.0f, 2.0f, 3.0f), 0.1f), box));
+    SM_TEST_CHECK(OverlapSphereAabb(MakeSphere(Vec3(1.0f, 2.0f, 3.0f), 10.0f), box));
+    SM_TEST_CHECK(OverlapSphereAabb(MakeSphere(Vec3(3.0f, 2.0f, 3.0f), 1.0f), box));
+    SM_TEST_CHECK(!OverlapSphereAabb(MakeSphere(Vec3(3.5f, 2.0f, 3.0f), 1.0f), box));
+
+    // a sphere off a corner is further away than it is along any one axis, 3 * 0.25^2 = 0.1875
+    SM_TEST_CHECK(OverlapSphereAabb(MakeSphere(Vec3(2.25f, 3.25f, 4.25f), 0.44f), box));
+    SM_TEST_CHECK(!OverlapSphereAabb(MakeSphere(Vec3(2.25f, 3.25f, 4.25f), 0.43f), box));
+}
+
+static Obb MakeObb(const Vec3& center, const Vec3& extents, const Mat44& rotation)
+{
+    Aabb aabb = MakeAabb(Vec3(0.0f, 0.0f, 0.0f), extents);
+    Obb obb = Obb::CreateFromAabb(aabb, rotation);
+    obb.m_center = center;
+    return obb;
+}
+
+static void TestOverlapObbObb()
+{
+    const Obb unit = MakeObb(Vec3(0.0f, 0.0f, 0.0f), Vec3(1.0f, 1.0f, 1.0f), Mat44::kIdentity);
+
+    // parallel boxes, touching faces overlap
+    SM_TEST_CHECK(OverlapObbObb(unit, MakeObb(Vec3(2.0f, 0.0f, 0.0f), Vec3(1.0f, 1.0f, 1.0f), Mat44::kIdentity)));
+    SM_TEST_CHECK(OverlapObbObb(unit, MakeObb(Vec3(2.0f, 2.0f, 2.0f), Vec3(1.0f, 1.0f, 1.0f), Mat44::kIdentity)));
+    SM_TEST_CHECK(!OverlapObbObb(unit, MakeObb(Vec3(2.01f, 0.0f, 0.0f), Vec3(1.0f, 1.0f, 1.0f), Mat44::kIdentity)));
+    SM_TEST_CHECK(OverlapObbObb(unit, MakeObb(Vec3(0.2f, 0.1f, 0.0f), Vec3(0.1f, 0.1f, 0.1f), Mat44::kIdentity)));
+
+    // turned 45 degrees about z a unit box reaches sqrt(2) along x
+    const Mat44 turnZ = Mat44::CreateRotationZDegs(45.0f);
+    SM_TEST_CHECK(OverlapObbObb(unit, MakeObb(Vec3(2.4f, 0.0f, 0.0f), Vec3(1.0f, 1.0f, 1.0f), turnZ)));
+    SM_TEST_CHECK(!OverlapObbObb(unit, MakeObb(Vec3(2.45f, 0.0f, 0.0f), Vec3(1.0f, 1.0f, 1.0f), turnZ)));
+    SM_TEST_CHECK(!OverlapObbObb(MakeObb(Vec3(2.45f, 0.0f, 0.0f), Vec3(1.0f, 1.0f, 1.0f), turnZ), unit));
+
+    // Two thin rods crossing like an X, each turned 45 degrees about its own length so their cross sections are
+    // diamonds reaching 0.1 * sqrt(2) = 0.1414 along z. Every face axis overlaps, only x cross y can separate them.
+    const Vec3 rodExtentsX(2.0f, 0.1f, 0.1f);
+    const Vec3 rodExtentsY(0.1f, 2.0f, 0.1f);
+    const Obb rodX = MakeObb(Vec3(0.0f, 0.0f, 0.0f), rodExtentsX, Mat44::CreateRotationXDegs(45.0f));
+    SM_TEST_CHECK(OverlapObbObb(rodX, MakeObb(Vec3(0.0f, 0.0f, 0.25f), rodExtentsY, Mat44::CreateRotationYDegs(45.0f))));
+    SM_TEST_CHECK(!OverlapObbObb(rodX, MakeObb(Vec3(0.0f, 0.0f, 0.3f), rodExtentsY, Mat44::CreateRotationYDegs(45.0f))));
+    SM_TEST_CHECK(!OverlapObbObb(MakeObb(Vec3(0.0f, 0.0f, 0.3f), rodExtentsY, Mat44::CreateRotationYDegs(45.0f)), rodX));
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// Batch vs scalar
+//------------------------------------------------------------------------------------------------------------------------
+// Odd so every width leaves a tail for the scalar kernel
+static const U32 kGeometryTestBatchCount = 1003;
+static const U32 kGeometryTestRays = 16;
+
+static Vec3 MakeTestVec3(Rng& rng, F32 low, F32 high)
+{
+    return Vec3(rng.NextF32(low, high), rng.NextF32(low, high), rng.NextF32(low, high));
+}
+
+static Mat44 MakeTestRotation(Rng& rng)
+{
+    Vec3 axis = Vec3(rng.NextF32(-1.0f, 1.0f), rng.NextF32(-1.0f, 1.0f), rng.NextF32(0.5f, 1.0f)).GetNormalized();
+    return Mat44::CreateRotationAroundAxisDegs(axis, rng.NextF32(-180.0f, 180.0f));
+}
+
+static Vec3SoA AllocVec3SoA(LinearAllocator& arena, U32 count)
+{
+    Vec3SoA vecs;
+    vecs.m_pX = arena.Alloc<F32>(count);
+    vecs.m_pY = arena.Alloc<F32>(count);
+    vecs.m_pZ = arena.Alloc<F32>(count);
+    return vecs;
+}
+
+static void StoreVec3(const Vec3SoA& vecs, U32 i, const Vec3& v)
+{
+    vecs.m_pX[i] = v.x;
+    vecs.m_pY[i] = v.y;
+    vecs.m_pZ[i] = v.z;
+}
+
+// The same shapes in both layouts. Triangles span sizes from 1e-4 to 100 and a few are degenerate.
+struct GeometryTestShapes
+{
+    Sphere* m_pSpheres = nullptr;
+    Aabb* m_pAabbs = nullptr;
+    Obb* m_pObbs = nullptr;
+    Triangle* m_pTriangles = nullptr;
+    SphereSoA m_sphereSoA;
+    AabbSoA m_aabbSoA;
+    ObbSoA m_obbSoA;
+    TriangleSoA m_triangleSoA;
+};
+
+static GeometryTestShapes MakeGeometryTestShapes(LinearAllocator& arena, Rng& rng)
+{
+    const U32 count = kGeometryTestBatchCount;
+    GeometryTestShapes shapes;
+    shapes.m_pSpheres = arena.Alloc<Sphere>(count);
+    shapes.m_pAabbs = arena.Alloc<Aabb>(count);
+    shapes.m_pObbs = arena.Alloc<Obb>(count);
+    shapes.m_pTriangles = arena.Alloc<Triangle>(count);
+
+    Vec3SoA sphereCenters = AllocVec3SoA(arena, count);
+    shapes.m_sphereSoA = { sphereCenters.m_pX, sphereCenters.m_pY, sphereCenters.m_pZ, arena.Alloc<F32>(count) };
+    Vec3SoA aabbCenters = AllocVec3SoA(arena, count);
+    Vec3SoA aabbExtents = AllocVec3SoA(arena, count);
+    shapes.m_aabbSoA = { aabbCenters.m_pX, aabbCenters.m_pY, aabbCenters.m_pZ, aabbExtents.m_pX, aabbExtents.m_pY, aabbExtents.m_pZ };
+    Vec3SoA obbCenters = AllocVec3SoA(arena, count);
+    Vec3SoA obbExtents = AllocVec3SoA(arena, count);
+    shapes.m_obbSoA.m_pCenterX = obbCenters.m_pX;
+    shapes.m_obbSoA.m_pCenterY = obbCenters.m_pY;
+    shapes.m_obbSoA.m_pCenterZ = obbCenters.m_pZ;
+    shapes.m_obbSoA.m_pExtentX = obbExtents.m_pX;
+    shapes.m_obbSoA.m_pExtentY = obbExtents.m_pY;
+    shapes.m_obbSoA.m_pExtentZ = obbExtents.m_pZ;
+    for(U32 axis = 0; axis < 9; axis++)
+    {
+        shapes.m_obbSoA.m_pAxes[axis] = arena.Alloc<F32>(count);
+    }
+    shapes.m_triangleSoA = { AllocVec3SoA(arena, count), AllocVec3SoA(arena, count), AllocVec3SoA(arena, count) };
+
+    for(U32 i = 0; i < count; i++)
+    {
+        Sphere& sphere = shapes.m_pSpheres[i];
+        sphere = MakeSphere(MakeTestVec3(rng, -10.0f, 10.0f), rng.NextF32(0.1f, 3.0f));
+        StoreVec3(sphereCenters, i, sphere.m_center);
+        shapes.m_sphereSoA.m_pRadius[i] = sphere.m_radius;
+
+        Aabb& aabb = shapes.m_pAabbs[i];
+        aabb = MakeAabb(MakeTestVec3(rng, -10.0f, 10.0f), MakeTestVec3(rng, 0.1f, 3.0f));
+        StoreVec3(aabbCenters, i, aabb.m_center);
+        StoreVec3(aabbExtents, i, aabb.m_extents);
+
+        Obb& obb = shapes.m_pObbs[i];
+        obb = MakeObb(MakeTestVec3(rng, -6.0f, 6.0f), MakeTestVec3(rng, 0.1f, 3.0f), MakeTestRotation(rng));
+        StoreVec3(obbCenters, i, obb.m_center);
+        StoreVec3(obbExtents, i, obb.m_extents);
+        for(U32 axis = 0; axis < 9; axis++)
+        {
+            shapes.m_obbSoA.m_pAxes[axis][i] = obb.m_axes[axis / 3][axis % 3];
+        }
+
+        Triangle& triangle = shapes.m_pTriangles[i];
+        F32 size = ::powf(10.0f, rng.NextF32(-4.0f, 2.0f));
+        triangle.m_v0 = MakeTestVec3(rng, -10.0f, 10.0f);
+        triangle.m_v1 = triangle.m_v0 + MakeTestVec3(rng, -size, size);
+        triangle.m_v2 = (i % 50 == 0) ? triangle.m_v1 : triangle.m_v0 + MakeTestVec3(rng, -size, size);
+        StoreVec3(shapes.m_triangleSoA.m_v0, i, triangle.m_v0);
+        StoreVec3(shapes.m_triangleSoA.m_v1, i, triangle.m_v1);
+        StoreVec3(shapes.m_triangleSoA.m_v2, i, triangle.m_v2);
+    }
+    return shapes;
+}
+
+// Rays from outside the shapes towards random points among them, so both hits and misses are common
+static Ray MakeTestRay(Rng& rng)
+{
+    Vec3 origin = MakeTestVec3(rng, -30.0f, 30.0f);
+    Vec3 target = MakeTestVec3(rng, -5.0f, 5.0f);
+    return MakeRay(origin, (target - origin) * rng.NextF32(0.1f, 2.0f));
+}
+
+static bool IsSameBits(F32 a, F32 b)
+{
+    return ::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+template<typename ScalarFunc>
+static U32 CountRayMismatches(const F32* pOutT, F32 maxT, ScalarFunc scalarFunc)
+{
+    U32 numMismatches = 0;
+    for(U32 i = 0; i < kGeometryTestBatchCount; i++)
+    {
+        F32 t = maxT;
+        F32 expected = scalarFunc(i, t) ? t : INFINITY;
+        numMismatches += IsSameBits(pOutT[i], expected) ? 0 : 1;
+    }
+    return numMismatches;
+}
+
+template<typename ScalarFunc>
+static U32 CountOverlapMismatches(const BitSet& overlapping, ScalarFunc scalarFunc)
+{
+    U32 numMismatches = 0;
+    for(U32 i = 0; i < kGeometryTestBatchCount; i++)
+    {
+        numMismatches += overlapping.IsSet(i) == scalarFunc(i) ? 0 : 1;
+    }
+    return numMismatches;
+}
+
+static void CheckBatchMismatches(const char* name, U32 numMismatches, SimdLevel level)
+{
+    if(!SM_TEST_CHECK(numMismatches == 0))
+    {
+        printf("    %s at %s: %u of %u differ from the scalar test\n", name, GetSimdLevelName(level), numMismatches, kGeometryTestBatchCount);
+    }
+}
+
+static void TestGeometryBatches()
+{
+    LinearAllocator arena;
+    arena.InitVirtual(MiB(16));
+    Rng rng(25);
+    GeometryTestShapes shapes = MakeGeometryTestShapes(arena, rng);
+    F32* pOutT = arena.Alloc<F32>(kGeometryTestBatchCount);
+    BitSet overlapping(&arena, kGeometryTestBatchCount);
+
+    SimdLevel supportedLevel = GetSupportedSimdLevel();
+    for(U32 levelIndex = kSimdLevelScalar; levelIndex <= (U32)supportedLevel; levelIndex++)
+    {
+        SimdLevel level = (SimdLevel)levelIndex;
+        SetSimdLevel(level);
+
+        U32 numRayAabbMismatches = 0;
+        U32 numRaySphereMismatches = 0;
+        U32 numRayTriangleMismatches = 0;
+        Rng rayRng(25);
+        for(U32 rayIndex = 0; rayIndex < kGeometryTestRays; rayIndex++)
+        {
+            Ray ray = MakeTestRay(rayRng);
+            F32 maxT = rayIndex % 2 == 0 ? 1000.0f : rayRng.NextF32(0.5f, 1.5f);
+
+            // some rays run along the top face of a box so the parallel slab paths see origins exactly on a plane
+            if(rayIndex % 4 == 3)
+            {
+                const Aabb& face = shapes.m_pAabbs[rayIndex];
+                ray.m_origin.y = face.m_center.y + face.m_extents.y;
+                ray.m_dir.y = 0.0f;
+            }
+
+            IntersectRayAabbs(ray, shapes.m_aabbSoA, maxT, pOutT, kGeometryTestBatchCount);
+            numRayAabbMismatches += CountRayMismatches(pOutT, maxT, [&](U32 i, F32& t) { return IntersectRayAabb(ray, shapes.m_pAabbs[i], t); });
+
+            IntersectRaySpheres(ray, shapes.m_sphereSoA, maxT, pOutT, kGeometryTestBatchCount);
+            numRaySphereMismatches += CountRayMismatches(pOutT, maxT, [&](U32 i, F32& t) { return IntersectRaySphere(ray, shapes.m_pSpheres[i], t); });
+
+            // aimed at a triangle so the small ones get hit too
+            const Triangle& target = shapes.m_pTriangles[rayRng.NextU32() % kGeometryTestBatchCount];
+            ray.m_dir = (target.m_v0 + target.m_v1 + target.m_v2) * (1.0f / 3.0f) - ray.m_origin;
+            IntersectRayTriangles(ray, shapes.m_triangleSoA, maxT, pOutT, kGeometryTestBatchCount);
+            numRayTriangleMismatches += CountRayMismatches(pOutT, maxT, [&](U32 i, F32& t) { return IntersectRayTriangle(ray, shapes.m_pTriangles[i], t); });
+        }
+        CheckBatchMismatches("IntersectRayAabbs", numRayAabbMismatches, level);
+        CheckBatchMismatches("IntersectRaySpheres", numRaySphereMismatches, level);
+        CheckBatchMismatches("IntersectRayTriangles", numRayTriangleMismatches, level);
+
+        const Sphere& sphere = shapes.m_pSpheres[0];
+        OverlapSphereSpheres(sphere, shapes.m_sphereSoA, kGeometryTestBatchCount, overlapping);
+        CheckBatchMismatches("OverlapSphereSpheres", CountOverlapMismatches(overlapping, [&](U32 i) { return OverlapSphereSphere(sphere, shapes.m_pSpheres[i]); }), level);
+        OverlapSphereAabbs(sphere, shapes.m_aabbSoA, kGeometryTestBatchCount, overlapping);
+        CheckBatchMismatches("OverlapSphereAabbs", CountOverlapMismatches(overlapping, [&](U32 i) { return OverlapSphereAabb(sphere, shapes.m_pAabbs[i]); }), level);
+
+        const Aabb& aabb = shapes.m_pAabbs[0];
+        OverlapAabbAabbs(aabb, shapes.m_aabbSoA, kGeometryTestBatchCount, overlapping);
+        CheckBatchMismatches("OverlapAabbAabbs", CountOverlapMismatches(overlapping, [&](U32 i) { return OverlapAabbAabb(aabb, shapes.m_pAabbs[i]); }), level);
+
+        const Obb& obb = shapes.m_pObbs[0];
+        OverlapObbObbs(obb, shapes.m_obbSoA, kGeometryTestBatchCount, overlapping);
+        CheckBatchMismatches("OverlapObbObbs", CountOverlapMismatches(overlapping, [&](U32 i) { return OverlapObbObb(obb, shapes.m_pObbs[i]); }), level);
+    }
+    SetSimdLevel(supportedLevel);
+    arena.Release();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// Bvh
+//------------------------------------------------------------------------------------------------------------------------
+// Past twice the parallel build cutoff in Bvh.cpp so the first two levels split over threads
+static const U32 kBvhTestNumTriangles = 40000;
+static const U32 kBvhTestNumRays = 300;
+static const U32 kBvhTestNumQueries = 100;
+
+// kBvhMaxLeafPrims in Bvh.cpp, the builder splits every bigger node even when no split is cheaper
+static const U32 kBvhTestMaxLeafPrims = 16;
+
+struct BvhTestPrims
+{
+    Vec3* m_pMins = nullptr;
+    Vec3* m_pMaxs = nullptr;
+    U32 m_numPrims = 0;
+};
+
+// Every primitive sits in exactly one leaf and every box holds the boxes below it
+static bool CheckBvhStructure(const char* name, const Bvh& bvh, const BvhTestPrims& prims, LinearAllocator& arena)
+{
+    size_t restoreAllocatedBytes = arena.m_allocatedBytes;
+    U32* pNumSeen = arena.Alloc<U32>(prims.m_numPrims);
+    ::memset(pNumSeen, 0, sizeof(U32) * prims.m_numPrims);
+
+    auto contains = [](const BvhNode& node, const Vec3& boundsMin, const Vec3& boundsMax) {
+        return node.m_boundsMin.x <= boundsMin.x && node.m_boundsMin.y <= boundsMin.y && node.m_boundsMin.z <= boundsMin.z &&
+               node.m_boundsMax.x >= boundsMax.x && node.m_boundsMax.y >= boundsMax.y && node.m_boundsMax.z >= boundsMax.z;
+    };
+
+    U32 numBadBounds = 0;
+    U32 numBadPrims = 0;
+    U32 maxLeafPrims = 0;
+    for(size_t nodeIndex = 0; nodeIndex < bvh.m_nodes.m_numItems; nodeIndex++)
+    {
+        const BvhNode& node = bvh.m_nodes[nodeIndex];
+        if(node.IsLeaf())
+        {
+            maxLeafPrims = Max(maxLeafPrims, node.m_numPrims);
+            for(U32 i = 0; i < node.m_numPrims; i++)
+            {
+                U32 primIndex = bvh.m_primIndices[node.m_firstChildOrPrim + i];
+                if(primIndex >= prims.m_numPrims)
+                {
+                    numBadPrims++;
+                    continue;
+                }
+                pNumSeen[primIndex]++;
+                numBadBounds += contains(node, prims.m_pMins[primIndex], prims.m_pMaxs[primIndex]) ? 0 : 1;
+            }
+        }
+        else
+        {
+            for(U32 child = node.m_firstChildOrPrim; child < node.m_firstChildOrPrim + 2; child++)
+            {
+                numBadBounds += contains(node, bvh.m_nodes[child].m_boundsMin, bvh.m_nodes[child].m_boundsMax) ? 0 : 1;
+            }
+        }
+    }
+    for(U32 i = 0; i < prims.m_numPrims; i++)
+    {
+        numBadPrims += pNumSeen[i] == 1 ? 0 : 1;
+    }
+
+    bool bPassed = SM_TEST_CHECK(numBadBounds == 0 && numBadPrims == 0 && maxLeafPrims <= kBvhTestMaxLeafPrims);
+    bPassed &= SM_TEST_CHECK(bvh.m_primIndices.m_numItems == prims.m_numPrims);
+    if(!bPassed)
+    {
+        printf("    %s: %u boxes not holding their contents, %u primitives not in exactly one leaf, %u in the biggest leaf\n", name,
+               numBadBounds, numBadPrims, maxLeafPrims);
+    }
+
+    arena.m_allocatedBytes = restoreAllocatedBytes;
+    return bPassed;
+}
+
+// Rays, spheres and boxes against a brute force loop over every primitive. Ties at the same distance may pick either
+// primitive, so a closest hit matches when the distance is identical and the returned primitive really hits there.
+// intersectPrim(primIndex, origin, dir, inOutMaxT) follows the Bvh::RayCast callback contract.
+template<typename IntersectFunc>
+static bool CheckBvhQueries(const char* name, const Bvh& bvh, const Bvh4& bvh4, const BvhTestPrims& prims, IntersectFunc intersectPrim,
+                            LinearAllocator& arena)
+{
+    size_t restoreAllocatedBytes = arena.m_allocatedBytes;
+    U32* pNumReported = arena.Alloc<U32>(prims.m_numPrims);
+    ::memset(pNumReported, 0, sizeof(U32) * prims.m_numPrims);
+
+    U32 numRayMismatches = 0;
+    U32 numAnyMismatches = 0;
+    U32 numBvh4Mismatches = 0;
+    U32 numHits = 0;
+    Rng rng(21);
+    for(U32 rayIndex = 0; rayIndex < kBvhTestNumRays; rayIndex++)
+    {
+        // most rays are aimed at a primitive so hits are common, short ones stop before the target half of the time
+        Vec3 origin = MakeTestVec3(rng, -80.0f, 80.0f);
+        U32 target = rng.NextU32(prims.m_numPrims);
+        Vec3 targetPoint = rayIndex % 4 == 3 ? MakeTestVec3(rng, -60.0f, 60.0f) : (prims.m_pMins[target] + prims.m_pMaxs[target]) * 0.5f;
+        Vec3 dir = targetPoint - origin;
+        F32 maxT = rayIndex % 2 == 0 ? 1000.0f : rng.NextF32(0.5f, 1.5f);
+
+        F32 expectedT = maxT;
+        U32 expectedPrim = kBvhInvalidIndex;
+        for(U32 i = 0; i < prims.m_numPrims; i++)
+        {
+            expectedPrim = intersectPrim(i, origin, dir, expectedT) ? i : expectedPrim;
+        }
+        numHits += expectedPrim != kBvhInvalidIndex ? 1 : 0;
+
+        auto isClosestHit = [&](U32 hitPrim, F32 t) {
+            if(hitPrim == kBvhInvalidIndex || expectedPrim == kBvhInvalidIndex)
+                return hitPrim == expectedPrim && t == maxT;
+
+            F32 primT = maxT;
+            return hitPrim < prims.m_numPrims && t == expectedT && intersectPrim(hitPrim, origin, dir, primT) && primT == expectedT;
+        };
+        auto intersect = [&](U32 primIndex, F32& inOutMaxT) { return intersectPrim(primIndex, origin, dir, inOutMaxT); };
+
+        F32 t = maxT;
+        U32 hitPrim = bvh.RayCast(origin, dir, t, intersect);
+        numRayMismatches += isClosestHit(hitPrim, t) ? 0 : 1;
+        numAnyMismatches += bvh.RayCastAny(origin, dir, maxT, intersect) == (expectedPrim != kBvhInvalidIndex) ? 0 : 1;
+
+        F32 t4 = maxT;
+        U32 hitPrim4 = bvh4.RayCast(origin, dir, t4, intersect);
+        numBvh4Mismatches += isClosestHit(hitPrim4, t4) && t4 == t ? 0 : 1;
+        numBvh4Mismatches += bvh4.RayCastAny(origin, dir, maxT, intersect) == (expectedPrim != kBvhInvalidIndex) ? 0 : 1;
+    }
+
+    // queries report whole leaves, so everything touching the shape must come back exactly once and the rest at most once
+    U32 numQueryMismatches = 0;
+    auto countReported = [&](auto isTouching) {
+        for(U32 i = 0; i < prims.m_numPrims; i++)
+        {
+            numQueryMismatches += (pNumReported[i] > 1 || (pNumReported[i] == 0 && isTouching(i))) ? 1 : 0;
+            pNumReported[i] = 0;
+        }
+    };
+    auto report = [&](U32 primIndex) {
+        if(primIndex < prims.m_numPrims)
+            pNumReported[primIndex]++;
+        else
+            numQueryMismatches++;
+    };
+    for(U32 queryIndex = 0; queryIndex < kBvhTestNumQueries; queryIndex++)
+    {
+        Vec3 center = MakeTestVec3(rng, -60.0f, 60.0f);
+        F32 radius = rng.NextF32(0.0f, 15.0f);
+        bvh.QuerySphere(center, radius, report);
+        countReported([&](U32 i) {
+            F32 dx = Max(Max(prims.m_pMins[i].x - center.x, center.x - prims.m_pMaxs[i].x), 0.0f);
+            F32 dy = Max(Max(prims.m_pMins[i].y - center.y, center.y - prims.m_pMaxs[i].y), 0.0f);
+            F32 dz = Max(Max(prims.m_pMins[i].z - center.z, center.z - prims.m_pMaxs[i].z), 0.0f);
+            return (dx * dx) + (dy * dy) + (dz * dz) <= radius * radius;
+        });
+
+        Vec3 extents = MakeTestVec3(rng, 0.0f, 15.0f);
+        Vec3 boundsMin = center - extents;
+        Vec3 boundsMax = center + extents;
+        bvh.QueryAabb(boundsMin, boundsMax, report);
+        countReported([&](U32 i) {
+            return prims.m_pMins[i].x <= boundsMax.x && prims.m_pMaxs[i].x >= boundsMin.x &&
+                   prims.m_pMins[i].y <= boundsMax.y && prims.m_pMaxs[i].y >= boundsMin.y &&
+                   prims.m_pMins[i].z <= boundsMax.z && prims.m_pMaxs[i].z >= boundsMin.z;
+        });
+    }
+
+    bool bPassed = SM_TEST_CHECK(numRayMismatches == 0 && numAnyMismatches == 0 && numBvh4Mismatches == 0 && numQueryMismatches == 0);
+    if(!bPassed)
+    {
+        printf("    %s: %u RayCast, %u RayCastAny, %u Bvh4 and %u query mismatches, %u of %u rays hit\n", name, numRayMismatches,
+               numAnyMismatches, numBvh4Mismatches, numQueryMismatches, numHits, kBvhTestNumRays);
+    }
+
+    arena.m_allocatedBytes = restoreAllocatedBytes;
+    return bPassed;
+}
+
+static void TestBvhTriangles()
+{
+    LinearAllocator arena;
+    arena.InitVirtual(MiB(64));
+    LinearAllocator scratch;
+    scratch.InitVirtual(MiB(64));
+
+    // small triangles scattered through a box, indexed so BuildFromTriangles has to follow the indices
+    Vec3* pPositions = arena.Alloc<Vec3>(kBvhTestNumTriangles * 3);
+    U32* pIndices = arena.Alloc<U32>(kBvhTestNumTriangles * 3);
+    BvhTestPrims prims;
+    prims.m_pMins = arena.Alloc<Vec3>(kBvhTestNumTriangles);
+    prims.m_pMaxs = arena.Alloc<Vec3>(kBvhTestNumTriangles);
+    Rng rng(21);
+    for(U32 i = 0; i < kBvhTestNumTriangles * 3; i += 3)
+    {
+        Vec3 center = MakeTestVec3(rng, -50.0f, 50.0f);
+        for(U32 corner = 0; corner < 3; corner++)
+        {
+            pPositions[i + corner] = center + MakeTestVec3(rng, -1.5f, 1.5f);
+            pIndices[i + corner] = kBvhTestNumTriangles * 3 - 1 - (i + corner);
+        }
+    }
+
+    auto intersectTriangle = [&](U32 triangle, const Vec3& origin, const Vec3& dir, F32& inOutMaxT) {
+        return IntersectRayTriangle(origin, dir, pPositions[pIndices[triangle * 3 + 0]], pPositions[pIndices[triangle * 3 + 1]],
+                                    pPositions[pIndices[triangle * 3 + 2]], inOutMaxT);
+    };
+
+    Bvh bvh(GetBuiltInHeap());
+    Bvh4 bvh4(GetBuiltInHeap());
+    for(U32 numPrims : { 1u, kBvhTestNumTriangles })
+    {
+        prims.m_numPrims = numPrims;
+        for(U32 i = 0; i < numPrims; i++)
+        {
+            const Vec3& v0 = pPositions[pIndices[i * 3 + 0]];
+            const Vec3& v1 = pPositions[pIndices[i * 3 + 1]];
+            const Vec3& v2 = pPositions[pIndices[i * 3 + 2]];
+            prims.m_pMins[i] = Vec3(Min(Min(v0.x, v1.x), v2.x), Min(Min(v0.y, v1.y), v2.y), Min(Min(v0.z, v1.z), v2.z));
+            prims.m_pMaxs[i] = Vec3(Max(Max(v0.x, v1.x), v2.x), Max(Max(v0.y, v1.y), v2.y), Max(Max(v0.z, v1.z), v2.z));
+        }
+
+        // a lone triangle is the root leaf and Bvh4 keeps it without any node
+        U32 maxThreads = numPrims == 1 ? 1 : GetTestMaxThreads();
+        for(U32 numThreads = 1; numThreads <= maxThreads; numThreads = GetNextTestThreadCount(numThreads))
+        {
+            bvh.BuildFromTriangles(pPositions, pIndices, numPrims, &scratch, numThreads);
+            bvh4.Build(bvh);
+            SM_TEST_CHECK(scratch.m_allocatedBytes == 0);
+
+            char name[64];
+            snprintf(name, sizeof(name), "%u triangles, %u build threads", numPrims, numThreads);
+            CheckBvhStructure(name, bvh, prims, arena);
+            CheckBvhQueries(name, bvh, bvh4, prims, intersectTriangle, arena);
+
+            // RayCastTriangles is the same walk with the triangle test built in
+            Vec3 origin(0.0f, 0.0f, -100.0f);
+            Vec3 dir = (prims.m_pMins[0] + prims.m_pMaxs[0]) * 0.5f - origin;
+            F32 t = 1000.0f;
+            F32 t4 = 1000.0f;
+            U32 hitPrim = bvh.RayCastTriangles(pPositions, pIndices, origin, dir, t);
+            SM_TEST_CHECK(hitPrim != kBvhInvalidIndex && bvh4.RayCastTriangles(pPositions, pIndices, origin, dir, t4) == hitPrim && t4 == t);
+        }
+        SM_TEST_CHECK(numPrims > 1 || (bvh.m_nodes.m_numItems == 1 && bvh4.IsEmpty() && bvh4.m_rootNumPrims == 1));
+    }
+
+    // an empty tree hits and reports nothing
+    bvh.Build(nullptr, nullptr, 0, &scratch);
+    bvh4.Build(bvh);
+    F32 t = 1000.0f;
+    U32 numReported = 0;
+    bvh.QuerySphere(Vec3::kZero, 1000.0f, [&](U32) { numReported++; });
+    SM_TEST_CHECK(bvh.IsEmpty() && bvh.RayCastTriangles(pPositions, pIndices, Vec3::kZero, Vec3(1.0f, 0.0f, 0.0f), t) == kBvhInvalidIndex);
+    SM_TEST_CHECK(bvh4.RayCastTriangles(pPositions, pIndices, Vec3::kZero, Vec3(1.0f, 0.0f, 0.0f), t) == kBvhInvalidIndex && numReported == 0);
+
+    scratch.Release();
+    arena.Release();
+}
+
+// Boxes all centered on the origin leave SAH binning nothing to split on, the builder still has to keep leaves small
+static void TestBvhSameCentroids()
+{
+    const U32 kNumBoxes = 1000;
+    LinearAllocator arena;
+    arena.InitVirtual(MiB(16));
+    LinearAllocator scratch;
+    scratch.InitVirtual(MiB(16));
+
+    BvhTestPrims prims;
+    prims.m_pMins = arena.Alloc<Vec3>(kNumBoxes);
+    prims.m_pMaxs = arena.Alloc<Vec3>(kNumBoxes);
+    prims.m_numPrims = kNumBoxes;
+    Rng rng(21);
+    for(U32 i = 0; i < kNumBoxes; i++)
+    {
+        // every tenth box is a copy of the one before so some are identical as well
+        Vec3 extents = i % 10 == 9 ? prims.m_pMaxs[i - 1] : MakeTestVec3(rng, 0.5f, 40.0f);
+        prims.m_pMins[i] = -extents;
+        prims.m_pMaxs[i] = extents;
+    }
+
+    auto intersectBox = [&](U32 box, const Vec3& origin, const Vec3& dir, F32& inOutMaxT) {
+        return IntersectRayAabb(MakeRay(origin, dir), MakeAabb(Vec3::kZero, prims.m_pMaxs[box]), inOutMaxT);
+    };
+
+    Bvh bvh(GetBuiltInHeap());
+    Bvh4 bvh4(GetBuiltInHeap());
+    bvh.Build(prims.m_pMins, prims.m_pMaxs, kNumBoxes, &scratch);
+    bvh4.Build(bvh);
+    CheckBvhStructure("boxes with the same centroid", bvh, prims, arena);
+    CheckBvhQueries("boxes with the same centroid", bvh, bvh4, prims, intersectBox, arena);
+
+    scratch.Release();
+    arena.Release();
+}
+
+void RunGeometryTests()
+{
+    TestRayAabb();
+    TestRayTriangle();
+    TestRayTriangleScale();
+    TestOverlapSphereAabb();
+    TestOverlapObbObb();
+    TestGeometryBatches();
+    TestBvhTriangles();
+    TestBvhSameCentroids();
+}
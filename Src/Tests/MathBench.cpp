@@ -0,0 +1,512 @@
+#include "SM/Math.h"
+#include "SM/MathBatch.h"
+#include "SM/Memory.h"
+#include "SM/Random.h"
+#include "SM/Renderer/Camera.h"
+#include "Tests/Bench.h"
+
+using namespace SM;
+
+//------------------------------------------------------------------------------------------------------------------------
+// Vec4 / Mat44
+//------------------------------------------------------------------------------------------------------------------------
+// Small enough to stay in L2 so the ALU work is measured rather than memory bandwidth
+static const U32 kMathBenchItems = 4096;
+static const U32 kMathBenchPasses = 256;
+
+// Plain scalar versions of the ops for comparison. Building with SM_SIMD_SCALAR times the engine's own scalar paths.
+static Mat44 ScalarMatMul(const Mat44& a, const Mat44& b)
+{
+    Mat44 result;
+    for(U32 row = 0; row < 4; row++)
+    {
+        for(U32 column = 0; column < 4; column++)
+        {
+            result[row][column] = a[row][0] * b[0][column] + a[row][1] * b[1][column] + a[row][2] * b[2][column] + a[row][3] * b[3][column];
+        }
+    }
+    return result;
+}
+
+static Vec4 ScalarVecMul(const Vec4& v, const Mat44& m)
+{
+    return Vec4(v.x * m.ix + v.y * m.jx + v.z * m.kx + v.w * m.tx,
+                v.x * m.iy + v.y * m.jy + v.z * m.ky + v.w * m.ty,
+                v.x * m.iz + v.y * m.jz + v.z * m.kz + v.w * m.tz,
+                v.x * m.iw + v.y * m.jw + v.z * m.kw + v.w * m.tw);
+}
+
+static Mat44 ScalarTranspose(const Mat44& m)
+{
+    return Mat44(m.ix, m.jx, m.kx, m.tx,
+                 m.iy, m.jy, m.ky, m.ty,
+                 m.iz, m.jz, m.kz, m.tz,
+                 m.iw, m.jw, m.kw, m.tw);
+}
+
+static Vec4 ScalarNormalize(const Vec4& v)
+{
+    F32 invLength = 1.0f / ::sqrtf(v.x * v.x + v.y * v.y + v.z * v.z + v.w * v.w);
+    return Vec4(v.x * invLength, v.y * invLength, v.z * invLength, v.w * invLength);
+}
+
+template<typename Func>
+static F64 BenchMathOpMs(Func func)
+{
+    return BenchMinMs([&func]()
+    {
+        for(U32 pass = 0; pass < kMathBenchPasses; pass++)
+        {
+            func();
+        }
+    });
+}
+
+static void BenchVec4Mat44()
+{
+    #if SM_SIMD_ENABLED
+    BenchHeader("Vec4 / Mat44, SIMD build vs plain scalar reference");
+    #else
+    BenchHeader("Vec4 / Mat44, SM_SIMD_SCALAR build vs plain scalar reference");
+    #endif
+
+    LinearAllocator arena;
+    arena.InitVirtual(MiB(16));
+    Mat44* pMatsA = arena.Alloc<Mat44>(kMathBenchItems);
+    Mat44* pMatsB = arena.Alloc<Mat44>(kMathBenchItems);
+    Mat44* pMatsOut = arena.Alloc<Mat44>(kMathBenchItems);
+    Vec4* pVecs = arena.Alloc<Vec4>(kMathBenchItems);
+    Vec4* pVecsOut = arena.Alloc<Vec4>(kMathBenchItems);
+
+    Rng rng(16);
+    for(U32 i = 0; i < kMathBenchItems; i++)
+    {
+        for(U32 row = 0; row < 4; row++)
+        {
+            for(U32 column = 0; column < 4; column++)
+            {
+                pMatsA[i][row][column] = rng.NextF32(-2.0f, 2.0f);
+                pMatsB[i][row][column] = rng.NextF32(-2.0f, 2.0f);
+            }
+        }
+        pVecs[i] = Vec4(rng.NextF32(-2.0f, 2.0f), rng.NextF32(-2.0f, 2.0f), rng.NextF32(-2.0f, 2.0f), rng.NextF32(0.5f, 2.0f));
+    }
+
+    U64 numOps = (U64)kMathBenchItems * kMathBenchPasses;
+
+    F64 matMulMs = BenchMathOpMs([&]() { for(U32 i = 0; i < kMathBenchItems; i++) pMatsOut[i] = pMatsA[i] * pMatsB[i]; });
+    BenchKeep(pMatsOut[kMathBenchItems - 1].ix);
+    F64 scalarMatMulMs = BenchMathOpMs([&]() { for(U32 i = 0; i < kMathBenchItems; i++) pMatsOut[i] = ScalarMatMul(pMatsA[i], pMatsB[i]); });
+    BenchKeep(pMatsOut[kMathBenchItems - 1].ix);
+
+    F64 vecMulMs = BenchMathOpMs([&]() { for(U32 i = 0; i < kMathBenchItems; i++) pVecsOut[i] = pVecs[i] * pMatsA[i]; });
+    BenchKeep(pVecsOut[kMathBenchItems - 1].x);
+    F64 scalarVecMulMs = BenchMathOpMs([&]() { for(U32 i = 0; i < kMathBenchItems; i++) pVecsOut[i] = ScalarVecMul(pVecs[i], pMatsA[i]); });
+    BenchKeep(pVecsOut[kMathBenchItems - 1].x);
+
+    F64 transposeMs = BenchMathOpMs([&]() { for(U32 i = 0; i < kMathBenchItems; i++) pMatsOut[i] = pMatsA[i].GetTransposed(); });
+    BenchKeep(pMatsOut[kMathBenchItems - 1].iy);
+    F64 scalarTransposeMs = BenchMathOpMs([&]() { for(U32 i = 0; i < kMathBenchItems; i++) pMatsOut[i] = ScalarTranspose(pMatsA[i]); });
+    BenchKeep(pMatsOut[kMathBenchItems - 1].iy);
+
+    F64 normalizeMs = BenchMathOpMs([&]() { for(U32 i = 0; i < kMathBenchItems; i++) pVecsOut[i] = pVecs[i].GetNormalized(); });
+    BenchKeep(pVecsOut[kMathBenchItems - 1].x);
+    F64 scalarNormalizeMs = BenchMathOpMs([&]() { for(U32 i = 0; i < kMathBenchItems; i++) pVecsOut[i] = ScalarNormalize(pVecs[i]); });
+    BenchKeep(pVecsOut[kMathBenchItems - 1].x);
+
+    BenchReport("Mat44 * Mat44", matMulMs, numOps);
+    BenchReport("Mat44 * Mat44, scalar reference", scalarMatMulMs, numOps);
+    BenchReport("Vec4 * Mat44", vecMulMs, numOps);
+    BenchReport("Vec4 * Mat44, scalar reference", scalarVecMulMs, numOps);
+    BenchReport("Mat44::GetTransposed", transposeMs, numOps);
+    BenchReport("Mat44::GetTransposed, scalar reference", scalarTransposeMs, numOps);
+    BenchReport("Vec4::GetNormalized", normalizeMs, numOps);
+    BenchReport("Vec4::GetNormalized, scalar reference", scalarNormalizeMs, numOps);
+
+    // the same products through the structure of arrays batch kernels at every simd level
+    Mat44SoA matsA;
+    Mat44SoA matsB;
+    Mat44SoA matsOut;
+    for(U32 element = 0; element < 16; element++)
+    {
+        matsA.m_pElements[element] = arena.Alloc<F32>(kMathBenchItems);
+        matsB.m_pElements[element] = arena.Alloc<F32>(kMathBenchItems);
+        matsOut.m_pElements[element] = arena.Alloc<F32>(kMathBenchItems);
+    }
+    ConvertToSoA(pMatsA, kMathBenchItems, matsA);
+    ConvertToSoA(pMatsB, kMathBenchItems, matsB);
+
+    Vec3SoA points;
+    Vec3SoA pointsOut;
+    points.m_pX = arena.Alloc<F32>(kMathBenchItems);
+    points.m_pY = arena.Alloc<F32>(kMathBenchItems);
+    points.m_pZ = arena.Alloc<F32>(kMathBenchItems);
+    pointsOut.m_pX = arena.Alloc<F32>(kMathBenchItems);
+    pointsOut.m_pY = arena.Alloc<F32>(kMathBenchItems);
+    pointsOut.m_pZ = arena.Alloc<F32>(kMathBenchItems);
+    for(U32 i = 0; i < kMathBenchItems; i++)
+    {
+        points.m_pX[i] = pVecs[i].x;
+        points.m_pY[i] = pVecs[i].y;
+        points.m_pZ[i] = pVecs[i].z;
+    }
+
+    SimdLevel supportedLevel = GetSupportedSimdLevel();
+    for(U32 level = kSimdLevelScalar; level <= (U32)supportedLevel; level++)
+    {
+        SetSimdLevel((SimdLevel)level);
+        F64 batchMatMulMs = BenchMathOpMs([&]() { MultiplyMatrices(matsA, matsB, matsOut, kMathBenchItems); });
+        BenchKeep(matsOut.m_pElements[0][kMathBenchItems - 1]);
+        F64 batchPointsMs = BenchMathOpMs([&]() { TransformPoints(matsA, points, pointsOut, kMathBenchItems); });
+        BenchKeep(pointsOut.m_pX[kMathBenchItems - 1]);
+
+        char name[64];
+        snprintf(name, sizeof(name), "MultiplyMatrices, %s", GetSimdLevelName((SimdLevel)level));
+        BenchReport(name, batchMatMulMs, numOps);
+        snprintf(name, sizeof(name), "TransformPoints per element, %s", GetSimdLevelName((SimdLevel)level));
+        BenchReport(name, batchPointsMs, numOps);
+    }
+    SetSimdLevel(supportedLevel);
+
+    arena.Release();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// Mat44 inverse
+//------------------------------------------------------------------------------------------------------------------------
+static const U32 kInverseBenchCount = 1000000;
+static const U32 kInverseBenchMatrices = 1024;
+
+// The inverse this engine used before the closed form one, a 3x3 submatrix and determinant per cofactor
+static F32 CofactorReference(const Mat44& m, U32 row, U32 column)
+{
+    Mat33 sub;
+    U32 subRow = 0;
+    for(U32 sourceRow = 0; sourceRow < 4; sourceRow++)
+    {
+        if(sourceRow == row)
+            continue;
+
+        U32 subColumn = 0;
+        for(U32 sourceColumn = 0; sourceColumn < 4; sourceColumn++)
+        {
+            if(sourceColumn == column)
+                continue;
+
+            sub[subRow][subColumn] = m[sourceRow][sourceColumn];
+            subColumn++;
+        }
+        subRow++;
+    }
+
+    F32 det = sub.Determinant();
+    return ((row + column) % 2) ? -det : det;
+}
+
+static Mat44 CofactorInverseReference(const Mat44& m)
+{
+    Mat44 cofactors;
+    for(U32 row = 0; row < 4; row++)
+    {
+        for(U32 column = 0; column < 4; column++)
+        {
+            cofactors[row][column] = CofactorReference(m, row, column);
+        }
+    }
+
+    F32 det = m.ix * cofactors.ix + m.iy * cofactors.iy + m.iz * cofactors.iz + m.iw * cofactors.iw;
+    cofactors.Transpose();
+    return cofactors * (1.0f / det);
+}
+
+template<typename InverseFunc>
+static F64 BenchInverseMs(const Mat44* pMatrices, Mat44* pInverses, InverseFunc inverse)
+{
+    return BenchMinMs([pMatrices, pInverses, &inverse]()
+    {
+        for(U32 i = 0; i < kInverseBenchCount; i++)
+        {
+            pInverses[i % kInverseBenchMatrices] = inverse(pMatrices[i % kInverseBenchMatrices]);
+        }
+        BenchKeep(pInverses[0].tx);
+    });
+}
+
+static void BenchMat44Inverse()
+{
+    BenchHeader("Mat44 inverse, 1M inversions");
+
+    LinearAllocator arena;
+    arena.InitVirtual(MiB(1));
+    Mat44* pGeneral = arena.Alloc<Mat44>(kInverseBenchMatrices);
+    Mat44* pAffine = arena.Alloc<Mat44>(kInverseBenchMatrices);
+    Mat44* pInverses = arena.Alloc<Mat44>(kInverseBenchMatrices);
+
+    Rng rng(18);
+    for(U32 i = 0; i < kInverseBenchMatrices; i++)
+    {
+        for(U32 row = 0; row < 4; row++)
+        {
+            for(U32 column = 0; column < 4; column++)
+            {
+                pGeneral[i][row][column] = rng.NextF32(-2.0f, 2.0f);
+            }
+        }
+        pGeneral[i].tw += 5.0f;
+
+        Vec3 axis = Vec3(rng.NextF32(-1.0f, 1.0f), rng.NextF32(-1.0f, 1.0f), rng.NextF32(2.0f, 4.0f)).GetNormalized();
+        pAffine[i] = Mat44::CreateRotationAroundAxisDegs(axis, rng.NextF32(-180.0f, 180.0f));
+        pAffine[i].SetTranslation(rng.NextF32(-10.0f, 10.0f), rng.NextF32(-10.0f, 10.0f), rng.NextF32(-10.0f, 10.0f));
+    }
+
+    F64 inverseMs = BenchInverseMs(pGeneral, pInverses, [](const Mat44& m) { return m.GetInversed(); });
+    F64 cofactorMs = BenchInverseMs(pGeneral, pInverses, [](const Mat44& m) { return CofactorInverseReference(m); });
+    F64 generalOnAffineMs = BenchInverseMs(pAffine, pInverses, [](const Mat44& m) { return m.GetInversed(); });
+    F64 affineMs = BenchInverseMs(pAffine, pInverses, [](const Mat44& m) { return m.GetAffineInversed(); });
+    F64 orthoMs = BenchInverseMs(pAffine, pInverses, [](const Mat44& m) { return m.GetFastOrthoInversed(); });
+
+    BenchReport("Inverse", inverseMs, kInverseBenchCount);
+    BenchReport("3x3 cofactor reference", cofactorMs, kInverseBenchCount);
+    BenchReport("Inverse, rotation + translation", generalOnAffineMs, kInverseBenchCount);
+    BenchReport("AffineInverse, rotation + translation", affineMs, kInverseBenchCount);
+    BenchReport("FastOrthoInverse, rotation + translation", orthoMs, kInverseBenchCount);
+
+    arena.Release();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// Frustum culling
+//------------------------------------------------------------------------------------------------------------------------
+static const U32 kCullBenchObjects = 1000000;
+
+static void BenchFrustumCulling()
+{
+    BenchHeader("Frustum culling, 1M objects scattered around the camera");
+
+    // 90 degree camera at the origin looking down +z, about a quarter of the objects end up visible
+    Frustum frustum = Frustum::CreateFromViewProjection(MakePerspectiveProjection(90.0f, 0.1f, 1000.0f, 16.0f / 9.0f));
+
+    LinearAllocator arena;
+    arena.InitVirtual(MiB(64));
+    SphereSoA spheres;
+    spheres.m_pCenterX = arena.Alloc<F32>(kCullBenchObjects);
+    spheres.m_pCenterY = arena.Alloc<F32>(kCullBenchObjects);
+    spheres.m_pCenterZ = arena.Alloc<F32>(kCullBenchObjects);
+    spheres.m_pRadius = arena.Alloc<F32>(kCullBenchObjects);
+
+    AabbSoA aabbs;
+    aabbs.m_pCenterX = spheres.m_pCenterX;
+    aabbs.m_pCenterY = spheres.m_pCenterY;
+    aabbs.m_pCenterZ = spheres.m_pCenterZ;
+    aabbs.m_pExtentX = arena.Alloc<F32>(kCullBenchObjects);
+    aabbs.m_pExtentY = arena.Alloc<F32>(kCullBenchObjects);
+    aabbs.m_pExtentZ = arena.Alloc<F32>(kCullBenchObjects);
+
+    Rng rng(20);
+    for(U32 i = 0; i < kCullBenchObjects; i++)
+    {
+        spheres.m_pCenterX[i] = rng.NextF32(-600.0f, 600.0f);
+        spheres.m_pCenterY[i] = rng.NextF32(-600.0f, 600.0f);
+        spheres.m_pCenterZ[i] = rng.NextF32(-600.0f, 600.0f);
+        spheres.m_pRadius[i] = rng.NextF32(0.0f, 20.0f);
+        aabbs.m_pExtentX[i] = rng.NextF32(0.0f, 20.0f);
+        aabbs.m_pExtentY[i] = rng.NextF32(0.0f, 20.0f);
+        aabbs.m_pExtentZ[i] = rng.NextF32(0.0f, 20.0f);
+    }
+
+    BitSet visible(&arena, kCullBenchObjects);
+
+    // one Frustum call per object is what culling looked like before the batch kernels
+    F64 sphereLoopMs = BenchMinMs([&]()
+    {
+        for(U32 i = 0; i < kCullBenchObjects; i++)
+        {
+            Vec3 center(spheres.m_pCenterX[i], spheres.m_pCenterY[i], spheres.m_pCenterZ[i]);
+            if(frustum.IsSphereVisible(center, spheres.m_pRadius[i]))
+                visible.Set(i);
+            else
+                visible.UnSet(i);
+        }
+    });
+    BenchReport("Frustum::IsSphereVisible loop", sphereLoopMs, kCullBenchObjects);
+
+    F64 aabbLoopMs = BenchMinMs([&]()
+    {
+        for(U32 i = 0; i < kCullBenchObjects; i++)
+        {
+            Vec3 center(aabbs.m_pCenterX[i], aabbs.m_pCenterY[i], aabbs.m_pCenterZ[i]);
+            Vec3 extents(aabbs.m_pExtentX[i], aabbs.m_pExtentY[i], aabbs.m_pExtentZ[i]);
+            if(frustum.IsAabbVisible(center, extents))
+                visible.Set(i);
+            else
+                visible.UnSet(i);
+        }
+    });
+    BenchReport("Frustum::IsAabbVisible loop", aabbLoopMs, kCullBenchObjects);
+
+    SimdLevel supportedLevel = GetSupportedSimdLevel();
+    for(U32 level = kSimdLevelScalar; level <= (U32)supportedLevel; level++)
+    {
+        SetSimdLevel((SimdLevel)level);
+        for(U32 numThreads = 1; numThreads <= GetBenchMaxThreads(); numThreads = GetNextBenchThreadCount(numThreads))
+        {
+            F64 spheresMs = BenchMinMs([&]() { CullSpheres(frustum, spheres, kCullBenchObjects, visible, numThreads); });
+            F64 aabbsMs = BenchMinMs([&]() { CullAabbs(frustum, aabbs, kCullBenchObjects, visible, numThreads); });
+
+            char name[64];
+            snprintf(name, sizeof(name), "CullSpheres, %s, %u threads", GetSimdLevelName((SimdLevel)level), numThreads);
+            BenchReport(name, spheresMs, kCullBenchObjects);
+            snprintf(name, sizeof(name), "CullAabbs, %s, %u threads", GetSimdLevelName((SimdLevel)level), numThreads);
+            BenchReport(name, aabbsMs, kCullBenchObjects);
+        }
+    }
+    SetSimdLevel(supportedLevel);
+
+    BenchKeep(visible.CountSetBits());
+    arena.Release();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// Fast approximations vs libm
+//------------------------------------------------------------------------------------------------------------------------
+static const U32 kApproxBenchValues = 1 << 20;
+
+struct ApproxErrors
+{
+    F64 m_abs = 0.0;
+    F64 m_rel = 0.0;
+};
+
+static ApproxErrors MeasureApproxErrors(const F32* pValues, const F64* pExpected, U32 count)
+{
+    ApproxErrors errors;
+    for(U32 i = 0; i < count; i++)
+    {
+        F64 error = ::fabs((F64)pValues[i] - pExpected[i]);
+        errors.m_abs = Max(errors.m_abs, error);
+        if(pExpected[i] != 0.0)
+        {
+            errors.m_rel = Max(errors.m_rel, error / ::fabs(pExpected[i]));
+        }
+    }
+    return errors;
+}
+
+static void ReportApproxErrors(const char* name, const F32* pValues, const F64* pExpected)
+{
+    ApproxErrors errors = MeasureApproxErrors(pValues, pExpected, kApproxBenchValues);
+    char label[64];
+    snprintf(label, sizeof(label), "%s, max error vs double", name);
+    printf("    %-44s %10.3g abs     %10.3g rel\n", label, errors.m_abs, errors.m_rel);
+}
+
+// Times func at every supported simd level, each level gives the same values so only speed differs
+template<typename Func>
+static void BenchApproxLevels(const char* name, Func func)
+{
+    SimdLevel supportedLevel = GetSupportedSimdLevel();
+    for(U32 level = kSimdLevelScalar; level <= (U32)supportedLevel; level++)
+    {
+        SetSimdLevel((SimdLevel)level);
+        char label[64];
+        snprintf(label, sizeof(label), "%s, %s", name, GetSimdLevelName((SimdLevel)level));
+        BenchReport(label, BenchMinMs(func), kApproxBenchValues);
+    }
+    SetSimdLevel(supportedLevel);
+}
+
+static void BenchApproximations()
+{
+    LinearAllocator arena;
+    arena.InitVirtual(MiB(64));
+    F32* pX = arena.Alloc<F32>(kApproxBenchValues);
+    F32* pY = arena.Alloc<F32>(kApproxBenchValues);
+    F32* pOut = arena.Alloc<F32>(kApproxBenchValues);
+    F32* pOut2 = arena.Alloc<F32>(kApproxBenchValues);
+    F64* pExpected = arena.Alloc<F64>(kApproxBenchValues);
+    F64* pExpected2 = arena.Alloc<F64>(kApproxBenchValues);
+    WideRng rng(23);
+
+    BenchHeader("FastSinCos vs sinf + cosf, rads in [-100, 100]");
+    rng.FillF32(pX, kApproxBenchValues, -100.0f, 100.0f);
+    BenchReport("sinf + cosf", BenchMinMs([&]()
+    {
+        for(U32 i = 0; i < kApproxBenchValues; i++)
+        {
+            pOut[i] = ::sinf(pX[i]);
+            pOut2[i] = ::cosf(pX[i]);
+        }
+    }), kApproxBenchValues);
+    BenchApproxLevels("FastSinCos", [&]() { FastSinCos(pX, pOut, pOut2, kApproxBenchValues); });
+    BenchApproxLevels("FastSinCos, sin only", [&]() { FastSinCos(pX, pOut, nullptr, kApproxBenchValues); });
+    for(U32 i = 0; i < kApproxBenchValues; i++)
+    {
+        pExpected[i] = ::sin((F64)pX[i]);
+        pExpected2[i] = ::cos((F64)pX[i]);
+    }
+    FastSinCos(pX, pOut, pOut2, kApproxBenchValues);
+    ReportApproxErrors("FastSinCos sin", pOut, pExpected);
+    ReportApproxErrors("FastSinCos cos", pOut2, pExpected2);
+    for(U32 i = 0; i < kApproxBenchValues; i++)
+    {
+        pOut[i] = ::sinf(pX[i]);
+        pOut2[i] = ::cosf(pX[i]);
+    }
+    ReportApproxErrors("sinf", pOut, pExpected);
+    ReportApproxErrors("cosf", pOut2, pExpected2);
+
+    BenchHeader("FastExp vs expf, x in [-80, 80]");
+    rng.FillF32(pX, kApproxBenchValues, -80.0f, 80.0f);
+    BenchReport("expf", BenchMinMs([&]() { for(U32 i = 0; i < kApproxBenchValues; i++) pOut[i] = ::expf(pX[i]); }), kApproxBenchValues);
+    BenchApproxLevels("FastExp", [&]() { FastExp(pX, pOut, kApproxBenchValues); });
+    for(U32 i = 0; i < kApproxBenchValues; i++)
+    {
+        pExpected[i] = ::exp((F64)pX[i]);
+        pOut2[i] = ::expf(pX[i]);
+    }
+    FastExp(pX, pOut, kApproxBenchValues);
+    ReportApproxErrors("FastExp", pOut, pExpected);
+    ReportApproxErrors("expf", pOut2, pExpected);
+
+    // spread over exponents rather than uniformly so small values are covered too
+    BenchHeader("FastLog vs logf, x = 2^[-20, 20]");
+    rng.FillF32(pY, kApproxBenchValues, -20.0f, 20.0f);
+    for(U32 i = 0; i < kApproxBenchValues; i++)
+    {
+        pX[i] = ::exp2f(pY[i]);
+    }
+    BenchReport("logf", BenchMinMs([&]() { for(U32 i = 0; i < kApproxBenchValues; i++) pOut[i] = ::logf(pX[i]); }), kApproxBenchValues);
+    BenchApproxLevels("FastLog", [&]() { FastLog(pX, pOut, kApproxBenchValues); });
+    for(U32 i = 0; i < kApproxBenchValues; i++)
+    {
+        pExpected[i] = ::log((F64)pX[i]);
+        pOut2[i] = ::logf(pX[i]);
+    }
+    FastLog(pX, pOut, kApproxBenchValues);
+    ReportApproxErrors("FastLog", pOut, pExpected);
+    ReportApproxErrors("logf", pOut2, pExpected);
+
+    BenchHeader("FastAtan2 vs atan2f, x and y in [-100, 100]");
+    rng.FillF32(pX, kApproxBenchValues, -100.0f, 100.0f);
+    rng.FillF32(pY, kApproxBenchValues, -100.0f, 100.0f);
+    BenchReport("atan2f", BenchMinMs([&]() { for(U32 i = 0; i < kApproxBenchValues; i++) pOut[i] = ::atan2f(pY[i], pX[i]); }), kApproxBenchValues);
+    BenchApproxLevels("FastAtan2", [&]() { FastAtan2(pY, pX, pOut, kApproxBenchValues); });
+    for(U32 i = 0; i < kApproxBenchValues; i++)
+    {
+        pExpected[i] = ::atan2((F64)pY[i], (F64)pX[i]);
+        pOut2[i] = ::atan2f(pY[i], pX[i]);
+    }
+    FastAtan2(pY, pX, pOut, kApproxBenchValues);
+    ReportApproxErrors("FastAtan2", pOut, pExpected);
+    ReportApproxErrors("atan2f", pOut2, pExpected);
+
+    arena.Release();
+}
+
+void RunMathBenchmarks()
+{
+    BenchVec4Mat44();
+    BenchMat44Inverse();
+    BenchFrustumCulling();
+    BenchApproximations();
+}
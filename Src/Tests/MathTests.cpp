@@ -0,0 +1,760 @@
+#include "SM/Math.h"
+#include "SM/MathBatch.h"
+#include "SM/Memory.h"
+#include "SM/Random.h"
+#include "SM/Simd.h"
+#include "Tests/Test.h"
+
+#include <cmath>
+#include <cstring>
+
+using namespace SM;
+
+//------------------------------------------------------------------------------------------------------------------------
+// Mat44 inverse
+//------------------------------------------------------------------------------------------------------------------------
+// Mat44 picks SIMD or scalar at compile time, build the tests with SM_SIMD_SCALAR as well to check the scalar paths
+static const U32 kInverseTestMatrices = 20000;
+
+// Errors are relative to the largest element of the expected matrix. The round trip inverts twice so it sees the
+// conditioning of the general matrices twice as well.
+static const F64 kGeneralInverseMaxError = 5e-5;
+static const F64 kGeneralRoundTripMaxError = 5e-4;
+static const F64 kAffineInverseMaxError = 5e-6;
+static const F64 kDeterminantMaxError = 5e-5;
+
+// Gauss-Jordan with partial pivoting in double precision as the reference
+static void ReferenceInverse(const Mat44& m, F64 outInverse[16])
+{
+    F64 rows[4][8];
+    for(U32 row = 0; row < 4; row++)
+    {
+        for(U32 column = 0; column < 4; column++)
+        {
+            rows[row][column] = m[row][column];
+            rows[row][column + 4] = row == column ? 1.0 : 0.0;
+        }
+    }
+
+    for(U32 column = 0; column < 4; column++)
+    {
+        U32 pivot = column;
+        for(U32 row = column + 1; row < 4; row++)
+        {
+            pivot = ::fabs(rows[row][column]) > ::fabs(rows[pivot][column]) ? row : pivot;
+        }
+        for(U32 i = 0; i < 8; i++)
+        {
+            Swap(rows[column][i], rows[pivot][i]);
+        }
+
+        F64 invPivot = 1.0 / rows[column][column];
+        for(U32 i = 0; i < 8; i++)
+        {
+            rows[column][i] *= invPivot;
+        }
+
+        for(U32 row = 0; row < 4; row++)
+        {
+            if(row == column)
+                continue;
+
+            F64 factor = rows[row][column];
+            for(U32 i = 0; i < 8; i++)
+            {
+                rows[row][i] -= factor * rows[column][i];
+            }
+        }
+    }
+
+    for(U32 row = 0; row < 4; row++)
+    {
+        for(U32 column = 0; column < 4; column++)
+        {
+            outInverse[row * 4 + column] = rows[row][column + 4];
+        }
+    }
+}
+
+static F64 ReferenceDeterminant(const Mat44& m)
+{
+    F64 rows[4][4];
+    for(U32 row = 0; row < 4; row++)
+    {
+        for(U32 column = 0; column < 4; column++)
+        {
+            rows[row][column] = m[row][column];
+        }
+    }
+
+    F64 det = 1.0;
+    for(U32 column = 0; column < 4; column++)
+    {
+        U32 pivot = column;
+        for(U32 row = column + 1; row < 4; row++)
+        {
+            pivot = ::fabs(rows[row][column]) > ::fabs(rows[pivot][column]) ? row : pivot;
+        }
+        if(pivot != column)
+        {
+            for(U32 i = 0; i < 4; i++)
+            {
+                Swap(rows[column][i], rows[pivot][i]);
+            }
+            det = -det;
+        }
+
+        det *= rows[column][column];
+        for(U32 row = column + 1; row < 4; row++)
+        {
+            F64 factor = rows[row][column] / rows[column][column];
+            for(U32 i = 0; i < 4; i++)
+            {
+                rows[row][i] -= factor * rows[column][i];
+            }
+        }
+    }
+    return det;
+}
+
+static F64 GetRelativeError(const Mat44& m, const F64 expected[16])
+{
+    F64 maxError = 0.0;
+    F64 maxExpected = 0.0;
+    for(U32 i = 0; i < 16; i++)
+    {
+        maxError = Max(maxError, ::fabs((F64)m[i / 4][i % 4] - expected[i]));
+        maxExpected = Max(maxExpected, ::fabs(expected[i]));
+    }
+    return maxError / maxExpected;
+}
+
+static F64 GetRelativeError(const Mat44& m, const Mat44& expected)
+{
+    F64 expectedValues[16];
+    for(U32 i = 0; i < 16; i++)
+    {
+        expectedValues[i] = expected[i / 4][i % 4];
+    }
+    return GetRelativeError(m, expectedValues);
+}
+
+// Matrices with entries in [-2, 2] and |det| >= 0.5 so the float inverse is well conditioned
+static Mat44 MakeGeneralTestMatrix(Rng& rng)
+{
+    for(;;)
+    {
+        Mat44 m;
+        for(U32 i = 0; i < 16; i++)
+        {
+            m[i / 4][i % 4] = rng.NextF32(-2.0f, 2.0f);
+        }
+        if(::fabs(ReferenceDeterminant(m)) >= 0.5)
+            return m;
+    }
+}
+
+static Mat44 MakeOrthonormalTestMatrix(Rng& rng)
+{
+    Vec3 axis = Vec3(rng.NextF32(-1.0f, 1.0f), rng.NextF32(-1.0f, 1.0f), rng.NextF32(2.0f, 4.0f)).GetNormalized();
+    Mat44 m = Mat44::CreateRotationAroundAxisDegs(axis, rng.NextF32(-180.0f, 180.0f));
+    m.SetTranslation(rng.NextF32(-10.0f, 10.0f), rng.NextF32(-10.0f, 10.0f), rng.NextF32(-10.0f, 10.0f));
+    return m;
+}
+
+// Non uniform scale, then rotation and translation
+static Mat44 MakeAffineTestMatrix(Rng& rng)
+{
+    Mat44 m = Mat44::CreateScale(rng.NextF32(0.5f, 4.0f), rng.NextF32(0.5f, 4.0f), rng.NextF32(0.5f, 4.0f)) * MakeOrthonormalTestMatrix(rng);
+    return m;
+}
+
+static F64 GetIdentityError(const Mat44& m, const Mat44& inverse)
+{
+    return GetRelativeError(m * inverse, Mat44::kIdentity);
+}
+
+struct InverseErrors
+{
+    F64 m_inverse = 0.0;
+    F64 m_identity = 0.0;
+    F64 m_roundTrip = 0.0;
+};
+
+template<typename InverseFunc>
+static InverseErrors MeasureInverseErrors(Mat44 (*makeMatrix)(Rng&), InverseFunc inverse)
+{
+    InverseErrors errors;
+    Rng rng(18);
+    for(U32 i = 0; i < kInverseTestMatrices; i++)
+    {
+        Mat44 m = makeMatrix(rng);
+        F64 expected[16];
+        ReferenceInverse(m, expected);
+
+        Mat44 inv = inverse(m);
+        errors.m_inverse = Max(errors.m_inverse, GetRelativeError(inv, expected));
+        errors.m_identity = Max(errors.m_identity, GetIdentityError(m, inv));
+        errors.m_roundTrip = Max(errors.m_roundTrip, GetRelativeError(inverse(inv), m));
+    }
+    return errors;
+}
+
+static void CheckInverseErrors(const char* name, const InverseErrors& errors, F64 maxError, F64 maxRoundTripError)
+{
+    bool bPassed = SM_TEST_CHECK(errors.m_inverse <= maxError) &&
+                   SM_TEST_CHECK(errors.m_identity <= maxError) &&
+                   SM_TEST_CHECK(errors.m_roundTrip <= maxRoundTripError);
+    if(!bPassed)
+    {
+        printf("    %s: inverse %.3g, M * inverse(M) %.3g, round trip %.3g\n", name, errors.m_inverse, errors.m_identity, errors.m_roundTrip);
+    }
+}
+
+static void TestMat44Inverse()
+{
+    InverseErrors general = MeasureInverseErrors(MakeGeneralTestMatrix, [](const Mat44& m) { return m.GetInversed(); });
+    CheckInverseErrors("Inverse, general", general, kGeneralInverseMaxError, kGeneralRoundTripMaxError);
+
+    InverseErrors generalOnAffine = MeasureInverseErrors(MakeAffineTestMatrix, [](const Mat44& m) { return m.GetInversed(); });
+    CheckInverseErrors("Inverse, affine", generalOnAffine, kGeneralInverseMaxError, kGeneralRoundTripMaxError);
+
+    InverseErrors affine = MeasureInverseErrors(MakeAffineTestMatrix, [](const Mat44& m) { return m.GetAffineInversed(); });
+    CheckInverseErrors("AffineInverse, affine", affine, kAffineInverseMaxError, kAffineInverseMaxError);
+
+    InverseErrors affineOnOrtho = MeasureInverseErrors(MakeOrthonormalTestMatrix, [](const Mat44& m) { return m.GetAffineInversed(); });
+    CheckInverseErrors("AffineInverse, orthonormal", affineOnOrtho, kAffineInverseMaxError, kAffineInverseMaxError);
+
+    InverseErrors ortho = MeasureInverseErrors(MakeOrthonormalTestMatrix, [](const Mat44& m) { return m.GetFastOrthoInversed(); });
+    CheckInverseErrors("FastOrthoInverse, orthonormal", ortho, kAffineInverseMaxError, kAffineInverseMaxError);
+
+    // the identity and pure translations are exact
+    Mat44 translation = Mat44::CreateTranslation(1.0f, -2.0f, 4.0f);
+    Mat44 invTranslation = Mat44::CreateTranslation(-1.0f, 2.0f, -4.0f);
+    SM_TEST_CHECK(GetRelativeError(Mat44::kIdentity.GetInversed(), Mat44::kIdentity) == 0.0);
+    SM_TEST_CHECK(GetRelativeError(Mat44::kIdentity.GetAffineInversed(), Mat44::kIdentity) == 0.0);
+    SM_TEST_CHECK(GetRelativeError(translation.GetInversed(), invTranslation) == 0.0);
+    SM_TEST_CHECK(GetRelativeError(translation.GetAffineInversed(), invTranslation) == 0.0);
+    SM_TEST_CHECK(GetRelativeError(translation.GetFastOrthoInversed(), invTranslation) == 0.0);
+}
+
+static void TestMat44Determinant()
+{
+    F64 maxError = 0.0;
+    Rng rng(18);
+    for(U32 i = 0; i < kInverseTestMatrices; i++)
+    {
+        Mat44 m = MakeGeneralTestMatrix(rng);
+        F64 expected = ReferenceDeterminant(m);
+        maxError = Max(maxError, ::fabs(m.Determinant() - expected) / ::fabs(expected));
+    }
+
+    if(!SM_TEST_CHECK(maxError <= kDeterminantMaxError))
+    {
+        printf("    Determinant: %.3g\n", maxError);
+    }
+    SM_TEST_CHECK(Mat44::kIdentity.Determinant() == 1.0f);
+    SM_TEST_CHECK(Mat44::CreateScale(2.0f, 3.0f, 4.0f).Determinant() == 24.0f);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// Quat / DualQuat
+//------------------------------------------------------------------------------------------------------------------------
+static const U32 kQuatTestCount = 20000;
+
+// Matrix errors are relative to the largest element like the inverse tests, quaternion errors are per component
+static const F64 kQuatMaxError = 1e-5;
+
+// The bounds from the Nlerp / FastSlerp comment in Math.h, measured against a double precision slerp
+static const F64 kNlerpMaxErrorDegs = 8.2;
+static const F64 kFastSlerpMaxErrorDegs = 0.05;
+
+static Vec3 MakeTestAxis(Rng& rng)
+{
+    for(;;)
+    {
+        Vec3 axis(rng.NextF32(-1.0f, 1.0f), rng.NextF32(-1.0f, 1.0f), rng.NextF32(-1.0f, 1.0f));
+        if(axis.CalcLengthSq() >= 0.01f)
+            return axis.GetNormalized();
+    }
+}
+
+static Quat MakeTestQuat(Rng& rng)
+{
+    return Quat::CreateRotationAroundAxisDegs(MakeTestAxis(rng), rng.NextF32(-180.0f, 180.0f));
+}
+
+// Largest component difference to q or -q, both are the same rotation
+static F64 GetQuatError(const Quat& q, const Quat& expected)
+{
+    F64 error = 0.0;
+    F64 negatedError = 0.0;
+    const F32 values[4] = { q.x, q.y, q.z, q.w };
+    const F32 expectedValues[4] = { expected.x, expected.y, expected.z, expected.w };
+    for(U32 i = 0; i < 4; i++)
+    {
+        error = Max(error, ::fabs((F64)values[i] - expectedValues[i]));
+        negatedError = Max(negatedError, ::fabs((F64)values[i] + expectedValues[i]));
+    }
+    return Min(error, negatedError);
+}
+
+static void ReferenceSlerp(const Quat& a, const Quat& b, F64 t, F64 outQuat[4])
+{
+    F64 aValues[4] = { a.x, a.y, a.z, a.w };
+    F64 bValues[4] = { b.x, b.y, b.z, b.w };
+    F64 cosAngle = aValues[0] * bValues[0] + aValues[1] * bValues[1] + aValues[2] * bValues[2] + aValues[3] * bValues[3];
+    F64 bSign = cosAngle < 0.0 ? -1.0 : 1.0;
+    F64 angle = ::acos(Min(::fabs(cosAngle), 1.0));
+    F64 aWeight = 1.0 - t;
+    F64 bWeight = t;
+    if(angle > 1e-9)
+    {
+        aWeight = ::sin((1.0 - t) * angle) / ::sin(angle);
+        bWeight = ::sin(t * angle) / ::sin(angle);
+    }
+    for(U32 i = 0; i < 4; i++)
+    {
+        outQuat[i] = aValues[i] * aWeight + bValues[i] * bWeight * bSign;
+    }
+}
+
+// The rotation between q and the expected rotation in degrees. The chord between two unit quaternions is 2 sin(angle / 4)
+// of the rotation angle, which stays accurate for tiny angles where acos of the dot product would not.
+static F64 GetRotationErrorDegs(const Quat& q, const F64 expected[4])
+{
+    const F32 values[4] = { q.x, q.y, q.z, q.w };
+    F64 differenceSq = 0.0;
+    F64 sumSq = 0.0;
+    for(U32 i = 0; i < 4; i++)
+    {
+        differenceSq += (values[i] - expected[i]) * (values[i] - expected[i]);
+        sumSq += (values[i] + expected[i]) * (values[i] + expected[i]);
+    }
+    F64 chord = ::sqrt(Min(differenceSq, sumSq));
+    return 4.0 * ::asin(Min(chord * 0.5, 1.0)) * (180.0 / 3.14159265358979323846);
+}
+
+static void TestQuatMat44()
+{
+    F64 composeError = 0.0;
+    F64 rotateError = 0.0;
+    F64 roundTripError = 0.0;
+    Rng rng(19);
+    for(U32 i = 0; i < kQuatTestCount; i++)
+    {
+        Quat a = MakeTestQuat(rng);
+        Quat b = MakeTestQuat(rng);
+        composeError = Max(composeError, GetRelativeError((a * b).ToMat44(), a.ToMat44() * b.ToMat44()));
+
+        Vec3 v(rng.NextF32(-10.0f, 10.0f), rng.NextF32(-10.0f, 10.0f), rng.NextF32(-10.0f, 10.0f));
+        Vec3 expected = a.ToMat44().TransformDir(v);
+        rotateError = Max(rotateError, (F64)(a.Rotate(v) - expected).CalcLength() / Max(v.CalcLength(), 1.0f));
+
+        roundTripError = Max(roundTripError, GetQuatError(Quat::CreateFromMat33(a.ToMat33()), a));
+        roundTripError = Max(roundTripError, GetQuatError(Quat::CreateFromMat44(a.ToMat44()), a));
+    }
+
+    // each branch of CreateFromMat33, the largest of w, x, y and z, and half turns where w is 0 and the trace is -1
+    const Quat branchQuats[] =
+    {
+        Quat::kIdentity,
+        Quat::CreateRotationXDegs(180.0f), Quat::CreateRotationYDegs(180.0f), Quat::CreateRotationZDegs(180.0f),
+        Quat::CreateRotationXDegs(-179.0f), Quat::CreateRotationYDegs(-179.0f), Quat::CreateRotationZDegs(-179.0f),
+        Quat::CreateRotationAroundAxisDegs(Vec3(1.0f, 1.0f, 1.0f), 180.0f),
+        Quat::CreateRotationAroundAxisDegs(Vec3(1.0f, -2.0f, 0.5f), 150.0f),
+    };
+    for(const Quat& q : branchQuats)
+    {
+        roundTripError = Max(roundTripError, GetQuatError(Quat::CreateFromMat33(q.ToMat33()), q));
+    }
+
+    bool bPassed = SM_TEST_CHECK(composeError <= kQuatMaxError);
+    bPassed &= SM_TEST_CHECK(rotateError <= kQuatMaxError);
+    bPassed &= SM_TEST_CHECK(roundTripError <= kQuatMaxError);
+    if(!bPassed)
+    {
+        printf("    Quat: a * b vs Mat44 %.3g, Rotate %.3g, CreateFromMat33 round trip %.3g\n", composeError, rotateError, roundTripError);
+    }
+}
+
+static void TestDualQuatMat44()
+{
+    F64 composeError = 0.0;
+    F64 pointError = 0.0;
+    F64 roundTripError = 0.0;
+    F64 inverseError = 0.0;
+    Rng rng(19);
+    for(U32 i = 0; i < kQuatTestCount; i++)
+    {
+        Vec3 translationA(rng.NextF32(-10.0f, 10.0f), rng.NextF32(-10.0f, 10.0f), rng.NextF32(-10.0f, 10.0f));
+        Vec3 translationB(rng.NextF32(-10.0f, 10.0f), rng.NextF32(-10.0f, 10.0f), rng.NextF32(-10.0f, 10.0f));
+        DualQuat a(MakeTestQuat(rng), translationA);
+        DualQuat b(MakeTestQuat(rng), translationB);
+        composeError = Max(composeError, GetRelativeError((a * b).ToMat44(), a.ToMat44() * b.ToMat44()));
+
+        Vec3 point(rng.NextF32(-10.0f, 10.0f), rng.NextF32(-10.0f, 10.0f), rng.NextF32(-10.0f, 10.0f));
+        Vec3 expected = a.ToMat44().TransformPoint(point);
+        pointError = Max(pointError, (F64)(a.TransformPoint(point) - expected).CalcLength() / Max(expected.CalcLength(), 1.0f));
+
+        Mat44 m = MakeOrthonormalTestMatrix(rng);
+        roundTripError = Max(roundTripError, GetRelativeError(DualQuat::CreateFromMat44(m).ToMat44(), m));
+        inverseError = Max(inverseError, GetRelativeError((a * a.GetConjugated()).ToMat44(), Mat44::kIdentity));
+    }
+
+    bool bPassed = SM_TEST_CHECK(composeError <= kQuatMaxError);
+    bPassed &= SM_TEST_CHECK(pointError <= kQuatMaxError);
+    bPassed &= SM_TEST_CHECK(roundTripError <= kQuatMaxError);
+    bPassed &= SM_TEST_CHECK(inverseError <= kQuatMaxError);
+    if(!bPassed)
+    {
+        printf("    DualQuat: a * b vs Mat44 %.3g, TransformPoint %.3g, CreateFromMat44 round trip %.3g, a * conjugate %.3g\n",
+               composeError, pointError, roundTripError, inverseError);
+    }
+}
+
+static void TestQuatInterpolation()
+{
+    F64 nlerpError = 0.0;
+    F64 fastSlerpError = 0.0;
+    F64 halfTurnNlerpError = 0.0;
+    Rng rng(19);
+    for(U32 i = 0; i < kQuatTestCount / 16; i++)
+    {
+        // every other pair is close to a half turn apart, the worst case for nlerp. Exactly half a turn has no shortest
+        // path so the sign flip could go either way.
+        Quat a = MakeTestQuat(rng);
+        Quat b = i % 2 == 0 ? MakeTestQuat(rng) : a * Quat::CreateRotationAroundAxisDegs(MakeTestAxis(rng), 179.9f);
+        for(U32 step = 0; step <= 16; step++)
+        {
+            F32 t = step < 16 ? rng.NextF32(0.0f, 1.0f) : (F32)(i % 3) * 0.5f;
+            F64 expected[4];
+            ReferenceSlerp(a, b, t, expected);
+
+            F64 error = GetRotationErrorDegs(Nlerp(a, b, t), expected);
+            nlerpError = Max(nlerpError, error);
+            halfTurnNlerpError = i % 2 == 1 ? Max(halfTurnNlerpError, error) : halfTurnNlerpError;
+            fastSlerpError = Max(fastSlerpError, GetRotationErrorDegs(FastSlerp(a, b, t), expected));
+        }
+    }
+
+    // the ends are exact up to the sign flip and normalizing
+    Quat a = Quat::CreateRotationXDegs(30.0f);
+    Quat b = -Quat::CreateRotationYDegs(120.0f);
+    bool bPassed = SM_TEST_CHECK(GetQuatError(Nlerp(a, b, 0.0f), a) <= kQuatMaxError && GetQuatError(Nlerp(a, b, 1.0f), b) <= kQuatMaxError);
+    bPassed &= SM_TEST_CHECK(GetQuatError(FastSlerp(a, b, 0.0f), a) <= kQuatMaxError && GetQuatError(FastSlerp(a, b, 1.0f), b) <= kQuatMaxError);
+    bPassed &= SM_TEST_CHECK(Dot(Nlerp(a, b, 0.5f), a) > 0.0f);
+
+    // the nlerp bound has to come from the half turns, otherwise they were not exercised
+    bPassed &= SM_TEST_CHECK(nlerpError <= kNlerpMaxErrorDegs && halfTurnNlerpError == nlerpError);
+    bPassed &= SM_TEST_CHECK(fastSlerpError <= kFastSlerpMaxErrorDegs);
+    if(!bPassed)
+    {
+        printf("    Nlerp %.4f degrees off slerp, %.4f on half turns, FastSlerp %.4f degrees\n", nlerpError, halfTurnNlerpError, fastSlerpError);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// Batch transforms
+//------------------------------------------------------------------------------------------------------------------------
+// Odd counts so every wide kernel leaves a tail for the narrower ones, 1003 runs all of them
+static const size_t s_mathTestBatchCounts[] = { 1, 3, 7, 17, 31, 33, 1003 };
+static const size_t kMathTestMaxBatchCount = 1003;
+
+// Streams start one float into their allocation so nothing can depend on aligned loads
+static F32* AllocMathTestStream(LinearAllocator& arena, size_t count)
+{
+    return arena.Alloc<F32>(count + 1) + 1;
+}
+
+static Vec3SoA AllocMathTestVec3SoA(LinearAllocator& arena, size_t count)
+{
+    Vec3SoA vecs;
+    vecs.m_pX = AllocMathTestStream(arena, count);
+    vecs.m_pY = AllocMathTestStream(arena, count);
+    vecs.m_pZ = AllocMathTestStream(arena, count);
+    return vecs;
+}
+
+static Mat44SoA AllocMathTestMat44SoA(LinearAllocator& arena, size_t count)
+{
+    Mat44SoA matrices;
+    for(U32 element = 0; element < 16; element++)
+    {
+        matrices.m_pElements[element] = AllocMathTestStream(arena, count);
+    }
+    return matrices;
+}
+
+// Points and matrices have to match bit for bit. Directions compare with == because the scalar code also adds 0 * the
+// translation, which turns a -0 into +0.
+template<typename ScalarFunc>
+static U32 CountVec3BatchMismatches(const Vec3SoA& vecs, size_t count, bool bExact, ScalarFunc scalarFunc)
+{
+    U32 numMismatches = 0;
+    for(size_t i = 0; i < count; i++)
+    {
+        Vec3 expected = scalarFunc(i);
+        F32 batch[3] = { vecs.m_pX[i], vecs.m_pY[i], vecs.m_pZ[i] };
+        F32 scalar[3] = { expected.x, expected.y, expected.z };
+        bool bSame = bExact ? ::memcmp(batch, scalar, sizeof(batch)) == 0 : (batch[0] == scalar[0] && batch[1] == scalar[1] && batch[2] == scalar[2]);
+        numMismatches += bSame ? 0 : 1;
+    }
+    return numMismatches;
+}
+
+template<typename ScalarFunc>
+static U32 CountMat44BatchMismatches(const Mat44SoA& matrices, size_t count, ScalarFunc scalarFunc)
+{
+    U32 numMismatches = 0;
+    for(size_t i = 0; i < count; i++)
+    {
+        Mat44 expected = scalarFunc(i);
+        bool bSame = true;
+        for(U32 element = 0; element < 16; element++)
+        {
+            bSame &= ::memcmp(&matrices.m_pElements[element][i], &expected[element / 4][element % 4], sizeof(F32)) == 0;
+        }
+        numMismatches += bSame ? 0 : 1;
+    }
+    return numMismatches;
+}
+
+static void CheckMathBatchMismatches(const char* name, U32 numMismatches, SimdLevel level)
+{
+    if(!SM_TEST_CHECK(numMismatches == 0))
+    {
+        printf("    %s at %s: %u elements differ from the scalar code\n", name, GetSimdLevelName(level), numMismatches);
+    }
+}
+
+static void TestBatchTransforms()
+{
+    LinearAllocator arena;
+    arena.InitVirtual(MiB(16));
+    Rng rng(17);
+
+    Vec3* pVecs = arena.Alloc<Vec3>(kMathTestMaxBatchCount);
+    Mat44* pMatricesA = arena.Alloc<Mat44>(kMathTestMaxBatchCount);
+    Mat44* pMatricesB = arena.Alloc<Mat44>(kMathTestMaxBatchCount);
+    for(size_t i = 0; i < kMathTestMaxBatchCount; i++)
+    {
+        pVecs[i] = Vec3(rng.NextF32(-100.0f, 100.0f), rng.NextF32(-100.0f, 100.0f), rng.NextF32(-100.0f, 100.0f));
+        pMatricesA[i] = i % 2 == 0 ? MakeAffineTestMatrix(rng) : MakeGeneralTestMatrix(rng);
+        pMatricesB[i] = i % 3 == 0 ? MakeGeneralTestMatrix(rng) : MakeAffineTestMatrix(rng);
+    }
+    // the general matrix has a w column so points pick up the whole last row
+    const Mat44 uniformMatrices[] = { MakeAffineTestMatrix(rng), MakeGeneralTestMatrix(rng) };
+
+    Vec3SoA vecs = AllocMathTestVec3SoA(arena, kMathTestMaxBatchCount);
+    Vec3SoA outVecs = AllocMathTestVec3SoA(arena, kMathTestMaxBatchCount);
+    Mat44SoA matricesA = AllocMathTestMat44SoA(arena, kMathTestMaxBatchCount);
+    Mat44SoA matricesB = AllocMathTestMat44SoA(arena, kMathTestMaxBatchCount);
+    Mat44SoA outMatrices = AllocMathTestMat44SoA(arena, kMathTestMaxBatchCount);
+    ConvertToSoA(pVecs, kMathTestMaxBatchCount, vecs);
+    ConvertToSoA(pMatricesA, kMathTestMaxBatchCount, matricesA);
+    ConvertToSoA(pMatricesB, kMathTestMaxBatchCount, matricesB);
+
+    SimdLevel supportedLevel = GetSupportedSimdLevel();
+    for(U32 levelIndex = kSimdLevelScalar; levelIndex <= (U32)supportedLevel; levelIndex++)
+    {
+        SimdLevel level = (SimdLevel)levelIndex;
+        SetSimdLevel(level);
+
+        U32 numPointMismatches = 0;
+        U32 numDirMismatches = 0;
+        U32 numPerElementPointMismatches = 0;
+        U32 numPerElementDirMismatches = 0;
+        U32 numMultiplyMismatches = 0;
+        U32 numComposeMismatches = 0;
+        U32 numInPlaceMismatches = 0;
+        for(size_t count : s_mathTestBatchCounts)
+        {
+            for(const Mat44& m : uniformMatrices)
+            {
+                TransformPoints(m, vecs, outVecs, count);
+                numPointMismatches += CountVec3BatchMismatches(outVecs, count, true, [&](size_t i) { return m.TransformPoint(pVecs[i]); });
+                TransformDirs(m, vecs, outVecs, count);
+                numDirMismatches += CountVec3BatchMismatches(outVecs, count, false, [&](size_t i) { return m.TransformDir(pVecs[i]); });
+
+                ConvertToSoA(pVecs, count, outVecs);
+                TransformPoints(m, outVecs, outVecs, count);
+                numInPlaceMismatches += CountVec3BatchMismatches(outVecs, count, true, [&](size_t i) { return m.TransformPoint(pVecs[i]); });
+                ConvertToSoA(pVecs, count, outVecs);
+                TransformDirs(m, outVecs, outVecs, count);
+                numInPlaceMismatches += CountVec3BatchMismatches(outVecs, count, false, [&](size_t i) { return m.TransformDir(pVecs[i]); });
+            }
+
+            TransformPoints(matricesA, vecs, outVecs, count);
+            numPerElementPointMismatches += CountVec3BatchMismatches(outVecs, count, true, [&](size_t i) { return pMatricesA[i].TransformPoint(pVecs[i]); });
+            TransformDirs(matricesA, vecs, outVecs, count);
+            numPerElementDirMismatches += CountVec3BatchMismatches(outVecs, count, false, [&](size_t i) { return pMatricesA[i].TransformDir(pVecs[i]); });
+
+            ConvertToSoA(pVecs, count, outVecs);
+            TransformPoints(matricesA, outVecs, outVecs, count);
+            numInPlaceMismatches += CountVec3BatchMismatches(outVecs, count, true, [&](size_t i) { return pMatricesA[i].TransformPoint(pVecs[i]); });
+            ConvertToSoA(pVecs, count, outVecs);
+            TransformDirs(matricesA, outVecs, outVecs, count);
+            numInPlaceMismatches += CountVec3BatchMismatches(outVecs, count, false, [&](size_t i) { return pMatricesA[i].TransformDir(pVecs[i]); });
+
+            auto multiplied = [&](size_t i) { return pMatricesA[i] * pMatricesB[i]; };
+            MultiplyMatrices(matricesA, matricesB, outMatrices, count);
+            numMultiplyMismatches += CountMat44BatchMismatches(outMatrices, count, multiplied);
+
+            // the output may alias either input, every element of both has to be read before it is written
+            ConvertToSoA(pMatricesA, count, outMatrices);
+            MultiplyMatrices(outMatrices, matricesB, outMatrices, count);
+            numInPlaceMismatches += CountMat44BatchMismatches(outMatrices, count, multiplied);
+            ConvertToSoA(pMatricesB, count, outMatrices);
+            MultiplyMatrices(matricesA, outMatrices, outMatrices, count);
+            numInPlaceMismatches += CountMat44BatchMismatches(outMatrices, count, multiplied);
+
+            // A is the parent world and B the local transform
+            auto composed = [&](size_t i) { return pMatricesB[i] * pMatricesA[i]; };
+            ComposeWorldTransforms(matricesA, matricesB, outMatrices, count);
+            numComposeMismatches += CountMat44BatchMismatches(outMatrices, count, composed);
+
+            ConvertToSoA(pMatricesA, count, outMatrices);
+            ComposeWorldTransforms(outMatrices, matricesB, outMatrices, count);
+            numInPlaceMismatches += CountMat44BatchMismatches(outMatrices, count, composed);
+            ConvertToSoA(pMatricesB, count, outMatrices);
+            ComposeWorldTransforms(matricesA, outMatrices, outMatrices, count);
+            numInPlaceMismatches += CountMat44BatchMismatches(outMatrices, count, composed);
+        }
+        CheckMathBatchMismatches("TransformPoints", numPointMismatches, level);
+        CheckMathBatchMismatches("TransformDirs", numDirMismatches, level);
+        CheckMathBatchMismatches("TransformPoints, matrix per element", numPerElementPointMismatches, level);
+        CheckMathBatchMismatches("TransformDirs, matrix per element", numPerElementDirMismatches, level);
+        CheckMathBatchMismatches("MultiplyMatrices", numMultiplyMismatches, level);
+        CheckMathBatchMismatches("ComposeWorldTransforms", numComposeMismatches, level);
+        CheckMathBatchMismatches("In place batch transforms", numInPlaceMismatches, level);
+    }
+    SetSimdLevel(supportedLevel);
+
+    // converting to streams and back is a plain copy
+    Mat44* pRoundTrip = arena.Alloc<Mat44>(kMathTestMaxBatchCount);
+    ConvertFromSoA(matricesA, kMathTestMaxBatchCount, pRoundTrip);
+    SM_TEST_CHECK(::memcmp(pRoundTrip, pMatricesA, kMathTestMaxBatchCount * sizeof(Mat44)) == 0);
+
+    arena.Release();
+}
+
+static QuatSoA AllocMathTestQuatSoA(LinearAllocator& arena, size_t count)
+{
+    QuatSoA quats;
+    quats.m_pX = AllocMathTestStream(arena, count);
+    quats.m_pY = AllocMathTestStream(arena, count);
+    quats.m_pZ = AllocMathTestStream(arena, count);
+    quats.m_pW = AllocMathTestStream(arena, count);
+    return quats;
+}
+
+template<typename ScalarFunc>
+static U32 CountQuatBatchMismatches(const QuatSoA& quats, size_t count, ScalarFunc scalarFunc)
+{
+    U32 numMismatches = 0;
+    for(size_t i = 0; i < count; i++)
+    {
+        Quat expected = scalarFunc(i);
+        F32 batch[4] = { quats.m_pX[i], quats.m_pY[i], quats.m_pZ[i], quats.m_pW[i] };
+        F32 scalar[4] = { expected.x, expected.y, expected.z, expected.w };
+        numMismatches += ::memcmp(batch, scalar, sizeof(batch)) == 0 ? 0 : 1;
+    }
+    return numMismatches;
+}
+
+static void TestBatchQuats()
+{
+    LinearAllocator arena;
+    arena.InitVirtual(MiB(16));
+    Rng rng(19);
+
+    Quat* pQuatsA = arena.Alloc<Quat>(kMathTestMaxBatchCount);
+    Quat* pQuatsB = arena.Alloc<Quat>(kMathTestMaxBatchCount);
+    Vec3* pVecs = arena.Alloc<Vec3>(kMathTestMaxBatchCount);
+    for(size_t i = 0; i < kMathTestMaxBatchCount; i++)
+    {
+        // about half the pairs are in opposite hemispheres so the shortest path flip is taken
+        pQuatsA[i] = MakeTestQuat(rng);
+        pQuatsB[i] = MakeTestQuat(rng);
+        pVecs[i] = Vec3(rng.NextF32(-100.0f, 100.0f), rng.NextF32(-100.0f, 100.0f), rng.NextF32(-100.0f, 100.0f));
+    }
+
+    QuatSoA quatsA = AllocMathTestQuatSoA(arena, kMathTestMaxBatchCount);
+    QuatSoA quatsB = AllocMathTestQuatSoA(arena, kMathTestMaxBatchCount);
+    QuatSoA outQuats = AllocMathTestQuatSoA(arena, kMathTestMaxBatchCount);
+    Vec3SoA vecs = AllocMathTestVec3SoA(arena, kMathTestMaxBatchCount);
+    Vec3SoA outVecs = AllocMathTestVec3SoA(arena, kMathTestMaxBatchCount);
+    ConvertToSoA(pQuatsA, kMathTestMaxBatchCount, quatsA);
+    ConvertToSoA(pQuatsB, kMathTestMaxBatchCount, quatsB);
+    ConvertToSoA(pVecs, kMathTestMaxBatchCount, vecs);
+
+    static const F32 s_ts[] = { 0.0f, 0.3f, 0.5f, 1.0f };
+
+    SimdLevel supportedLevel = GetSupportedSimdLevel();
+    for(U32 levelIndex = kSimdLevelScalar; levelIndex <= (U32)supportedLevel; levelIndex++)
+    {
+        SimdLevel level = (SimdLevel)levelIndex;
+        SetSimdLevel(level);
+
+        U32 numMultiplyMismatches = 0;
+        U32 numNlerpMismatches = 0;
+        U32 numFastSlerpMismatches = 0;
+        U32 numRotateMismatches = 0;
+        U32 numInPlaceMismatches = 0;
+        for(size_t count : s_mathTestBatchCounts)
+        {
+            auto multiplied = [&](size_t i) { return pQuatsA[i] * pQuatsB[i]; };
+            MultiplyQuats(quatsA, quatsB, outQuats, count);
+            numMultiplyMismatches += CountQuatBatchMismatches(outQuats, count, multiplied);
+            ConvertToSoA(pQuatsA, count, outQuats);
+            MultiplyQuats(outQuats, quatsB, outQuats, count);
+            numInPlaceMismatches += CountQuatBatchMismatches(outQuats, count, multiplied);
+            ConvertToSoA(pQuatsB, count, outQuats);
+            MultiplyQuats(quatsA, outQuats, outQuats, count);
+            numInPlaceMismatches += CountQuatBatchMismatches(outQuats, count, multiplied);
+
+            for(F32 t : s_ts)
+            {
+                auto nlerped = [&](size_t i) { return Nlerp(pQuatsA[i], pQuatsB[i], t); };
+                NlerpQuats(quatsA, quatsB, t, outQuats, count);
+                numNlerpMismatches += CountQuatBatchMismatches(outQuats, count, nlerped);
+                ConvertToSoA(pQuatsA, count, outQuats);
+                NlerpQuats(outQuats, quatsB, t, outQuats, count);
+                numInPlaceMismatches += CountQuatBatchMismatches(outQuats, count, nlerped);
+
+                auto slerped = [&](size_t i) { return FastSlerp(pQuatsA[i], pQuatsB[i], t); };
+                FastSlerpQuats(quatsA, quatsB, t, outQuats, count);
+                numFastSlerpMismatches += CountQuatBatchMismatches(outQuats, count, slerped);
+                ConvertToSoA(pQuatsB, count, outQuats);
+                FastSlerpQuats(quatsA, outQuats, t, outQuats, count);
+                numInPlaceMismatches += CountQuatBatchMismatches(outQuats, count, slerped);
+            }
+
+            auto rotated = [&](size_t i) { return pQuatsA[i].Rotate(pVecs[i]); };
+            RotateVecs(quatsA, vecs, outVecs, count);
+            numRotateMismatches += CountVec3BatchMismatches(outVecs, count, true, rotated);
+            ConvertToSoA(pVecs, count, outVecs);
+            RotateVecs(quatsA, outVecs, outVecs, count);
+            numInPlaceMismatches += CountVec3BatchMismatches(outVecs, count, true, rotated);
+        }
+        CheckMathBatchMismatches("MultiplyQuats", numMultiplyMismatches, level);
+        CheckMathBatchMismatches("NlerpQuats", numNlerpMismatches, level);
+        CheckMathBatchMismatches("FastSlerpQuats", numFastSlerpMismatches, level);
+        CheckMathBatchMismatches("RotateVecs", numRotateMismatches, level);
+        CheckMathBatchMismatches("In place batch quats", numInPlaceMismatches, level);
+    }
+    SetSimdLevel(supportedLevel);
+    arena.Release();
+}
+
+void RunMathTests()
+{
+    TestMat44Determinant();
+    TestMat44Inverse();
+    TestQuatMat44();
+    TestDualQuatMat44();
+    TestQuatInterpolation();
+    TestBatchTransforms();
+    TestBatchQuats();
+}
@@ -0,0 +1,372 @@
+#include "SM/Memory.h"
+#include "SM/Random.h"
+#include "SM/Util.h"
+#include "Tests/Bench.h"
+
+#include <cstdlib>
+
+using namespace SM;
+
+//------------------------------------------------------------------------------------------------------------------------
+// Thread scratch arenas
+//------------------------------------------------------------------------------------------------------------------------
+static const U32 kScratchScopesPerThread = 200000;
+static const U32 kScratchAllocsPerScope = 16;
+
+static void BenchThreadScratchScaling()
+{
+    BenchHeader("Thread scratch arenas, 16 x 32 byte SM::Alloc per pushed scope vs malloc/free");
+
+    for(U32 numThreads = 1; numThreads <= GetBenchMaxThreads(); numThreads = GetNextBenchThreadCount(numThreads))
+    {
+        U64 numAllocs = (U64)numThreads * kScratchScopesPerThread * kScratchAllocsPerScope;
+
+        F64 scratchMs = BenchMinMs([numThreads]()
+        {
+            BenchThreadsMs(numThreads, [](U32 threadIndex)
+            {
+                U32 sum = 0;
+                for(U32 scope = 0; scope < kScratchScopesPerThread; scope++)
+                {
+                    ScopedScratchAllocator scratch;
+                    for(U32 i = 0; i < kScratchAllocsPerScope; i++)
+                    {
+                        U32* pItems = SM::Alloc<U32>(8);
+                        pItems[0] = i;
+                        sum += pItems[0];
+                    }
+                }
+                BenchKeep(sum + threadIndex);
+            });
+        }, 3);
+
+        F64 mallocMs = BenchMinMs([numThreads]()
+        {
+            BenchThreadsMs(numThreads, [](U32 threadIndex)
+            {
+                U32 sum = 0;
+                U32* allocations[kScratchAllocsPerScope];
+                for(U32 scope = 0; scope < kScratchScopesPerThread; scope++)
+                {
+                    for(U32 i = 0; i < kScratchAllocsPerScope; i++)
+                    {
+                        allocations[i] = (U32*)::malloc(8 * sizeof(U32));
+                        allocations[i][0] = i;
+                        sum += allocations[i][0];
+                    }
+                    for(U32 i = 0; i < kScratchAllocsPerScope; i++)
+                    {
+                        ::free(allocations[i]);
+                    }
+                }
+                BenchKeep(sum + threadIndex);
+            });
+        }, 3);
+
+        char name[64];
+        snprintf(name, sizeof(name), "scratch, %u threads", numThreads);
+        BenchReport(name, scratchMs, numAllocs);
+        snprintf(name, sizeof(name), "malloc/free, %u threads", numThreads);
+        BenchReport(name, mallocMs, numAllocs);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// Pool allocator
+//------------------------------------------------------------------------------------------------------------------------
+struct BenchParticle
+{
+    F32 m_data[12];
+};
+
+struct BenchRenderObject
+{
+    F32 m_transform[16];
+    U32 m_meshId;
+    U32 m_materialId;
+};
+
+static const U32 kNumBurstParticles = 10000;
+static const U32 kNumBursts = 200;
+static const U32 kNumChurnLiveObjects = 4096;
+static const U32 kNumChurnOps = 2000000;
+
+static void BenchPoolAllocator()
+{
+    BenchHeader("PoolAllocator vs malloc/free");
+
+    LinearAllocator parent;
+    parent.InitVirtual(GiB(1));
+    void** pointers = parent.Alloc<void*>(kNumBurstParticles);
+
+    // particle bursts, allocate a whole emitter worth then free it all
+    F64 poolBurstMs = BenchMinMs([&]()
+    {
+        PoolAllocator pool;
+        pool.Init<BenchParticle>(&parent, 1024);
+        for(U32 burst = 0; burst < kNumBursts; burst++)
+        {
+            for(U32 i = 0; i < kNumBurstParticles; i++)
+            {
+                BenchParticle* pParticle = pool.Alloc<BenchParticle>();
+                pParticle->m_data[0] = (F32)i;
+                pointers[i] = pParticle;
+            }
+            for(U32 i = 0; i < kNumBurstParticles; i++)
+            {
+                pool.Free(pointers[i]);
+            }
+        }
+    });
+
+    F64 mallocBurstMs = BenchMinMs([&]()
+    {
+        for(U32 burst = 0; burst < kNumBursts; burst++)
+        {
+            for(U32 i = 0; i < kNumBurstParticles; i++)
+            {
+                BenchParticle* pParticle = (BenchParticle*)::malloc(sizeof(BenchParticle));
+                pParticle->m_data[0] = (F32)i;
+                pointers[i] = pParticle;
+            }
+            for(U32 i = 0; i < kNumBurstParticles; i++)
+            {
+                ::free(pointers[i]);
+            }
+        }
+    });
+
+    U64 numBurstOps = (U64)kNumBursts * kNumBurstParticles;
+    BenchReport("pool, particle bursts (alloc + free)", poolBurstMs, numBurstOps);
+    BenchReport("malloc, particle bursts (alloc + free)", mallocBurstMs, numBurstOps);
+
+    // transient render objects, a steady live set where a random object is replaced every op so the free list gets shuffled
+    U32* replaceOrder = parent.Alloc<U32>(kNumChurnOps);
+    Rng rng(1);
+    for(U32 i = 0; i < kNumChurnOps; i++)
+    {
+        replaceOrder[i] = rng.NextU32(kNumChurnLiveObjects);
+    }
+
+    F64 poolChurnMs = BenchMinMs([&]()
+    {
+        PoolAllocator pool;
+        pool.Init<BenchRenderObject>(&parent, 1024);
+        for(U32 i = 0; i < kNumChurnLiveObjects; i++)
+        {
+            pointers[i] = pool.Alloc<BenchRenderObject>();
+        }
+        for(U32 i = 0; i < kNumChurnOps; i++)
+        {
+            U32 slot = replaceOrder[i];
+            pool.Free(pointers[slot]);
+            BenchRenderObject* pObject = pool.Alloc<BenchRenderObject>();
+            pObject->m_meshId = i;
+            pointers[slot] = pObject;
+        }
+        for(U32 i = 0; i < kNumChurnLiveObjects; i++)
+        {
+            pool.Free(pointers[i]);
+        }
+    });
+
+    F64 mallocChurnMs = BenchMinMs([&]()
+    {
+        for(U32 i = 0; i < kNumChurnLiveObjects; i++)
+        {
+            pointers[i] = ::malloc(sizeof(BenchRenderObject));
+        }
+        for(U32 i = 0; i < kNumChurnOps; i++)
+        {
+            U32 slot = replaceOrder[i];
+            ::free(pointers[slot]);
+            BenchRenderObject* pObject = (BenchRenderObject*)::malloc(sizeof(BenchRenderObject));
+            pObject->m_meshId = i;
+            pointers[slot] = pObject;
+        }
+        for(U32 i = 0; i < kNumChurnLiveObjects; i++)
+        {
+            ::free(pointers[i]);
+        }
+    });
+
+    BenchReport("pool, render object churn (free + alloc)", poolChurnMs, kNumChurnOps);
+    BenchReport("malloc, render object churn (free + alloc)", mallocChurnMs, kNumChurnOps);
+
+    parent.Release();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// Heap allocator
+//------------------------------------------------------------------------------------------------------------------------
+static const U32 kNumHeapLiveAllocations = 8192;
+static const U32 kNumHeapOps = 500000;
+
+struct HeapBenchOp
+{
+    U32 m_slot;
+    U32 m_size;
+};
+
+// The churn runs twice, the first pass includes growing the heap and faulting in pages, the second shows the steady state
+template<typename AllocFunc, typename FreeFunc>
+static void RunHeapLatency(const char* name, const HeapBenchOp* pOps, void** pointers, F32* pAllocNs, F32* pFreeNs, AllocFunc alloc, FreeFunc free)
+{
+    static const char* s_passNames[] = { "first pass", "steady state" };
+
+    for(U32 pass = 0; pass < ARRAY_LEN(s_passNames); pass++)
+    {
+        for(U32 i = 0; i < kNumHeapLiveAllocations; i++)
+        {
+            pointers[i] = alloc(pOps[i].m_size);
+        }
+
+        // time every op on its own, a single slow alloc or free is a frame hitch no matter how good the average is
+        for(U32 i = 0; i < kNumHeapOps; i++)
+        {
+            const HeapBenchOp& op = pOps[i];
+
+            BenchTimer freeTimer;
+            free(pointers[op.m_slot]);
+            pFreeNs[i] = (F32)freeTimer.GetElapsedNs();
+
+            BenchTimer allocTimer;
+            void* ptr = alloc(op.m_size);
+            pAllocNs[i] = (F32)allocTimer.GetElapsedNs();
+
+            *(U32*)ptr = i;
+            pointers[op.m_slot] = ptr;
+        }
+
+        for(U32 i = 0; i < kNumHeapLiveAllocations; i++)
+        {
+            free(pointers[i]);
+        }
+
+        char label[64];
+        snprintf(label, sizeof(label), "%s alloc, %s", name, s_passNames[pass]);
+        BenchReportLatency(label, pAllocNs, kNumHeapOps);
+        snprintf(label, sizeof(label), "%s free, %s", name, s_passNames[pass]);
+        BenchReportLatency(label, pFreeNs, kNumHeapOps);
+    }
+}
+
+static void BenchHeapAllocator()
+{
+    BenchHeader("HeapAllocator vs malloc/free per op latency, 8K live blocks, 7/8 16-512 B and 1/8 up to 64 KiB");
+
+    LinearAllocator scratch;
+    scratch.InitVirtual(GiB(1));
+    HeapBenchOp* pOps = scratch.Alloc<HeapBenchOp>(kNumHeapOps);
+    void** pointers = scratch.Alloc<void*>(kNumHeapLiveAllocations);
+    F32* pAllocNs = scratch.Alloc<F32>(kNumHeapOps);
+    F32* pFreeNs = scratch.Alloc<F32>(kNumHeapOps);
+
+    Rng rng(4);
+    for(U32 i = 0; i < kNumHeapOps; i++)
+    {
+        pOps[i].m_slot = rng.NextU32(kNumHeapLiveAllocations);
+        pOps[i].m_size = rng.NextU32(8) == 0 ? 16 + rng.NextU32(KiB(64)) : 16 + rng.NextU32(496);
+    }
+
+    HeapAllocator heap;
+    heap.InitVirtual(GiB(4));
+    RunHeapLatency("heap", pOps, pointers, pAllocNs, pFreeNs,
+                   [&heap](size_t size) { return heap.Alloc(size); },
+                   [&heap](void* ptr) { heap.Free(ptr); });
+
+    RunHeapLatency("malloc", pOps, pointers, pAllocNs, pFreeNs,
+                   [](size_t size) { return ::malloc(size); },
+                   [](void* ptr) { ::free(ptr); });
+
+    // the same churn again to read the fragmentation it leaves behind while the live set is still allocated
+    for(U32 i = 0; i < kNumHeapLiveAllocations; i++)
+    {
+        pointers[i] = heap.Alloc(pOps[i].m_size);
+    }
+    for(U32 i = 0; i < kNumHeapOps; i++)
+    {
+        heap.Free(pointers[pOps[i].m_slot]);
+        pointers[pOps[i].m_slot] = heap.Alloc(pOps[i].m_size);
+    }
+
+    HeapAllocator::Stats stats = heap.GetStats();
+    printf("    heap after churn: %zu used, %zu free in %u blocks, largest free %zu, fragmentation %.3f\n",
+           stats.m_usedBytes, stats.m_freeBytes, stats.m_numFreeBlocks, stats.m_largestFreeBlock, stats.CalcFragmentation());
+
+    heap.Release();
+    scratch.Release();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// Large pages
+//------------------------------------------------------------------------------------------------------------------------
+static const size_t kTraversalArenaSize = GiB(1);
+static const U32 kNumRandomReads = 1 << 24;
+
+static void BenchArenaTraversal(const char* name, LinearAllocator* pArena)
+{
+    size_t numElements = kTraversalArenaSize / sizeof(U64);
+    U64* pElements = pArena->Alloc<U64>(numElements);
+    for(size_t i = 0; i < numElements; i++)
+    {
+        pElements[i] = i;
+    }
+
+    F64 linearMs = BenchMinMs([=]()
+    {
+        U64 sum = 0;
+        for(size_t i = 0; i < numElements; i++)
+        {
+            sum += pElements[i];
+        }
+        BenchKeep(sum);
+    }, 3);
+
+    // each read lands on an effectively random page so almost every one is a TLB miss with 4 KiB pages
+    F64 randomMs = BenchMinMs([=]()
+    {
+        Rng rng(7);
+        U64 sum = 0;
+        for(U32 i = 0; i < kNumRandomReads; i++)
+        {
+            sum += pElements[rng.NextU64() & (numElements - 1)];
+        }
+        BenchKeep(sum);
+    }, 3);
+
+    char label[64];
+    snprintf(label, sizeof(label), "%s, linear", name);
+    BenchReport(label, linearMs, numElements);
+    snprintf(label, sizeof(label), "%s, random", name);
+    BenchReport(label, randomMs, kNumRandomReads);
+}
+
+static void BenchLargePages()
+{
+    BenchHeader("1 GiB arena traversal, U64 reads with regular vs large pages");
+
+    LinearAllocator arena;
+    arena.InitVirtual(kTraversalArenaSize);
+    BenchArenaTraversal("regular pages", &arena);
+    arena.Release();
+
+    arena.InitLargePages(kTraversalArenaSize);
+    if(arena.m_bUsesLargePages)
+    {
+        BenchArenaTraversal("large pages", &arena);
+    }
+    else
+    {
+        printf("    large pages unavailable, skipped\n");
+    }
+    arena.Release();
+}
+
+void RunMemoryBenchmarks()
+{
+    BenchThreadScratchScaling();
+    BenchPoolAllocator();
+    BenchHeapAllocator();
+    BenchLargePages();
+}
@@ -0,0 +1,249 @@
+#include "SM/Memory.h"
+#include "SM/Random.h"
+#include "Tests/Test.h"
+
+using namespace SM;
+
+//------------------------------------------------------------------------------------------------------------------------
+// Heap allocator
+//------------------------------------------------------------------------------------------------------------------------
+static const U32 kHeapTestNumAllocs = 2000;
+
+// Every free block merged back into one means the whole heap is free again, minus the header and the end sentinel
+static bool CheckHeapFullyCoalesced(const HeapAllocator& heap, const char* name)
+{
+    HeapAllocator::Stats stats = heap.GetStats();
+    size_t expectedFreeBytes = stats.m_committedBytes - 2 * sizeof(HeapAllocator::BlockHeader);
+    bool bPassed = SM_TEST_CHECK(stats.m_numUsedBlocks == 0 && stats.m_usedBytes == 0);
+    bPassed &= SM_TEST_CHECK(stats.m_numFreeBlocks == 1 && stats.m_freeBytes == expectedFreeBytes);
+    if(!bPassed)
+    {
+        printf("    %s: %u used blocks, %u free blocks, %llu of %llu bytes free\n", name, stats.m_numUsedBlocks, stats.m_numFreeBlocks,
+               (unsigned long long)stats.m_freeBytes, (unsigned long long)expectedFreeBytes);
+    }
+    return bPassed;
+}
+
+// Random sizes and alignments freed in random order, payloads are filled so overlapping blocks show up as corrupted bytes
+static void StressHeap(HeapAllocator& heap, const char* name)
+{
+    struct HeapTestAlloc
+    {
+        Byte* m_pData;
+        size_t m_size;
+        Byte m_fill;
+    };
+
+    LinearAllocator arena;
+    arena.InitVirtual(MiB(1));
+    HeapTestAlloc* pAllocs = arena.Alloc<HeapTestAlloc>(kHeapTestNumAllocs);
+
+    Rng rng(4);
+    U32 numMisaligned = 0;
+    U32 numWrongSizes = 0;
+    U32 numCorrupted = 0;
+    size_t usedBytes = 0;
+    for(U32 i = 0; i < kHeapTestNumAllocs; i++)
+    {
+        size_t size = rng.NextU32(4) == 0 ? 1 + rng.NextU32(KiB(16)) : 1 + rng.NextU32(256);
+        U32 alignment = kAlign16 << rng.NextU32(6);
+        Byte* pData = (Byte*)heap.Alloc(size, alignment);
+        numMisaligned += ((uintptr_t)pData & (alignment - 1)) != 0 ? 1 : 0;
+
+        size_t allocationSize = heap.GetAllocationSize(pData);
+        numWrongSizes += (allocationSize < size || (allocationSize & (kAlign16 - 1)) != 0) ? 1 : 0;
+        usedBytes += allocationSize;
+
+        pAllocs[i] = { pData, size, (Byte)i };
+        ::memset(pData, pAllocs[i].m_fill, size);
+    }
+    SM_TEST_CHECK(numMisaligned == 0);
+    SM_TEST_CHECK(numWrongSizes == 0);
+    SM_TEST_CHECK(heap.GetStats().m_usedBytes == usedBytes && heap.GetStats().m_numUsedBlocks == kHeapTestNumAllocs);
+
+    for(U32 i = kHeapTestNumAllocs - 1; i > 0; i--)
+    {
+        U32 swapIndex = rng.NextU32(i + 1);
+        HeapTestAlloc temp = pAllocs[i];
+        pAllocs[i] = pAllocs[swapIndex];
+        pAllocs[swapIndex] = temp;
+    }
+
+    for(U32 i = 0; i < kHeapTestNumAllocs; i++)
+    {
+        for(size_t byte = 0; byte < pAllocs[i].m_size; byte++)
+        {
+            numCorrupted += pAllocs[i].m_pData[byte] != pAllocs[i].m_fill ? 1 : 0;
+        }
+        heap.Free(pAllocs[i].m_pData);
+    }
+    if(!SM_TEST_CHECK(numMisaligned == 0 && numWrongSizes == 0 && numCorrupted == 0))
+    {
+        printf("    %s: %u misaligned, %u wrong sizes, %u corrupted bytes\n", name, numMisaligned, numWrongSizes, numCorrupted);
+    }
+    CheckHeapFullyCoalesced(heap, name);
+
+    arena.Release();
+}
+
+static void TestHeapAllocatorFixed()
+{
+    const size_t kStorageSize = MiB(16);
+    LinearAllocator arena;
+    arena.InitVirtual(kStorageSize + kAlign16);
+    void* pStorage = arena.Alloc(kStorageSize, kAlign16);
+
+    HeapAllocator heap;
+    heap.Init(pStorage, kStorageSize);
+    SM_TEST_CHECK(heap.GetStats().m_committedBytes == kStorageSize);
+    CheckHeapFullyCoalesced(heap, "fixed init");
+
+    StressHeap(heap, "fixed");
+
+    // a block that needs most of the buffer still fits and stays inside the caller's storage without anything committed
+    const size_t kHalfSize = kStorageSize / 2;
+    Byte* pHalf = (Byte*)heap.Alloc(kHalfSize, kAlign1KiB);
+    SM_TEST_CHECK(pHalf != nullptr && ((uintptr_t)pHalf & (kAlign1KiB - 1)) == 0);
+    SM_TEST_CHECK(pHalf >= (Byte*)pStorage && pHalf + kHalfSize <= (Byte*)pStorage + kStorageSize);
+    SM_TEST_CHECK(heap.GetStats().m_committedBytes == kStorageSize && heap.GetStats().m_numFreeBlocks == 2);
+    ::memset(pHalf, 0xcd, kHalfSize);
+    heap.Free(pHalf);
+    CheckHeapFullyCoalesced(heap, "fixed half block");
+
+    heap.Release();
+    arena.Release();
+}
+
+static void TestHeapAllocatorVirtual()
+{
+    HeapAllocator heap;
+    heap.InitVirtual(MiB(64));
+    SM_TEST_CHECK(heap.GetStats().m_committedBytes == HeapAllocator::kVirtualGrowGranularity);
+
+    // more than the initial commit has to grow, the new pages merge with the free tail so it is still one block after
+    void* pLarge = heap.Alloc(MiB(3), kAlign256);
+    HeapAllocator::Stats stats = heap.GetStats();
+    SM_TEST_CHECK(pLarge != nullptr && ((uintptr_t)pLarge & (kAlign256 - 1)) == 0);
+    SM_TEST_CHECK(stats.m_committedBytes > MiB(3) && stats.m_committedBytes % HeapAllocator::kVirtualGrowGranularity == 0);
+    SM_TEST_CHECK(heap.GetAllocationSize(pLarge) >= MiB(3));
+    ::memset(pLarge, 0xab, MiB(3));
+    heap.Free(pLarge);
+    CheckHeapFullyCoalesced(heap, "virtual grow");
+
+    // many small blocks filling past the committed size grow one granule at a time
+    size_t committedBefore = heap.GetStats().m_committedBytes;
+    const U32 kNumSmallAllocs = (U32)(committedBefore / KiB(1)) + 64;
+    LinearAllocator arena;
+    arena.InitVirtual(MiB(1));
+    void** pSmallAllocs = arena.Alloc<void*>(kNumSmallAllocs);
+    for(U32 i = 0; i < kNumSmallAllocs; i++)
+    {
+        pSmallAllocs[i] = heap.Alloc(KiB(1) - sizeof(HeapAllocator::BlockHeader));
+        ::memset(pSmallAllocs[i], (int)i, KiB(1) - sizeof(HeapAllocator::BlockHeader));
+    }
+    SM_TEST_CHECK(heap.GetStats().m_committedBytes > committedBefore);
+    for(U32 i = 0; i < kNumSmallAllocs; i++)
+    {
+        heap.Free(pSmallAllocs[i]);
+    }
+    CheckHeapFullyCoalesced(heap, "virtual small grow");
+
+    StressHeap(heap, "virtual");
+
+    arena.Release();
+    heap.Release();
+}
+
+static void TestHeapAllocatorAlignment()
+{
+    HeapAllocator heap;
+    heap.InitVirtual(MiB(16));
+
+    // every power of two alignment for sizes right around the minimum block, each one pinned down while the next is made
+    void* pAllocs[8 * 5];
+    U32 numAllocs = 0;
+    U32 numMisaligned = 0;
+    for(U32 alignment = kAlign16; alignment <= KiB(2); alignment <<= 1)
+    {
+        for(size_t size : { (size_t)1, (size_t)15, (size_t)16, (size_t)17, (size_t)alignment })
+        {
+            void* ptr = heap.Alloc(size, alignment);
+            if(((uintptr_t)ptr & (alignment - 1)) != 0 || heap.GetAllocationSize(ptr) < size)
+            {
+                printf("    size %llu alignment %u: %p, allocation size %llu\n", (unsigned long long)size, alignment, ptr,
+                       (unsigned long long)heap.GetAllocationSize(ptr));
+                numMisaligned++;
+            }
+            pAllocs[numAllocs++] = ptr;
+        }
+    }
+    SM_TEST_CHECK(numMisaligned == 0);
+
+    // minimum sized blocks round up to 16 bytes
+    void* pTiny = heap.Alloc(1);
+    SM_TEST_CHECK(heap.GetAllocationSize(pTiny) == HeapAllocator::kMinBlockSize);
+    heap.Free(pTiny);
+
+    for(U32 i = 0; i < numAllocs; i += 2)
+    {
+        heap.Free(pAllocs[i]);
+    }
+    for(U32 i = 1; i < numAllocs; i += 2)
+    {
+        heap.Free(pAllocs[i]);
+    }
+    CheckHeapFullyCoalesced(heap, "alignment");
+
+    heap.Release();
+}
+
+static void TestHeapAllocatorCoalescing()
+{
+    HeapAllocator heap;
+    heap.InitVirtual(MiB(16));
+
+    // the free tail after the blocks counts as one, freeing in this order merges with the previous block, the next block
+    // and both at once until everything is back to the single block
+    const U32 kNumBlocks = 9;
+    void* pBlocks[kNumBlocks];
+    for(U32 i = 0; i < kNumBlocks; i++)
+    {
+        pBlocks[i] = heap.Alloc(100 + i * 32);
+    }
+
+    U32 freeOrder[kNumBlocks] = { 1, 0, 2, 4, 5, 3, 7, 6, 8 };
+    U32 numExpectedFreeBlocks[kNumBlocks] = { 2, 2, 2, 3, 3, 2, 3, 2, 1 };
+    U32 numWrongCounts = 0;
+    for(U32 i = 0; i < kNumBlocks; i++)
+    {
+        heap.Free(pBlocks[freeOrder[i]]);
+        U32 numFreeBlocks = heap.GetStats().m_numFreeBlocks;
+        if(numFreeBlocks != numExpectedFreeBlocks[i])
+        {
+            printf("    after freeing block %u: %u free blocks, expected %u\n", freeOrder[i], numFreeBlocks, numExpectedFreeBlocks[i]);
+            numWrongCounts++;
+        }
+    }
+    SM_TEST_CHECK(numWrongCounts == 0);
+    CheckHeapFullyCoalesced(heap, "coalescing");
+
+    // a freed block in a smaller size class is reused before the large free tail gets split
+    void* pFirst = heap.Alloc(512);
+    void* pSecond = heap.Alloc(512);
+    heap.Free(pFirst);
+    SM_TEST_CHECK(heap.GetStats().CalcFragmentation() > 0.0f);
+    SM_TEST_CHECK(heap.Alloc(256) == pFirst);
+    heap.Free(pFirst);
+    heap.Free(pSecond);
+    CheckHeapFullyCoalesced(heap, "reuse");
+
+    heap.Release();
+}
+
+static void RunMemoryTests()
+{
+    TestHeapAllocatorFixed();
+    TestHeapAllocatorVirtual();
+    TestHeapAllocatorAlignment();
+    TestHeapAllocatorCoalescing();
+}
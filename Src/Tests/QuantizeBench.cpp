@@ -0,0 +1,258 @@
+#include "SM/MathBatch.h"
+#include "SM/Memory.h"
+#include "SM/Quantize.h"
+#include "SM/Random.h"
+#include "Tests/Bench.h"
+
+using namespace SM;
+
+//------------------------------------------------------------------------------------------------------------------------
+// Encoders
+//------------------------------------------------------------------------------------------------------------------------
+// Inputs and outputs of the widest encoder stay in L2, as in the math benches
+static const U32 kQuantizeBenchItems = 8192;
+static const U32 kQuantizeBenchPasses = 64;
+
+template<typename Func>
+static F64 BenchQuantizeOpMs(Func func)
+{
+    return BenchMinMs([&func]()
+    {
+        for(U32 pass = 0; pass < kQuantizeBenchPasses; pass++)
+        {
+            func();
+        }
+    });
+}
+
+static Vec3 MakeQuantizeBenchDir(Rng& rng)
+{
+    for(;;)
+    {
+        Vec3 v(rng.NextF32(-1.0f, 1.0f), rng.NextF32(-1.0f, 1.0f), rng.NextF32(-1.0f, 1.0f));
+        F32 lengthSq = v.CalcLengthSq();
+        if(lengthSq > 0.01f && lengthSq <= 1.0f)
+            return v.GetNormalized();
+    }
+}
+
+static void BenchQuantizeEncoders()
+{
+    BenchHeader("Quantize, per element scalar encoders vs batch encoders");
+
+    LinearAllocator arena;
+    arena.InitVirtual(MiB(16));
+    F32* pValues = arena.Alloc<F32>(kQuantizeBenchItems);
+    U16* pHalfs = arena.Alloc<U16>(kQuantizeBenchItems);
+    F32* pOutValues = arena.Alloc<F32>(kQuantizeBenchItems);
+    F32* pScaledValues = arena.Alloc<F32>(kQuantizeBenchItems);
+    U16* pOutHalfs = arena.Alloc<U16>(kQuantizeBenchItems);
+    I16* pOutSnorm16 = arena.Alloc<I16>(kQuantizeBenchItems);
+    U32* pOutPacked = arena.Alloc<U32>(kQuantizeBenchItems);
+    PackedTangentFrame* pOutFrames = arena.Alloc<PackedTangentFrame>(kQuantizeBenchItems);
+    Vec3* pNormals = arena.Alloc<Vec3>(kQuantizeBenchItems);
+    Vec3* pTangents = arena.Alloc<Vec3>(kQuantizeBenchItems);
+    F32* pSigns = arena.Alloc<F32>(kQuantizeBenchItems);
+    Vec3SoA normals;
+    Vec3SoA tangents;
+    normals.m_pX = arena.Alloc<F32>(kQuantizeBenchItems);
+    normals.m_pY = arena.Alloc<F32>(kQuantizeBenchItems);
+    normals.m_pZ = arena.Alloc<F32>(kQuantizeBenchItems);
+    tangents.m_pX = arena.Alloc<F32>(kQuantizeBenchItems);
+    tangents.m_pY = arena.Alloc<F32>(kQuantizeBenchItems);
+    tangents.m_pZ = arena.Alloc<F32>(kQuantizeBenchItems);
+
+    Rng rng(24);
+    for(U32 i = 0; i < kQuantizeBenchItems; i++)
+    {
+        pValues[i] = rng.NextF32(-1000.0f, 1000.0f);
+        pHalfs[i] = ConvertF32ToF16(pValues[i]);
+        pNormals[i] = MakeQuantizeBenchDir(rng);
+        do
+        {
+            pTangents[i] = MakeQuantizeBenchDir(rng);
+        } while(::fabsf(Dot(pNormals[i], pTangents[i])) > 0.99f);
+        pSigns[i] = rng.NextU32(2) == 0 ? 1.0f : -1.0f;
+    }
+    ConvertToSoA(pNormals, kQuantizeBenchItems, normals);
+    ConvertToSoA(pTangents, kQuantizeBenchItems, tangents);
+
+    U64 numOps = (U64)kQuantizeBenchItems * kQuantizeBenchPasses;
+
+    F64 toHalfMs = BenchQuantizeOpMs([&]() { for(U32 i = 0; i < kQuantizeBenchItems; i++) pOutHalfs[i] = ConvertF32ToF16(pValues[i]); });
+    BenchKeep(pOutHalfs[kQuantizeBenchItems - 1]);
+    F64 fromHalfMs = BenchQuantizeOpMs([&]() { for(U32 i = 0; i < kQuantizeBenchItems; i++) pOutValues[i] = ConvertF16ToF32(pHalfs[i]); });
+    BenchKeep(pOutValues[kQuantizeBenchItems - 1]);
+    F64 snorm16Ms = BenchQuantizeOpMs([&]() { for(U32 i = 0; i < kQuantizeBenchItems; i++) pOutSnorm16[i] = EncodeSnorm16(pValues[i] * 1e-3f); });
+    BenchKeep(pOutSnorm16[kQuantizeBenchItems - 1]);
+    F64 packMs = BenchQuantizeOpMs([&]() { for(U32 i = 0; i < kQuantizeBenchItems; i++) pOutPacked[i] = PackSnorm1010102(Vec4(pNormals[i], pSigns[i])); });
+    BenchKeep(pOutPacked[kQuantizeBenchItems - 1]);
+    F64 octahedralMs = BenchQuantizeOpMs([&]() { for(U32 i = 0; i < kQuantizeBenchItems; i++) pOutPacked[i] = EncodeOctahedralSnorm16(pNormals[i]); });
+    BenchKeep(pOutPacked[kQuantizeBenchItems - 1]);
+    F64 framesMs = BenchQuantizeOpMs([&]() { for(U32 i = 0; i < kQuantizeBenchItems; i++) pOutFrames[i] = EncodeTangentFrame(pNormals[i], pTangents[i], pSigns[i]); });
+    BenchKeep(pOutFrames[kQuantizeBenchItems - 1].w);
+
+    BenchReport("ConvertF32ToF16 per element", toHalfMs, numOps);
+    BenchReport("ConvertF16ToF32 per element", fromHalfMs, numOps);
+    BenchReport("EncodeSnorm16 per element", snorm16Ms, numOps);
+    BenchReport("PackSnorm1010102 per element", packMs, numOps);
+    BenchReport("EncodeOctahedralSnorm16 per element", octahedralMs, numOps);
+    BenchReport("EncodeTangentFrame per element", framesMs, numOps);
+
+    // the batch versions give the same bits, scaled snorm input is precomputed since the batch encoder takes no scale
+    for(U32 i = 0; i < kQuantizeBenchItems; i++)
+    {
+        pScaledValues[i] = pValues[i] * 1e-3f;
+    }
+
+    SimdLevel supportedLevel = GetSupportedSimdLevel();
+    for(U32 level = kSimdLevelScalar; level <= (U32)supportedLevel; level++)
+    {
+        SetSimdLevel((SimdLevel)level);
+        F64 batchToHalfMs = BenchQuantizeOpMs([&]() { ConvertF32ToF16(pValues, pOutHalfs, kQuantizeBenchItems); });
+        BenchKeep(pOutHalfs[kQuantizeBenchItems - 1]);
+        F64 batchFromHalfMs = BenchQuantizeOpMs([&]() { ConvertF16ToF32(pHalfs, pOutValues, kQuantizeBenchItems); });
+        BenchKeep(pOutValues[kQuantizeBenchItems - 1]);
+        F64 batchSnorm16Ms = BenchQuantizeOpMs([&]() { EncodeSnorm16(pScaledValues, pOutSnorm16, kQuantizeBenchItems); });
+        BenchKeep(pOutSnorm16[kQuantizeBenchItems - 1]);
+        F64 batchPackMs = BenchQuantizeOpMs([&]() { PackSnorm1010102(normals, pSigns, pOutPacked, kQuantizeBenchItems); });
+        BenchKeep(pOutPacked[kQuantizeBenchItems - 1]);
+        F64 batchOctahedralMs = BenchQuantizeOpMs([&]() { EncodeOctahedralSnorm16(normals, pOutPacked, kQuantizeBenchItems); });
+        BenchKeep(pOutPacked[kQuantizeBenchItems - 1]);
+        F64 batchFramesMs = BenchQuantizeOpMs([&]() { EncodeTangentFrames(normals, tangents, pSigns, pOutFrames, kQuantizeBenchItems); });
+        BenchKeep(pOutFrames[kQuantizeBenchItems - 1].w);
+
+        const char* levelName = GetSimdLevelName((SimdLevel)level);
+        char name[64];
+        snprintf(name, sizeof(name), "ConvertF32ToF16, %s", levelName);
+        BenchReport(name, batchToHalfMs, numOps);
+        snprintf(name, sizeof(name), "ConvertF16ToF32, %s", levelName);
+        BenchReport(name, batchFromHalfMs, numOps);
+        snprintf(name, sizeof(name), "EncodeSnorm16, %s", levelName);
+        BenchReport(name, batchSnorm16Ms, numOps);
+        snprintf(name, sizeof(name), "PackSnorm1010102, %s", levelName);
+        BenchReport(name, batchPackMs, numOps);
+        snprintf(name, sizeof(name), "EncodeOctahedralSnorm16, %s", levelName);
+        BenchReport(name, batchOctahedralMs, numOps);
+        snprintf(name, sizeof(name), "EncodeTangentFrames, %s", levelName);
+        BenchReport(name, batchFramesMs, numOps);
+    }
+    SetSimdLevel(supportedLevel);
+
+    arena.Release();
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// Vertices
+//------------------------------------------------------------------------------------------------------------------------
+// The three layouts from the comment at the top of Quantize.h
+struct QuantizeBenchVertex
+{
+    F32 m_position[3];
+    F32 m_normal[3];
+    F32 m_tangent[4];
+    F32 m_uv[2];
+};
+
+struct QuantizeBenchCompactVertex
+{
+    F32 m_position[3];
+    PackedTangentFrame m_frame;
+    U16 m_uv[2];
+};
+
+// The position's fourth half is padding so the attribute stays 8 byte aligned
+struct QuantizeBenchHalfVertex
+{
+    U16 m_position[4];
+    PackedTangentFrame m_frame;
+    U16 m_uv[2];
+};
+
+// Streams a mesh through the encoder a vertex at a time, large enough that the source vertices come from memory
+static const U32 kQuantizeBenchVertices = 1 << 20;
+
+static void BenchQuantizeVertices()
+{
+    BenchHeader("Quantize, vertex encoding and size");
+
+    LinearAllocator arena;
+    arena.InitVirtual(MiB(128));
+    QuantizeBenchVertex* pVertices = arena.Alloc<QuantizeBenchVertex>(kQuantizeBenchVertices);
+    QuantizeBenchCompactVertex* pCompact = arena.Alloc<QuantizeBenchCompactVertex>(kQuantizeBenchVertices);
+    QuantizeBenchHalfVertex* pHalf = arena.Alloc<QuantizeBenchHalfVertex>(kQuantizeBenchVertices);
+
+    Rng rng(24);
+    for(U32 i = 0; i < kQuantizeBenchVertices; i++)
+    {
+        Vec3 normal = MakeQuantizeBenchDir(rng);
+        Vec3 tangent = Cross(normal, MakeQuantizeBenchDir(rng)).GetNormalized();
+        QuantizeBenchVertex& vertex = pVertices[i];
+        vertex = { { rng.NextF32(-100.0f, 100.0f), rng.NextF32(-100.0f, 100.0f), rng.NextF32(-100.0f, 100.0f) },
+                   { normal.x, normal.y, normal.z }, { tangent.x, tangent.y, tangent.z, rng.NextU32(2) == 0 ? 1.0f : -1.0f },
+                   { rng.NextF32(0.0f, 4.0f), rng.NextF32(0.0f, 4.0f) } };
+    }
+
+    F64 compactMs = BenchMinMs([&]()
+    {
+        for(U32 i = 0; i < kQuantizeBenchVertices; i++)
+        {
+            const QuantizeBenchVertex& vertex = pVertices[i];
+            QuantizeBenchCompactVertex& out = pCompact[i];
+            out.m_position[0] = vertex.m_position[0];
+            out.m_position[1] = vertex.m_position[1];
+            out.m_position[2] = vertex.m_position[2];
+            out.m_frame = EncodeTangentFrame(Vec3(vertex.m_normal[0], vertex.m_normal[1], vertex.m_normal[2]),
+                                             Vec3(vertex.m_tangent[0], vertex.m_tangent[1], vertex.m_tangent[2]), vertex.m_tangent[3]);
+            out.m_uv[0] = ConvertF32ToF16(vertex.m_uv[0]);
+            out.m_uv[1] = ConvertF32ToF16(vertex.m_uv[1]);
+        }
+    });
+    BenchKeep(pCompact[kQuantizeBenchVertices - 1].m_frame.w);
+
+    F64 halfMs = BenchMinMs([&]()
+    {
+        for(U32 i = 0; i < kQuantizeBenchVertices; i++)
+        {
+            const QuantizeBenchVertex& vertex = pVertices[i];
+            QuantizeBenchHalfVertex& out = pHalf[i];
+            out.m_position[0] = ConvertF32ToF16(vertex.m_position[0]);
+            out.m_position[1] = ConvertF32ToF16(vertex.m_position[1]);
+            out.m_position[2] = ConvertF32ToF16(vertex.m_position[2]);
+            out.m_position[3] = 0;
+            out.m_frame = EncodeTangentFrame(Vec3(vertex.m_normal[0], vertex.m_normal[1], vertex.m_normal[2]),
+                                             Vec3(vertex.m_tangent[0], vertex.m_tangent[1], vertex.m_tangent[2]), vertex.m_tangent[3]);
+            out.m_uv[0] = ConvertF32ToF16(vertex.m_uv[0]);
+            out.m_uv[1] = ConvertF32ToF16(vertex.m_uv[1]);
+        }
+    });
+    BenchKeep(pHalf[kQuantizeBenchVertices - 1].m_frame.w);
+
+    BenchReport("F32 to tangent frame + F16 uv vertices", compactMs, kQuantizeBenchVertices);
+    BenchReport("F32 to F16 position + frame + uv vertices", halfMs, kQuantizeBenchVertices);
+
+    // what a mesh of these vertices takes in a vertex buffer
+    static const struct
+    {
+        const char* m_name;
+        size_t m_vertexSize;
+    } s_layouts[] =
+    {
+        { "F32 position, normal, tangent + sign, uv", sizeof(QuantizeBenchVertex) },
+        { "F32 position, tangent frame, F16 uv", sizeof(QuantizeBenchCompactVertex) },
+        { "F16 position, tangent frame, F16 uv", sizeof(QuantizeBenchHalfVertex) },
+    };
+    for(const auto& layout : s_layouts)
+    {
+        printf("    %-44s %10llu bytes/vertex %8.1f MiB per %u vertices\n", layout.m_name, (unsigned long long)layout.m_vertexSize,
+               (F64)(layout.m_vertexSize * kQuantizeBenchVertices) / (F64)MiB(1), kQuantizeBenchVertices);
+    }
+
+    arena.Release();
+}
+
+void RunQuantizeBenchmarks()
+{
+    BenchQuantizeEncoders();
+    BenchQuantizeVertices();
+}
@@ -0,0 +1,444 @@
+#include "SM/MathBatch.h"
+#include "SM/Memory.h"
+#include "SM/Quantize.h"
+#include "SM/Random.h"
+#include "SM/Simd.h"
+#include "Tests/Test.h"
+
+#include <cmath>
+#include <cstring>
+
+using namespace SM;
+
+//------------------------------------------------------------------------------------------------------------------------
+// Half floats
+//------------------------------------------------------------------------------------------------------------------------
+static const U32 kHalfTestNumHalfs = 65536;
+static const U32 kHalfTestRandomFloats = 1 << 20;
+
+static U32 GetF32Bits(F32 f)
+{
+    U32 bits;
+    ::memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+static F32 MakeF32FromBits(U32 bits)
+{
+    F32 f;
+    ::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+// Straight from the definition in double precision, sign * 2^(exponent - 15) * 1.mantissa
+static U32 ReferenceF16ToF32Bits(U16 h)
+{
+    U32 sign = (U32)(h & 0x8000) << 16;
+    U32 exponent = (h >> 10) & 0x1f;
+    U32 mantissa = h & 0x3ff;
+    if(exponent == 0x1f)
+        return sign | 0x7f800000 | (mantissa << 13) | (mantissa != 0 ? 0x00400000 : 0);
+
+    F64 value = exponent == 0 ? ::ldexp((F64)mantissa, -24) : ::ldexp((F64)(mantissa + 1024), (I32)exponent - 25);
+    return sign | GetF32Bits((F32)value);
+}
+
+// Rounds |f| to a multiple of the half spacing at its exponent with nearbyint, which rounds ties to even. Spacing stops
+// shrinking below the smallest normal so denormals fall out of the same formula, and a mantissa rounding up to 2048
+// carries into the exponent, which at the top exponent gives inf.
+static U16 ReferenceF32ToF16(F32 f)
+{
+    U16 sign = std::signbit(f) ? 0x8000 : 0;
+    F64 value = ::fabs((F64)f);
+    if(std::isnan(f))
+        return (U16)(sign | 0x7e00 | ((GetF32Bits(f) >> 13) & 0x3ff));
+    if(value >= 65536.0)
+        return sign | 0x7c00;
+    if(value == 0.0)
+        return sign;
+
+    I32 binaryExponent;
+    ::frexp(value, &binaryExponent);
+    I32 exponent = Max(binaryExponent - 1, -14);
+    F64 mantissa = ::nearbyint(::ldexp(value, 10 - exponent));
+    return (U16)(sign | (U32)(((exponent + 14) << 10) + (I32)mantissa));
+}
+
+static bool CheckHalfMismatches(const char* name, U32 numMismatches, U32 count)
+{
+    if(!SM_TEST_CHECK(numMismatches == 0))
+    {
+        printf("    %s: %u of %u differ from the reference\n", name, numMismatches, count);
+        return false;
+    }
+    return true;
+}
+
+static void TestHalfConversions()
+{
+    // every half, nans included, to F32 and back
+    U32 numDecodeMismatches = 0;
+    U32 numRoundTripMismatches = 0;
+    for(U32 i = 0; i < kHalfTestNumHalfs; i++)
+    {
+        U16 h = (U16)i;
+        F32 f = ConvertF16ToF32(h);
+        numDecodeMismatches += GetF32Bits(f) == ReferenceF16ToF32Bits(h) ? 0 : 1;
+
+        bool bNan = (h & 0x7c00) == 0x7c00 && (h & 0x3ff) != 0;
+        numRoundTripMismatches += ConvertF32ToF16(f) == (bNan ? (U16)(h | 0x200) : h) ? 0 : 1;
+    }
+    CheckHalfMismatches("ConvertF16ToF32, every half", numDecodeMismatches, kHalfTestNumHalfs);
+    CheckHalfMismatches("ConvertF32ToF16, every half round trip", numRoundTripMismatches, kHalfTestNumHalfs);
+
+    // halfway between neighbouring halves ties to even, one F32 step either side goes to the nearer one
+    U32 numTieMismatches = 0;
+    for(U32 h = 0; h < 0x7c00; h++)
+    {
+        F32 low = ConvertF16ToF32((U16)h);
+        F32 high = h + 1 < 0x7c00 ? ConvertF16ToF32((U16)(h + 1)) : 65536.0f;
+        F32 middle = (low + high) * 0.5f;
+        for(F32 f : { middle, ::nextafterf(middle, 0.0f), ::nextafterf(middle, INFINITY) })
+        {
+            numTieMismatches += ConvertF32ToF16(f) == ReferenceF32ToF16(f) ? 0 : 1;
+            numTieMismatches += ConvertF32ToF16(-f) == ReferenceF32ToF16(-f) ? 0 : 1;
+        }
+    }
+    CheckHalfMismatches("ConvertF32ToF16, ties between halves", numTieMismatches, 0x7c00 * 6);
+
+    // random bit patterns cover every F32 exponent, F32 denormals and nans with random payloads
+    U32 numRandomMismatches = 0;
+    Rng rng(24);
+    for(U32 i = 0; i < kHalfTestRandomFloats; i++)
+    {
+        F32 f = MakeF32FromBits(rng.NextU32());
+        numRandomMismatches += ConvertF32ToF16(f) == ReferenceF32ToF16(f) ? 0 : 1;
+    }
+    CheckHalfMismatches("ConvertF32ToF16, random bits", numRandomMismatches, kHalfTestRandomFloats);
+
+    // 65520 is halfway from the largest half to 65536 and ties to even, which is inf
+    SM_TEST_CHECK(ConvertF32ToF16(65504.0f) == 0x7bff && ConvertF32ToF16(::nextafterf(65520.0f, 0.0f)) == 0x7bff);
+    SM_TEST_CHECK(ConvertF32ToF16(65520.0f) == 0x7c00 && ConvertF32ToF16(-65520.0f) == 0xfc00);
+    SM_TEST_CHECK(ConvertF32ToF16(INFINITY) == 0x7c00 && ConvertF32ToF16(-INFINITY) == 0xfc00 && ConvertF32ToF16(1e30f) == 0x7c00);
+    SM_TEST_CHECK(ConvertF16ToF32(0x7c00) == INFINITY && ConvertF16ToF32(0xfc00) == -INFINITY);
+
+    // nans stay nans, a signalling nan payload that only has low bits set still has to come out as a nan
+    SM_TEST_CHECK(ConvertF32ToF16(NAN) == 0x7e00 && std::isnan(ConvertF16ToF32(0x7e00)));
+    SM_TEST_CHECK(ConvertF32ToF16(MakeF32FromBits(0x7f800001)) == 0x7e00 && ConvertF32ToF16(MakeF32FromBits(0xffa00000)) == 0xff00);
+    SM_TEST_CHECK(GetF32Bits(ConvertF16ToF32(0x7c01)) == 0x7fc02000);
+
+    // half denormals, the smallest is 2^-24 and half of that ties to even zero
+    SM_TEST_CHECK(ConvertF32ToF16(5.9604645e-08f) == 0x0001 && ConvertF16ToF32(0x0001) == 5.9604645e-08f);
+    SM_TEST_CHECK(ConvertF32ToF16(2.9802322e-08f) == 0x0000 && ConvertF32ToF16(::nextafterf(2.9802322e-08f, 1.0f)) == 0x0001);
+    SM_TEST_CHECK(ConvertF32ToF16(8.9406967e-08f) == 0x0002 && ConvertF32ToF16(-6.0975552e-05f) == 0x83ff);
+    SM_TEST_CHECK(ConvertF16ToF32(0x03ff) == 6.0975552e-05f && ConvertF16ToF32(0x0400) == 6.1035156e-05f);
+    SM_TEST_CHECK(ConvertF32ToF16(MakeF32FromBits(0x00000001)) == 0x0000 && ConvertF32ToF16(-0.0f) == 0x8000);
+    SM_TEST_CHECK(GetF32Bits(ConvertF16ToF32(0x8000)) == 0x80000000);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// Normalized integers
+//------------------------------------------------------------------------------------------------------------------------
+static const U32 kNormTestValues = 100000;
+
+static void TestNormalizedIntegers()
+{
+    F64 snorm8Error = 0.0;
+    F64 snorm16Error = 0.0;
+    F64 unorm8Error = 0.0;
+    F64 unorm16Error = 0.0;
+    F64 snorm10Error = 0.0;
+    F64 unorm10Error = 0.0;
+    Rng rng(24);
+    for(U32 i = 0; i < kNormTestValues; i++)
+    {
+        F32 s = rng.NextF32(-1.0f, 1.0f);
+        F32 u = rng.NextF32(0.0f, 1.0f);
+        snorm8Error = Max(snorm8Error, ::fabs((F64)DecodeSnorm8(EncodeSnorm8(s)) - s) * 127.0);
+        snorm16Error = Max(snorm16Error, ::fabs((F64)DecodeSnorm16(EncodeSnorm16(s)) - s) * 32767.0);
+        unorm8Error = Max(unorm8Error, ::fabs((F64)DecodeUnorm8(EncodeUnorm8(u)) - u) * 255.0);
+        unorm16Error = Max(unorm16Error, ::fabs((F64)DecodeUnorm16(EncodeUnorm16(u)) - u) * 65535.0);
+
+        Vec4 snormVec(s, -s, s * 0.5f, i % 3 == 0 ? -1.0f : (i % 3 == 1 ? 0.0f : 1.0f));
+        Vec4 snormUnpacked = UnpackSnorm1010102(PackSnorm1010102(snormVec));
+        snorm10Error = Max(snorm10Error, ::fabs((F64)snormUnpacked.x - snormVec.x) * 511.0);
+        snorm10Error = Max(snorm10Error, ::fabs((F64)snormUnpacked.y - snormVec.y) * 511.0);
+        snorm10Error = Max(snorm10Error, ::fabs((F64)snormUnpacked.z - snormVec.z) * 511.0);
+        snorm10Error = Max(snorm10Error, snormUnpacked.w == snormVec.w ? 0.0 : 1.0);
+
+        Vec4 unormVec(u, 1.0f - u, u * 0.5f, (F32)(i % 4) / 3.0f);
+        Vec4 unormUnpacked = UnpackUnorm1010102(PackUnorm1010102(unormVec));
+        unorm10Error = Max(unorm10Error, ::fabs((F64)unormUnpacked.x - unormVec.x) * 1023.0);
+        unorm10Error = Max(unorm10Error, ::fabs((F64)unormUnpacked.y - unormVec.y) * 1023.0);
+        unorm10Error = Max(unorm10Error, ::fabs((F64)unormUnpacked.z - unormVec.z) * 1023.0);
+        unorm10Error = Max(unorm10Error, ::fabs((F64)unormUnpacked.w - unormVec.w) * 3.0);
+    }
+
+    // in steps, half a step plus the F32 rounding of the decoded value, which is up to 0.002 of a 16 bit step near 1
+    const F64 kMaxStepError = 0.505;
+    bool bPassed = SM_TEST_CHECK(snorm8Error <= kMaxStepError && snorm16Error <= kMaxStepError);
+    bPassed &= SM_TEST_CHECK(unorm8Error <= kMaxStepError && unorm16Error <= kMaxStepError);
+    bPassed &= SM_TEST_CHECK(snorm10Error <= kMaxStepError && unorm10Error <= kMaxStepError);
+    if(!bPassed)
+    {
+        printf("    steps off: snorm8 %.4f, snorm16 %.4f, unorm8 %.4f, unorm16 %.4f, snorm 1010102 %.4f, unorm 1010102 %.4f\n",
+               snorm8Error, snorm16Error, unorm8Error, unorm16Error, snorm10Error, unorm10Error);
+    }
+
+    // out of range clamps, nan is the lowest value and the most negative snorm decodes to -1 as well
+    SM_TEST_CHECK(EncodeSnorm8(2.0f) == 127 && EncodeSnorm8(-2.0f) == -127 && EncodeSnorm8(NAN) == -127);
+    SM_TEST_CHECK(EncodeSnorm16(INFINITY) == 32767 && EncodeSnorm16(-INFINITY) == -32767 && EncodeSnorm16(NAN) == -32767);
+    SM_TEST_CHECK(EncodeUnorm8(-1.0f) == 0 && EncodeUnorm8(1.5f) == 255 && EncodeUnorm8(NAN) == 0);
+    SM_TEST_CHECK(EncodeUnorm16(-1.0f) == 0 && EncodeUnorm16(1.5f) == 65535 && EncodeUnorm16(NAN) == 0);
+    SM_TEST_CHECK(DecodeSnorm8(-128) == -1.0f && DecodeSnorm16(-32768) == -1.0f);
+
+    // exact halfway values round to even
+    SM_TEST_CHECK(EncodeUnorm8(0.5f / 255.0f) == 0 && EncodeUnorm8(1.5f / 255.0f) == 2);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// Octahedral normals and tangent frames
+//------------------------------------------------------------------------------------------------------------------------
+static const U32 kOctahedralTestVecs = 200000;
+
+// The bounds from the comments in Quantize.h
+static const F64 kOctahedralSnorm16MaxErrorDegs = 0.0037;
+static const F64 kOctahedralSnorm8MaxErrorDegs = 0.95;
+static const F64 kTangentFrameMaxErrorDegs = 0.0041;
+
+static Vec3 MakeQuantizeTestDir(Rng& rng)
+{
+    for(;;)
+    {
+        Vec3 v(rng.NextF32(-1.0f, 1.0f), rng.NextF32(-1.0f, 1.0f), rng.NextF32(-1.0f, 1.0f));
+        F32 lengthSq = v.CalcLengthSq();
+        if(lengthSq > 0.01f && lengthSq <= 1.0f)
+            return v.GetNormalized();
+    }
+}
+
+static F64 GetAngleDegs(const Vec3& a, const Vec3& b)
+{
+    F64 crossX = (F64)a.y * b.z - (F64)a.z * b.y;
+    F64 crossY = (F64)a.z * b.x - (F64)a.x * b.z;
+    F64 crossZ = (F64)a.x * b.y - (F64)a.y * b.x;
+    F64 dot = (F64)a.x * b.x + (F64)a.y * b.y + (F64)a.z * b.z;
+    return ::atan2(::sqrt(crossX * crossX + crossY * crossY + crossZ * crossZ), dot) * (180.0 / 3.14159265358979323846);
+}
+
+// Axes, the diagonals and directions along the fold edges of the lower half are where the octahedron unfolds
+static const Vec3 s_quantizeTestEdgeDirs[] =
+{
+    Vec3(1.0f, 0.0f, 0.0f), Vec3(-1.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f), Vec3(0.0f, -1.0f, 0.0f), Vec3(0.0f, 0.0f, 1.0f), Vec3(0.0f, 0.0f, -1.0f),
+    Vec3(0.0f, -0.0f, -1.0f), Vec3(-0.0f, 0.0f, -1.0f), Vec3(0.70710678f, 0.0f, -0.70710678f), Vec3(0.0f, -0.70710678f, -0.70710678f),
+    Vec3(0.57735027f, 0.57735027f, 0.57735027f), Vec3(-0.57735027f, 0.57735027f, -0.57735027f), Vec3(0.57735027f, -0.57735027f, -0.57735027f),
+};
+
+static void TestOctahedral()
+{
+    F64 snorm16Error = 0.0;
+    F64 snorm8Error = 0.0;
+    F64 floatError = 0.0;
+    Rng rng(24);
+    const U32 kNumEdgeDirs = sizeof(s_quantizeTestEdgeDirs) / sizeof(s_quantizeTestEdgeDirs[0]);
+    for(U32 i = 0; i < kOctahedralTestVecs + kNumEdgeDirs; i++)
+    {
+        Vec3 n = i < kNumEdgeDirs ? s_quantizeTestEdgeDirs[i] : MakeQuantizeTestDir(rng);
+        snorm16Error = Max(snorm16Error, GetAngleDegs(n, DecodeOctahedralSnorm16(EncodeOctahedralSnorm16(n))));
+        snorm8Error = Max(snorm8Error, GetAngleDegs(n, DecodeOctahedralSnorm8(EncodeOctahedralSnorm8(n))));
+        floatError = Max(floatError, GetAngleDegs(n, DecodeOctahedral(EncodeOctahedral(n))));
+    }
+
+    bool bPassed = SM_TEST_CHECK(snorm16Error <= kOctahedralSnorm16MaxErrorDegs && snorm8Error <= kOctahedralSnorm8MaxErrorDegs);
+    bPassed &= SM_TEST_CHECK(floatError <= 1e-4);
+    if(!bPassed)
+    {
+        printf("    octahedral max error: snorm16 %.5f, snorm8 %.4f, unquantized %.3g degrees\n", snorm16Error, snorm8Error, floatError);
+    }
+}
+
+static void TestTangentFrames()
+{
+    F64 maxError = 0.0;
+    U32 numWrongBitangents = 0;
+    Rng rng(24);
+    const U32 kNumEdgeDirs = sizeof(s_quantizeTestEdgeDirs) / sizeof(s_quantizeTestEdgeDirs[0]);
+    for(U32 i = 0; i < kOctahedralTestVecs + kNumEdgeDirs; i++)
+    {
+        // the edge directions as normals with an axis tangent hit w = 0 rotations, e.g. z flipped to -z around x
+        Vec3 normal = i < kNumEdgeDirs ? s_quantizeTestEdgeDirs[i] : MakeQuantizeTestDir(rng);
+        Vec3 tangent = i < kNumEdgeDirs ? Vec3(::fabsf(normal.x) < 0.9f ? 1.0f : 0.0f, ::fabsf(normal.x) < 0.9f ? 0.0f : 1.0f, 0.0f) : MakeQuantizeTestDir(rng);
+        if(::fabsf(Dot(normal, tangent)) > 0.99f)
+            continue;
+
+        F32 bitangentSign = i % 2 == 0 ? 1.0f : -1.0f;
+        Vec3 expectedTangent = (tangent - normal * Dot(normal, tangent)).GetNormalized();
+        Vec3 expectedBitangent = Cross(normal, expectedTangent) * bitangentSign;
+
+        Vec3 decodedNormal, decodedTangent, decodedBitangent;
+        DecodeTangentFrame(EncodeTangentFrame(normal, tangent, bitangentSign), decodedNormal, decodedTangent, decodedBitangent);
+        maxError = Max(maxError, GetAngleDegs(normal, decodedNormal));
+        maxError = Max(maxError, GetAngleDegs(expectedTangent, decodedTangent));
+        numWrongBitangents += GetAngleDegs(expectedBitangent, decodedBitangent) <= 1.0 ? 0 : 1;
+    }
+
+    if(!SM_TEST_CHECK(maxError <= kTangentFrameMaxErrorDegs && numWrongBitangents == 0))
+    {
+        printf("    tangent frames: max error %.5f degrees, %u wrong bitangents\n", maxError, numWrongBitangents);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// Batch encoders
+//------------------------------------------------------------------------------------------------------------------------
+// Odd so every wide kernel leaves a tail for the narrower ones
+static const size_t kQuantizeTestBatchCount = 4099;
+
+static void CheckQuantizeBatchMismatches(const char* name, U32 numMismatches, SimdLevel level)
+{
+    if(!SM_TEST_CHECK(numMismatches == 0))
+    {
+        printf("    %s at %s: %u differ from the scalar encoder\n", name, GetSimdLevelName(level), numMismatches);
+    }
+}
+
+template<typename T, typename ScalarFunc>
+static U32 CountQuantizeMismatches(const T* pBatch, size_t count, ScalarFunc scalarFunc)
+{
+    U32 numMismatches = 0;
+    for(size_t i = 0; i < count; i++)
+    {
+        T expected = scalarFunc(i);
+        numMismatches += ::memcmp(&pBatch[i], &expected, sizeof(T)) == 0 ? 0 : 1;
+    }
+    return numMismatches;
+}
+
+static void TestQuantizeBatches()
+{
+    LinearAllocator arena;
+    arena.InitVirtual(MiB(16));
+
+    // values include nans, infs, out of range values, -0, exact ties and every other half with the midpoints to the halves
+    // in between, streams are unaligned
+    const size_t kNumValues = kHalfTestNumHalfs + kQuantizeTestBatchCount;
+    F32* pValues = arena.Alloc<F32>(kNumValues + 1) + 1;
+    U16* pHalfs = arena.Alloc<U16>(kNumValues + 1) + 1;
+    F32* pOutValues = arena.Alloc<F32>(kNumValues + 1) + 1;
+    U16* pOutHalfs = arena.Alloc<U16>(kNumValues + 1) + 1;
+    static const F32 s_specialValues[] = { NAN, -NAN, INFINITY, -INFINITY, 0.0f, -0.0f, 1.0f, -1.0f, 2.0f, -2.0f, 65520.0f, 65504.0f,
+                                           0.5f / 255.0f, 1.5f / 255.0f, 2.9802322e-08f, 1e-40f, 1e30f };
+    Rng rng(24);
+    for(size_t i = 0; i < kNumValues; i++)
+    {
+        if(i < kHalfTestNumHalfs)
+            pValues[i] = i % 2 == 0 ? ConvertF16ToF32((U16)i) : (ConvertF16ToF32((U16)(i - 1)) + ConvertF16ToF32((U16)i)) * 0.5f;
+        else if(i % 7 == 0)
+            pValues[i] = s_specialValues[rng.NextU32(sizeof(s_specialValues) / sizeof(s_specialValues[0]))];
+        else
+            pValues[i] = i % 3 == 0 ? MakeF32FromBits(rng.NextU32()) : rng.NextF32(-1.5f, 1.5f);
+        pHalfs[i] = (U16)rng.NextU32(kHalfTestNumHalfs);
+    }
+    for(U32 i = 0; i < kHalfTestNumHalfs; i++)
+    {
+        pHalfs[i] = (U16)i;
+    }
+
+    I8* pSnorm8 = arena.Alloc<I8>(kQuantizeTestBatchCount);
+    I16* pSnorm16 = arena.Alloc<I16>(kQuantizeTestBatchCount);
+    U8* pUnorm8 = arena.Alloc<U8>(kQuantizeTestBatchCount);
+    U16* pUnorm16 = arena.Alloc<U16>(kQuantizeTestBatchCount);
+    U32* pPacked = arena.Alloc<U32>(kQuantizeTestBatchCount);
+    U16* pPacked16 = arena.Alloc<U16>(kQuantizeTestBatchCount);
+    PackedTangentFrame* pFrames = arena.Alloc<PackedTangentFrame>(kQuantizeTestBatchCount);
+
+    // the tail of pValues has the specials, packed vectors use it for x, y, z and w
+    const F32* pMixed = pValues + kHalfTestNumHalfs;
+    Vec3SoA mixedVecs;
+    mixedVecs.m_pX = const_cast<F32*>(pMixed);
+    mixedVecs.m_pY = pOutValues;
+    mixedVecs.m_pZ = pOutValues + kQuantizeTestBatchCount;
+    F32* pW = pOutValues + 2 * kQuantizeTestBatchCount;
+    Vec3* pNormals = arena.Alloc<Vec3>(kQuantizeTestBatchCount);
+    Vec3* pTangents = arena.Alloc<Vec3>(kQuantizeTestBatchCount);
+    F32* pSigns = arena.Alloc<F32>(kQuantizeTestBatchCount);
+    Vec3SoA normals;
+    Vec3SoA tangents;
+    normals.m_pX = arena.Alloc<F32>(kQuantizeTestBatchCount);
+    normals.m_pY = arena.Alloc<F32>(kQuantizeTestBatchCount);
+    normals.m_pZ = arena.Alloc<F32>(kQuantizeTestBatchCount);
+    tangents.m_pX = arena.Alloc<F32>(kQuantizeTestBatchCount);
+    tangents.m_pY = arena.Alloc<F32>(kQuantizeTestBatchCount);
+    tangents.m_pZ = arena.Alloc<F32>(kQuantizeTestBatchCount);
+    const U32 kNumEdgeDirs = sizeof(s_quantizeTestEdgeDirs) / sizeof(s_quantizeTestEdgeDirs[0]);
+    for(size_t i = 0; i < kQuantizeTestBatchCount; i++)
+    {
+        pNormals[i] = i < kNumEdgeDirs ? s_quantizeTestEdgeDirs[i] : MakeQuantizeTestDir(rng);
+        do
+        {
+            pTangents[i] = MakeQuantizeTestDir(rng);
+        } while(::fabsf(Dot(pNormals[i], pTangents[i])) > 0.99f);
+        pSigns[i] = i % 2 == 0 ? 1.0f : -1.0f;
+    }
+    ConvertToSoA(pNormals, kQuantizeTestBatchCount, normals);
+    ConvertToSoA(pTangents, kQuantizeTestBatchCount, tangents);
+
+    SimdLevel supportedLevel = GetSupportedSimdLevel();
+    for(U32 levelIndex = kSimdLevelScalar; levelIndex <= (U32)supportedLevel; levelIndex++)
+    {
+        SimdLevel level = (SimdLevel)levelIndex;
+        SetSimdLevel(level);
+
+        // the packed vectors take their y, z and w from the output buffer, so refill them at every level
+        for(size_t i = 0; i < kQuantizeTestBatchCount; i++)
+        {
+            mixedVecs.m_pY[i] = pMixed[(i + 1) % kQuantizeTestBatchCount];
+            mixedVecs.m_pZ[i] = pMixed[(i + 2) % kQuantizeTestBatchCount];
+            pW[i] = pMixed[(i + 3) % kQuantizeTestBatchCount];
+        }
+        auto mixedVec4 = [&](size_t i, F32 w) { return Vec4(mixedVecs.m_pX[i], mixedVecs.m_pY[i], mixedVecs.m_pZ[i], w); };
+
+        ConvertF32ToF16(pValues, pOutHalfs, kNumValues);
+        CheckQuantizeBatchMismatches("ConvertF32ToF16", CountQuantizeMismatches(pOutHalfs, kNumValues, [&](size_t i) { return ConvertF32ToF16(pValues[i]); }), level);
+        ConvertF16ToF32(pHalfs, pOutValues + 3 * kQuantizeTestBatchCount, kNumValues - 3 * kQuantizeTestBatchCount);
+        CheckQuantizeBatchMismatches("ConvertF16ToF32", CountQuantizeMismatches(pOutValues + 3 * kQuantizeTestBatchCount, kNumValues - 3 * kQuantizeTestBatchCount,
+                                     [&](size_t i) { return ConvertF16ToF32(pHalfs[i]); }), level);
+
+        EncodeSnorm8(pMixed, pSnorm8, kQuantizeTestBatchCount);
+        CheckQuantizeBatchMismatches("EncodeSnorm8", CountQuantizeMismatches(pSnorm8, kQuantizeTestBatchCount, [&](size_t i) { return EncodeSnorm8(pMixed[i]); }), level);
+        EncodeSnorm16(pMixed, pSnorm16, kQuantizeTestBatchCount);
+        CheckQuantizeBatchMismatches("EncodeSnorm16", CountQuantizeMismatches(pSnorm16, kQuantizeTestBatchCount, [&](size_t i) { return EncodeSnorm16(pMixed[i]); }), level);
+        EncodeUnorm8(pMixed, pUnorm8, kQuantizeTestBatchCount);
+        CheckQuantizeBatchMismatches("EncodeUnorm8", CountQuantizeMismatches(pUnorm8, kQuantizeTestBatchCount, [&](size_t i) { return EncodeUnorm8(pMixed[i]); }), level);
+        EncodeUnorm16(pMixed, pUnorm16, kQuantizeTestBatchCount);
+        CheckQuantizeBatchMismatches("EncodeUnorm16", CountQuantizeMismatches(pUnorm16, kQuantizeTestBatchCount, [&](size_t i) { return EncodeUnorm16(pMixed[i]); }), level);
+
+        PackSnorm1010102(mixedVecs, pW, pPacked, kQuantizeTestBatchCount);
+        CheckQuantizeBatchMismatches("PackSnorm1010102", CountQuantizeMismatches(pPacked, kQuantizeTestBatchCount, [&](size_t i) { return PackSnorm1010102(mixedVec4(i, pW[i])); }), level);
+        PackSnorm1010102(mixedVecs, nullptr, pPacked, kQuantizeTestBatchCount);
+        CheckQuantizeBatchMismatches("PackSnorm1010102, no w", CountQuantizeMismatches(pPacked, kQuantizeTestBatchCount, [&](size_t i) { return PackSnorm1010102(mixedVec4(i, 0.0f)); }), level);
+        PackUnorm1010102(mixedVecs, pW, pPacked, kQuantizeTestBatchCount);
+        CheckQuantizeBatchMismatches("PackUnorm1010102", CountQuantizeMismatches(pPacked, kQuantizeTestBatchCount, [&](size_t i) { return PackUnorm1010102(mixedVec4(i, pW[i])); }), level);
+        PackUnorm1010102(mixedVecs, nullptr, pPacked, kQuantizeTestBatchCount);
+        CheckQuantizeBatchMismatches("PackUnorm1010102, no w", CountQuantizeMismatches(pPacked, kQuantizeTestBatchCount, [&](size_t i) { return PackUnorm1010102(mixedVec4(i, 0.0f)); }), level);
+
+        EncodeOctahedralSnorm16(normals, pPacked, kQuantizeTestBatchCount);
+        CheckQuantizeBatchMismatches("EncodeOctahedralSnorm16", CountQuantizeMismatches(pPacked, kQuantizeTestBatchCount, [&](size_t i) { return EncodeOctahedralSnorm16(pNormals[i]); }), level);
+        EncodeOctahedralSnorm8(normals, pPacked16, kQuantizeTestBatchCount);
+        CheckQuantizeBatchMismatches("EncodeOctahedralSnorm8", CountQuantizeMismatches(pPacked16, kQuantizeTestBatchCount, [&](size_t i) { return EncodeOctahedralSnorm8(pNormals[i]); }), level);
+        EncodeTangentFrames(normals, tangents, pSigns, pFrames, kQuantizeTestBatchCount);
+        CheckQuantizeBatchMismatches("EncodeTangentFrames", CountQuantizeMismatches(pFrames, kQuantizeTestBatchCount,
+                                     [&](size_t i) { return EncodeTangentFrame(pNormals[i], pTangents[i], pSigns[i]); }), level);
+    }
+    SetSimdLevel(supportedLevel);
+    arena.Release();
+}
+
+static void RunQuantizeTests()
+{
+    TestHalfConversions();
+    TestNormalizedIntegers();
+    TestOctahedral();
+    TestTangentFrames();
+    TestQuantizeBatches();
+}
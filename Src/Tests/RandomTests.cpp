@@ -0,0 +1,117 @@
+#include "SM/Random.h"
+#include "SM/Simd.h"
+#include "Tests/Test.h"
+
+#include <cmath>
+
+using namespace SM;
+
+//------------------------------------------------------------------------------------------------------------------------
+// F32 ranges
+//------------------------------------------------------------------------------------------------------------------------
+static const U32 kRandomTestFillCount = 1003;
+
+// Inverse of an odd number mod 2^64, each Newton step doubles the number of correct low bits
+static U64 InverseMod64(U64 x)
+{
+    U64 inverse = x;
+    for(U32 i = 0; i < 5; i++)
+    {
+        inverse *= 2 - x * inverse;
+    }
+    return inverse;
+}
+
+// A state word 1 that makes the next xoshiro256** output equal to output, undoing rotl(s1 * 5, 7) * 9
+static U64 CalcStateForOutput(U64 output)
+{
+    U64 rotated = output * InverseMod64(9);
+    return RngRotateLeft(rotated, 64 - 7) * InverseMod64(5);
+}
+
+static void TestNextF32Range()
+{
+    // the largest unit value 1 - 2^-24 makes 1 + u * 1 a tie that rounds up to exactly 2
+    const U64 kMaxUnitOutput = 0xffffff0000000000ull;
+    const F32 kBelowTwo = ::nextafterf(2.0f, 1.0f);
+
+    Rng rng(22);
+    rng.m_state[1] = CalcStateForOutput(kMaxUnitOutput);
+    Rng copy = rng;
+    SM_TEST_CHECK(copy.NextU64() == kMaxUnitOutput);
+    SM_TEST_CHECK(rng.NextF32(1.0f, 2.0f) == kBelowTwo);
+
+    SimdLevel supportedLevel = GetSupportedSimdLevel();
+    for(U32 level = kSimdLevelScalar; level <= (U32)supportedLevel; level++)
+    {
+        SetSimdLevel((SimdLevel)level);
+
+        WideRng wideRng(22);
+        for(U32 lane = 0; lane < WideRng::kNumLanes; lane++)
+        {
+            wideRng.m_state[1][lane] = CalcStateForOutput(kMaxUnitOutput);
+        }
+        F32 values[WideRng::kNumLanes];
+        wideRng.FillF32(values, WideRng::kNumLanes, 1.0f, 2.0f);
+
+        U32 numNotClamped = 0;
+        for(F32 value : values)
+        {
+            numNotClamped += value == kBelowTwo ? 0 : 1;
+        }
+        if(!SM_TEST_CHECK(numNotClamped == 0))
+        {
+            printf("    WideRng::FillF32 at %s\n", GetSimdLevelName((SimdLevel)level));
+        }
+    }
+    SetSimdLevel(supportedLevel);
+}
+
+// Element i of a fill must match lane i % 8 stepped as a plain Rng, at every simd level
+static void TestWideRngFillF32()
+{
+    static const F32 s_ranges[][2] = { { 0.0f, 1.0f }, { 1.0f, 2.0f }, { -3.0f, 5.0f }, { 1000.0f, 1000.5f } };
+
+    SimdLevel supportedLevel = GetSupportedSimdLevel();
+    for(U32 level = kSimdLevelScalar; level <= (U32)supportedLevel; level++)
+    {
+        SetSimdLevel((SimdLevel)level);
+        for(const F32* range : s_ranges)
+        {
+            Rng base = Rng::CreateStream(22, 1);
+            WideRng wideRng(base);
+            Rng lanes[WideRng::kNumLanes];
+            lanes[0] = base;
+            for(U32 lane = 1; lane < WideRng::kNumLanes; lane++)
+            {
+                lanes[lane] = lanes[lane - 1];
+                lanes[lane].Jump();
+            }
+
+            F32 values[kRandomTestFillCount];
+            wideRng.FillF32(values, kRandomTestFillCount, range[0], range[1]);
+
+            U32 numMismatches = 0;
+            U32 numOutOfRange = 0;
+            for(U32 i = 0; i < kRandomTestFillCount; i++)
+            {
+                F32 expected = lanes[i % WideRng::kNumLanes].NextF32(range[0], range[1]);
+                numMismatches += values[i] == expected ? 0 : 1;
+                numOutOfRange += (values[i] >= range[0] && values[i] < range[1]) ? 0 : 1;
+            }
+
+            bool bPassed = SM_TEST_CHECK(numMismatches == 0) && SM_TEST_CHECK(numOutOfRange == 0);
+            if(!bPassed)
+            {
+                printf("    WideRng::FillF32 [%g, %g) at %s\n", range[0], range[1], GetSimdLevelName((SimdLevel)level));
+            }
+        }
+    }
+    SetSimdLevel(supportedLevel);
+}
+
+void RunRandomTests()
+{
+    TestNextF32Range();
+    TestWideRngFillF32();
+}
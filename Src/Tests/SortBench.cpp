@@ -0,0 +1,104 @@
+#include "SM/Sort.h"
+#include "SM/Random.h"
+#include "Tests/Bench.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace SM;
+
+//------------------------------------------------------------------------------------------------------------------------
+// Radix sort
+//------------------------------------------------------------------------------------------------------------------------
+struct BenchKeyValue
+{
+    U32 m_key;
+    U32 m_value;
+};
+
+// Restores the unsorted input before every run and only times the sort itself
+template<typename T, typename SortFunc>
+static F64 BenchSortMs(const T* pSource, T* pWork, size_t numKeys, U32 numRuns, SortFunc sort)
+{
+    F64 bestMs = 1e300;
+    for(U32 run = 0; run < numRuns; run++)
+    {
+        ::memcpy(pWork, pSource, numKeys * sizeof(T));
+        BenchTimer timer;
+        sort(pWork, numKeys);
+        bestMs = Min(bestMs, timer.GetElapsedMs());
+    }
+    return bestMs;
+}
+
+static void BenchRadixSortSize(LinearAllocator& arena, size_t numKeys)
+{
+    U32 numRuns = numKeys >= 1000000 ? 3 : 50;
+    U32 numThreads = GetBenchMaxThreads();
+
+    U32* pSourceKeys32 = arena.Alloc<U32>(numKeys);
+    U64* pSourceKeys64 = arena.Alloc<U64>(numKeys);
+    BenchKeyValue* pSourcePairs = arena.Alloc<BenchKeyValue>(numKeys);
+    U32* pKeys32 = arena.Alloc<U32>(numKeys);
+    U64* pKeys64 = arena.Alloc<U64>(numKeys);
+    BenchKeyValue* pPairs = arena.Alloc<BenchKeyValue>(numKeys);
+    U32* pValues = arena.Alloc<U32>(numKeys);
+
+    Rng rng(13);
+    for(size_t i = 0; i < numKeys; i++)
+    {
+        pSourceKeys32[i] = rng.NextU32();
+        pSourceKeys64[i] = rng.NextU64();
+        pSourcePairs[i] = BenchKeyValue{ pSourceKeys32[i], (U32)i };
+    }
+
+    F64 radix32Ms = BenchSortMs(pSourceKeys32, pKeys32, numKeys, numRuns, [](U32* pKeys, size_t n) { RadixSort(pKeys, n); });
+    F64 radix32ThreadedMs = BenchSortMs(pSourceKeys32, pKeys32, numKeys, numRuns, [numThreads](U32* pKeys, size_t n) { RadixSort(pKeys, n, GetThreadScratchAllocator(), numThreads); });
+    F64 std32Ms = BenchSortMs(pSourceKeys32, pKeys32, numKeys, numRuns, [](U32* pKeys, size_t n) { std::sort(pKeys, pKeys + n); });
+
+    F64 radix64Ms = BenchSortMs(pSourceKeys64, pKeys64, numKeys, numRuns, [](U64* pKeys, size_t n) { RadixSort(pKeys, n); });
+    F64 std64Ms = BenchSortMs(pSourceKeys64, pKeys64, numKeys, numRuns, [](U64* pKeys, size_t n) { std::sort(pKeys, pKeys + n); });
+
+    // key + index payload, the radix sort is stable so it is compared against std::stable_sort
+    F64 radixPairsMs = BenchSortMs(pSourceKeys32, pKeys32, numKeys, numRuns, [pValues](U32* pKeys, size_t n)
+    {
+        for(size_t i = 0; i < n; i++)
+        {
+            pValues[i] = (U32)i;
+        }
+        RadixSort(pKeys, pValues, n);
+    });
+    F64 stdPairsMs = BenchSortMs(pSourcePairs, pPairs, numKeys, numRuns, [](BenchKeyValue* pItems, size_t n)
+    {
+        std::stable_sort(pItems, pItems + n, [](const BenchKeyValue& a, const BenchKeyValue& b) { return a.m_key < b.m_key; });
+    });
+
+    char label[64];
+    snprintf(label, sizeof(label), "RadixSort vs std::sort, %zu random keys", numKeys);
+    BenchHeader(label);
+    BenchReport("RadixSort U32", radix32Ms, numKeys);
+    snprintf(label, sizeof(label), "RadixSort U32, %u threads", numThreads);
+    BenchReport(label, radix32ThreadedMs, numKeys);
+    BenchReport("std::sort U32", std32Ms, numKeys);
+    BenchReport("RadixSort U64", radix64Ms, numKeys);
+    BenchReport("std::sort U64", std64Ms, numKeys);
+    BenchReport("RadixSort U32 key + U32 value", radixPairsMs, numKeys);
+    BenchReport("std::stable_sort U32 key + U32 value", stdPairsMs, numKeys);
+
+    arena.Reset();
+}
+
+static void BenchRadixSort()
+{
+    LinearAllocator arena;
+    arena.InitVirtual(GiB(4));
+    BenchRadixSortSize(arena, 10000);
+    BenchRadixSortSize(arena, 1000000);
+    BenchRadixSortSize(arena, 16000000);
+    arena.Release();
+}
+
+void RunSortBenchmarks()
+{
+    BenchRadixSort();
+}
@@ -0,0 +1,168 @@
+#include "SM/Sort.h"
+#include "SM/Random.h"
+#include "Tests/Test.h"
+
+#include <algorithm>
+
+using namespace SM;
+
+//------------------------------------------------------------------------------------------------------------------------
+// Radix sort
+//------------------------------------------------------------------------------------------------------------------------
+// Large enough that every thread count up to 4 gets its own range instead of falling back to the calling thread
+static const size_t kRadixTestThreadedCount = 300007;
+static const U32 kRadixTestMaxThreads = 64;
+
+enum RadixTestKeys
+{
+    kRadixTestKeysRandom,
+    kRadixTestKeysFewDistinct,
+    kRadixTestKeysHighByteOnly,
+    kRadixTestKeysMiddleByteOnly,
+    kRadixTestKeysAllEqual,
+    kRadixTestKeysDescending,
+    kRadixTestNumKeyPatterns
+};
+
+static const char* s_radixTestKeyNames[] = { "random", "few distinct", "high byte only", "middle byte only", "all equal", "descending" };
+
+template<typename Key>
+struct RadixTestPair
+{
+    Key m_key;
+    U32 m_index;
+};
+
+// Values are derived from the original index so the reference order can be checked without storing a second copy, U64
+// values use the top bits too so a value truncated to 32 bits is caught
+template<typename Value>
+static Value MakeRadixTestValue(size_t index)
+{
+    return (Value)(index * 0x9e3779b97f4a7c15ull);
+}
+
+// Only the bytes a pattern varies in are random so the sort has to skip every pass over the constant bytes
+template<typename Key>
+static void FillRadixTestKeys(Key* pKeys, size_t numKeys, RadixTestKeys pattern, Rng& rng)
+{
+    const U32 kHighShift = (sizeof(Key) - 1) * 8;
+    const U32 kMiddleShift = (sizeof(Key) / 2) * 8;
+    const Key kConstantBits = (Key)0x5a5a5a5a5a5a5a5aull;
+    for(size_t i = 0; i < numKeys; i++)
+    {
+        Key random = (Key)rng.NextU64();
+        switch(pattern)
+        {
+            case kRadixTestKeysRandom: pKeys[i] = random; break;
+            case kRadixTestKeysFewDistinct: pKeys[i] = (Key)(rng.NextU32(5) * 0x0101010101010101ull); break;
+            case kRadixTestKeysHighByteOnly: pKeys[i] = (kConstantBits & ~((Key)0xff << kHighShift)) | (random & ((Key)0xff << kHighShift)); break;
+            case kRadixTestKeysMiddleByteOnly: pKeys[i] = (kConstantBits & ~((Key)0xff << kMiddleShift)) | (random & ((Key)0xff << kMiddleShift)); break;
+            case kRadixTestKeysAllEqual: pKeys[i] = kConstantBits; break;
+            case kRadixTestKeysDescending: pKeys[i] = (Key)(numKeys - i) << 8; break;
+            default: break;
+        }
+    }
+}
+
+// Sorts a copy of the keys with and without values and compares both against std::stable_sort of key / index pairs
+template<typename Key, typename Value>
+static bool CheckRadixSort(const Key* pSourceKeys, size_t numKeys, U32 numThreads, LinearAllocator& arena, LinearAllocator& scratch)
+{
+    size_t restoreAllocatedBytes = arena.m_allocatedBytes;
+
+    RadixTestPair<Key>* pReference = arena.Alloc<RadixTestPair<Key>>(numKeys);
+    Key* pKeys = arena.Alloc<Key>(numKeys);
+    Key* pKeysOnly = arena.Alloc<Key>(numKeys);
+    Value* pValues = arena.Alloc<Value>(numKeys);
+    for(size_t i = 0; i < numKeys; i++)
+    {
+        pReference[i] = RadixTestPair<Key>{ pSourceKeys[i], (U32)i };
+        pKeys[i] = pSourceKeys[i];
+        pKeysOnly[i] = pSourceKeys[i];
+        pValues[i] = MakeRadixTestValue<Value>(i);
+    }
+    std::stable_sort(pReference, pReference + numKeys, [](const RadixTestPair<Key>& a, const RadixTestPair<Key>& b) { return a.m_key < b.m_key; });
+
+    // the count 0 case gets no storage at all so any access would fault
+    if(numKeys == 0)
+    {
+        pKeys = nullptr;
+        pKeysOnly = nullptr;
+        pValues = nullptr;
+    }
+
+    size_t scratchAllocatedBytes = scratch.m_allocatedBytes;
+    RadixSort(pKeys, pValues, numKeys, &scratch, numThreads);
+    RadixSort(pKeysOnly, numKeys, &scratch, numThreads);
+
+    size_t numKeyMismatches = 0;
+    size_t numValueMismatches = 0;
+    for(size_t i = 0; i < numKeys; i++)
+    {
+        numKeyMismatches += (pKeys[i] != pReference[i].m_key || pKeysOnly[i] != pReference[i].m_key) ? 1 : 0;
+        numValueMismatches += pValues[i] != MakeRadixTestValue<Value>(pReference[i].m_index) ? 1 : 0;
+    }
+
+    bool bPassed = SM_TEST_CHECK(numKeyMismatches == 0 && numValueMismatches == 0);
+    bPassed &= SM_TEST_CHECK(scratch.m_allocatedBytes == scratchAllocatedBytes);
+    if(!bPassed)
+    {
+        printf("    %llu key and %llu value mismatches\n", (unsigned long long)numKeyMismatches, (unsigned long long)numValueMismatches);
+    }
+
+    arena.m_allocatedBytes = restoreAllocatedBytes;
+    return bPassed;
+}
+
+template<typename Key, typename Value>
+static void TestRadixSortType(const char* name, LinearAllocator& arena, LinearAllocator& scratch)
+{
+    static const size_t s_numKeys[] = { 0, 1, 2, 3, 255, 256, 1000, 4099 };
+
+    Rng rng(13);
+    Key* pSourceKeys = arena.Alloc<Key>(kRadixTestThreadedCount);
+    for(U32 pattern = 0; pattern < kRadixTestNumKeyPatterns; pattern++)
+    {
+        for(size_t numKeys : s_numKeys)
+        {
+            FillRadixTestKeys(pSourceKeys, numKeys, (RadixTestKeys)pattern, rng);
+            if(!CheckRadixSort<Key, Value>(pSourceKeys, numKeys, 1, arena, scratch))
+            {
+                printf("    %s, %s keys, %llu keys\n", name, s_radixTestKeyNames[pattern], (unsigned long long)numKeys);
+            }
+        }
+
+        // the threaded path splits histograms and scatters per range, which has to stay stable across the ranges
+        FillRadixTestKeys(pSourceKeys, kRadixTestThreadedCount, (RadixTestKeys)pattern, rng);
+        U32 maxThreads = Min(GetTestMaxThreads(), kRadixTestMaxThreads);
+        for(U32 numThreads = 1; numThreads <= maxThreads; numThreads = GetNextTestThreadCount(numThreads))
+        {
+            if(!CheckRadixSort<Key, Value>(pSourceKeys, kRadixTestThreadedCount, numThreads, arena, scratch))
+            {
+                printf("    %s, %s keys, %llu keys, %u threads\n", name, s_radixTestKeyNames[pattern], (unsigned long long)kRadixTestThreadedCount,
+                       numThreads);
+            }
+        }
+    }
+}
+
+static void TestRadixSort()
+{
+    LinearAllocator arena;
+    arena.InitVirtual(GiB(1));
+    LinearAllocator scratch;
+    scratch.InitVirtual(GiB(1));
+
+    TestRadixSortType<U32, U32>("U32 keys, U32 values", arena, scratch);
+    TestRadixSortType<U32, U64>("U32 keys, U64 values", arena, scratch);
+    TestRadixSortType<U64, U32>("U64 keys, U32 values", arena, scratch);
+    TestRadixSortType<U64, U64>("U64 keys, U64 values", arena, scratch);
+
+    scratch.Release();
+    arena.Release();
+}
+
+static void RunSortTests()
+{
+    TestRadixSort();
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "SM/StandardTypes.h"
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+namespace SM
+{
+    // Failed checks are counted and reported instead of asserting so one run lists every broken case.
+    // Checks can be made from any thread.
+    struct TestStats
+    {
+        std::atomic<U64> m_numChecks = 0;
+        std::atomic<U64> m_numFailures = 0;
+    };
+
+    inline TestStats& GetTestStats()
+    {
+        static TestStats s_stats;
+        return s_stats;
+    }
+
+    inline bool TestCheck(bool bPassed, const char* expression, const char* filename, I32 lineNumber)
+    {
+        TestStats& stats = GetTestStats();
+        stats.m_numChecks++;
+        if(!bPassed)
+        {
+            stats.m_numFailures++;
+            printf("    FAILED %s(%i): %s\n", filename, lineNumber, expression);
+        }
+        return bPassed;
+    }
+
+    #define SM_TEST_CHECK(expr) TestCheck((expr), #expr, __FILE__, __LINE__)
+
+    // Thread counts to sweep are 1, 2, 4, ... up to the number of hardware threads but at least 4 so contention is
+    // still exercised on small machines
+    inline U32 GetTestMaxThreads()
+    {
+        U32 numHardwareThreads = std::thread::hardware_concurrency();
+        return numHardwareThreads > 4 ? numHardwareThreads : 4;
+    }
+
+    inline U32 GetNextTestThreadCount(U32 numThreads)
+    {
+        U32 maxThreads = GetTestMaxThreads();
+        return (numThreads < maxThreads && numThreads * 2 > maxThreads) ? maxThreads : numThreads * 2;
+    }
+}
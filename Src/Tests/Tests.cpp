@@ -0,0 +1,56 @@
+// Test runner, built by EngineBuild.bat as SM-Tests.exe against the debug engine so asserts stay on.
+// Pass a suite name to run only that suite, e.g. SM-Tests.exe Containers. Returns non zero when any check fails.
+
+#include "SM/Engine.h"
+#include "Tests/Test.h"
+
+#include <cstring>
+
+#include "Tests/ContainersTests.cpp"
+#include "Tests/GeometryTests.cpp"
+#include "Tests/MathTests.cpp"
+#include "Tests/MemoryTests.cpp"
+#include "Tests/QuantizeTests.cpp"
+#include "Tests/RandomTests.cpp"
+#include "Tests/SortTests.cpp"
+#include "Tests/TimerTests.cpp"
+
+using namespace SM;
+
+struct TestSuite
+{
+    const char* m_name;
+    void (*m_run)();
+};
+
+static const TestSuite s_testSuites[] =
+{
+    { "Containers", RunContainerTests },
+    { "Geometry", RunGeometryTests },
+    { "Math", RunMathTests },
+    { "Memory", RunMemoryTests },
+    { "Quantize", RunQuantizeTests },
+    { "Random", RunRandomTests },
+    { "Sort", RunSortTests },
+    { "Timer", RunTimerTests },
+};
+
+int main(int argc, char** argv)
+{
+    EngineConfig config;
+    SM::Init(config);
+
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    for(const TestSuite& suite : s_testSuites)
+    {
+        if(filter != nullptr && ::strcmp(filter, suite.m_name) != 0)
+            continue;
+
+        printf("==== %s ====\n", suite.m_name);
+        suite.m_run();
+    }
+
+    TestStats& stats = GetTestStats();
+    printf("\n%llu checks, %llu failed\n", (unsigned long long)stats.m_numChecks.load(), (unsigned long long)stats.m_numFailures.load());
+    return stats.m_numFailures.load() == 0 ? 0 : 1;
+}
@@ -0,0 +1,236 @@
+#include "SM/Timer.h"
+#include "SM/Random.h"
+#include "Tests/Test.h"
+
+using namespace SM;
+
+//------------------------------------------------------------------------------------------------------------------------
+// Timer wheel
+//------------------------------------------------------------------------------------------------------------------------
+static const U32 kTimerTestNumTimers = 2000;
+static const U32 kTimerTestMaxUpdates = 16384;
+
+static void CountTimerFire(void* pUserData)
+{
+    (*(U32*)pUserData)++;
+}
+
+// Timers scheduled before the first Update used to count from tick 0 while the performance counter counts from boot, so
+// a repeating timer fired once per interval of uptime and every early one shot fired on the first Update
+static void TestTimerFirstUpdate()
+{
+    TimerWheel wheel(GetBuiltInHeap());
+    U32 numRepeatFires = 0;
+    U32 numOneShotFires = 0;
+    wheel.Schedule(1.0f, CountTimerFire, &numRepeatFires, 1.0f);
+    wheel.Schedule(0.5f, CountTimerFire, &numOneShotFires);
+
+    wheel.Update(86400.0);
+    bool bPassed = SM_TEST_CHECK(numRepeatFires == 0 && numOneShotFires == 0 && wheel.GetNumPending() == 2);
+
+    wheel.Update(86400.499);
+    bPassed &= SM_TEST_CHECK(numRepeatFires == 0 && numOneShotFires == 0);
+    wheel.Update(86400.5);
+    bPassed &= SM_TEST_CHECK(numRepeatFires == 0 && numOneShotFires == 1);
+    wheel.Update(86401.0);
+    bPassed &= SM_TEST_CHECK(numRepeatFires == 1 && numOneShotFires == 1);
+    wheel.Update(86410.0);
+    bPassed &= SM_TEST_CHECK(numRepeatFires == 10 && numOneShotFires == 1 && wheel.GetNumPending() == 1);
+    if(!bPassed)
+    {
+        printf("    caller time: %u repeat fires, %u one shot fires\n", numRepeatFires, numOneShotFires);
+    }
+
+    // the same through the performance counter overload, nothing is due until a second after the first Update
+    TimerWheel counterWheel(GetBuiltInHeap());
+    U32 numCounterFires = 0;
+    counterWheel.Schedule(1.0f, CountTimerFire, &numCounterFires, 1.0f);
+    counterWheel.Update();
+    counterWheel.Update();
+    if(!SM_TEST_CHECK(numCounterFires == 0 && counterWheel.GetNumPending() == 1))
+    {
+        printf("    performance counter: %u repeat fires\n", numCounterFires);
+    }
+}
+
+struct TimerOrderTest
+{
+    U64 m_expiryTicks[kTimerTestNumTimers];
+    U32 m_firedUpdates[kTimerTestNumTimers];
+    U32 m_numFires[kTimerTestNumTimers];
+    U32 m_firedOrder[kTimerTestNumTimers];
+    U32 m_numFired = 0;
+    U32 m_updateIndex = 0;
+};
+
+struct TimerOrderTestTimer
+{
+    TimerOrderTest* m_pTest;
+    U32 m_id;
+};
+
+static void RecordTimerFire(void* pUserData)
+{
+    TimerOrderTestTimer* pTimer = (TimerOrderTestTimer*)pUserData;
+    TimerOrderTest* pTest = pTimer->m_pTest;
+    pTest->m_numFires[pTimer->m_id]++;
+    pTest->m_firedUpdates[pTimer->m_id] = pTest->m_updateIndex;
+    pTest->m_firedOrder[pTest->m_numFired++] = pTimer->m_id;
+}
+
+// Delays from a tick to past the furthest level so timers go through every level, cascade and get parked and re-bucketed.
+// Each timer has to fire exactly once on the first Update that reaches its tick and in order of expiry.
+static void TestTimerOrder()
+{
+    LinearAllocator arena;
+    arena.InitVirtual(MiB(16));
+    TimerOrderTest* pTest = arena.Alloc<TimerOrderTest>();
+    new(pTest) TimerOrderTest();
+    TimerOrderTestTimer* pTimers = arena.Alloc<TimerOrderTestTimer>(kTimerTestNumTimers);
+    TimerHandle* pHandles = arena.Alloc<TimerHandle>(kTimerTestNumTimers);
+    bool* pCancelled = arena.Alloc<bool>(kTimerTestNumTimers);
+
+    TimerWheel wheel(GetBuiltInHeap());
+    wheel.Update(0.0);
+
+    static const F32 s_maxDelays[] = { 0.3f, 20.0f, 2000.0f, 100000.0f };
+    Rng rng(15);
+    for(U32 i = 0; i < kTimerTestNumTimers; i++)
+    {
+        F32 delay = rng.NextU32(16) == 0 ? 0.0f : rng.NextF32(0.0f, s_maxDelays[i % 4]);
+        pTimers[i] = TimerOrderTestTimer{ pTest, i };
+        pTest->m_expiryTicks[i] = (U64)((F64)delay * TimerWheel::kTimerWheelTicksPerSecond + 0.5);
+        pHandles[i] = wheel.Schedule(delay, RecordTimerFire, &pTimers[i]);
+    }
+
+    // cancelled timers must never fire and their handles go stale
+    U32 numCancelled = 0;
+    U32 numBadCancels = 0;
+    for(U32 i = 0; i < kTimerTestNumTimers; i++)
+    {
+        pCancelled[i] = i % 5 == 0;
+        if(pCancelled[i])
+        {
+            numBadCancels += wheel.Cancel(pHandles[i]) ? 0 : 1;
+            numBadCancels += (wheel.Cancel(pHandles[i]) || wheel.IsPending(pHandles[i])) ? 1 : 0;
+            numCancelled++;
+        }
+    }
+    SM_TEST_CHECK(numBadCancels == 0 && wheel.GetNumPending() == kTimerTestNumTimers - numCancelled);
+
+    // uneven steps, mostly short ones with the odd jump over thousands of ticks
+    U64 maxExpiryTick = (U64)(s_maxDelays[3] * TimerWheel::kTimerWheelTicksPerSecond) + 1;
+    U64* pUpdateTicks = arena.Alloc<U64>(kTimerTestMaxUpdates);
+    U64 nowTick = 0;
+    while(nowTick <= maxExpiryTick && pTest->m_updateIndex < kTimerTestMaxUpdates)
+    {
+        nowTick += rng.NextU32(4) == 0 ? rng.NextU32(300000) : rng.NextU32(64);
+        pUpdateTicks[pTest->m_updateIndex] = nowTick;
+        wheel.Update((F64)nowTick / TimerWheel::kTimerWheelTicksPerSecond);
+        pTest->m_updateIndex++;
+    }
+
+    U32 numWrongFires = 0;
+    U32 numWrongUpdates = 0;
+    for(U32 i = 0; i < kTimerTestNumTimers; i++)
+    {
+        numWrongFires += pTest->m_numFires[i] != (pCancelled[i] ? 0u : 1u) ? 1 : 0;
+        if(pTest->m_numFires[i] == 1)
+        {
+            U32 update = pTest->m_firedUpdates[i];
+            U64 expiryTick = pTest->m_expiryTicks[i];
+            numWrongUpdates += (pUpdateTicks[update] < expiryTick || (update > 0 && pUpdateTicks[update - 1] >= expiryTick)) ? 1 : 0;
+        }
+    }
+
+    U32 numOutOfOrder = 0;
+    for(U32 i = 1; i < pTest->m_numFired; i++)
+    {
+        numOutOfOrder += pTest->m_expiryTicks[pTest->m_firedOrder[i]] < pTest->m_expiryTicks[pTest->m_firedOrder[i - 1]] ? 1 : 0;
+    }
+
+    bool bPassed = SM_TEST_CHECK(numWrongFires == 0 && numWrongUpdates == 0 && numOutOfOrder == 0);
+    bPassed &= SM_TEST_CHECK(pTest->m_numFired == kTimerTestNumTimers - numCancelled && wheel.GetNumPending() == 0);
+    if(!bPassed)
+    {
+        printf("    %u timers fired the wrong number of times, %u on the wrong update, %u out of order\n", numWrongFires,
+               numWrongUpdates, numOutOfOrder);
+    }
+
+    arena.Release();
+}
+
+struct TimerRepeatTest
+{
+    TimerWheel* m_pWheel;
+    TimerHandle m_handle;
+    U32 m_numFires;
+    U32 m_cancelAfter;
+};
+
+static void RepeatTimerFire(void* pUserData)
+{
+    TimerRepeatTest* pTest = (TimerRepeatTest*)pUserData;
+    if(++pTest->m_numFires == pTest->m_cancelAfter)
+    {
+        pTest->m_pWheel->Cancel(pTest->m_handle);
+    }
+}
+
+static void TestTimerRepeat()
+{
+    TimerWheel wheel(GetBuiltInHeap());
+    wheel.Update(10.0);
+
+    // fires every 250 ticks from the schedule time, including the ones skipped over by an update longer than the interval
+    TimerRepeatTest repeat = { &wheel, {}, 0, 0 };
+    repeat.m_handle = wheel.Schedule(0.25f, RepeatTimerFire, &repeat, 0.25f);
+
+    // a repeating timer can cancel itself from its own callback
+    TimerRepeatTest selfCancel = { &wheel, {}, 0, 3 };
+    selfCancel.m_handle = wheel.Schedule(0.1f, RepeatTimerFire, &selfCancel, 0.1f);
+
+    U32 numWrongCounts = 0;
+    for(U32 step = 1; step <= 100; step++)
+    {
+        wheel.Update(10.0 + step * 0.1);
+        numWrongCounts += repeat.m_numFires != step * 100 / 250 ? 1 : 0;
+    }
+    wheel.Update(32.0);
+    numWrongCounts += repeat.m_numFires != 22 * 4 ? 1 : 0;
+
+    bool bPassed = SM_TEST_CHECK(numWrongCounts == 0 && selfCancel.m_numFires == 3 && !wheel.IsPending(selfCancel.m_handle));
+    bPassed &= SM_TEST_CHECK(wheel.IsPending(repeat.m_handle) && wheel.GetNumPending() == 1);
+    if(!bPassed)
+    {
+        printf("    %u wrong repeat counts, %u repeat fires, %u fires of the self cancelling timer\n", numWrongCounts,
+               repeat.m_numFires, selfCancel.m_numFires);
+    }
+
+    SM_TEST_CHECK(wheel.Cancel(repeat.m_handle) && wheel.GetNumPending() == 0);
+    wheel.Update(40.0);
+    SM_TEST_CHECK(repeat.m_numFires == 22 * 4);
+}
+
+// A released timer is reused by the next Schedule, the old handle must not reach the new timer
+static void TestTimerHandleReuse()
+{
+    TimerWheel wheel(GetBuiltInHeap());
+    U32 numFired = 0;
+    TimerHandle first = wheel.Schedule(1.0f, CountTimerFire, &numFired);
+    wheel.Cancel(first);
+    TimerHandle second = wheel.Schedule(1.0f, CountTimerFire, &numFired);
+    SM_TEST_CHECK(second.m_index == first.m_index && second.m_generation != first.m_generation);
+    SM_TEST_CHECK(!wheel.Cancel(first) && !wheel.IsPending(first) && wheel.IsPending(second));
+    wheel.Update(0.0);
+    wheel.Update(1.0);
+    SM_TEST_CHECK(numFired == 1 && !wheel.IsPending(second));
+}
+
+static void RunTimerTests()
+{
+    TestTimerFirstUpdate();
+    TestTimerOrder();
+    TestTimerRepeat();
+    TestTimerHandleReuse();
+}